@@ -1,14 +1,17 @@
 //*************************************************************************************
 /** \file character_database.cpp
- *    This file contains a task class for running a user interface for the motor
- *    controller demonstration. It has a single-state task which just reads the
- *    serial port to see if the user typed anything, and acts if s/he has done so. 
+ *    This file contains the character database, which holds the gesture used to
+ *    fingerspell every character the hand knows. Every character is an entry 
+ *    pointing at one or more gesture steps; every step holds a packed target for each
+ *    of the 13 outputs. All of it is constant data in program memory, and finding a
+ *    character is a single table read. 
  *
  *  Revisions:
  *    \li 02-06-2008 JRR Original file
  *    \li 05-15-2008 JRR Modified to work with two motor drivers rather than one
  *    \li 03-08-2009 JRR Added code to test A/D converter
  *    \li 01-19-2011 JRR Updated calls to newer version of stl_task constructor
+ *    \li 10-16-2026 Tables moved to program memory, character objects removed
  *
  *  License:
  *    This file released under the Lesser GNU Public License, version 2. This program
@@ -17,211 +20,240 @@
 //*************************************************************************************
 
 #include <stdlib.h>
-#include <avr/io.h>
-#include "character.h"
+#include "lib/hal.h"
+#include "gesture.h"
 #include "character_database.h"
 
+
+// These macros keep the table below readable. They are only used in this file.
+#define NC		GESTURE_NO_CHANGE			///< Leave this motor alone
+#define Pa		1							///< Slave set point 'a'
+#define Pb		2							///< Slave set point 'b'
+#define Pc		3							///< Slave set point 'c'
+#define Pd		4							///< Slave set point 'd'
+#define Pe		5							///< Slave set point 'e'
+#define X0		1							///< Index spread switch off
+#define X1		2							///< Index spread switch on
+#define W0		1							///< Wrist servo at 0 degrees
+#define W45		2							///< Wrist servo at 45 degrees
+#define W90		3							///< Wrist servo at 90 degrees
+
+#define IT		GESTURE_INTERFERE_THUMB
+#define II		GESTURE_INTERFERE_INDEX
+#define IM		GESTURE_INTERFERE_MIDDLE
+#define IR		GESTURE_INTERFERE_RING
+#define IP		GESTURE_INTERFERE_PINKY
+
+#define NA		CHARACTER_NONE				///< Character not in the database
+
+/// This macro packs the 13 motor targets of one step two to a byte
+#define GESTURE_STEP(m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11, m12, m13, intf) \
+	{ { (m1) | ((m2) << 4), (m3) | ((m4) << 4), (m5) | ((m6) << 4), \
+		(m7) | ((m8) << 4), (m9) | ((m10) << 4), (m11) | ((m12) << 4), (m13) }, (intf) }
+
+
 //-------------------------------------------------------------------------------------
-/** This constructor creates a slave_picker object. It outputs the correct pins to
- *  choose multiplexer outputs to make sure the master is communicating with the right
- *  slave chips.
+/** This table holds every step of every character. The columns are motors 1 through
+ *  13 followed by the fingers which the step leaves in an interfering position.
  */
 
-character_database::character_database ()
+const gesture_step character_steps[] PROGMEM = 
 {
-	character_array = new character[36];
-	
-	create_all_characters();
-}
+	//            M1   M2   M3   M4   M5   M6   M7   M8   M9   M10  M11  M12  M13  Interference
+	GESTURE_STEP (Pc , Pc , Pc , Pc , Pe , Pb , Pb , Pb , Pc , Pc , NC , W0 , W0 , 0),	// 0
+	GESTURE_STEP (Pa , Pe , Pe , Pe , Pa , Pa , Pa , Pa , Pa , Pe , NC , W0 , W0 , 0),	// 1
+	GESTURE_STEP (Pa , Pa , Pe , Pe , Pa , Pa , Pa , Pa , Pa , Pa , NC , W0 , W0 , 0),	// 2
+	GESTURE_STEP (Pa , Pa , Pe , Pe , Pa , Pe , Pa , Pa , Pa , Pa , NC , W0 , W0 , 0),	// 3
+	GESTURE_STEP (Pa , Pa , Pa , Pa , Pe , Pa , Pb , Pb , Pa , Pa , NC , W0 , W0 , 0),	// 4
+	GESTURE_STEP (NC , NC , NC , NC , Pc , Pc , Pe , Pa , NC , NC , NC , NC , NC , IT),	// 4
+	GESTURE_STEP (Pa , Pa , Pa , Pa , Pa , Pe , Pa , Pa , Pa , Pa , NC , W0 , W0 , 0),	// 5
+	GESTURE_STEP (Pa , Pa , Pa , Pe , Pe , Pa , Pb , Pb , Pa , Pa , NC , W0 , W0 , 0),	// 6
+	GESTURE_STEP (NC , NC , NC , NC , Pc , Pc , Pe , Pa , NC , NC , NC , NC , NC , IT),	// 6
+	GESTURE_STEP (Pa , Pa , Pe , Pa , Pe , Pa , Pb , Pb , Pa , Pa , NC , W0 , W0 , 0),	// 7
+	GESTURE_STEP (NC , NC , NC , NC , Pc , Pc , Pe , Pa , NC , NC , NC , NC , NC , IT),	// 7
+	GESTURE_STEP (Pa , Pe , Pa , Pa , Pe , Pa , Pb , Pb , Pa , Pe , NC , W0 , W0 , 0),	// 8
+	GESTURE_STEP (NC , NC , NC , NC , Pc , Pc , Pe , Pa , NC , NC , NC , NC , NC , IT),	// 8
+	GESTURE_STEP (Pe , Pa , Pa , Pa , Pa , Pa , Pa , Pa , Pe , Pa , NC , W0 , W0 , 0),	// 9
+	GESTURE_STEP (Pe , Pe , Pe , Pe , Pa , Pa , Pa , Pa , Pe , Pe , NC , W0 , W0 , 0),	// A
+	GESTURE_STEP (Pc , Pc , Pc , Pe , Pe , Pa , Pb , Pb , Pc , Pc , NC , W0 , W0 , 0),	// C
+	GESTURE_STEP (Pa , Pc , Pc , Pe , Pe , Pb , Pb , Pb , Pa , Pc , NC , W0 , W0 , 0),	// D
+	GESTURE_STEP (Pa , Pa , Pa , Pa , Pe , Pa , Pb , Pb , Pa , Pa , NC , W0 , W0 , 0),	// E
+	GESTURE_STEP (Pc , Pc , Pc , Pc , Pc , Pc , Pe , Pa , Pc , Pc , NC , NC , NC , IT|II|IM|IR|IP),	// E
+	GESTURE_STEP (Pe , Pa , Pa , Pa , Pa , Pa , Pa , Pa , Pe , Pa , NC , W0 , W0 , 0),	// F
+	GESTURE_STEP (Pa , Pe , Pe , Pe , Pa , Pa , Pa , Pa , Pa , Pe , NC , W90, W0 , 0),	// G
+	GESTURE_STEP (Pa , Pa , Pe , Pe , Pa , Pa , Pa , Pa , Pa , Pa , NC , W90, W0 , 0),	// H
+	GESTURE_STEP (Pe , Pe , Pe , Pa , Pa , Pa , Pa , Pa , Pe , Pe , NC , W0 , W0 , 0),	// I
+	GESTURE_STEP (Pe , Pe , Pe , Pa , Pa , Pa , Pa , Pa , Pe , Pe , NC , W0 , W0 , 0),	// J
+	GESTURE_STEP (NC , NC , NC , NC , NC , NC , NC , NC , NC , NC , NC , W90, W0 , 0),	// J
+	GESTURE_STEP (NC , NC , NC , NC , NC , NC , NC , NC , NC , NC , NC , W90, W90, 0),	// J
+	GESTURE_STEP (NC , NC , NC , NC , NC , NC , NC , NC , NC , NC , NC , W0 , W90, 0),	// J
+	GESTURE_STEP (Pa , Pa , Pe , Pe , Pa , Pa , Pa , Pa , Pa , Pa , NC , W0 , W0 , 0),	// K
+	GESTURE_STEP (NC , NC , NC , NC , Pc , Pc , Pe , Pa , NC , NC , NC , NC , NC , IT),	// K
+	GESTURE_STEP (Pa , Pe , Pe , Pe , Pa , Pe , Pa , Pa , Pa , Pe , NC , W0 , W0 , 0),	// L
+	GESTURE_STEP (Pa , Pa , Pa , Pe , Pc , Pc , Pe , Pa , Pa , Pa , NC , W0 , W0 , 0),	// M
+	GESTURE_STEP (Pa , Pa , Pc , NC , NC , NC , NC , NC , Pe , Pe , NC , NC , NC , IT|II|IM|IR),	// M
+	GESTURE_STEP (Pa , Pa , Pe , Pe , Pc , Pc , Pe , Pa , Pa , Pa , NC , W0 , W0 , 0),	// N
+	GESTURE_STEP (Pa , Pa , NC , NC , NC , NC , NC , NC , Pe , Pe , NC , NC , NC , IT|II|IM),	// N
+	GESTURE_STEP (Pa , Pe , Pe , Pe , Pe , Pa , Pa , Pa , Pa , Pa , NC , W90, W0 , IT|IM),	// P
+	GESTURE_STEP (Pe , Pe , Pe , Pe , Pe , Pa , Pb , Pb , Pa , Pe , NC , W90, W0 , 0),	// Q
+	GESTURE_STEP (Pc , Pe , Pe , Pe , Pa , Pa , Pa , Pa , Pa , Pe , X1 , W0 , W0 , II),	// R
+	GESTURE_STEP (Pe , Pe , Pe , Pe , Pe , Pa , Pb , Pb , Pe , Pe , NC , W0 , W0 , 0),	// S
+	GESTURE_STEP (NC , NC , NC , NC , Pc , Pc , Pe , Pa , NC , NC , NC , NC , NC , IT),	// S
+	GESTURE_STEP (Pa , Pe , Pe , Pe , Pa , Pa , Pa , Pa , Pe , Pe , NC , W0 , W0 , 0),	// T
+	GESTURE_STEP (NC , NC , NC , NC , Pc , Pc , Pe , Pa , NC , NC , NC , NC , NC , IT|II),	// T
+	GESTURE_STEP (Pa , Pa , Pe , Pe , Pa , Pa , Pa , Pa , Pa , Pa , NC , W0 , W0 , 0),	// U
+	GESTURE_STEP (Pa , NC , NC , NC , NC , NC , NC , NC , Pa , NC , X1 , NC , NC , IT|II),	// U
+	GESTURE_STEP (Pa , Pe , Pe , Pe , Pe , Pa , Pb , Pb , Pa , Pe , NC , W0 , W0 , 0),	// X
+	GESTURE_STEP (Pa , NC , NC , NC , Pc , Pc , Pe , Pa , Pe , NC , NC , NC , NC , IT|II),	// X
+	GESTURE_STEP (Pe , Pe , Pe , Pa , Pa , Pe , Pa , Pa , Pe , Pe , NC , W0 , W0 , 0),	// Y
+	GESTURE_STEP (Pe , Pe , Pe , Pa , Pa , Pa , Pa , Pa , Pe , Pe , NC , W45, W45, 0),	// Z
+	GESTURE_STEP (NC , NC , NC , NC , NC , NC , NC , NC , NC , NC , NC , W45, W0 , 0),	// Z
+	GESTURE_STEP (NC , NC , NC , NC , NC , NC , NC , NC , NC , NC , NC , W90, W45, 0),	// Z
+	GESTURE_STEP (NC , NC , NC , NC , NC , NC , NC , NC , NC , NC , NC , W90, W0 , 0)	// Z
+};
 
-void character_database::create_all_characters(void)
+
+//-------------------------------------------------------------------------------------
+/** This table gives the first step and number of steps of each character. Characters
+ *  which share a hand shape (0 and O, 4 and B, 6 and W, 2 and V) share their steps. 
+ */
+
+const character_entry character_entries[NUM_CHARACTERS] PROGMEM = 
+{
+	{  0, 1 },	// 0
+	{  1, 1 },	// 1
+	{  2, 1 },	// 2
+	{  3, 1 },	// 3
+	{  4, 2 },	// 4
+	{  6, 1 },	// 5
+	{  7, 2 },	// 6
+	{  9, 2 },	// 7
+	{ 11, 2 },	// 8
+	{ 13, 1 },	// 9
+	{ 14, 1 },	// A
+	{  4, 2 },	// B
+	{ 15, 1 },	// C
+	{ 16, 1 },	// D
+	{ 17, 2 },	// E
+	{ 19, 1 },	// F
+	{ 20, 1 },	// G
+	{ 21, 1 },	// H
+	{ 22, 1 },	// I
+	{ 23, 4 },	// J
+	{ 27, 2 },	// K
+	{ 29, 1 },	// L
+	{ 30, 2 },	// M
+	{ 32, 2 },	// N
+	{  0, 1 },	// O
+	{ 34, 1 },	// P
+	{ 35, 1 },	// Q
+	{ 36, 1 },	// R
+	{ 37, 2 },	// S
+	{ 39, 2 },	// T
+	{ 41, 2 },	// U
+	{  2, 1 },	// V
+	{  7, 2 },	// W
+	{ 43, 2 },	// X
+	{ 45, 1 },	// Y
+	{ 46, 4 },	// Z
+	{  0, 0 },	// ,
+	{  0, 0 },	// .
+	{  0, 0 }	// space
+};
+
+
+//-------------------------------------------------------------------------------------
+/** This table gives the characters held in each row of the database. 
+ */
+
+const char character_letters[NUM_CHARACTERS + 1] PROGMEM = 
+	"0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ,. ";
+
+
+//-------------------------------------------------------------------------------------
+/** This table maps every 7-bit ASCII code to its row in the database. Upper and lower
+ *  case letters share a row. 
+ */
+
+const uint8_t character_index_table[128] PROGMEM = 
+{
+	NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA,	// 0x00-0x0F
+	NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA,	// 0x10-0x1F
+	38, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, 36, NA, 37, NA,	// 0x20-0x2F
+	 0,  1,  2,  3,  4,  5,  6,  7,  8,  9, NA, NA, NA, NA, NA, NA,	// 0x30-0x3F
+	NA, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24,	// 0x40-0x4F
+	25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, NA, NA, NA, NA, NA,	// 0x50-0x5F
+	NA, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24,	// 0x60-0x6F
+	25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, NA, NA, NA, NA, NA	// 0x70-0x7F
+};
+
+
+//-------------------------------------------------------------------------------------
+/** This constructor creates a character database object. Everything is in program 
+ *  memory already, so there is nothing to set up. 
+ */
+
+character_database::character_database (void)
 {
-	// Create characters
-			character_array[0].set_letter_and_steps('0',1);
-			character_array[1].set_letter_and_steps('1',1);
-			character_array[2].set_letter_and_steps('2',1);
-			character_array[3].set_letter_and_steps('3',1);
-			character_array[4].set_letter_and_steps('4',2);
-			character_array[5].set_letter_and_steps('5',1);
-			character_array[6].set_letter_and_steps('6',2);
-			character_array[7].set_letter_and_steps('7',2);
-			character_array[8].set_letter_and_steps('8',2);
-			character_array[9].set_letter_and_steps('9',1);
-			character_array[10].set_letter_and_steps('A',1);
-			character_array[11].set_letter_and_steps('B',2);
-			character_array[12].set_letter_and_steps('C',1);
-			character_array[13].set_letter_and_steps('D',1);
-			character_array[14].set_letter_and_steps('E',2);
-			character_array[15].set_letter_and_steps('F',1);
-			character_array[16].set_letter_and_steps('G',1);
-			character_array[17].set_letter_and_steps('H',1);
-			character_array[18].set_letter_and_steps('I',1);
-			character_array[19].set_letter_and_steps('J',4);
-			character_array[20].set_letter_and_steps('K',2);
-			character_array[21].set_letter_and_steps('L',1);
-			character_array[22].set_letter_and_steps('M',2);
-			character_array[23].set_letter_and_steps('N',2);
-			character_array[24].set_letter_and_steps('O',1);
-			character_array[25].set_letter_and_steps('P',1);
-			character_array[26].set_letter_and_steps('Q',1);
-			character_array[27].set_letter_and_steps('R',2);
-			character_array[28].set_letter_and_steps('S',2);
-			character_array[29].set_letter_and_steps('T',3);
-			character_array[30].set_letter_and_steps('U',1);
-			character_array[31].set_letter_and_steps('V',1);
-			character_array[32].set_letter_and_steps('W',1);
-			character_array[33].set_letter_and_steps('X',1);
-			character_array[34].set_letter_and_steps('Y',1);
-			character_array[35].set_letter_and_steps('Z',4);
-	// Populate with correct values
-			character_array[0].set_config(0,1,1,1,1,0,5,0,0);
-			character_array[1].set_config(0,2,2,2,0,0,0,0,0);
-			character_array[2].set_config(0,2,2,0,2,1,0,0,0);
-			character_array[3].set_config(0,2,2,0,0,1,0,0,0);
-			character_array[4].set_config(0,0,0,0,0,0,3,0,0);
-			character_array[4].set_config(1,0,0,0,0,0,2,0,0);
-			character_array[5].set_config(0,0,0,0,0,0,0,0,0);
-			character_array[6].set_config(0,2,0,0,0,0,3,0,0);
-			character_array[6].set_config(1,2,0,0,0,0,2,0,0);
-			character_array[7].set_config(0,0,2,0,0,1,3,0,0);
-			character_array[7].set_config(1,0,2,0,0,1,3,0,0);
-			character_array[8].set_config(0,0,0,2,0,0,3,0,0);
-			character_array[8].set_config(1,0,0,2,0,0,2,0,0);
-			character_array[9].set_config(0,0,0,0,2,0,0,0,0);
-			character_array[10].set_config(0,2,2,2,2,0,0,0,0);
-			character_array[11].set_config(0,0,0,0,0,0,3,0,0);
-			character_array[11].set_config(1,0,0,0,0,0,2,0,0);
-			character_array[12].set_config(0,1,1,1,1,0,3,0,0);
-			character_array[13].set_config(0,1,1,1,1,0,3,0,0);
-			character_array[14].set_config(0,1,1,1,1,0,3,0,0);
-			character_array[14].set_config(1,1,1,1,1,0,2,0,0);
-			character_array[15].set_config(0,0,0,0,3,0,0,0,0);
-			character_array[16].set_config(0,2,2,2,4,0,0,0,0);
-			character_array[17].set_config(0,2,2,4,4,0,0,0,0);
-			character_array[18].set_config(0,0,2,2,2,0,0,0,0);
-			character_array[19].set_config(0,0,2,2,2,0,0,0,0);
-			character_array[19].set_config(1,0,2,2,2,0,0,90,0);
-			character_array[19].set_config(2,0,2,2,2,0,0,90,45);
-			character_array[19].set_config(3,0,2,2,2,0,0,0,45);
-			character_array[20].set_config(0,2,2,0,0,1,0,0,0);
-			character_array[20].set_config(1,2,2,0,0,1,4,0,0);
-			character_array[21].set_config(0,2,2,2,0,0,1,0,0);
-			character_array[22].set_config(0,2,1,3,3,0,3,90,0);
-			character_array[22].set_config(1,2,1,3,3,0,2,90,0);
-			character_array[23].set_config(0,2,2,3,3,0,3,90,0);
-			character_array[23].set_config(1,2,2,3,3,0,2,90,0);
-			character_array[24].set_config(0,1,1,1,1,0,3,0,0);
-			character_array[25].set_config(0,2,2,4,0,0,3,0,0);
-			character_array[26].set_config(0,2,2,2,4,0,3,0,0);
-			character_array[27].set_config(0,2,2,0,5,0,0,0,0);
-			character_array[27].set_config(0,2,2,0,5,0,0,0,0);
-			character_array[28].set_config(0,2,2,2,2,0,1,0,0);
-			character_array[28].set_config(0,2,2,2,2,0,2,0,0);
-			character_array[29].set_config(0,2,2,2,0,1,0,0,0);
-			character_array[29].set_config(0,2,2,2,0,1,4,0,0);
-			character_array[29].set_config(0,2,2,2,3,1,4,0,0);
-			character_array[30].set_config(0,2,2,0,3,0,0,0,0);
-			character_array[31].set_config(0,2,2,0,0,1,0,0,0);
-			character_array[32].set_config(0,2,0,0,0,0,0,0,0);
-			character_array[33].set_config(0,2,2,2,0,0,0,0,0);
-			character_array[34].set_config(0,2,2,2,1,0,1,0,0);
-			character_array[35].set_config(0,2,2,2,0,0,0,0,0);
-			character_array[35].set_config(1,2,2,2,0,0,0,0,45);
-			character_array[35].set_config(2,2,2,2,0,0,0,90,0);
-			character_array[35].set_config(3,2,2,2,0,0,0,90,45);
 }
 
+
 //-------------------------------------------------------------------------------------
-/** This is the function which runs when it is called by the task scheduler. It causes
- *  the motor to move back and forth, having several states to cause such motion. 
- *  @param pinnumber The output pin on the multiplexers
- *  @return Number of gestures for this character
+/** This method finds the row in the database which holds a character. 
+ *  @param input_character The ASCII character to be looked up
+ *  @return The row number, or CHARACTER_NONE if the character isn't in the database
  */
 
 unsigned char character_database::get_index (unsigned char input_character)
 {
-	unsigned char index = 0;
-	
-	// Determine which row in the array matches the character
-	if ( (input_character >= '0')&&(input_character <= '9') )	// Check if it's a number
-	{
-		index = input_character - 0x30;	// Subtract hex 30 to convert from ascii to decimal
-	}
-	else if ( (input_character >= 'A')&&(input_character <= 'Z' ) )	// Check if it's a letter
+	if (input_character & 0x80)
 	{
-		index = input_character - 'A' + 10;	// Subtract 0x41 to shift down to 0. Add 10 to align with gesture_count array.
+		return (CHARACTER_NONE);
 	}
-	else if (input_character == ',')
-	{
-		index = 36;
-	}
-	else if (input_character == '.')
-	{
-		index = 37;
-	}
-	else if (input_character == ' ')
-	{
-		index = 38;
-	}
-
-	// Grab count value using index
-	return(index);
+	return (pgm_read_byte (&character_index_table[input_character]));
 }
 
 
-/** This is the function which runs when it is called by the task scheduler. It causes
- *  the motor to move back and forth, having several states to cause such motion. 
- *  @param pinnumber The output pin on the multiplexers
- *  @return Number of gestures for this character
+//-------------------------------------------------------------------------------------
+/** This method returns the character held in a row of the database. 
+ *  @param index The row number
+ *  @return The character (upper case for letters), or zero if the row isn't valid
  */
 
-/*void character_database::initialize_gesture_count (void)
+unsigned char character_database::get_letter (unsigned char index)
 {
-	// Fill in character column of gesture count array
-	
-			// Fill in 0-9
-			for (unsigned char i = 0; i < 10; i++)
-			{
-				gesture_count[i][0] = 0x30 + i;	// Character 0 + i
-			}
-			
-			// Fill in letters
-			for (unsigned char i = 0; i < 26; i++)
-			{
-				gesture_count[i+10][0] = 0x41 + i;	// Letter A + i
-			}
-			
-			// Comma, period, space
-			gesture_count[36][0] = ',';
-			gesture_count[37][0] = '.';
-			gesture_count[38][0] = ' ';
-	// Fill in count column of gesture count array
-	
-			// Fill in all 1s for default
-			for (unsigned char i = 0; i < NUM_CHARACTERS; i++)
-			{
-				gesture_count[i][1] = 1;
-			}
-			
-			// Add exceptions
-			gesture_count[4][1] = 2;	// 4
-			gesture_count[6][1] = 2;	// 6
-			gesture_count[7][1] = 2;	// 7
-			gesture_count[8][1] = 2;	// 8
-			gesture_count[11][1] = 2;	// B
-			gesture_count[14][1] = 2;	// E
-			gesture_count[19][1] = 4;	// J
-			gesture_count[22][1] = 2;	// M
-			gesture_count[23][1] = 2;	// N
-			gesture_count[27][1] = 2;	// R
-			gesture_count[28][1] = 2;	// S
-			gesture_count[29][1] = 3;	// T
-			gesture_count[35][1] = 4;	// Z
-}*/
-
+	if (index >= NUM_CHARACTERS)
+	{
+		return (0);
+	}
+	return (pgm_read_byte (&character_letters[index]));
+}
 
 
+//-------------------------------------------------------------------------------------
+/** This method returns the number of gesture steps needed to form a character. 
+ *  @param index The row number
+ *  @return The number of steps; zero for pauses and rows which aren't valid
+ */
 
+unsigned char character_database::get_steps (unsigned char index)
+{
+	if (index >= NUM_CHARACTERS)
+	{
+		return (0);
+	}
+	return (pgm_read_byte (&(character_entries[index].num_steps)));
+}
 
 
+//-------------------------------------------------------------------------------------
+/** This method finds one step of a character in the step table. 
+ *  @param index The row number, which must be valid
+ *  @param step The step number, starting at zero
+ *  @return The program memory address of the step
+ */
 
+const gesture_step* character_database::get_step (unsigned char index, unsigned char step)
+{
+	return (&character_steps[pgm_read_byte (&(character_entries[index].first_step)) + step]);
+}
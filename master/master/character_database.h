@@ -1,14 +1,15 @@
 //*************************************************************************************
 /** \file character_database.h
- *	  This file contains a task class for running a user interface for the motor
- *	  controller demonstration. It has a single-state task which just reads the
- *	  serial port to see if the user typed anything, and acts if s/he has done so. 
+ *	  This file contains the character database, which holds the gesture used to
+ *	  fingerspell every character the hand knows. The database is a set of constant
+ *	  tables in program memory, so it takes no SRAM and needs no setup at startup. 
  *
  *  Revisions:
  *	  \li 02-06-2008 JRR Original file
  *	  \li 05-15-2008 JRR Modified to work with two motor drivers rather than one
  *	  \li 03-08-2009 JRR Added code to test A/D converter
  *    \li 01-19-2011 JRR Updated calls to newer version of stl_task constructor
+ *    \li 10-16-2026 Tables moved to program memory, character objects removed
  *
  *  License:
  *	This file released under the Lesser GNU Public License, version 2. This program
@@ -19,28 +20,48 @@
 #ifndef _CHARACTER_DATABASE_H_
 #define _CHARACTER_DATABASE_H_
 
-#define NUM_CHARACTERS		39
+#include "gesture.h"
+
+#define NUM_CHARACTERS		39		///< Digits, letters, comma, period and space
+#define CHARACTER_NONE		0xFF	///< Index returned for characters not in database
+
 
 //-------------------------------------------------------------------------------------
-/** This class contains a task which moves a motorized lever back and forth. 
- *  WARNING:  This task uses an older version of parent class stl_task, and its 
- *            constructor parameters are out of date. Use it as an example, but
- *            do not attempt to just copy the parameters. 
+/** This structure locates the steps belonging to one character in the step table.
+ *  Pause characters (comma, period and space) have no steps. 
+ */
+
+typedef struct
+{
+	uint8_t first_step;				///< Index of the first step in the step table
+	uint8_t num_steps;				///< Number of steps in this character
+} character_entry;
+
+
+//-------------------------------------------------------------------------------------
+/** This class gives access to the gestures for all characters. Rows are numbered 0-9
+ *  for the digits, 10-35 for the letters, then 36, 37 and 38 for comma, period and
+ *  space. All the data is in program memory; the object itself holds nothing and is 
+ *  only passed around so that tasks can be pointed at a database. 
  */
 
 class character_database
 {
 	public:
-		character* character_array;	///< Array of character classes
-		
-		// The constructor creates a new task object
+		// The constructor creates a new database object
 		character_database (void);
 		
-		// Initialization functions designed to keep constructor clean
-		void create_all_characters (void);
-		
-		// Retrieve index value
+		// Retrieve the row holding a character
 		unsigned char get_index (unsigned char);
+		
+		// Retrieve the character held in a row
+		unsigned char get_letter (unsigned char);
+		
+		// Get the number of gesture steps in a row
+		unsigned char get_steps (unsigned char);
+		
+		// Get the program memory address of one step of a row
+		const gesture_step* get_step (unsigned char, unsigned char);
 };
 
 #endif
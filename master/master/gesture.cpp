@@ -0,0 +1,142 @@
+//*************************************************************************************
+/** \file gesture.cpp
+ *    This file contains the functions which unpack gesture steps for task_output. 
+ *    The steps themselves are stored with the character database; every step holds a
+ *    packed target for each of the 13 outputs, and these functions turn a packed
+ *    target into the value which is sent to a motor.
+ *
+ *  Revisions:
+ *    \li 10-16-2026 Original file, replaces the character switch in task_output
+ *    \li 10-16-2026 Encoder counts for each finger's target codes
+ *    \li 10-16-2026 Which slaves each interfering finger blocks
+ *
+ *  License:
+ *    This file released under the Lesser GNU Public License, version 2. This program
+ *    is intended for educational use only, but it is not limited thereto.
+ */
+//*************************************************************************************
+
+#include <stdint.h>
+#include "lib/hal.h"
+#include "gesture.h"
+
+
+//-------------------------------------------------------------------------------------
+/** The order in which the targets of a step are sent: thumb (5-8), index (1, 9 and
+ *  the spread switch 11), middle (2, 10), ring (3), pinky (4), then the wrist servos.
+ */
+
+const uint8_t gesture_motor_order[GESTURE_NUM_MOTORS] PROGMEM = 
+{
+	5, 6, 7, 8, 1, 9, 11, 2, 10, 3, 4, 12, 13
+};
+
+
+//-------------------------------------------------------------------------------------
+/** The finger slaves which move each finger that has an interference bit, in the 
+ *  order of the GESTURE_INTERFERE_* bits: thumb (5-8), index (1, 9), middle (2, 10),
+ *  ring (3) and pinky (4). 
+ */
+
+const uint16_t gesture_group_slaves[GESTURE_NUM_GROUPS] PROGMEM = 
+{
+	GESTURE_SLAVE_BIT (5) | GESTURE_SLAVE_BIT (6) | GESTURE_SLAVE_BIT (7) | GESTURE_SLAVE_BIT (8),
+	GESTURE_SLAVE_BIT (1) | GESTURE_SLAVE_BIT (9),
+	GESTURE_SLAVE_BIT (2) | GESTURE_SLAVE_BIT (10),
+	GESTURE_SLAVE_BIT (3),
+	GESTURE_SLAVE_BIT (4)
+};
+
+
+//-------------------------------------------------------------------------------------
+/** The finger slaves which would collide with each finger while it's interfering, in
+ *  the same order. A thumb folded over the fingers blocks all four fingers; a crossed
+ *  or clenched index finger blocks the thumb and the middle finger; a folded middle
+ *  finger blocks the thumb and the index finger; and a ring finger or pinky curled 
+ *  under the thumb blocks the thumb. 
+ */
+
+const uint16_t gesture_group_conflicts[GESTURE_NUM_GROUPS] PROGMEM = 
+{
+	GESTURE_SLAVE_BIT (1) | GESTURE_SLAVE_BIT (9) | GESTURE_SLAVE_BIT (2) | GESTURE_SLAVE_BIT (10)
+		| GESTURE_SLAVE_BIT (3) | GESTURE_SLAVE_BIT (4),
+	GESTURE_SLAVE_BIT (5) | GESTURE_SLAVE_BIT (6) | GESTURE_SLAVE_BIT (7) | GESTURE_SLAVE_BIT (8)
+		| GESTURE_SLAVE_BIT (2) | GESTURE_SLAVE_BIT (10),
+	GESTURE_SLAVE_BIT (5) | GESTURE_SLAVE_BIT (6) | GESTURE_SLAVE_BIT (7) | GESTURE_SLAVE_BIT (8)
+		| GESTURE_SLAVE_BIT (1) | GESTURE_SLAVE_BIT (9),
+	GESTURE_SLAVE_BIT (5) | GESTURE_SLAVE_BIT (6) | GESTURE_SLAVE_BIT (7) | GESTURE_SLAVE_BIT (8),
+	GESTURE_SLAVE_BIT (5) | GESTURE_SLAVE_BIT (6) | GESTURE_SLAVE_BIT (7) | GESTURE_SLAVE_BIT (8)
+};
+
+
+//-------------------------------------------------------------------------------------
+/** The encoder count each finger slave moves to for target codes 1-5, one row per
+ *  code and one column per slave. These were the slaves' own set point angles, which
+ *  were eight-bit counts (a quarter of the encoder count); keeping them here means a
+ *  finger can be tuned to any of its 1024 counts without reprogramming its slave. 
+ */
+
+const uint16_t gesture_slave_counts[GESTURE_NUM_CODES][GESTURE_NUM_SLAVES] PROGMEM = 
+{
+	{   4,   4,   4,   4,   4,   4,   4,   4,   4,   4 },		// 'a', open
+	{ 260, 260, 260, 260, 260, 260, 260, 260, 260, 260 },		// 'b'
+	{ 384, 384, 384, 384, 384, 384, 384, 384, 384, 384 },		// 'c'
+	{ 512, 512, 512, 512, 512, 512, 512, 512, 512, 512 },		// 'd'
+	{ 768, 768, 768, 768, 768, 768, 768, 768, 768, 768 }		// 'e'
+};
+
+
+//-------------------------------------------------------------------------------------
+/** This function reads the target code for one motor out of a step. 
+ *  @param p_step Program memory address of the step
+ *  @param motor The motor number, 1-13
+ *  @return The four-bit target code, or GESTURE_NO_CHANGE
+ */
+
+uint8_t gesture_target (const gesture_step* p_step, uint8_t motor)
+{
+	uint8_t packed = pgm_read_byte (&(p_step->targets[(motor - 1) >> 1]));
+
+	if ((motor - 1) & 0x01)
+	{
+		return (packed >> 4);
+	}
+	return (packed & 0x0F);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function converts a target code into the value which output_to_motor() sends
+ *  to the given motor: a set point letter for slaves 1-10, on or off for the spread
+ *  switch, and an angle in degrees for the wrist servos. 
+ *  @param motor The motor number, 1-13
+ *  @param code A target code other than GESTURE_NO_CHANGE
+ *  @return The value to be sent to the motor
+ */
+
+uint8_t gesture_decode (uint8_t motor, uint8_t code)
+{
+	if (motor <= 10)
+	{
+		return ('a' + code - 1);
+	}
+	else if (motor == 11)
+	{
+		return (code - 1);
+	}
+	return ((code - 1) * 45);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function converts a finger slave's target code into the encoder count which
+ *  is sent to the slave in a target frame. 
+ *  @param motor The slave number, 1-10
+ *  @param code A target code from 1 to 5
+ *  @return The encoder count the finger is to move to
+ */
+
+uint16_t gesture_count (uint8_t motor, uint8_t code)
+{
+	return (pgm_read_word (&gesture_slave_counts[code - 1][motor - 1]));
+}
@@ -0,0 +1,91 @@
+//*************************************************************************************
+/** \file gesture.h
+ *	  This file contains the layout of a gesture step, which describes one movement
+ *	  of the hand while it forms a fingerspelled character. Each step holds a target
+ *	  for every one of the 13 outputs (slaves 1-10, the index spread switch 11, and 
+ *	  the two wrist servos 12 and 13). The steps live in program memory with the
+ *	  character database and are walked by task_output one step per run.
+ *
+ *  Revisions:
+ *	  \li 10-16-2026 Original file, replaces the character switch in task_output
+ *	  \li 10-16-2026 Finger target codes turned into encoder counts on the master
+ *	  \li 10-16-2026 Slaves belonging to each interfering finger and the slaves whose
+ *	                 moves it blocks
+ *
+ *  License:
+ *	This file released under the Lesser GNU Public License, version 2. This program
+ *	is intended for educational use only, but it is not limited thereto.
+ */
+//*************************************************************************************
+
+#ifndef _GESTURE_H_
+#define _GESTURE_H_
+
+#include <stdint.h>
+#include "lib/hal.h"
+
+#define GESTURE_NUM_MOTORS		13			///< Outputs 1-13 driven by each step
+#define GESTURE_PACKED_SIZE		7			///< Bytes holding 13 four-bit targets
+#define GESTURE_MAX_STEPS		4			///< Longest character (J and Z)
+#define GESTURE_NUM_SLAVES		10			///< Finger slaves, motors 1-10
+#define GESTURE_NUM_CODES		5			///< Finger target codes 1-5, set points 'a'-'e'
+
+/// This target code means that a step leaves the motor where it was
+#define GESTURE_NO_CHANGE		0
+
+// These bits mark the fingers a step leaves in a position that blocks other fingers,
+// so that they are opened again before the next character is formed
+#define GESTURE_INTERFERE_THUMB		0x01	///< Thumb folded over the fingers
+#define GESTURE_INTERFERE_INDEX		0x02	///< Index finger crossed or clenched
+#define GESTURE_INTERFERE_MIDDLE	0x04	///< Middle finger folded or clenched
+#define GESTURE_INTERFERE_RING		0x08	///< Ring finger curled under thumb
+#define GESTURE_INTERFERE_PINKY		0x10	///< Pinky curled under thumb
+
+/// Fingers with an interference bit, finger g having bit (1 << g): thumb to pinky
+#define GESTURE_NUM_GROUPS		5
+
+/// This macro gives the bit standing for a finger slave, 1-10, in a set of slaves
+#define GESTURE_SLAVE_BIT(slave)	(1 << ((slave) - 1))
+
+
+//-------------------------------------------------------------------------------------
+/** This structure holds one step of a gesture. The targets for motors 1-13 are packed
+ *  two to a byte, odd-numbered motors in the low nibble; a nibble of zero means the
+ *  motor is not commanded in this step.
+ */
+
+typedef struct
+{
+	uint8_t targets[GESTURE_PACKED_SIZE];	///< Packed four-bit target codes
+	uint8_t interference;					///< GESTURE_INTERFERE_* bits set by step
+} gesture_step;
+
+
+/// The order in which a step's targets are sent, thumb first and wrist last
+extern const uint8_t gesture_motor_order[GESTURE_NUM_MOTORS] PROGMEM;
+
+/// The finger slaves which make up each finger with an interference bit
+extern const uint16_t gesture_group_slaves[GESTURE_NUM_GROUPS] PROGMEM;
+
+/// The finger slaves which can't move while each finger is interfering
+extern const uint16_t gesture_group_conflicts[GESTURE_NUM_GROUPS] PROGMEM;
+
+// This function reads the target code for one motor out of a step
+uint8_t gesture_target (const gesture_step*, uint8_t);
+
+// This function converts a target code into the value sent to a motor
+uint8_t gesture_decode (uint8_t, uint8_t);
+
+// This function converts a finger's target code into the encoder count it moves to
+uint16_t gesture_count (uint8_t, uint8_t);
+
+/** This function reads the interference bits belonging to a step.
+ *  @param p_step Program memory address of the step
+ *  @return The GESTURE_INTERFERE_* bits set by the step
+ */
+inline uint8_t gesture_interference (const gesture_step* p_step)
+{
+	return (pgm_read_byte (&(p_step->interference)));
+}
+
+#endif // _GESTURE_H_
@@ -0,0 +1,123 @@
+//*************************************************************************************
+/** \file host_protocol.h
+ *	  This file contains the framed binary protocol by which a program on the computer
+ *	  can run the hand without going through the text menu. It shares the computer's
+ *	  serial port with the menu. At the home screen a byte of HOST_FRAME_START begins
+ *	  a frame and any other byte is a menu key, so the mode is found from each byte
+ *	  and needs no switch. While the last thing to come in was a good frame, the menu
+ *	  isn't printed, and the first menu key brings it back.
+ *
+ *  Revisions:
+ *	  \li 10-16-2026 Original file
+ *	  \li 10-16-2026 Stats give the characters dropped from the transmit buffer
+ *	  \li 10-16-2026 Answers go out whole or are held for a later run, and stats 
+ *		  count those held
+ *	  \li 10-16-2026 Software flow control must be off while frames are used
+ *
+ *  License:
+ *	This file released under the Lesser GNU Public License, version 2. This program
+ *	is intended for educational use only, but it is not limited thereto.
+ */
+//*************************************************************************************
+
+#ifndef _HOST_PROTOCOL_H_
+#define _HOST_PROTOCOL_H_
+
+#include <stdint.h>
+
+//-------------------------------------------------------------------------------------
+/*  A frame is HOST_FRAME_START, a command byte, a length byte, that many data bytes,
+ *  then a check byte which is the CRC-8 (polynomial 0x07, starting at zero) of the
+ *  command, length and data bytes. The start byte is never sent in text, so the
+ *  computer can skip any text, such as the output task's messages, between frames.
+ *  There may be no more than HOST_FRAME_GAP_MS between the bytes of a frame, or what
+ *  has come in is thrown away.
+ *
+ *  Every frame is answered with a frame whose command byte is the request's command
+ *  ored with HOST_REPLY, and whose first data byte is a status. Any more data follows
+ *  the status, with 16-bit values high byte first. Frames which come in while a
+ *  sentence is being spelled wait in the receive buffer and are answered once it's
+ *  done; the buffer holds about two full frames. An answer is only sent when the 
+ *  transmit buffer has room for all of it, so the computer never gets part of one; 
+ *  if there isn't room, the answer is held and sent on a later run, and no more 
+ *  frames are taken until it has gone.
+ *
+ *  The data and check bytes of a frame may be any value, XON (0x11) and XOFF (0x13)
+ *  among them; the length byte, not any marker, says where a frame ends. Software
+ *  flow control must therefore be off on the computer while frames are used, or it
+ *  will take those bytes out of answers. The hand only sends XON and XOFF as flow
+ *  control in streaming mode, which frames aren't taken in.
+ */
+
+#define HOST_FRAME_START		0xA5	///< First byte of a frame, in either direction
+#define HOST_MAX_DATA			64		///< Most data bytes in a frame
+#define HOST_FRAME_GAP_MS		100		///< Longest time between the bytes of a frame
+#define HOST_REPLY				0x80	///< Bit set in the command byte of an answer
+#define HOST_FRAME_EXTRA		4		///< Bytes of a frame besides its data
+
+#define HOST_OK					0		///< Status: the command was carried out
+#define HOST_BAD_FRAME			1		///< Status: the check byte didn't match
+#define HOST_BAD_COMMAND		2		///< Status: there's no such command
+#define HOST_BAD_DATA			3		///< Status: the data was wrong for the command
+#define HOST_NO_ANSWER			4		///< Status: a finger slave didn't answer
+#define HOST_DONE				5		///< Status: a sentence has been spelled
+
+//-------------------------------------------------------------------------------------
+/*  HOST_SPELL has the text to spell as its data. It's taken as in streaming mode:
+ *  lowercase letters become capitals, ? and ! become periods, line ends become spaces
+ *  and anything else other than letters, digits, spaces, commas and periods is left
+ *  out. The answer, HOST_OK and the number of characters to be spelled, comes at
+ *  once, and a second answer with HOST_DONE comes when the last one has been held.
+ *  Text with nothing to spell is answered HOST_BAD_DATA.
+ *
+ *  HOST_SET_MOTOR has three data bytes, a slave number from 1 to 10 and an encoder
+ *  count from 0 to SLAVE_TARGET_MAX, and moves that finger there. The motors are
+ *  started first if they're stopped. The answer, HOST_OK, comes once the output task
+ *  has the target, without waiting for the finger to get there.
+ *
+ *  HOST_QUERY_ENCODER has one data byte, a slave number from 1 to 10. The answer is
+ *  HOST_OK and the slave's 10-bit encoder count, to the nearest four counts, or
+ *  HOST_NO_ANSWER if it doesn't answer within HOST_ANSWER_MS.
+ *
+ *  HOST_READ_STATS has no data. The answer is HOST_OK, then HOST_STATS_SIZE bytes:
+ *  \li Letters and pauses spelled since reset, 16 bits
+ *  \li Good frames received, 16 bits
+ *  \li Frames thrown away for a bad check byte, 16 bits
+ *  \li Characters lost to a full receive buffer, 8 bits, stopping at 255
+ *  \li Characters waiting to be spelled, 8 bits
+ *  \li Runs of the user task which started late, 16 bits
+ *  \li 1 if the motors are started, 0 if not, 8 bits
+ *  \li Characters dropped from a full transmit buffer, 8 bits, stopping at 255
+ *  \li Answers held for a later run because the transmit buffer hadn't room for 
+ *      them, 8 bits, stopping at 255
+ */
+
+#define HOST_SPELL				0x01	///< Command to spell some text
+#define HOST_SET_MOTOR			0x02	///< Command to move one finger to an encoder count
+#define HOST_QUERY_ENCODER		0x03	///< Command to read one finger's encoder
+#define HOST_READ_STATS			0x04	///< Command to read the counters
+#define HOST_ANSWER_MS			50		///< Time a slave has to answer an encoder query
+#define HOST_STATS_SIZE			13		///< Data bytes after the status in a stats answer
+
+
+//-------------------------------------------------------------------------------------
+/** This function adds a byte to the CRC-8 which is the check byte of a frame.
+ *  @param crc The CRC of the bytes before this one, zero to start
+ *  @param data The byte to be added
+ *  @return The CRC including the new byte
+ */
+
+inline uint8_t host_crc8 (uint8_t crc, uint8_t data)
+{
+	crc ^= data;
+	for (uint8_t bit = 0; bit < 8; bit++)
+	{
+		if (crc & 0x80)
+			crc = (crc << 1) ^ 0x07;
+		else
+			crc <<= 1;
+	}
+	return (crc);
+}
+
+#endif // _HOST_PROTOCOL_H_
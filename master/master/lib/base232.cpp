@@ -20,6 +20,9 @@
  *    \li 12-22-2008 JRR Split off stuff in base232.h for efficiency
  *    \li 01-30-2009 JRR Added class with port setup in constructor
  *    \li 06-02-2009 JRR Changed baud rate divisor formula to work better
+ *    \li 10-16-2026 Serial port registers may be simulated in a PC build (HAL_SIM)
+ *    \li 10-16-2026 Baud rate set by set_baud(), which sets the double speed bit U2X;
+ *        the constructors had ORed in its bit number, which set MPCM
  *
  *  License:
  *    This file is released under the Lesser GNU Public License, version 2. This 
@@ -27,8 +30,9 @@
  */
 //*************************************************************************************
 
-#ifdef __AVR
-	#include <avr/io.h>						// Definitions of AVR's I/O registers
+#if defined (__AVR) || defined (HAL_SIM)
+	#include <stddef.h>						// For NULL
+	#include "hal.h"						// AVR's I/O registers, real or simulated
 	#include "global_debug.h"				// For a global debugging port
 #else
 	#include <stdlib.h>						// Standard stuff such as exit()
@@ -52,7 +56,7 @@
  */
 
 // This section compiles for the AVR microcontroller
-#ifdef __AVR
+#if defined (__AVR) || defined (HAL_SIM)
 base232::base232 (unsigned int baud_rate, unsigned char port_number)
 {
 	// If we're compiling for a chip with UCSR0A defined, it has dual serial ports
@@ -63,13 +67,11 @@ base232::base232 (unsigned int baud_rate, unsigned char port_number)
 			p_UDR = &UDR0;
 			p_USR = &UCSR0A;
 			p_UCR = &UCSR0B;
+			p_UBRRH = &UBRR0H;
+			p_UBRRL = &UBRR0L;
+			mask_U2X = (1 << U2X0);
 			UCSR0B = (1 << RXEN0) | (1 << TXEN0);
 			UCSR0C = (1 << UCSZ01) | (1 << UCSZ00); // | (1 << USBS0);
-			UBRR0H = 0x00;
-			UBRR0L = calc_baud_div (baud_rate);
-			#ifdef UART_DOUBLE_SPEED					// Activate double speed mode
-				UCSR0A |= U2X0;							// if required
-			#endif
 			mask_UDRE = (1 << UDRE0);
 			mask_RXC = (1 << RXC0);
 			mask_TXC = (1 << TXC0);
@@ -80,13 +82,11 @@ base232::base232 (unsigned int baud_rate, unsigned char port_number)
 			p_UDR = &UDR1;
 			p_USR = &UCSR1A;
 			p_UCR = &UCSR1B;
+			p_UBRRH = &UBRR1H;
+			p_UBRRL = &UBRR1L;
+			mask_U2X = (1 << U2X1);
 			UCSR1B = (1 << RXEN1) | (1 << TXEN1);
 			UCSR1C = (1 << UCSZ11) | (1 << UCSZ10); // | (1 << USBS1);
-			UBRR1H = 0x00;
-			UBRR1L = calc_baud_div (baud_rate);
-			#ifdef UART_DOUBLE_SPEED		// If double-speed macro has been defined,
-				UCSR1A |= U2X1;				// turn on double-speed operation
-			#endif
 			mask_UDRE = (1 << UDRE1);
 			mask_RXC = (1 << RXC1);
 			mask_TXC = (1 << TXC1);
@@ -101,13 +101,11 @@ base232::base232 (unsigned int baud_rate, unsigned char port_number)
 			p_UDR = &UDR;
 			p_USR = &UCSRA;
 			p_UCR = &UCSRB;
+			p_UBRRH = &UBRRH;
+			p_UBRRL = &UBRRL;
+			mask_U2X = (1 << U2X);
 			UCSRB = (1 << RXEN) | (1 << TXEN);
 			UCSRC = (1 << URSEL) | (1 << UCSZ1) | (1 << UCSZ0);		// | (1 << USBS0);
-			UBRRH = 0x00;
-			UBRRL = calc_baud_div (baud_rate);
-			#ifdef UART_DOUBLE_SPEED				// Activate double speed mode
-				UCSRA |= U2X;						// if required
-			#endif
 			mask_UDRE = (1 << UDRE);
 			mask_RXC = (1 << RXC);
 			mask_TXC = (1 << TXC);
@@ -116,14 +114,18 @@ base232::base232 (unsigned int baud_rate, unsigned char port_number)
 			p_UDR = &UDR;
 			p_USR = &USR;
 			p_UCR = &UCR;
+			p_UBRRH = NULL;							// These chips have an 8-bit
+			p_UBRRL = &UBRR;						// divisor and no double speed
+			mask_U2X = 0;
 			UCR = (1 << RXEN) | (1 << TXEN);		// 0x18 for mode N81
-			UBRR = calc_baud_div (baud_rate);
 			mask_UDRE = (1 << UDRE);
 			mask_RXC = (1 << RXC);
 			mask_TXC = (1 << TXC);
 		#endif // UCSRA
 	#endif // UCSR0A
 
+	set_baud (baud_rate);
+
 	// Read the data register to ensure that it's empty
 	port_number = *p_UDR;
 	port_number = *p_UDR;
@@ -143,7 +145,37 @@ base232::base232 (char* port_name)
 			 << endl;
 	}
 }
-#endif // __AVR
+#endif // __AVR || HAL_SIM
+
+
+//-------------------------------------------------------------------------------------
+/** This method sets the baud rate divisor, and double-speed mode if it's used. A
+ *  character which is being sent or received when the rate changes will be garbled,
+ *  so the caller should wait until everything has been sent. Writing the whole 
+ *  status register sets the double-speed bit and clears the multi-processor mode bit;
+ *  the flag bits are either read-only or cleared by writing ones, so they're left 
+ *  alone. 
+ *  @param baud_rate The new baud rate
+ */
+
+#if defined (__AVR) || defined (HAL_SIM)
+void base232::set_baud (unsigned long baud_rate)
+{
+	unsigned int divisor = calc_baud_div (baud_rate);
+
+	if (p_UBRRH)
+	{
+		*p_UBRRH = (unsigned char)(divisor >> 8);
+	}
+	*p_UBRRL = (unsigned char)divisor;
+	#ifdef UART_DOUBLE_SPEED
+		if (mask_U2X)
+		{
+			*p_USR = mask_U2X;
+		}
+	#endif
+}
+#endif // __AVR || HAL_SIM
 
 
 //-------------------------------------------------------------------------------------
@@ -154,7 +186,7 @@ base232::base232 (char* port_name)
 
 bool base232::ready_to_send (void)
 {
-#ifdef __AVR
+#if defined (__AVR) || defined (HAL_SIM)
 	// If transmitter buffer is full, we're not ready to send
 	if (*p_USR & mask_UDRE)
 		return (true);
@@ -177,7 +209,7 @@ bool base232::ready_to_send (void)
 
 bool base232::is_sending (void)
 {
-#ifdef __AVR
+#if defined (__AVR) || defined (HAL_SIM)
 	if (*p_USR & mask_TXC)
 		return (false);
 	else
@@ -21,6 +21,9 @@
  *    \li 01-30-2009 JRR Added class with port setup in constructor
  *    \li 06-02-2009 JRR Changed baud rate divisor formula to work better
  *    \li 12-14-2009 JRR Changed CPU_FREQ_Hz to F_CPU to be compatible with avr-libc
+ *    \li 10-16-2026 Serial port registers may be simulated in a PC build (HAL_SIM)
+ *    \li 10-16-2026 Divisor rounded and less one, and right for double speed; added
+ *        set_baud(), which really sets U2X rather than MPCM
  *
  *  License:
  *    This file is released under the Lesser GNU Public License, version 2. This 
@@ -55,14 +58,17 @@
 /** This macro computes a value for the baud rate divisor from the desired baud rate 
  *  and the CPU clock frequency. The CPU clock frequency should have been set in the 
  *  macro F_CPU, which is normally configured in the Makefile. The divisor is
- *  calculated as (frequency, MHz / (16 * baudrate)), unless the USART is running in
- *  double-speed mode, in which case the baud rate divisor is twice as big. 
+ *  calculated as (frequency / (16 * baudrate)) - 1, rounded to the nearest whole
+ *  number, unless the USART is running in double-speed mode, in which case the baud
+ *  rate divisor is (frequency / (8 * baudrate)) - 1. 
  */
 
 #ifdef UART_DOUBLE_SPEED
-	#define calc_baud_div(baud_rate) ((F_CPU) / (16UL * (baud_rate)))
+	#define calc_baud_div(baud_rate) \
+		((((F_CPU) + 4UL * (baud_rate)) / (8UL * (baud_rate))) - 1)
 #else
-	#define calc_baud_div(baud_rate) ((F_CPU) / (8UL * (baud_rate)))
+	#define calc_baud_div(baud_rate) \
+		((((F_CPU) + 8UL * (baud_rate)) / (16UL * (baud_rate))) - 1)
 #endif
 
 
@@ -75,7 +81,7 @@
 class base232
 {
 	protected:
-	#ifdef __AVR
+	#if defined (__AVR) || defined (HAL_SIM)
 		/// This is a pointer to the data register used by the UART
 		volatile unsigned char* p_UDR;
 
@@ -85,6 +91,15 @@ class base232
 		/// This is a pointer to the control register used by the UART
 		volatile unsigned char* p_UCR;
 
+		/// This is a pointer to the high byte of the baud rate divisor, if there is one
+		volatile unsigned char* p_UBRRH;
+
+		/// This is a pointer to the low byte of the baud rate divisor
+		volatile unsigned char* p_UBRRL;
+
+		/// This bitmask identifies the bit for double speed, U2X, if there is one
+		unsigned char mask_U2X;
+
 		/// This bitmask identifies the bit for data register empty, UDRE
 		unsigned char mask_UDRE;
 
@@ -96,10 +111,10 @@ class base232
 	#else
 		/// This is the file handle for the serial port file device on a PC
 		int serial_file;
-	#endif // __AVR
+	#endif // __AVR || HAL_SIM
 
 	public:
-	#ifdef __AVR
+	#if defined (__AVR) || defined (HAL_SIM)
 		/// The constructor sets up the port with the given baud rate and port number.
 		base232 (unsigned int = 9600, unsigned char = 0);
 	#else
@@ -107,6 +122,9 @@ class base232
 		base232 (char*);
 	#endif
 
+		/// This method changes the baud rate; the port should have finished sending.
+		void set_baud (unsigned long);
+
 		/// This method checks if the serial port is ready to transmit data.
 		bool ready_to_send (void);
 
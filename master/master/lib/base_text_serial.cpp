@@ -20,6 +20,13 @@
  *    \li 11-24-2009 JRR Changed operation of 'clrscr' to a function to work with LCD
  *    \li 11-26-2009 JRR Integrated floating point support into this file
  *    \li 12-16-2009 JRR Improved support for constant strings in program memory
+ *    \li 10-16-2026 done_sending() checks without waiting that everything is out
+ *    \li 10-16-2026 set_baud() changes the baud rate of devices which have one
+ *    \li 10-16-2026 getchars() reads whatever has been received, all at once
+ *    \li 10-16-2026 get_lost_chars() counts characters lost to a full buffer
+ *    \li 10-16-2026 get_dropped_chars() counts characters not sent, buffer full
+ *    \li 10-16-2026 Text printed with "<<" waits for room rather than being dropped
+ *    \li 10-16-2026 room_to_send() tells how many characters can be sent at once
  *
  *  Licenses:
  *    This file released under the Lesser GNU Public License, version 2. This program
@@ -32,7 +39,7 @@
 
 #include <stdint.h>
 #include <stdlib.h>
-#include <avr/io.h>
+#include "hal.h"
 #include "base_text_serial.h"
 
 
@@ -74,6 +81,20 @@ bool base_text_serial::ready_to_send (void)
 }
 
 
+//-------------------------------------------------------------------------------------
+/** This base method finds how many characters can be sent without waiting, so that a
+ *  message which must go out whole can be held back until it fits. Devices without a
+ *  transmit buffer send everything at once, so the base method says there's all the
+ *  room a byte can count. 
+ *  @return 255, as there's no buffer to fill
+ */
+
+uint8_t base_text_serial::room_to_send (void)
+{
+	return (0xFF);
+}
+
+
 //-------------------------------------------------------------------------------------
 /** This base method just returns zero, because it shouldn't be called. There might be
  *  classes which only send characters and don't ever receive them, and this method
@@ -100,6 +121,53 @@ bool base_text_serial::check_for_char (void)
 }
 
 
+//-------------------------------------------------------------------------------------
+/** This method gets as many of the characters which have been received as will fit,
+ *  without waiting for any more. The base method takes them one at a time through 
+ *  check_for_char() and getchar(); devices with a buffer can copy them more quickly. 
+ *  @param p_buffer A pointer to the place where the characters are to be put
+ *  @param max_chars The most characters to get
+ *  @return The number of characters which were put into the buffer
+ */
+
+uint8_t base_text_serial::getchars (char* p_buffer, uint8_t max_chars)
+{
+	uint8_t count = 0;						// Characters got so far
+
+	while (count < max_chars && check_for_char ())
+	{
+		p_buffer[count++] = getchar ();
+	}
+	return (count);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This base method finds how many received characters were lost because there was
+ *  no room for them. Devices without a receive buffer don't lose any this way, so the
+ *  base method always says none. 
+ *  @return Zero, as no characters were lost
+ */
+
+uint8_t base_text_serial::get_lost_chars (void)
+{
+	return (0);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This base method finds how many characters were dropped, not sent, because there
+ *  was no room to buffer them. Devices without a transmit buffer send everything, so
+ *  the base method always says none. 
+ *  @return Zero, as no characters were dropped
+ */
+
+uint8_t base_text_serial::get_dropped_chars (void)
+{
+	return (0);
+}
+
+
 //-------------------------------------------------------------------------------------
 /** This is a base method for causing immediate transmission of a buffer full of data.
  *  The base method doesn't do anything, because it will be implemented in descendent
@@ -112,6 +180,29 @@ void base_text_serial::transmit_now (void)
 }
 
 
+//-------------------------------------------------------------------------------------
+/** This base method checks whether everything which was sent has gone out. Devices
+ *  without buffers send everything immediately, so the base method always says yes. 
+ *  @return True, because nothing is ever left waiting to go out
+ */
+
+bool base_text_serial::done_sending (void)
+{
+	return (true);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This base method changes the baud rate of a device which has one. Devices without
+ *  a baud rate have nothing to change, so the base method does nothing. 
+ *  @param baud_rate The new baud rate
+ */
+
+void base_text_serial::set_baud (unsigned long baud_rate)
+{
+}
+
+
 //-------------------------------------------------------------------------------------
 /** This is a base method to clear a display screen, if there is one. It is called 
  *  when the format modifier 'clrscr' is inserted in an output line. Descendant
@@ -123,6 +214,22 @@ void base_text_serial::clear_screen (void)
 }
 
 
+//-------------------------------------------------------------------------------------
+/** This method sends one character of text printed with "<<". Nothing which prints
+ *  text checks whether each character went, so rather than drop a character when a 
+ *  buffered device is full, this waits until there's room for it. Text which fits in
+ *  the buffer goes at once; a task which prints more than that in one run waits for
+ *  the rest, as it would with an unbuffered port. 
+ *  @param ch The character to be sent
+ */
+
+void base_text_serial::put_text (char ch)
+{
+	while (!ready_to_send ()) HAL_WAIT ();
+	putchar (ch);
+}
+
+
 //-------------------------------------------------------------------------------------
 /** This method writes the string whose first character is pointed to by the given
  *  character pointer to the serial device. It acts in about the same way as puts(). 
@@ -138,14 +245,14 @@ base_text_serial& base_text_serial::operator<< (const char* string)
 	{
 		pgm_string = false;
 		while (char ch = pgm_read_byte_near (string++))
-			putchar (ch);
+			put_text (ch);
 
 	}
 	// If the program-string variable is not set, the string is in RAM and printed
 	// in the normal way
 	else
 	{
-		while (*string) putchar (*string++);
+		while (*string) put_text (*string++);
 	}
 
 	return (*this);
@@ -161,9 +268,9 @@ base_text_serial& base_text_serial::operator<< (const char* string)
 base_text_serial& base_text_serial::operator<< (bool value)
 {
 	if (value)
-		putchar ('T');
+		put_text ('T');
 	else
-		putchar ('F');
+		put_text ('F');
 
 	return (*this);;   
 }
@@ -182,22 +289,22 @@ base_text_serial& base_text_serial::operator<< (unsigned char num)
 
 	if (print_ascii)
 	{
-		putchar (num);
+		put_text (num);
 	}
 	else if (base == 2)
 	{
 		for (unsigned char bmask = 0x80; bmask != 0; bmask >>= 1)
 		{
-			if (num & bmask) putchar ('1');
-			else			 putchar ('0');
+			if (num & bmask) put_text ('1');
+			else			 put_text ('0');
 		}
 	}
 	else if (base == 16)
 	{
 		temp_char = (num >> 4) & 0x0F;
-		putchar ((temp_char > 9) ? temp_char + ('A' - 10) : temp_char + '0');
+		put_text ((temp_char > 9) ? temp_char + ('A' - 10) : temp_char + '0');
 		temp_char = num & 0x0F;
-		putchar ((temp_char > 9) ? temp_char + ('A' - 10) : temp_char + '0');
+		put_text ((temp_char > 9) ? temp_char + ('A' - 10) : temp_char + '0');
 	}
 	else
 	{
@@ -223,7 +330,7 @@ base_text_serial& base_text_serial::operator<< (char num)
 	char out_str[5];
 
 	if (print_ascii) 
-		putchar (num);
+		put_text (num);
 	else
 	{
 		if (base == 10)
@@ -388,19 +495,19 @@ base_text_serial& base_text_serial::operator<< (float num)
 
 	// Display the sign if it's negative
 	if (vtype & FTOA_MINUS)
-		putchar ('-');
+		put_text ('-');
 
 	// Show the mantissa
-	putchar (*p_buf++);
+	put_text (*p_buf++);
 	if (digits)
-		putchar ('.');
+		put_text ('.');
 	while ((digits-- > 0) && *p_buf)
-		putchar (*p_buf++);
+		put_text (*p_buf++);
 
 	// Now display the exponent
-	putchar ('e');
+	put_text ('e');
 	if (exponent > 0)
-		putchar ('+');
+		put_text ('+');
 	*this << exponent;
 }
 
@@ -429,20 +536,20 @@ base_text_serial& base_text_serial::operator<< (double num)
 
 	// Display the sign if it's negative
 	if (vtype & FTOA_MINUS)
-		putchar ('-');
+		put_text ('-');
 
 	// Show the mantissa
-	putchar (*p_buf++);
+	put_text (*p_buf++);
 	if (digits)
-		putchar ('.');
+		put_text ('.');
 	do
-		putchar (*p_buf++);
+		put_text (*p_buf++);
 	while (--digits && *p_buf);
 
 	// Now display the exponent
-	putchar ('e');
+	put_text ('e');
 	if (exponent > 0)
-		putchar ('+');
+		put_text ('+');
 	*this << exponent;
 }
 
@@ -20,6 +20,13 @@
  *    \li 11-24-2009 JRR Changed operation of 'clrscr' to a function to work with LCD
  *    \li 11-26-2009 JRR Integrated floating point support into this file
  *    \li 12-16-2009 JRR Improved support for constant strings in program memory
+ *    \li 10-16-2026 done_sending() checks without waiting that everything is out
+ *    \li 10-16-2026 set_baud() changes the baud rate of devices which have one
+ *    \li 10-16-2026 getchars() reads whatever has been received, all at once
+ *    \li 10-16-2026 get_lost_chars() counts characters lost to a full buffer
+ *    \li 10-16-2026 get_dropped_chars() counts characters not sent, buffer full
+ *    \li 10-16-2026 Text printed with "<<" waits for room rather than being dropped
+ *    \li 10-16-2026 room_to_send() tells how many characters can be sent at once
  *
  *  Licenses:
  *    This file released under the Lesser GNU Public License, version 2. This program
@@ -62,7 +69,7 @@
 #ifndef _BASE_TEXT_SERIAL_H_
 #define _BASE_TEXT_SERIAL_H_
 
-#include <avr/pgmspace.h>					// Header for program-space (Flash) data
+#include "hal.h"							// Program-space (Flash) data, real or simulated
 
 // Uncomment this line to enable floating point handling by base_text_serial; comment
 // it out if you don't need floating point and would like to save lots of memory
@@ -198,11 +205,18 @@ class base_text_serial
 	public:
 		base_text_serial (void);			// Simple constructor doesn't do much
 		virtual bool ready_to_send (void);  // Virtual and not defined in base class
+		virtual uint8_t room_to_send (void);	// Characters which can be sent at once
 		virtual bool putchar (char) {}	 	///< Virtual and not defined in base class
 		virtual void puts (char const*) {}	///< Virtual and not defined in base class
+		void put_text (char);				// Send a character of text, waiting for room
 		virtual bool check_for_char (void); // Check if a character is in the buffer
 		virtual char getchar (void);		// Get a character; wait if none is ready
+		virtual uint8_t getchars (char*, uint8_t);	// Get the characters which are ready
+		virtual uint8_t get_lost_chars (void);	// Count characters lost to a full buffer
+		virtual uint8_t get_dropped_chars (void);	// Count characters not sent, buffer full
 		virtual void transmit_now (void);	// Immediately transmit any buffered data
+		virtual bool done_sending (void);	// Check if all buffered data has gone out
+		virtual void set_baud (unsigned long);	// Change the baud rate, if there is one
 		virtual void clear_screen (void);	// Clear a display screen if there is one
 
 		// The overloaded left-shift operators convert numbers to strings and send the 
@@ -13,11 +13,12 @@
  *    \li 01-31-2009 JRR Original file
  *    \li 02-08-2009 JRR Added code to enable this debugging under Linux
  *    \li 12-20-2009 JRR Added do_reboot() function 
+ *    \li 10-16-2026 Debugging port used as on the AVR in a simulated PC build
  */
 //*************************************************************************************
 
 #include <stdlib.h>
-#include <avr/wdt.h>
+#include "hal.h"
 #include "global_debug.h"
 
 #ifdef SERIAL_DEBUG
@@ -48,5 +49,5 @@
 void do_reboot (void)
 {
 	wdt_enable (0);							// Enable watchdog timer to timeout soon
-	while (true);							// Enter infinite loop until the reset
+	while (true) HAL_WAIT ();				// Enter infinite loop until the reset
 }
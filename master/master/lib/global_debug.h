@@ -13,6 +13,7 @@
  *    \li 01-31-2009 JRR Original file
  *    \li 02-08-2009 JRR Added code to enable this debugging under Linux
  *    \li 12-20-2009 JRR Added do_reboot() function 
+ *    \li 10-16-2026 Debugging port used as on the AVR in a simulated PC build
  */
 //*************************************************************************************
 
@@ -20,7 +21,7 @@
 #define _GLOBAL_DEBUG_H_
 
 #ifdef SERIAL_DEBUG
-	#ifdef __AVR
+	#if defined (__AVR) || defined (HAL_SIM)
 		#include "base_text_serial.h"		// Header for all the serial devices
 
 		/// This pointer points to a serial device which handles debugging output. It
@@ -35,7 +36,7 @@
 		/// This definition allows a bunch of debugging information to be printed if the
 		/// SERIAL_DEBUG macro has been defined. If not, this macro expands to nothing. 
 		#define GLOB_DEBUG(x) if (p_glb_dbg_port) *p_glb_dbg_port << x
-	#else // Not __AVR
+	#else // Not __AVR or HAL_SIM
 		// We don't have to set up a debugging port on a PC, just use 'cout'
 		#define set_glob_debug_port(x)
 
@@ -0,0 +1,70 @@
+//*************************************************************************************
+/** \file hal.h
+ *    This file is the hardware abstraction layer for the master firmware. Every file
+ *    which uses the AVR's registers, interrupts, sleep modes, program memory or EEPROM
+ *    gets them by including this header rather than the AVR-LibC headers directly. When
+ *    compiled for the AVR, this header just pulls in the AVR-LibC headers. When the
+ *    macro HAL_SIM is defined and the program is compiled for a Linux PC, it pulls in
+ *    hal_sim.h instead, which backs the same register names with simulated ports,
+ *    timers and UARTs so that the whole program runs as a native process.
+ *
+ *    The native build compiles every *.cpp file in the master project, including
+ *    lib/hal_sim.cpp, with the PC's compiler; from the project directory, run
+ *    \code
+ *    g++ -DHAL_SIM -o master_sim `find . -name "*.cpp"`
+ *    \endcode
+ *    See hal_sim.h for how the simulated devices are connected to the PC.
+ *
+ *    The firmware marks points of interest with HAL_EVENT(code, value), which does
+ *    nothing on the AVR and tells the models of the devices around the AVR what the
+ *    firmware is doing when it's simulated.
+ *
+ *  Revisions:
+ *    \li 10-16-2026 Original file
+ *    \li 10-16-2026 Added HAL_EVENT() for measurements in the simulation
+ *    \li 10-16-2026 Events marking the start and end of a sentence
+ *    \li 10-16-2026 EEPROM
+ *    \li 10-16-2026 Event marking the start and end of streaming mode
+ *
+ *  License:
+ *    This file released under the Lesser GNU Public License, version 2. This program
+ *    is intended for educational use only, but it is not limited thereto.
+ */
+//*************************************************************************************
+
+/// This define prevents this .h file from being included more than once in a .cc file
+#ifndef _HAL_H_
+#define _HAL_H_
+
+#if defined (__AVR)
+	#include <avr/io.h>						// Input-output ports, special registers
+	#include <avr/interrupt.h>				// Interrupt handling functions
+	#include <avr/pgmspace.h>				// Data kept in program memory
+	#include <avr/sleep.h>					// Idle mode between task runs
+	#include <avr/wdt.h>					// Watchdog timer used for rebooting
+	#include <avr/eeprom.h>					// Settings kept while the power is off
+
+	/// On the AVR, the hardware changes by itself while a loop waits for it
+	#define HAL_WAIT()
+
+	/// Events only mean something to a simulation, so on the AVR they cost nothing
+	#define HAL_EVENT(code, value)
+
+#elif defined (HAL_SIM)
+	#include "hal_sim.h"					// Simulated devices on a Linux PC
+
+#else
+	#error Compile for the AVR, or define HAL_SIM to run the program on a PC
+#endif
+
+
+//-------------------------------------------------------------------------------------
+// Codes for HAL_EVENT(), which marks the points in the firmware where a simulation
+// takes its measurements or follows what the firmware is doing
+
+#define HAL_EVENT_LETTER		'L'			///< Output task given a character to form
+#define HAL_EVENT_SENTENCE		'S'			///< User ended a sentence of value characters
+#define HAL_EVENT_SENTENCE_DONE	'D'			///< Last character handed to the output task
+#define HAL_EVENT_STREAMING		'X'			///< Streaming mode started (1) or stopped (0)
+
+#endif // _HAL_H_
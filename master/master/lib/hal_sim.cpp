@@ -0,0 +1,860 @@
+//*************************************************************************************
+/** \file hal_sim.cpp
+ *    This file contains the device models behind the simulated registers declared in
+ *    hal_sim.h. Simulated time is counted in ticks of Timer 3, F_CPU / 8, and moves
+ *    from one event to the next: a timer overflow or compare match, a byte finishing
+ *    its trip through a USART, or a byte arriving at one. At each event the models
+ *    update the registers and call the interrupt service routines the firmware has
+ *    defined. The file only compiles when HAL_SIM is defined, so the AVR build can
+ *    keep it in its list of source files.
+ *
+ *  Revisions:
+ *    \li 10-16-2026 Original file
+ *    \li 10-16-2026 Added device hooks, port reading and firmware events
+ *    \li 10-16-2026 Several device models; a model can take over the terminal
+ *    \li 10-16-2026 Device models can drive input pins
+ *    \li 10-16-2026 Baud rates take in the high byte of the divisor
+ *    \li 10-16-2026 Standard input is paced by XON and XOFF from the firmware
+ *    \li 10-16-2026 Standard input can be passed on unchanged, for binary frames
+ *    \li 10-16-2026 XON and XOFF are only flow control in streaming mode; a model at
+ *        the terminal can read what it shows
+ *
+ *  License:
+ *    This file released under the Lesser GNU Public License, version 2. This program
+ *    is intended for educational use only, but it is not limited thereto.
+ */
+//*************************************************************************************
+
+#ifdef HAL_SIM
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <termios.h>
+#include <time.h>
+#include <sys/select.h>
+#include "hal.h"
+#include "base232.h"						// For the CPU frequency F_CPU
+#include "base_text_serial.h"				// For the FTOA_* flags
+
+
+/// The rate at which Timer 3, and simulated time, count
+#define HAL_SIM_TICKS_PER_SEC	(F_CPU / 8UL)
+
+/// The longest step of simulated time, so that the keyboard is checked often enough
+#define HAL_SIM_MAX_STEP		(HAL_SIM_TICKS_PER_SEC / 1000UL)
+
+/// Bytes waiting to arrive at a USART; 256, so that byte indices wrap by themselves
+#define HAL_SIM_RCV_SIZE		256
+
+/// Bytes of standard input let ahead into USART 0, like the transmit FIFO of a computer's
+/// serial port, which keeps sending them after XOFF
+#define HAL_SIM_HOST_FIFO		16
+
+/// Characters with which the firmware stops and restarts what comes from standard input
+#define HAL_SIM_XON				0x11
+#define HAL_SIM_XOFF			0x13
+
+/// The most models of devices outside the AVR which can run alongside the firmware
+#define HAL_SIM_MAX_DEVICES		4
+
+
+//-------------------------------------------------------------------------------------
+// The simulated registers declared in hal_sim.h
+
+volatile uint8_t hal_SREG;
+volatile uint8_t hal_UDR0, hal_UCSR0A, hal_UCSR0B, hal_UCSR0C, hal_UBRR0H, hal_UBRR0L;
+volatile uint8_t hal_UDR1, hal_UCSR1A, hal_UCSR1B, hal_UCSR1C, hal_UBRR1H, hal_UBRR1L;
+volatile uint8_t hal_TCCR1A, hal_TCCR1B, hal_TIMSK;
+volatile uint8_t hal_TCCR3A, hal_TCCR3B, hal_ETIMSK, hal_ETIFR;
+volatile uint8_t hal_PORTA, hal_PORTB, hal_PORTC, hal_PORTD;
+volatile uint8_t hal_DDRA, hal_DDRB, hal_DDRC, hal_DDRD;
+volatile uint8_t hal_PINA, hal_PINB, hal_PINC, hal_PIND;
+volatile uint16_t hal_TCNT1, hal_ICR1, hal_OCR1A, hal_OCR1B;
+volatile uint16_t hal_TCNT3, hal_OCR3A;
+
+// The interrupt service routines are weak references, so that a program which leaves
+// some of them out still links; a missing one has the address zero and isn't called
+extern "C" void hal_sim_timer3_ovf (void) __attribute__ ((weak));
+extern "C" void hal_sim_timer3_compa (void) __attribute__ ((weak));
+extern "C" void hal_sim_usart0_rx (void) __attribute__ ((weak));
+extern "C" void hal_sim_usart0_udre (void) __attribute__ ((weak));
+extern "C" void hal_sim_usart1_rx (void) __attribute__ ((weak));
+extern "C" void hal_sim_usart1_udre (void) __attribute__ ((weak));
+
+
+//-------------------------------------------------------------------------------------
+/** This structure holds the state of one simulated USART.
+ */
+
+typedef struct
+{
+	volatile uint8_t* p_UDR;				///< Data register
+	volatile uint8_t* p_USR;				///< Status register, UCSRnA
+	volatile uint8_t* p_UCR;				///< Control register, UCSRnB
+	volatile uint8_t* p_UBRRH;				///< High byte of the baud rate divisor
+	volatile uint8_t* p_UBRRL;				///< Low byte of the baud rate divisor
+	void (*p_rx_isr)(void);					///< Receive complete interrupt
+	void (*p_udre_isr)(void);				///< Data register empty interrupt
+	void (*p_sink)(uint8_t);				///< Function which gets each byte sent
+	bool sending;							///< A byte is being shifted out
+	bool sent;								///< The TXC flag, kept apart from UCSRnA
+	uint64_t xmt_done;						///< Tick at which the byte has gone out
+	uint64_t rcv_free;						///< Tick at which the next byte can arrive
+	uint8_t rcv_buf[HAL_SIM_RCV_SIZE];		///< Bytes on their way to the receiver
+	uint8_t rcv_head;						///< Index where the next byte is put
+	uint8_t rcv_tail;						///< Index of the next byte to arrive
+} hal_sim_usart;
+
+
+/// This structure holds a model of a device outside the AVR and when it's run
+typedef struct
+{
+	void (*p_run)(uint64_t);				///< Function which runs the model
+	uint64_t period;						///< Ticks between runs
+	uint64_t due;							///< Tick at which it runs next
+} hal_sim_device;
+
+
+// This function prints bytes sent by USART 0 on the PC's standard output
+static void hal_sim_print (uint8_t);
+
+/// The two simulated USARTs; number 0 talks to the PC's terminal
+static hal_sim_usart usarts[2] =
+{
+	{ &hal_UDR0, &hal_UCSR0A, &hal_UCSR0B, &hal_UBRR0H, &hal_UBRR0L,
+	  hal_sim_usart0_rx, hal_sim_usart0_udre, hal_sim_print },
+	{ &hal_UDR1, &hal_UCSR1A, &hal_UCSR1B, &hal_UBRR1H, &hal_UBRR1L,
+	  hal_sim_usart1_rx, hal_sim_usart1_udre, NULL }
+};
+
+static uint64_t now_ticks = 0;				///< Simulated time since the start
+static uint64_t end_ticks = 0;				///< Time at which to stop, 0 for never
+static uint32_t interrupts_run = 0;			///< Count of interrupts serviced
+static bool timer_overflowed = false;		///< TOV3 flag, kept apart from ETIFR
+static bool timer_matched = false;			///< OCF3A flag, kept apart from ETIFR
+static bool real_time = false;				///< Keep pace with the wall clock
+static bool input_done = false;				///< Standard input has ended
+static bool terminal_taken = false;			///< A model types instead of the user
+static bool input_stopped = false;			///< The firmware has sent XOFF
+static bool flow_control = false;			///< XON and XOFF are flow control, not data
+static bool flow_control_ending = false;	///< Streaming has stopped; the rest is going out
+static void (*p_screen)(uint8_t) = NULL;	///< Function a model at the terminal reads with
+static bool raw_input = false;				///< Line feeds aren't made carriage returns
+static struct termios saved_termios;		///< Terminal settings to restore at exit
+static hal_sim_device devices[HAL_SIM_MAX_DEVICES];	///< Models of outside devices
+static uint8_t device_count = 0;			///< Number of device models
+static hal_sim_event_hook p_event_hook = NULL;	///< Function told of HAL_EVENT()'s
+static struct timespec start_time;			///< Wall clock time at the start
+
+
+//-------------------------------------------------------------------------------------
+/** This function prints a byte sent through USART 0 on standard output, or gives it 
+ *  to the model which has taken the terminal. In streaming mode XON and XOFF aren't 
+ *  shown, but start and stop the reading of standard input as a terminal program with
+ *  software flow control would. Outside it they're data like any other byte, as they
+ *  may be in the binary frames of host_protocol.h.
+ *  @param byte The byte which was sent
+ */
+
+static void hal_sim_print (uint8_t byte)
+{
+	if (flow_control && (byte == HAL_SIM_XON || byte == HAL_SIM_XOFF))
+	{
+		input_stopped = (byte == HAL_SIM_XOFF);
+		return;
+	}
+	if (terminal_taken)
+	{
+		if (p_screen)
+		{
+			p_screen (byte);
+		}
+		return;
+	}
+	putchar (byte);
+	if (real_time)
+	{
+		fflush (stdout);
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function puts the terminal back the way it was when the simulation started.
+ */
+
+static void hal_sim_restore (void)
+{
+	fflush (stdout);
+	if (real_time)
+	{
+		tcsetattr (STDIN_FILENO, TCSANOW, &saved_termios);
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function sets up the simulation before main() runs. If standard input is a
+ *  terminal, keys are passed on as soon as they're pressed, without being echoed, and
+ *  time is kept real; otherwise the run length is taken from HAL_SIM_SECONDS.
+ */
+
+static void __attribute__ ((constructor)) hal_sim_start (void)
+{
+	hal_UCSR0A = (1 << UDRE0);
+	hal_UCSR1A = (1 << UDRE1);
+
+	raw_input = (getenv ("HAL_SIM_RAW_INPUT") != NULL);
+	real_time = isatty (STDIN_FILENO);
+	if (real_time)
+	{
+		struct termios raw;
+		tcgetattr (STDIN_FILENO, &saved_termios);
+		raw = saved_termios;
+		raw.c_lflag &= ~(ICANON | ECHO);
+		raw.c_cc[VMIN] = 0;
+		raw.c_cc[VTIME] = 0;
+		tcsetattr (STDIN_FILENO, TCSANOW, &raw);
+	}
+	else
+	{
+		const char* p_env = getenv ("HAL_SIM_SECONDS");
+		end_ticks = (uint64_t)(p_env ? atol (p_env) : HAL_SIM_SECONDS)
+					* HAL_SIM_TICKS_PER_SEC;
+	}
+	atexit (hal_sim_restore);
+	clock_gettime (CLOCK_MONOTONIC, &start_time);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function calls an interrupt service routine if it exists and interrupts are
+ *  enabled. As on the AVR, interrupts are disabled while the routine runs.
+ *  @param p_isr The interrupt service routine
+ *  @return True if the routine was called, false if not
+ */
+
+static bool hal_sim_interrupt (void (*p_isr)(void))
+{
+	if (p_isr == NULL || !(hal_SREG & 0x80))
+	{
+		return (false);
+	}
+	hal_SREG &= 0x7F;
+	p_isr ();
+	hal_SREG |= 0x80;
+	interrupts_run++;
+	return (true);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function finds how many ticks a USART takes to send or receive a byte of one
+ *  start bit, eight data bits and one stop bit at the baud rate set in its registers.
+ *  @param usart The USART
+ *  @return The time for one byte, in ticks
+ */
+
+static uint64_t hal_sim_byte_time (hal_sim_usart& usart)
+{
+	uint32_t cycles_per_bit = (*usart.p_USR & (1 << U2X0)) ? 8 : 16;
+	cycles_per_bit *= ((uint32_t)(*usart.p_UBRRH & 0x0F) << 8) + *usart.p_UBRRL + 1;
+	return ((10UL * cycles_per_bit) / 8);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function reads whatever has been typed on standard input into the receiver
+ *  queue of USART 0, without waiting, as long as the firmware hasn't sent XOFF and
+ *  no more than HAL_SIM_HOST_FIFO bytes are on their way. Line feeds become the
+ *  carriage returns sent by the Enter key of a terminal program, unless the input is
+ *  raw binary.
+ */
+
+static void hal_sim_read_input (void)
+{
+	hal_sim_usart& usart = usarts[0];
+	fd_set read_set;
+	struct timeval no_wait = { 0, 0 };
+	unsigned char ch;
+
+	while (!input_done && !terminal_taken && !input_stopped
+		   && (uint8_t)(usart.rcv_head - usart.rcv_tail) < HAL_SIM_HOST_FIFO)
+	{
+		FD_ZERO (&read_set);
+		FD_SET (STDIN_FILENO, &read_set);
+		if (select (STDIN_FILENO + 1, &read_set, NULL, NULL, &no_wait) <= 0)
+		{
+			return;
+		}
+		if (read (STDIN_FILENO, &ch, 1) != 1)
+		{
+			input_done = !real_time;
+			return;
+		}
+		hal_sim_receive (0, (ch == '\n' && !raw_input) ? '\r' : ch);
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function runs the interrupts which are due at the present simulated time: a
+ *  pending timer overflow or compare match, a byte which has arrived at a USART, and
+ *  the data register empty interrupt of a USART which can take another byte.
+ */
+
+static void hal_sim_service (void)
+{
+	// A one written to a flag in ETIFR clears that flag; the register reads as zero
+	if (hal_ETIFR & (1 << TOV3))
+	{
+		timer_overflowed = false;
+	}
+	if (hal_ETIFR & (1 << OCF3A))
+	{
+		timer_matched = false;
+	}
+	hal_ETIFR = 0;
+
+	if (timer_overflowed && (hal_ETIMSK & (1 << TOIE3))
+		&& hal_sim_interrupt (hal_sim_timer3_ovf))
+	{
+		timer_overflowed = false;
+	}
+	if (timer_matched && (hal_ETIMSK & (1 << OCIE3A))
+		&& hal_sim_interrupt (hal_sim_timer3_compa))
+	{
+		timer_matched = false;
+	}
+
+	for (uint8_t index = 0; index < 2; index++)
+	{
+		hal_sim_usart& usart = usarts[index];
+
+		// The firmware clears TXC by writing a one to it, which can't be told apart
+		// from a flag that's still set, so the model keeps the flag itself
+		if (usart.sending && now_ticks >= usart.xmt_done)
+		{
+			usart.sending = false;
+			usart.sent = true;
+		}
+		*usart.p_USR = (*usart.p_USR & ~((1 << TXC0) | (1 << UDRE0)))
+					   | (usart.sent ? (1 << TXC0) : 0)
+					   | (usart.sending ? 0 : (1 << UDRE0));
+
+		// The data register empty interrupt either loads a byte or turns itself off
+		if (!usart.sending && (*usart.p_UCR & (1 << UDRIE0))
+			&& hal_sim_interrupt (usart.p_udre_isr) && (*usart.p_UCR & (1 << UDRIE0)))
+		{
+			usart.sending = true;
+			usart.sent = false;
+			usart.xmt_done = now_ticks + hal_sim_byte_time (usart);
+			*usart.p_USR &= ~((1 << TXC0) | (1 << UDRE0));
+			if (usart.p_sink)
+			{
+				usart.p_sink (*usart.p_UDR);
+			}
+		}
+
+		// Once the bytes sent before streaming stopped are out, which the interrupt 
+		// shows by turning itself off, XON and XOFF are data again
+		if (index == 0 && flow_control_ending && !(*usart.p_UCR & (1 << UDRIE0)))
+		{
+			flow_control = false;
+			flow_control_ending = false;
+		}
+
+		// A byte arrives if the line has been quiet for one byte time since the last
+		if (usart.rcv_head != usart.rcv_tail && now_ticks >= usart.rcv_free
+			&& (*usart.p_UCR & (1 << RXCIE0)) && (hal_SREG & 0x80))
+		{
+			*usart.p_UDR = usart.rcv_buf[usart.rcv_tail++];
+			usart.rcv_free = now_ticks + hal_sim_byte_time (usart);
+			hal_sim_interrupt (usart.p_rx_isr);
+		}
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function moves simulated time forward to the next event, or by the longest
+ *  step if nothing happens sooner, and then runs the interrupts which have come due.
+ *  When the simulation runs in real time, it waits for the wall clock to catch up.
+ */
+
+static void hal_sim_step (void)
+{
+	uint64_t step = HAL_SIM_MAX_STEP;		// Ticks until the next event
+	uint32_t to_event;						// Ticks until one kind of event
+
+	hal_sim_read_input ();
+	hal_sim_service ();
+
+	// Find the next timer event, if the timer is running
+	bool timer_running = (hal_TCCR3B & 0x07) != 0;
+	if (timer_running)
+	{
+		to_event = 0x10000UL - hal_TCNT3;
+		if (to_event < step)
+		{
+			step = to_event;
+		}
+		to_event = (uint16_t)(hal_OCR3A - hal_TCNT3);
+		if (to_event == 0)
+		{
+			to_event = 0x10000UL;
+		}
+		if ((hal_ETIMSK & (1 << OCIE3A)) && to_event < step)
+		{
+			step = to_event;
+		}
+	}
+
+	// Find the next USART event which lies in the future
+	for (uint8_t index = 0; index < 2; index++)
+	{
+		hal_sim_usart& usart = usarts[index];
+		if (usart.sending && usart.xmt_done - now_ticks < step)
+		{
+			step = usart.xmt_done - now_ticks;
+		}
+		if (usart.rcv_head != usart.rcv_tail && usart.rcv_free > now_ticks
+			&& usart.rcv_free - now_ticks < step)
+		{
+			step = usart.rcv_free - now_ticks;
+		}
+	}
+
+	// Each device model outside the AVR runs at its own steady rate
+	for (uint8_t index = 0; index < device_count; index++)
+	{
+		if (devices[index].due - now_ticks < step)
+		{
+			step = devices[index].due - now_ticks;
+		}
+	}
+
+	// Let the time pass, noting a timer overflow or compare match along the way
+	if (timer_running)
+	{
+		if ((uint16_t)(hal_OCR3A - hal_TCNT3 - 1) < step)
+		{
+			timer_matched = true;
+		}
+		if (hal_TCNT3 + step > 0xFFFFUL)
+		{
+			timer_overflowed = true;
+		}
+		hal_TCNT3 = (uint16_t)(hal_TCNT3 + step);
+	}
+	now_ticks += step;
+
+	if (end_ticks && now_ticks >= end_ticks)
+	{
+		hal_sim_exit ();
+	}
+
+	if (real_time)
+	{
+		struct timespec wall;
+		clock_gettime (CLOCK_MONOTONIC, &wall);
+		int64_t wall_us = (int64_t)(wall.tv_sec - start_time.tv_sec) * 1000000L
+						  + (wall.tv_nsec - start_time.tv_nsec) / 1000L;
+		int64_t ahead_us = (int64_t)hal_sim_time_us () - wall_us;
+		if (ahead_us > 0)
+		{
+			usleep (ahead_us);
+		}
+	}
+
+	hal_sim_service ();
+
+	for (uint8_t index = 0; index < device_count; index++)
+	{
+		if (now_ticks >= devices[index].due)
+		{
+			devices[index].due += devices[index].period;
+			devices[index].p_run (hal_sim_time_us ());
+			hal_sim_service ();
+		}
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function lets simulated time pass until an interrupt has been serviced, as an
+ *  AVR in idle sleep mode does until an interrupt wakes it up.
+ */
+
+void hal_sim_sleep (void)
+{
+	uint32_t interrupts_before = interrupts_run;
+
+	while (interrupts_run == interrupts_before)
+	{
+		hal_sim_step ();
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function lets simulated time move to the next event. It's called by loops
+ *  which wait for the hardware to do something, through the HAL_WAIT() macro.
+ */
+
+void hal_sim_wait (void)
+{
+	hal_sim_step ();
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function ends the simulation. It's called when the run time is up and when
+ *  the firmware reboots itself with the watchdog timer.
+ */
+
+void hal_sim_exit (void)
+{
+	fflush (stdout);
+	fprintf (stderr, "\nSimulation ended at %.3f s\n", hal_sim_time_us () / 1.0e6);
+	exit (0);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function finds the simulated time since the program started.
+ *  @return The time in microseconds
+ */
+
+uint64_t hal_sim_time_us (void)
+{
+	return ((now_ticks * 1000000ULL) / HAL_SIM_TICKS_PER_SEC);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function sets the function which is given every byte sent by a USART. The
+ *  default for USART 0 prints the bytes; USART 1 has none, so its bytes are lost.
+ *  @param port The number of the USART, 0 or 1
+ *  @param p_sink The function to be called with each byte, or NULL for none
+ */
+
+void hal_sim_set_uart_sink (uint8_t port, void (*p_sink)(uint8_t))
+{
+	usarts[port & 1].p_sink = p_sink;
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function puts a byte into the queue of bytes on their way to a USART's
+ *  receiver. The bytes arrive one byte time apart; if the queue is full, the byte is
+ *  lost, just as it would be on a real serial line with nobody listening.
+ *  @param port The number of the USART, 0 or 1
+ *  @param byte The byte to be received
+ */
+
+void hal_sim_receive (uint8_t port, uint8_t byte)
+{
+	hal_sim_usart& usart = usarts[port & 1];
+
+	if ((uint8_t)(usart.rcv_head + 1) != usart.rcv_tail)
+	{
+		usart.rcv_buf[usart.rcv_head++] = byte;
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function finds how long a USART takes to send or receive one byte at the baud
+ *  rate which the firmware has set, so that a device model can time its answers.
+ *  @param port The number of the USART, 0 or 1
+ *  @return The time for one byte, in microseconds
+ */
+
+double hal_sim_byte_time_us (uint8_t port)
+{
+	return (hal_sim_byte_time (usarts[port & 1]) * 1.0e6 / HAL_SIM_TICKS_PER_SEC);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function adds a device model which is run as simulated time passes. It's
+ *  called with the simulated time every period, and between runs the firmware can't
+ *  tell that it exists. Up to HAL_SIM_MAX_DEVICES models can be added.
+ *  @param p_run The function which runs the device model, given the time in
+ *               microseconds
+ *  @param period_us The number of microseconds between runs, at least one
+ *  @return True if the model was added, false if there's no room for it
+ */
+
+bool hal_sim_add_device (void (*p_run)(uint64_t), uint32_t period_us)
+{
+	if (device_count >= HAL_SIM_MAX_DEVICES)
+	{
+		return (false);
+	}
+	hal_sim_device& device = devices[device_count++];
+	device.p_run = p_run;
+	device.period = ((uint64_t)period_us * HAL_SIM_TICKS_PER_SEC) / 1000000ULL;
+	if (device.period == 0)
+	{
+		device.period = 1;
+	}
+	device.due = now_ticks + device.period;
+	return (true);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function lets a device model take the user's place at the terminal. From
+ *  then on, standard input is ignored, what the firmware sends through USART 0 is
+ *  given to the model's screen function, as the terminal would show it, or dropped 
+ *  if there's none, the simulation runs as fast as it can, and it doesn't stop after
+ *  HAL_SIM_SECONDS; the model types what it likes with hal_sim_receive() and ends the
+ *  run with hal_sim_exit().
+ *  @param p_model_screen A function which gets each byte the terminal would show, or
+ *                        NULL if the model doesn't look
+ */
+
+void hal_sim_take_terminal (void (*p_model_screen)(uint8_t))
+{
+	hal_sim_restore ();
+	terminal_taken = true;
+	real_time = false;
+	end_ticks = 0;
+	p_screen = p_model_screen;
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function reads the output register of a port, which a device model uses to
+ *  see what the firmware has put on the pins which connect to it.
+ *  @param port The letter of the port, 'A' to 'D'
+ *  @return The contents of the port's output register, or 0 for an unknown port
+ */
+
+uint8_t hal_sim_read_port (char port)
+{
+	switch (port)
+	{
+		case 'A':
+			return (hal_PORTA);
+		case 'B':
+			return (hal_PORTB);
+		case 'C':
+			return (hal_PORTC);
+		case 'D':
+			return (hal_PORTD);
+		default:
+			return (0);
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function sets input pins of a port, which a device model uses to put levels
+ *  on the pins which connect to it. The firmware sees them in the port's input
+ *  register; pins which no model drives stay as they were.
+ *  @param port The letter of the port, 'A' to 'D'
+ *  @param mask A bit set for each pin to be driven
+ *  @param levels The levels of those pins, a bit set for each pin which is high
+ */
+
+void hal_sim_drive_port (char port, uint8_t mask, uint8_t levels)
+{
+	volatile uint8_t* p_pins;
+
+	switch (port)
+	{
+		case 'A':
+			p_pins = &hal_PINA;
+			break;
+		case 'B':
+			p_pins = &hal_PINB;
+			break;
+		case 'C':
+			p_pins = &hal_PINC;
+			break;
+		case 'D':
+			p_pins = &hal_PIND;
+			break;
+		default:
+			return;
+	}
+	*p_pins = (*p_pins & ~mask) | (levels & mask);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function sets the function which is told of each HAL_EVENT() the firmware
+ *  reaches. A watcher which needs to share the events with one set before it calls
+ *  the one which this function returns.
+ *  @param p_hook The function to be called with each event's code and value
+ *  @return The function which was set before, or NULL if there was none
+ */
+
+hal_sim_event_hook hal_sim_set_event_hook (hal_sim_event_hook p_hook)
+{
+	hal_sim_event_hook p_previous = p_event_hook;
+	p_event_hook = p_hook;
+	return (p_previous);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function is called by the HAL_EVENT() macro when the firmware reaches a point
+ *  of interest, and passes the event on to whatever is watching the simulation.
+ *  @param code The kind of event, one of the HAL_EVENT_* codes in hal.h
+ *  @param value A number which goes with the event, such as a character
+ */
+
+void hal_sim_event (uint8_t code, uint8_t value)
+{
+	// The terminal follows streaming mode, in which XON and XOFF are flow control. When
+	// it stops, those already sent still are, until they've all gone out
+	if (code == HAL_EVENT_STREAMING)
+	{
+		flow_control = flow_control || value;
+		flow_control_ending = !value && flow_control;
+	}
+	if (p_event_hook)
+	{
+		p_event_hook (code, value);
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function writes an unsigned number as text in the given base, as avr-libc's
+ *  number conversions do. The other conversions below call it.
+ *  @param num The number to be converted
+ *  @param p_str The buffer in which the text is put
+ *  @param base The base, from 2 to 36
+ *  @return A pointer to the text
+ */
+
+static char* hal_sim_ntoa (unsigned long num, char* p_str, int base)
+{
+	char digits[8 * sizeof (unsigned long)];	// Digits, last one first
+	uint8_t count = 0;
+	char* p_out = p_str;
+
+	do
+	{
+		uint8_t digit = num % base;
+		digits[count++] = (digit < 10) ? ('0' + digit) : ('a' + digit - 10);
+		num /= base;
+	}
+	while (num);
+
+	while (count)
+	{
+		*p_out++ = digits[--count];
+	}
+	*p_out = '\0';
+	return (p_str);
+}
+
+
+//-------------------------------------------------------------------------------------
+// These are avr-libc's conversions of signed and unsigned numbers, declared in hal_sim.h
+
+char* itoa (int num, char* p_str, int base)
+{
+	if (num < 0 && base == 10)
+	{
+		*p_str = '-';
+		hal_sim_ntoa (-(long)num, p_str + 1, base);
+		return (p_str);
+	}
+	return (hal_sim_ntoa ((unsigned int)num, p_str, base));
+}
+
+
+char* utoa (unsigned int num, char* p_str, int base)
+{
+	return (hal_sim_ntoa (num, p_str, base));
+}
+
+
+char* ltoa (long num, char* p_str, int base)
+{
+	if (num < 0 && base == 10)
+	{
+		*p_str = '-';
+		hal_sim_ntoa (-num, p_str + 1, base);
+		return (p_str);
+	}
+	return (hal_sim_ntoa ((unsigned long)num, p_str, base));
+}
+
+
+char* ultoa (unsigned long num, char* p_str, int base)
+{
+	return (hal_sim_ntoa (num, p_str, base));
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function does what avr-libc's float conversion engine does: it puts a byte of
+ *  FTOA_* flags into the buffer, then prec + 1 decimal digits of the number, and
+ *  returns the power of ten by which the first digit is multiplied.
+ *  @param val The number to be converted
+ *  @param p_buf The buffer, which must hold at least prec + 3 characters
+ *  @param prec The number of digits after the first one
+ *  @param maxdgs The largest number of digits which are meaningful
+ *  @return The decimal exponent of the first digit
+ */
+
+extern "C" int __ftoa_engine (double val, char* p_buf, unsigned char prec,
+							  unsigned char maxdgs)
+{
+	char text[48];							// The number in printf's %e format
+	int exponent = 0;
+
+	if (prec >= maxdgs)
+	{
+		prec = maxdgs - 1;
+	}
+
+	p_buf[0] = signbit (val) ? FTOA_MINUS : 0;
+	if (isnan (val))
+	{
+		p_buf[0] |= FTOA_NAN;
+		p_buf[1] = '\0';
+		return (0);
+	}
+	if (isinf (val))
+	{
+		p_buf[0] |= FTOA_INF;
+		p_buf[1] = '\0';
+		return (0);
+	}
+	if (val == 0.0)
+	{
+		p_buf[0] |= FTOA_ZERO;
+	}
+
+	// The text looks like "d.ddde+xx"; copy the digits and read the exponent
+	snprintf (text, sizeof (text), "%.*e", prec, fabs (val));
+	char* p_out = p_buf + 1;
+	for (char* p_in = text; *p_in && *p_in != 'e'; p_in++)
+	{
+		if (*p_in != '.')
+		{
+			*p_out++ = *p_in;
+		}
+	}
+	*p_out = '\0';
+	char* p_exp = strchr (text, 'e');
+	if (p_exp)
+	{
+		exponent = atoi (p_exp + 1);
+	}
+	return (exponent);
+}
+
+#endif // HAL_SIM
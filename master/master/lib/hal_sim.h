@@ -0,0 +1,269 @@
+//*************************************************************************************
+/** \file hal_sim.h
+ *    This file contains the simulated hardware which lets the master firmware run as
+ *    a program on a Linux PC. It is included by hal.h when the macro HAL_SIM is
+ *    defined. Every AVR register the firmware uses is an ordinary variable here, and
+ *    the device models in hal_sim.cpp watch those variables and call the interrupt
+ *    service routines just as the hardware would:
+ *    \li Timer 3 counts at the AVR's rate of F_CPU / 8 and calls the overflow and
+ *        compare match A interrupts, so the task timer and idle sleep work unchanged
+ *    \li USART 0 is the user's terminal. Characters typed on the PC's standard input
+ *        arrive through the receive interrupt, and whatever the firmware sends through
+ *        the data register empty interrupt is printed on standard output. In
+ *        streaming mode, XON and XOFF from the firmware start and stop the reading of
+ *        standard input, so a document can be piped in; otherwise they're printed
+ *        like any other byte, as binary frames may hold them. Line feeds become the
+ *        carriage returns of the Enter key, unless the environment variable
+ *        HAL_SIM_RAW_INPUT is set, which passes every byte as it is for the binary
+ *        frames of host_protocol.h
+ *    \li USART 1 is the slave bus. Bytes sent to it go to the slave simulator in
+ *        sim/slave_sim.cpp, which runs the slave firmware and sends the slaves'
+ *        answers back
+ *    \li The other ports and Timer 1 are only variables which hold what was written,
+ *        except for input pins which a device model drives
+ *    \li Models of the devices outside the AVR, such as the slave simulator, use the
+ *        hooks declared in hal_sim_dev.h to run alongside the firmware
+ *
+ *    Code runs in no simulated time at all; time only passes while the program sleeps
+ *    in sleep_cpu() or waits for the hardware in a loop which calls HAL_WAIT(). When
+ *    standard input is a terminal, simulated time is held back to real time so that
+ *    the hand moves at its real speed. When it's a file or pipe, the simulation runs
+ *    as fast as it can and stops after HAL_SIM_SECONDS of simulated time, which may
+ *    be changed with the environment variable of the same name.
+ *
+ *  Revisions:
+ *    \li 10-16-2026 Original file
+ *    \li 10-16-2026 Device hooks moved to hal_sim_dev.h; firmware events added
+ *    \li 10-16-2026 pgm_read_word()
+ *    \li 10-16-2026 PIND0, and input pins driven by device models
+ *    \li 10-16-2026 EEPROM, and the high bytes of the baud rate divisors
+ *    \li 10-16-2026 XON and XOFF on the terminal
+ *    \li 10-16-2026 HAL_SIM_RAW_INPUT for binary input
+ *    \li 10-16-2026 XON and XOFF are only flow control in streaming mode
+ *
+ *  License:
+ *    This file released under the Lesser GNU Public License, version 2. This program
+ *    is intended for educational use only, but it is not limited thereto.
+ */
+//*************************************************************************************
+
+/// This define prevents this .h file from being included more than once in a .cc file
+#ifndef _HAL_SIM_H_
+#define _HAL_SIM_H_
+
+#include <stdint.h>
+#include "hal_sim_dev.h"					// Hooks for simulated devices outside the AVR
+
+
+/// Simulated seconds a run from a file or pipe lasts unless HAL_SIM_SECONDS is set
+#define HAL_SIM_SECONDS		600
+
+
+//-------------------------------------------------------------------------------------
+// The simulated registers. Each is a variable defined in hal_sim.cpp, given the name
+// used in the ATmega128 data sheet so that the firmware compiles unchanged
+
+/// This macro declares a simulated 8-bit register and gives it its AVR name
+#define HAL_SIM_REG(name)	extern volatile uint8_t hal_##name;
+
+HAL_SIM_REG (SREG)
+HAL_SIM_REG (UDR0)   HAL_SIM_REG (UCSR0A) HAL_SIM_REG (UCSR0B) HAL_SIM_REG (UCSR0C)
+HAL_SIM_REG (UBRR0H) HAL_SIM_REG (UBRR0L)
+HAL_SIM_REG (UDR1)   HAL_SIM_REG (UCSR1A) HAL_SIM_REG (UCSR1B) HAL_SIM_REG (UCSR1C)
+HAL_SIM_REG (UBRR1H) HAL_SIM_REG (UBRR1L)
+HAL_SIM_REG (TCCR1A) HAL_SIM_REG (TCCR1B) HAL_SIM_REG (TIMSK)
+HAL_SIM_REG (TCCR3A) HAL_SIM_REG (TCCR3B) HAL_SIM_REG (ETIMSK) HAL_SIM_REG (ETIFR)
+HAL_SIM_REG (PORTA)  HAL_SIM_REG (PORTB)  HAL_SIM_REG (PORTC)  HAL_SIM_REG (PORTD)
+HAL_SIM_REG (DDRA)   HAL_SIM_REG (DDRB)   HAL_SIM_REG (DDRC)   HAL_SIM_REG (DDRD)
+HAL_SIM_REG (PINA)   HAL_SIM_REG (PINB)   HAL_SIM_REG (PINC)   HAL_SIM_REG (PIND)
+
+#define SREG		hal_SREG
+#define UDR0		hal_UDR0
+#define UCSR0A		hal_UCSR0A
+#define UCSR0B		hal_UCSR0B
+#define UCSR0C		hal_UCSR0C
+#define UBRR0H		hal_UBRR0H
+#define UBRR0L		hal_UBRR0L
+#define UDR1		hal_UDR1
+#define UCSR1A		hal_UCSR1A
+#define UCSR1B		hal_UCSR1B
+#define UCSR1C		hal_UCSR1C
+#define UBRR1H		hal_UBRR1H
+#define UBRR1L		hal_UBRR1L
+#define TCCR1A		hal_TCCR1A
+#define TCCR1B		hal_TCCR1B
+#define TIMSK		hal_TIMSK
+#define TCCR3A		hal_TCCR3A
+#define TCCR3B		hal_TCCR3B
+#define ETIMSK		hal_ETIMSK
+#define ETIFR		hal_ETIFR
+#define PORTA		hal_PORTA
+#define PORTB		hal_PORTB
+#define PORTC		hal_PORTC
+#define PORTD		hal_PORTD
+#define DDRA		hal_DDRA
+#define DDRB		hal_DDRB
+#define DDRC		hal_DDRC
+#define DDRD		hal_DDRD
+#define PINA		hal_PINA
+#define PINB		hal_PINB
+#define PINC		hal_PINC
+#define PIND		hal_PIND
+
+// The 16-bit timer registers. The high and low bytes of the output compare registers
+// are the bytes of the 16-bit variable; this works because PCs are little-endian
+extern volatile uint16_t hal_TCNT1, hal_ICR1, hal_OCR1A, hal_OCR1B;
+extern volatile uint16_t hal_TCNT3, hal_OCR3A;
+
+#define TCNT1		hal_TCNT1
+#define ICR1		hal_ICR1
+#define OCR1A		hal_OCR1A
+#define OCR1B		hal_OCR1B
+#define OCR1AL		(((volatile uint8_t*)&hal_OCR1A)[0])
+#define OCR1AH		(((volatile uint8_t*)&hal_OCR1A)[1])
+#define OCR1BL		(((volatile uint8_t*)&hal_OCR1B)[0])
+#define OCR1BH		(((volatile uint8_t*)&hal_OCR1B)[1])
+#define TCNT3		hal_TCNT3
+#define OCR3A		hal_OCR3A
+
+// Bit numbers in the USART registers, the same for both USARTs
+#define MPCM0	0
+#define U2X0	1
+#define TXC0	6
+#define RXC0	7
+#define UDRE0	5
+#define TXEN0	3
+#define RXEN0	4
+#define UDRIE0	5
+#define TXCIE0	6
+#define RXCIE0	7
+#define UCSZ00	1
+#define UCSZ01	2
+#define USBS0	3
+#define MPCM1	0
+#define U2X1	1
+#define UDRE1	5
+#define TXC1	6
+#define RXC1	7
+#define TXEN1	3
+#define RXEN1	4
+#define UDRIE1	5
+#define TXCIE1	6
+#define RXCIE1	7
+#define UCSZ10	1
+#define UCSZ11	2
+#define USBS1	3
+
+// Bit numbers in the timer registers
+#define WGM10	0
+#define WGM11	1
+#define COM1B1	5
+#define COM1A1	7
+#define CS10	0
+#define CS11	1
+#define CS12	2
+#define WGM12	3
+#define WGM13	4
+#define TOIE1	2
+#define CS31	1
+#define TOIE3	2
+#define OCIE3A	4
+#define TOV3	2
+#define OCF3A	4
+
+// Bit numbers in the ports
+#define PINA0	0
+#define PINA1	1
+#define PINA2	2
+#define PINA3	3
+#define PINA4	4
+#define PINA5	5
+#define PINA6	6
+#define PINA7	7
+#define PIND0	0
+#define PIND4	4
+#define PIND5	5
+#define PIND6	6
+
+
+//-------------------------------------------------------------------------------------
+// Interrupts. An ISR becomes an ordinary C function named after its vector, which the
+// device models call with the global interrupt enable bit in SREG cleared
+
+#define TIMER3_OVF_vect		hal_sim_timer3_ovf		///< Timer 3 overflow
+#define TIMER3_COMPA_vect	hal_sim_timer3_compa	///< Timer 3 compare match A
+#define TIMER1_OVF_vect		hal_sim_timer1_ovf		///< Timer 1 overflow (never called)
+#define USART0_RX_vect		hal_sim_usart0_rx		///< USART 0 receive complete
+#define USART0_UDRE_vect	hal_sim_usart0_udre		///< USART 0 data register empty
+#define USART1_RX_vect		hal_sim_usart1_rx		///< USART 1 receive complete
+#define USART1_UDRE_vect	hal_sim_usart1_udre		///< USART 1 data register empty
+
+#define ISR(vector, ...)	extern "C" void vector (void); extern "C" void vector (void)
+#define EMPTY_INTERRUPT(vector)	extern "C" void vector (void) { }
+#define sei()				(hal_SREG |= 0x80)
+#define cli()				(hal_SREG &= 0x7F)
+
+
+//-------------------------------------------------------------------------------------
+// Sleeping and waiting let simulated time pass
+
+#define SLEEP_MODE_IDLE			0
+#define set_sleep_mode(mode)
+#define sleep_enable()
+#define sleep_disable()
+#define sleep_cpu()				hal_sim_sleep ()
+
+/// A loop which waits for the hardware calls this macro so that the hardware can act
+#define HAL_WAIT()				hal_sim_wait ()
+
+/// Points of interest in the firmware are passed on to whatever watches the simulation
+#define HAL_EVENT(code, value)	hal_sim_event ((code), (value))
+
+/// Rebooting with the watchdog timer ends the simulation
+#define wdt_enable(timeout)		hal_sim_exit ()
+
+
+//-------------------------------------------------------------------------------------
+// Program memory is ordinary memory on a PC
+
+#define PROGMEM
+#define PSTR(s)					(s)
+#define pgm_read_byte(addr)		(*(const uint8_t*)(addr))
+#define pgm_read_byte_near(addr)	(*(const uint8_t*)(addr))
+#define pgm_read_word(addr)		(*(const uint16_t*)(addr))
+
+
+//-------------------------------------------------------------------------------------
+// EEPROM is ordinary memory too, so what's written there is lost when the program ends
+
+#define EEMEM
+#define eeprom_read_byte(addr)			(*(const uint8_t*)(addr))
+#define eeprom_update_byte(addr, value)	(*(uint8_t*)(addr) = (value))
+
+
+//-------------------------------------------------------------------------------------
+// Number conversions from avr-libc which the PC's C library doesn't have; the float
+// conversion __ftoa_engine() used by base_text_serial is also defined in hal_sim.cpp
+
+char* itoa (int, char*, int);
+char* utoa (unsigned int, char*, int);
+char* ltoa (long, char*, int);
+char* ultoa (unsigned long, char*, int);
+
+
+//-------------------------------------------------------------------------------------
+// Functions which run the simulated hardware
+
+// Let simulated time pass until some interrupt has run, as the AVR's idle sleep does
+void hal_sim_sleep (void);
+
+// Let a little simulated time pass while the program waits for the hardware
+void hal_sim_wait (void);
+
+// End the simulation, printing how much simulated time has passed
+void hal_sim_exit (void);
+
+// Tell whatever is watching the simulation that the firmware reached a HAL_EVENT()
+void hal_sim_event (uint8_t, uint8_t);
+
+#endif // _HAL_SIM_H_
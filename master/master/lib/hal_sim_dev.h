@@ -0,0 +1,70 @@
+//*************************************************************************************
+/** \file hal_sim_dev.h
+ *    This file contains the hooks by which models of the devices outside the AVR are
+ *    connected to the simulated master. It's included by hal_sim.h, and it can also
+ *    be included on its own by a device model which has register names of its own,
+ *    such as the simulator of the finger slaves, because it defines no register
+ *    macros. A device model may:
+ *    \li Be given every byte sent by a USART, with hal_sim_set_uart_sink()
+ *    \li Send bytes to a USART's receiver with hal_sim_receive()
+ *    \li Be run at a steady rate as simulated time passes, with hal_sim_add_device()
+ *    \li Type at the terminal in the user's place, and read what it shows, after
+ *        hal_sim_take_terminal()
+ *    \li Watch the output pins of a port with hal_sim_read_port()
+ *    \li Drive input pins of a port, as the firmware reads them, with
+ *        hal_sim_drive_port()
+ *    \li Be told of points of interest in the firmware, marked there with HAL_EVENT(),
+ *        through a function given to hal_sim_set_event_hook()
+ *
+ *  Revisions:
+ *    \li 10-16-2026 Original file
+ *    \li 10-16-2026 Several device models; a model can take over the terminal
+ *    \li 10-16-2026 Models can drive input pins
+ *    \li 10-16-2026 A model at the terminal can read what it shows
+ *
+ *  License:
+ *    This file released under the Lesser GNU Public License, version 2. This program
+ *    is intended for educational use only, but it is not limited thereto.
+ */
+//*************************************************************************************
+
+/// This define prevents this .h file from being included more than once in a .cc file
+#ifndef _HAL_SIM_DEV_H_
+#define _HAL_SIM_DEV_H_
+
+#include <stdint.h>
+#include <stddef.h>						// For NULL, the default screen function
+
+
+/// The type of a function which is called at each HAL_EVENT() with its code and value
+typedef void (*hal_sim_event_hook)(uint8_t, uint8_t);
+
+
+// Find the simulated time since the program started, in microseconds
+uint64_t hal_sim_time_us (void);
+
+// Set the function which gets every byte sent by a USART
+void hal_sim_set_uart_sink (uint8_t, void (*)(uint8_t));
+
+// Put a byte into a USART's receiver as if it had come in on the wire
+void hal_sim_receive (uint8_t, uint8_t);
+
+// Find how long a USART takes to send one byte at the baud rate it's set to
+double hal_sim_byte_time_us (uint8_t);
+
+// Add a function to be run every so many microseconds of simulated time
+bool hal_sim_add_device (void (*)(uint64_t), uint32_t);
+
+// Let a device model type at the terminal instead of the user, and perhaps read it
+void hal_sim_take_terminal (void (*)(uint8_t) = NULL);
+
+// Read what the firmware has written to the output register of port A, B, C or D
+uint8_t hal_sim_read_port (char);
+
+// Set the levels of some input pins of port A, B, C or D
+void hal_sim_drive_port (char, uint8_t, uint8_t);
+
+// Set the function which is told of HAL_EVENT()'s, returning the one set before
+hal_sim_event_hook hal_sim_set_event_hook (hal_sim_event_hook);
+
+#endif // _HAL_SIM_DEV_H_
@@ -8,11 +8,15 @@
  *
  *  Revisions
  *    \li  04-12-08  JRR  Original file, material from source above
+ *    \li  10-16-26       Added free_ram() for memory use measurements
+ *    \li  10-16-26       AVR-only parts left out of a simulated PC build
  */
 //*************************************************************************************
  
 #include "mechutil.h"
 
+#ifdef __AVR
+
 //-------------------------------------------------------------------------------------
 // Stuff to make the new and delete operators work. Doxygen comments in mechutil.h
 
@@ -37,6 +41,33 @@ void operator delete[] (void* ptr)
     }
 
 
+#endif // __AVR
+
+//-------------------------------------------------------------------------------------
+// Stuff to measure memory usage. Doxygen comments in mechutil.h. A PC has no fixed
+// amount of SRAM to run out of, so the simulated build just reports zero
+
+#ifdef __AVR
+extern int __heap_start;
+extern int* __brkval;
+
+int free_ram (void)
+    {
+    int top_of_stack;
+    if (__brkval == 0)
+        return ((int)&top_of_stack - (int)&__heap_start);
+    return ((int)&top_of_stack - (int)__brkval);
+    }
+#else
+int free_ram (void)
+    {
+    return (0);
+    }
+#endif // __AVR
+
+#ifdef __AVR
+
+
 //-------------------------------------------------------------------------------------
 // Stuff needed for templates and virtual methods (?). Doxygen comments in mechutil.h
 
@@ -72,3 +103,5 @@ void __cxa_pure_virtual (void)
     {
     }
 }
+
+#endif // __AVR
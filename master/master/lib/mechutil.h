@@ -8,6 +8,8 @@
  *
  *  Revisions
  *    \li  04-12-08  JRR  Original file, material from source above
+ *    \li  10-16-26       Added free_ram() for memory use measurements
+ *    \li  10-16-26       AVR-only parts left out of a simulated PC build
  */
 //*************************************************************************************
 
@@ -16,6 +18,9 @@
 
 #include <stdlib.h> 
 
+// The PC's own libraries already have new, delete and the guard functions
+#ifdef __AVR
+
 // ------------------ Stuff to make the new and delete operators work -----------------
 
 /** This is the standard "new" operator, defined here because it's not available in the
@@ -40,6 +45,17 @@ void* operator new[] (size_t size);
  */
 void operator delete[] (void* ptr);
 
+#endif // __AVR
+
+// ------------------------- Stuff to measure memory usage ---------------------------
+
+/** This function returns the number of bytes of SRAM between the top of the heap and 
+ *  the bottom of the stack. It's a quick way to see how much memory is left over.
+ */
+int free_ram (void);
+
+#ifdef __AVR
+
 // ---------------------- Stuff for pure virtual functions (?) ------------------------
 
 // This stuff is supposed to help with templates and virtual methods
@@ -53,4 +69,6 @@ extern "C" void __cxa_guard_abort (__guard *);
  */
 extern "C" void __cxa_pure_virtual (void);
 
+#endif // __AVR
+
 #endif // _ME405_H_
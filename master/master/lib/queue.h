@@ -15,7 +15,9 @@
  *    a character as qIndexType; otherwise use a regular 16-bit integer. For example,
  *    a queue holding 100 long integers (which would use 400 bytes for the data plus
  *    a few more bytes for the indices) could be declared as 
- *    "queue<long, char, 100> my_queue". 
+ *    "queue<long, char, 100> my_queue". If qSize is a power of two, indices are 
+ *    wrapped with a mask rather than a comparison. Blocks of items can be moved with
+ *    put_n(), get_n() and peek(), or used where they lie with get_span() and skip(). 
  *
  *  Revisions:
  *    \li 08-28-03  JRR  Reference: www.yureu.com/logo_plotter/queue_code.htm
@@ -23,6 +25,9 @@
  *    \li 12-14-07  JRR  Doxygen comments added
  *    \li 02-17-08  JRR  Changed index type from define to template parameter
  *    \li 08-12-08  JRR  Added overloaded array subscript operator
+ *    \li 10-16-2026 Subscripts wrap around the end of the buffer correctly
+ *    \li 10-16-2026 Masked indices for power of two sizes; block and span methods; 
+ *                    jam() moves its index and delete_one() checks for an empty queue
  *
  *  License:
  *    This file copyright 2007-2008 by JR Ridgely. It is released under the Lesser GNU
@@ -54,6 +59,12 @@ class queue
 		qIndexType i_get;			   ///< Index where oldest data was written
 		qIndexType how_full;			///< How many elements are full at this time
 
+		// Move an index on by some places, wrapping around the end of the buffer
+		qIndexType advance (qIndexType, qIndexType);
+
+		// Move an index on by one place, wrapping around the end of the buffer
+		qIndexType next (qIndexType);
+
 	public:
 
 		queue (void);				// Constructor
@@ -63,6 +74,11 @@ class queue
 		bool is_empty (void);		// Is the queue empty or not?
 		void flush (void);			// Empty out the whole buffer
 		void delete_one (void);		// Delete the last entry
+		qIndexType put_n (const qType*, qIndexType);	// Adds a block of items
+		qIndexType get_n (qType*, qIndexType);			// Gets a block of items
+		qIndexType peek (qType*, qIndexType);			// Copies items, leaving them
+		qType* get_span (qIndexType*);		// Finds the oldest items lying together
+		void skip (qIndexType);				// Throws away the oldest items
 
 		// This operator returns an item at the given index in the queue
 		qType operator[] (qIndexType);
@@ -97,6 +113,50 @@ queue<qType, qIndexType, qSize>::queue (void)
 }
 
 
+//-------------------------------------------------------------------------------------
+/** This method finds where an index gets to when moved on by a number of places, 
+ *  wrapping around the end of the buffer. When the queue's size is a power of two the
+ *  wrap is a mask; otherwise it's a comparison, made so as not to add past what the 
+ *  index type can hold. The test of the size is made by the compiler, which leaves 
+ *  only one of the two in the code. 
+ *  @param index The index to be moved
+ *  @param count How many places to move it, no more than the size of the queue
+ *  @return The moved index
+ */
+
+template <class qType, class qIndexType, qIndexType qSize> 
+inline qIndexType queue<qType, qIndexType, qSize>::advance (qIndexType index, 
+	qIndexType count)
+{
+	if ((qSize & (qSize - 1)) == 0)
+		return ((qIndexType)(index + count) & (qSize - 1));
+	else if (count < qSize - index)
+		return (index + count);
+	else
+		return (count - (qSize - index));
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method moves an index on by one place, wrapping around the end of the buffer.
+ *  It's the same as advance() with a count of one, but quicker when the size of the 
+ *  queue isn't a power of two. 
+ *  @param index The index to be moved
+ *  @return The moved index
+ */
+
+template <class qType, class qIndexType, qIndexType qSize> 
+inline qIndexType queue<qType, qIndexType, qSize>::next (qIndexType index)
+{
+	if ((qSize & (qSize - 1)) == 0)
+		return ((qIndexType)(index + 1) & (qSize - 1));
+	else if (++index >= qSize)
+		return (0);
+	else
+		return (index);
+}
+
+
 //-------------------------------------------------------------------------------------
 /** This method empties the buffer. It doesn't actually erase everything; it just sets
  *  the indices and fill indicator all to zero as if the buffer contained nothing.
@@ -128,8 +188,7 @@ bool queue<qType, qIndexType, qSize>::put (qType data)
 
 	// OK, there's room in the buffer so add the data in
 	buffer[i_put] = data;
-	if (++i_put >= qSize) 
-		i_put = 0;
+	i_put = next (i_put);
 	how_full++;
 
 	return false;
@@ -148,15 +207,13 @@ bool queue<qType, qIndexType, qSize>::jam (qType data)
 {
 	// Write the data and move the write pointer to the next element
 	buffer[i_put] = data;
-	if (i_put >= qSize) 
-		i_put = 0;
+	i_put = next (i_put);
 
 	// Check if the buffer is already full; if so, the read index has to be moved so
 	// that it points to the oldest unread data, which isn't the data written now
 	if (how_full >= qSize)
 	{
-		if (++i_get >= qSize)
-			i_get = 0;
+		i_get = next (i_get);
 		return true;
 	}
 	else
@@ -182,9 +239,8 @@ qType queue<qType, qIndexType, qSize>::get (void)
 	whatIgot = buffer[i_get];			   // Read and hold the data
 
 	if (how_full > 0)					   // If the buffer's not empty,
-	{								   // moveflush the read pointer to the next full
-		if (++i_get >= qSize)			   // element
-			i_get = 0;
+	{								   // move the read pointer to the next full
+		i_get = next (i_get);		 // element
 		how_full--;						 // There's now one less item in the buffer
 	}
 
@@ -219,27 +275,152 @@ template <class qType, class qIndexType, qIndexType qSize>
 qType queue<qType, qIndexType, qSize>::operator[] (qIndexType index)
 {
 	// Check if there's data written at the given location
-	if (index > how_full)
+	if (index >= how_full)
 		return ((qType)(-1));
 
-	// Find an index pointing to the correct location in the queue
-	qIndexType getIndex = i_get + index;
-	if (getIndex > qSize)
-		getIndex -= qSize;
-
-	// Get the data at that index location
-	return (buffer[getIndex]);
+	// Get the data at that index location, wrapping around the end of the buffer
+	return (buffer[advance (i_get, index)]);
 }
 
 //-------------------------------------------------------------------------------------
-/** This method decrements the i_put and how_full variables to "delete" the latest character.
+/** This method decrements the i_put and how_full variables to "delete" the latest 
+ *  character. If the queue is empty, nothing is done.
  */
 
 template <class qType, class qIndexType, qIndexType qSize> 
 void queue<qType, qIndexType, qSize>::delete_one (void)
 {
-	i_put--;
+	if (how_full == 0)
+		return;
+
+	i_put = advance (i_put, qSize - 1);	 // One place back, around the end if need be
 	how_full--;
 }
 
+
+//-------------------------------------------------------------------------------------
+/** This method adds a block of items into the queue, as many as there's room for. 
+ *  The items are copied in at most two runs, one up to the end of the buffer and one
+ *  from its start, and the indices are moved once, which is quicker than calling 
+ *  put() for each item. 
+ *  @param p_data A pointer to the items to be written into the queue
+ *  @param count The number of items to be written
+ *  @return The number of items which were written, less than count if the queue 
+ *	  became full
+ */
+
+template <class qType, class qIndexType, qIndexType qSize> 
+qIndexType queue<qType, qIndexType, qSize>::put_n (const qType* p_data, 
+	qIndexType count)
+{
+	qIndexType index;					   // Index into the caller's items
+	qIndexType first_run;				   // Items which fit before the end
+
+	if (count > qSize - how_full)
+		count = qSize - how_full;
+
+	first_run = qSize - i_put;
+	if (first_run > count)
+		first_run = count;
+	for (index = 0; index < first_run; index++)
+		buffer[i_put + index] = p_data[index];
+	for ( ; index < count; index++)
+		buffer[index - first_run] = p_data[index];
+
+	i_put = advance (i_put, count);
+	how_full += count;
+
+	return (count);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method copies the oldest items in the queue into the caller's memory without
+ *  removing them from the queue. 
+ *  @param p_data A pointer to the place where the items are to be put
+ *  @param count The most items to copy
+ *  @return The number of items which were copied, less than count if there weren't
+ *	  that many in the queue
+ */
+
+template <class qType, class qIndexType, qIndexType qSize> 
+qIndexType queue<qType, qIndexType, qSize>::peek (qType* p_data, qIndexType count)
+{
+	qIndexType index;					   // Index into the caller's memory
+	qIndexType first_run;				   // Items which lie before the end
+
+	if (count > how_full)
+		count = how_full;
+
+	first_run = qSize - i_get;
+	if (first_run > count)
+		first_run = count;
+	for (index = 0; index < first_run; index++)
+		p_data[index] = buffer[i_get + index];
+	for ( ; index < count; index++)
+		p_data[index] = buffer[index - first_run];
+
+	return (count);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method takes the oldest items out of the queue in a block. It's quicker than
+ *  calling get() for each of them. 
+ *  @param p_data A pointer to the place where the items are to be put
+ *  @param count The most items to get
+ *  @return The number of items which were taken, less than count if there weren't
+ *	  that many in the queue
+ */
+
+template <class qType, class qIndexType, qIndexType qSize> 
+qIndexType queue<qType, qIndexType, qSize>::get_n (qType* p_data, qIndexType count)
+{
+	count = peek (p_data, count);
+	skip (count);
+
+	return (count);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method finds the oldest items in the queue which lie next to each other in 
+ *  the buffer, so that they can be used where they are rather than copied out. When
+ *  they have been used, skip() removes them from the queue. If the queue's contents
+ *  wrap around the end of the buffer, the rest is found by calling this method again
+ *  after skip(). 
+ *  @param p_count A pointer to a place where the number of items is to be put; it's
+ *	  zero if the queue is empty
+ *  @return A pointer to the oldest item in the queue
+ */
+
+template <class qType, class qIndexType, qIndexType qSize> 
+qType* queue<qType, qIndexType, qSize>::get_span (qIndexType* p_count)
+{
+	if (how_full < qSize - i_get)
+		*p_count = how_full;
+	else
+		*p_count = qSize - i_get;
+
+	return (buffer + i_get);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method removes the oldest items from the queue without reading them, as 
+ *  after they've been used through get_span(). 
+ *  @param count The number of items to remove; if there are fewer in the queue, it's
+ *	  emptied
+ */
+
+template <class qType, class qIndexType, qIndexType qSize> 
+void queue<qType, qIndexType, qSize>::skip (qIndexType count)
+{
+	if (count > how_full)
+		count = how_full;
+
+	i_get = advance (i_get, count);
+	how_full -= count;
+}
+
 #endif // _QUEUE_H_
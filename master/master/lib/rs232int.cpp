@@ -2,7 +2,9 @@
 /** \file rs232int.cpp
  *    This file contains a class which allows the use of a serial port on an AVR 
  *    microcontroller. This version of the class uses the serial port receiver 
- *    interrupt and a buffer to allow characters to be received in the background.
+ *    interrupt and a buffer to allow characters to be received in the background,
+ *    and the data register empty interrupt and another buffer to send characters in
+ *    the background.
  *    The port is used in "text mode"; that is, the information which is sent and 
  *    received is expected to be plain ASCII text, and the set of overloaded left-shift 
  *    operators "<<" in base_text_serial.* can be used to easily send all sorts of data 
@@ -23,6 +25,14 @@
  *    \li 07-05-2008 JRR Changed from 1 to 2 stop bits to placate finicky receivers
  *    \li 12-22-2008 JRR Split off stuff in base232.h for efficiency
  *    \li 06-30-2009 JRR Received data interrupt and buffer added
+ *    \li 10-16-2026 Transmit buffer drained by the data register empty interrupt
+ *    \li 10-16-2026 Waiting loops let the simulated hardware run in a PC build
+ *    \li 10-16-2026 done_sending() tells whether the buffer has gone out, without waiting
+ *    \li 10-16-2026 set_baud() changes the baud rate
+ *    \li 10-16-2026 Receiver buffers are single producer, single consumer rings with 
+ *        8-bit indices; lost characters are counted; getchars() reads in bulk
+ *    \li 10-16-2026 room_to_send() tells how many characters the buffer has room for
+ *    \li 10-16-2026 Transmitter buffers are static arrays, like the receiver buffers
  *
  *  License:
  *		This file is released under the Lesser GNU Public License, version 2. This 
@@ -32,30 +42,54 @@
 
 #include <stdint.h>
 #include <stdlib.h>
-#include <avr/io.h>
+#include "hal.h"
 #include "rs232int.h"
 
 
 // Every AVR has at least one serial port, so enable at least one receiver buffer
 /// This buffer holds characters received through serial port 0 by the ISR. 
-uint8_t* rcv0_buffer = NULL;
+volatile uint8_t rcv0_buffer[RSINT_BUF_SIZE];
 
-/// This index is used to write into serial character receiver buffer 0.
-uint16_t rcv0_read_index;
+/// This free-running index is used to read from serial character receiver buffer 0.
+volatile uint8_t rcv0_read_index;
 
-/// This index is used to read from serial character receiver buffer 0. 
-uint16_t rcv0_write_index;
+/// This free-running index is used by the ISR to write into receiver buffer 0. 
+volatile uint8_t rcv0_write_index;
+
+/// This counts the characters lost because receiver buffer 0 was full, up to 255.
+volatile uint8_t rcv0_lost;
+
+/// This buffer holds characters waiting to be sent through serial port 0 by the ISR.
+volatile uint8_t xmt0_buffer[RSINT_XMT_BUF_SIZE];
+
+/// This index is used by the ISR to read from serial transmitter buffer 0.
+volatile uint8_t xmt0_read_index;
+
+/// This index is used to write into serial transmitter buffer 0.
+volatile uint8_t xmt0_write_index;
 
 // If there's a UCSR0A register, there are 2 serial ports, so enable another buffer
 #ifdef UCSR1A
 	/// This buffer holds characters received through serial port 1 by the ISR. 
-	uint8_t* rcv1_buffer = NULL;
+	volatile uint8_t rcv1_buffer[RSINT_BUF_SIZE];
+
+	/// This free-running index is used to read from serial character receiver buffer 1.
+	volatile uint8_t rcv1_read_index;
 
-	/// This index is used to write into serial character receiver buffer 1.
-	uint16_t rcv1_read_index;
+	/// This free-running index is used by the ISR to write into receiver buffer 1. 
+	volatile uint8_t rcv1_write_index;
 
-	/// This index is used to read from serial character receiver buffer 1. 
-	uint16_t rcv1_write_index;
+	/// This counts the characters lost because receiver buffer 1 was full, up to 255.
+	volatile uint8_t rcv1_lost;
+
+	/// This buffer holds characters waiting to be sent through serial port 1 by the ISR.
+	volatile uint8_t xmt1_buffer[RSINT_XMT_BUF_SIZE];
+
+	/// This index is used by the ISR to read from serial transmitter buffer 1.
+	volatile uint8_t xmt1_read_index;
+
+	/// This index is used to write into serial transmitter buffer 1.
+	volatile uint8_t xmt1_write_index;
 #endif
 
 
@@ -77,6 +111,8 @@ rs232::rs232 (unsigned int baud_rate, unsigned char port_number)
 {
 	// Save the number of the serial port, 0 or 1
 	port_num = port_number;
+	started_sending = false;
+	xmt_dropped = 0;
 
 	// If we're compiling for a chip with UCSR0A defined, it has dual serial ports
 	// (examples are ATmega324P and ATmega128). Set up Port 0 or Port 1
@@ -85,20 +121,39 @@ rs232::rs232 (unsigned int baud_rate, unsigned char port_number)
 		{
 			UCSR0B |= (1 << RXCIE0);		// Receive complete interrupt enable
 
-			// Allocate some memory for the receiver buffer and reset the indices
-			rcv0_buffer = new uint8_t[RSINT_BUF_SIZE];
+			// Use the port's receiver buffer and reset the indices
+			p_rcv_buffer = rcv0_buffer;
+			p_rcv_read_index = &rcv0_read_index;
+			p_rcv_write_index = &rcv0_write_index;
+			p_rcv_lost = &rcv0_lost;
 			rcv0_read_index = 0;
 			rcv0_write_index = 0;
+			rcv0_lost = 0;
+
+			// The transmitter buffer is sent by the data register empty interrupt,
+			// which is only enabled while there's something in the buffer; reset its
+			// indices
+			xmt0_read_index = 0;
+			xmt0_write_index = 0;
+			mask_UDRIE = (1 << UDRIE0);
 		}
 		else  // Serial port number 1
 		{
 		#if defined UCSR1A
 			UCSR1B |= (1 << RXCIE1);		// Receive complete interrupt enable
 
-			// Allocate some memory for the receiver buffer and reset the indices
-			rcv1_buffer = new uint8_t[RSINT_BUF_SIZE];
+			// Use the port's receiver buffer and reset the indices
+			p_rcv_buffer = rcv1_buffer;
+			p_rcv_read_index = &rcv1_read_index;
+			p_rcv_write_index = &rcv1_write_index;
+			p_rcv_lost = &rcv1_lost;
 			rcv1_read_index = 0;
 			rcv1_write_index = 0;
+			rcv1_lost = 0;
+
+			xmt1_read_index = 0;
+			xmt1_write_index = 0;
+			mask_UDRIE = (1 << UDRIE1);
 		#endif // UCSR1A
 		}
 	// We're compiling for a chip which doesn't define UCSR0A; assume it has only one
@@ -106,10 +161,18 @@ rs232::rs232 (unsigned int baud_rate, unsigned char port_number)
 	#else
 		UCSRB |= (1 << RXCIE);				// Receive complete interrupt enable
 
-		// Allocate some memory for the receiver buffer and reset the indices
-		rcv0_buffer = new uint8_t[RSINT_BUF_SIZE];
+		// Use the port's receiver buffer and reset the indices
+		p_rcv_buffer = rcv0_buffer;
+		p_rcv_read_index = &rcv0_read_index;
+		p_rcv_write_index = &rcv0_write_index;
+		p_rcv_lost = &rcv0_lost;
 		rcv0_read_index = 0;
 		rcv0_write_index = 0;
+		rcv0_lost = 0;
+
+		xmt0_read_index = 0;
+		xmt0_write_index = 0;
+		mask_UDRIE = (1 << UDRIE);
 	#endif
 
 	// The Xiphos 1.0 board may need the pullup activated on the RXD1 line in order to
@@ -122,47 +185,192 @@ rs232::rs232 (unsigned int baud_rate, unsigned char port_number)
 
 
 //-------------------------------------------------------------------------------------
-/** This method sends one character to the serial port.  It waits until the port is
- *  ready, so it can hold up the system for a while.  It times out if it waits too 
- *  long to send the character; you can check the return value to see if the character
- *  was successfully sent, or just cross your fingers and ignore the return value.
- *  Note 1:  It's possible that at slower baud rates and/or higher processor speeds, 
- *  this routine might time out even when the port is working fine.  A solution would
- *  be to change the count variable to an integer and use a larger starting number. 
- *  Note 2:  Fixed!  The count is now an integer and it works at lower baud rates.
+/** This method puts one character into the transmitter buffer and returns right away;
+ *  the data register empty interrupt sends the buffered characters out in the back-
+ *  ground. If the buffer is full the character is not sent and false is returned, so
+ *  a task which must not lose characters can check ready_to_send() first or try again
+ *  on its next run. Because it never waits, printing doesn't hold up the scheduler. 
+ *  Text printed with "<<" waits for room instead, through put_text(); characters 
+ *  which putchar() itself drops are counted, and get_dropped_chars() tells how many. 
  *  @param chout The character to be sent out
- *  @return True if everything was OK and false if there was a timeout
+ *  @return True if the character was buffered and false if the buffer was full
  */
 
 bool rs232::putchar (char chout)
 {
-	// Now wait for the serial port transmitter buffer to be empty	 
-	for (unsigned int count = 0; ((*p_USR & mask_UDRE) == 0); count++)
-	{
-		if (count > UART_TX_TOUT)
-			return (false);
-	}
+	uint8_t next_index;						// Write index after this character
+
+	#ifdef UCSR1A							// If this is a dual-port chip
+		if (port_num != 0)
+		{
+			next_index = xmt1_write_index + 1;
+			if (next_index >= RSINT_XMT_BUF_SIZE)
+				next_index = 0;
+			if (next_index == xmt1_read_index)
+			{
+				if (xmt_dropped != 0xFF)
+					xmt_dropped++;
+				return (false);
+			}
+			xmt1_buffer[xmt1_write_index] = chout;
+			xmt1_write_index = next_index;
+		}
+		else
+	#endif
+		{
+			next_index = xmt0_write_index + 1;
+			if (next_index >= RSINT_XMT_BUF_SIZE)
+				next_index = 0;
+			if (next_index == xmt0_read_index)
+			{
+				if (xmt_dropped != 0xFF)
+					xmt_dropped++;
+				return (false);
+			}
+			xmt0_buffer[xmt0_write_index] = chout;
+			xmt0_write_index = next_index;
+		}
 
 	// Clear the TXCn bit so it can be used to check if the serial port is busy.  This
 	// check needs to be done prior to putting the processor into sleep mode.  Oddly,
 	// the TXCn bit is cleared by writing a one to its bit location
 	*p_USR |= mask_TXC;
+	started_sending = true;
 
-	// The CTS line is 0 and the transmitter buffer is empty, so send the character
-	*p_UDR = chout;
+	// Make sure the interrupt is enabled so it will send the character. The interrupt
+	// turns itself off again when the buffer has been emptied
+	*p_UCR |= mask_UDRIE;
 	return (true);
 }
 
 
+//-------------------------------------------------------------------------------------
+/** This method checks if there is room in the transmitter buffer for another char-
+ *  acter, so that the next call to putchar() will succeed. 
+ *  @return True if a character can be sent now, false if the buffer is full
+ */
+
+bool rs232::ready_to_send (void)
+{
+	uint8_t next_index;						// Write index after one more character
+
+	#ifdef UCSR1A							// If this is a dual-port chip
+		if (port_num != 0)
+		{
+			next_index = xmt1_write_index + 1;
+			if (next_index >= RSINT_XMT_BUF_SIZE)
+				next_index = 0;
+			return (next_index != xmt1_read_index);
+		}
+	#endif
+
+	next_index = xmt0_write_index + 1;
+	if (next_index >= RSINT_XMT_BUF_SIZE)
+		next_index = 0;
+	return (next_index != xmt0_read_index);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method finds how many characters can be put into the transmitter buffer now,
+ *  so that a message which has to go out whole, such as a frame, can be held back 
+ *  until all of it fits. The interrupt only makes more room, so the answer can only 
+ *  grow until putchar() is called. One place in the buffer is always left empty, to 
+ *  tell a full buffer from an empty one. 
+ *  @return The number of characters putchar() will take without dropping any
+ */
+
+uint8_t rs232::room_to_send (void)
+{
+	int16_t room;							// Free places, less the one kept empty
+
+	#ifdef UCSR1A							// If this is a dual-port chip
+		if (port_num != 0)
+		{
+			room = (int16_t)xmt1_read_index - xmt1_write_index - 1;
+			if (room < 0)
+				room += RSINT_XMT_BUF_SIZE;
+			return ((uint8_t)room);
+		}
+	#endif
+
+	room = (int16_t)xmt0_read_index - xmt0_write_index - 1;
+	if (room < 0)
+		room += RSINT_XMT_BUF_SIZE;
+	return ((uint8_t)room);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method waits until everything in the transmitter buffer has gone out of the
+ *  USART. It's used when the characters must be out before the program goes on, for
+ *  example before the slave multiplexer is switched or the processor is put to sleep.
+ *  It blocks, so it should not be called where a short wait would hurt. 
+ */
+
+void rs232::transmit_now (void)
+{
+	#ifdef UCSR1A							// If this is a dual-port chip
+		if (port_num != 0)
+			while (xmt1_read_index != xmt1_write_index) HAL_WAIT ();
+		else
+	#endif
+			while (xmt0_read_index != xmt0_write_index) HAL_WAIT ();
+
+	// The last character may still be in the shift register. The TXC bit is only set
+	// after something has been sent, so don't wait for it if nothing ever was
+	if (started_sending)
+		while (is_sending ()) HAL_WAIT ();
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method checks whether everything in the transmitter buffer has gone out of
+ *  the USART, as transmit_now() waits for, but it returns right away. A task which
+ *  mustn't hold up the scheduler can call it each time it runs until it's true. 
+ *  @return True if the buffer and the shift register are empty, false if not
+ */
+
+bool rs232::done_sending (void)
+{
+	#ifdef UCSR1A							// If this is a dual-port chip
+		if (port_num != 0)
+		{
+			if (xmt1_read_index != xmt1_write_index)
+				return (false);
+		}
+		else
+	#endif
+		if (xmt0_read_index != xmt0_write_index)
+			return (false);
+
+	return (!started_sending || !is_sending ());
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method changes the baud rate. Characters still in the transmitter buffer, or
+ *  on their way out, would be garbled, so the caller should first wait until 
+ *  done_sending() is true. 
+ *  @param baud_rate The new baud rate
+ */
+
+void rs232::set_baud (unsigned long baud_rate)
+{
+	base232::set_baud (baud_rate);
+}
+
+
 //-------------------------------------------------------------------------------------
 /** This method writes all the characters in a string until it gets to the '\\0' at 
- *  the end. Warning: This function blocks until it's finished. 
+ *  the end. It's used for text, so it waits for room in the transmitter buffer rather
+ *  than lose characters which don't fit. 
  *  @param str The string to be written 
  */
 
 void rs232::puts (char const* str)
 {
-	while (*str) putchar (*str++);
+	while (*str) put_text (*str++);
 }
 
 
@@ -176,37 +384,69 @@ void rs232::puts (char const* str)
 
 char rs232::getchar (void)
 {
+	uint8_t read_index = *p_rcv_read_index;	// Only this end of the ring moves it
 	uint8_t recv_char;						// Character read from the queue
 
 	// Wait until there's a character in the receiver queue
-	#ifdef UCSR0A  // If this is a dual-port chip
-		if (port_num == 0)
-		{
-			while (rcv0_read_index == rcv0_write_index);
-			recv_char = rcv0_buffer[rcv0_read_index];
-			if (++rcv0_read_index >= RSINT_BUF_SIZE)
-				rcv0_read_index = 0;
-		}
-		else  // This is port 1 of a dual-port chip
-		{
-		#if defined UCSR1A
-			while (rcv1_read_index == rcv1_write_index);
-			recv_char = rcv1_buffer[rcv1_read_index];
-			if (++rcv1_read_index >= RSINT_BUF_SIZE)
-				rcv1_read_index = 0;
-		#endif // UCSR1A
-		}
-	#else  // This chip has only one serial port
-		while (rcv0_read_index == rcv0_write_index);
-		recv_char = rcv0_buffer[rcv0_read_index];
-		if (++rcv0_read_index >= RSINT_BUF_SIZE)
-			rcv0_read_index = 0;
-	#endif
+	while (read_index == *p_rcv_write_index) HAL_WAIT ();
+	recv_char = p_rcv_buffer[read_index & RSINT_BUF_MASK];
+
+	// The character has been taken before the interrupt is told it may use the place
+	*p_rcv_read_index = read_index + 1;
 
 	return (recv_char);
 }
 
 
+//-------------------------------------------------------------------------------------
+/** This method gets as many of the characters waiting in the receiver queue as will
+ *  fit, without waiting for any more. It reads the write index once and moves the 
+ *  read index once, so it's quicker than calling check_for_char() and getchar() for
+ *  each character. 
+ *  @param p_buffer A pointer to the place where the characters are to be put
+ *  @param max_chars The most characters to get
+ *  @return The number of characters which were put into the buffer
+ */
+
+uint8_t rs232::getchars (char* p_buffer, uint8_t max_chars)
+{
+	uint8_t read_index = *p_rcv_read_index;	// Only this end of the ring moves it
+	uint8_t count = *p_rcv_write_index - read_index;	// Characters waiting
+
+	if (count > max_chars)
+		count = max_chars;
+	for (uint8_t index = 0; index < count; index++)
+		p_buffer[index] = p_rcv_buffer[(uint8_t)(read_index + index) & RSINT_BUF_MASK];
+	*p_rcv_read_index = read_index + count;
+
+	return (count);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method finds how many characters have been lost since the port was set up 
+ *  because they came in while the receiver queue was full. The count stops at 255.
+ *  @return The number of characters lost
+ */
+
+uint8_t rs232::get_lost_chars (void)
+{
+	return (*p_rcv_lost);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method finds how many characters putchar() has dropped since the port was set
+ *  up because the transmitter buffer was full. The count stops at 255.
+ *  @return The number of characters dropped
+ */
+
+uint8_t rs232::get_dropped_chars (void)
+{
+	return (xmt_dropped);
+}
+
+
 //-------------------------------------------------------------------------------------
 /** This method checks if there is a character in the serial port's receiver queue.
  *  The queue will have been filled if a character came in through the serial port and
@@ -217,14 +457,7 @@ char rs232::getchar (void)
 
 bool rs232::check_for_char (void)
 {
-	#ifdef UCSR1A							// If this is a dual-port chip
-		if (port_num == 0)
-			return (rcv0_read_index != rcv0_write_index);
-		else
-			return (rcv1_read_index != rcv1_write_index);
-	#else									// This chip has only one serial port
-		return (rcv0_read_index != rcv0_write_index);
-	#endif
+	return (*p_rcv_read_index != *p_rcv_write_index);
 }
 
 
@@ -235,7 +468,7 @@ bool rs232::check_for_char (void)
 
 void rs232::clear_screen (void)
 {
-	putchar (CLRSCR_STYLE);
+	put_text (CLRSCR_STYLE);
 }
 
 
@@ -248,24 +481,26 @@ void rs232::clear_screen (void)
 ISR (RSI_CHAR_RECV_INT_0)
 {
 	// When this ISR is triggered, there's a character waiting in the USART data reg-
-	// ister, and the write index indexes the place where that character should go
-
+	// ister. It's read even if there's no room for it, as that clears the interrupt
 	#if defined UCSR0A  // If this is a dual-serial-port chip (ATmega324P, 128, etc.)
-		rcv0_buffer[rcv0_write_index] = UDR0;
+		uint8_t data = UDR0;
 	#else  // If this chip has only a single serial port (ATmega8, 32, etc.)
-		rcv0_buffer[rcv0_write_index] = UDR;
+		uint8_t data = UDR;
 	#endif
+	uint8_t write_index = rcv0_write_index;
 
-	// Increment the write pointer
-	if (++rcv0_write_index >= RSINT_BUF_SIZE)
-		rcv0_write_index = 0;
+	// If the buffer is full, the new character is lost and counted. The oldest one 
+	// can't be thrown away instead, as only the reader may move the read index
+	if ((uint8_t)(write_index - rcv0_read_index) >= RSINT_BUF_SIZE)
+	{
+		if (rcv0_lost != 0xFF)
+			rcv0_lost++;
+		return;
+	}
 
-	// If the write pointer is now equal to the read pointer, that means we've just
-	// overwritten the oldest data. Increment the read pointer so that it doesn't seem
-	// as if the buffer is empty
-	if (rcv0_write_index == rcv0_read_index)
-		if (++rcv0_read_index >= RSINT_BUF_SIZE)
-			rcv0_read_index = 0;
+	// The character is put in place before the reader is told it's there
+	rcv0_buffer[write_index & RSINT_BUF_MASK] = data;
+	rcv0_write_index = write_index + 1;
 }
 
 
@@ -278,18 +513,71 @@ ISR (RSI_CHAR_RECV_INT_0)
 	ISR (RSI_CHAR_RECV_INT_1)
 	{
 		// Read the character from the serial port receiver buffer
-		rcv1_buffer[rcv1_write_index] = UDR1;
+		uint8_t data = UDR1;
+		uint8_t write_index = rcv1_write_index;
 
-		// Increment the write pointer
-		if (++rcv1_write_index >= RSINT_BUF_SIZE)
-			rcv1_write_index = 0;
+		// If the buffer is full, the new character is lost and counted
+		if ((uint8_t)(write_index - rcv1_read_index) >= RSINT_BUF_SIZE)
+		{
+			if (rcv1_lost != 0xFF)
+				rcv1_lost++;
+			return;
+		}
+
+		// The character is put in place before the reader is told it's there
+		rcv1_buffer[write_index & RSINT_BUF_MASK] = data;
+		rcv1_write_index = write_index + 1;
+	}
+#endif // Dual serial ports
+
+
+//-------------------------------------------------------------------------------------
+/** This interrupt service routine runs whenever the data register of serial port 0
+ *  is empty and the interrupt is enabled. It sends the next character from the
+ *  transmitter buffer, or turns itself off if the buffer is empty. 
+ */
+
+ISR (RSI_XMT_EMPTY_INT_0)
+{
+	if (xmt0_read_index == xmt0_write_index)
+	{
+		#if defined UCSR0A
+			UCSR0B &= ~(1 << UDRIE0);
+		#else
+			UCSRB &= ~(1 << UDRIE);
+		#endif
+		return;
+	}
+
+	#if defined UCSR0A
+		UDR0 = xmt0_buffer[xmt0_read_index];
+	#else
+		UDR = xmt0_buffer[xmt0_read_index];
+	#endif
+
+	if (++xmt0_read_index >= RSINT_XMT_BUF_SIZE)
+		xmt0_read_index = 0;
+}
+
+
+#ifdef UCSR1A // The second ISR is only compiled for processors with dual serial ports
+	//-------------------------------------------------------------------------------------
+	/** This interrupt service routine runs whenever the data register of serial port 1
+	*  is empty and the interrupt is enabled. It sends the next buffered character.
+	*/
+
+	ISR (RSI_XMT_EMPTY_INT_1)
+	{
+		if (xmt1_read_index == xmt1_write_index)
+		{
+			UCSR1B &= ~(1 << UDRIE1);
+			return;
+		}
+
+		UDR1 = xmt1_buffer[xmt1_read_index];
 
-		// If the write pointer is now equal to the read pointer, that means we've just
-		// overwritten the oldest data. Increment the read pointer so that it doesn't seem
-		// as if the buffer is empty
-		if (rcv1_write_index == rcv1_read_index)
-			if (++rcv1_read_index >= RSINT_BUF_SIZE)
-				rcv1_read_index = 0;
+		if (++xmt1_read_index >= RSINT_XMT_BUF_SIZE)
+			xmt1_read_index = 0;
 	}
 #endif // Dual serial ports
 /** \endcond  (End of section which is not to be documented by Doxygen) */
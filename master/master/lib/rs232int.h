@@ -2,7 +2,9 @@
 /** \file rs232int.h
  *    This file contains a class which allows the use of a serial port on an AVR 
  *    microcontroller. This version of the class uses the serial port receiver 
- *    interrupt and a buffer to allow characters to be received in the background.
+ *    interrupt and a buffer to allow characters to be received in the background,
+ *    and the data register empty interrupt and another buffer to send characters in
+ *    the background.
  *    The port is used in "text mode"; that is, the information which is sent and 
  *    received is expected to be plain ASCII text, and the set of overloaded left-shift 
  *    operators "<<" in base_text_serial.* can be used to easily send all sorts of data 
@@ -23,6 +25,15 @@
  *    \li 07-05-2008 JRR Changed from 1 to 2 stop bits to placate finicky receivers
  *    \li 12-22-2008 JRR Split off stuff in base232.h for efficiency
  *    \li 06-30-2009 JRR Received data interrupt and buffer added
+ *    \li 10-16-2026 Transmit buffer drained by the data register empty interrupt
+ *    \li 10-16-2026 done_sending() tells whether the buffer has gone out, without waiting
+ *    \li 10-16-2026 set_baud() changes the baud rate
+ *    \li 10-16-2026 Receiver buffers are single producer, single consumer rings with 
+ *        8-bit indices; lost characters are counted; getchars() reads in bulk
+ *    \li 10-16-2026 Characters dropped because the transmitter buffer was full are
+ *        counted; text waits for room instead of being dropped
+ *    \li 10-16-2026 room_to_send() tells how many characters the buffer has room for
+ *    \li 10-16-2026 Transmitter buffers are static arrays, like the receiver buffers
  *
  *  License:
  *		This file is released under the Lesser GNU Public License, version 2. This 
@@ -34,7 +45,7 @@
 #ifndef _RS232_H_
 #define _RS232_H_
 
-#include <avr/interrupt.h>					// Header for AVR interrupt programming
+#include "hal.h"							// AVR interrupt programming, real or simulated
 #include "base232.h"						// Grab the base RS232-style header file
 #include "base_text_serial.h"				// Pull in the base class header file
 
@@ -45,17 +56,40 @@
 #if defined UCSR0A
 	#define RSI_CHAR_RECV_INT_0 USART0_RX_vect 
 	#define RSI_CHAR_RECV_INT_1 USART1_RX_vect 
+	#define RSI_XMT_EMPTY_INT_0 USART0_UDRE_vect
+	#define RSI_XMT_EMPTY_INT_1 USART1_UDRE_vect
 // There's no second serial port, so define one port's interrupt. This is for ATmega8
 // and ATmega32 and similar chips. This section will need to be expanded if other
 // single-UART/USART chips are used, as the vector may have a different name
 #else
 	#define RSI_CHAR_RECV_INT_0 USART_RXC_vect
+	#define RSI_XMT_EMPTY_INT_0 USART_UDRE_vect
 #endif
 
 
-/// This is the size of the buffer which holds characters received by the serial port.
+/** This is the size of the buffer which holds characters received by the serial port.
+ *  It must be a power of two, so that an index can be masked rather than compared, and
+ *  no more than 128, so that the indices can run freely as single bytes, which the 
+ *  interrupt and the rest of the program can each read in one instruction. The 
+ *  interrupt only writes the write index and the rest of the program only the read 
+ *  index, so neither has to turn interrupts off. */
 #define RSINT_BUF_SIZE		128
 
+/// This mask turns a free-running receiver index into a place in the buffer.
+#define RSINT_BUF_MASK		(RSINT_BUF_SIZE - 1)
+
+#if (RSINT_BUF_SIZE & RSINT_BUF_MASK) || (RSINT_BUF_SIZE > 128)
+	#error RSINT_BUF_SIZE must be a power of two no more than 128
+#endif
+
+/** This is the size of the buffer which holds characters waiting to be sent. It must 
+ *  be no more than 255 so that the indices can be single bytes, which the interrupt 
+ *  and the rest of the program can share without turning interrupts off. It should 
+ *  hold the longest burst of text one task prints in one run, such as a menu. Each 
+ *  port's buffer is a static array, so a chip with two ports uses twice this much 
+ *  RAM, and it's counted in the data size at link time. */
+#define RSINT_XMT_BUF_SIZE	192
+
 
 //-------------------------------------------------------------------------------------
 /** This class controls a UART (Universal Asynchronous Receiver Transmitter), a common 
@@ -71,18 +105,39 @@ class rs232 : public base_text_serial, public base232
 	protected:
 		uint8_t port_num;					///< The USART number, 0 or 1
 
+		/// This bitmask identifies the data register empty interrupt enable bit, UDRIE
+		unsigned char mask_UDRIE;
+
+		/// This flag is set once a character has been sent, so the TXC bit means something
+		bool started_sending;
+
+		volatile uint8_t* p_rcv_buffer;		///< The port's receiver buffer
+		volatile uint8_t* p_rcv_read_index;	///< Where the next character is read from it
+		volatile uint8_t* p_rcv_write_index;	///< Where the interrupt puts the next one
+		volatile uint8_t* p_rcv_lost;		///< Characters lost because it was full
+		uint8_t xmt_dropped;				///< Characters dropped from a full transmitter
+
 	// Public methods can be called from anywhere in the program where there is a 
 	// pointer or reference to an object of this class
 	public:
 		// The constructor sets up the UART, saving its baud rate and port number
 		rs232 (unsigned int = 9600, unsigned char = 0);
 
-		/// This method writes one character to the serial port.
+		/// This method puts one character in the transmit buffer without waiting.
 		bool putchar (char);
 
+		bool ready_to_send (void);			// Check if there's room in the buffer
+		uint8_t room_to_send (void);		// Count the characters there's room for
+		void transmit_now (void);			// Wait until the buffer has been sent
+		bool done_sending (void);			// Check if the buffer has been sent
+		void set_baud (unsigned long);		// Change the baud rate once it has
+
 		void puts (char const*);			// Write a string constant to serial port
 		bool check_for_char (void);			// Check if a character is in the buffer
 		char getchar (void);				// Get a character; wait if none is ready
+		uint8_t getchars (char*, uint8_t);	// Get the characters which are ready
+		uint8_t get_lost_chars (void);		// Count characters lost to a full buffer
+		uint8_t get_dropped_chars (void);	// Count characters not sent, buffer full
 		void clear_screen (void);			// Send the 'clear display screen' code
 // 		char getch_tout (unsigned int);		// Try a given number of times to get char
 };
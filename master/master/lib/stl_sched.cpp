@@ -0,0 +1,130 @@
+//*************************************************************************************
+/** \file stl_sched.cpp
+ *    This file contains a scheduler class which runs a set of tasks derived from 
+ *    stl_task. Instead of calling each task's schedule() method in turn from the main
+ *    loop, the scheduler looks at all the tasks which are due and runs the one with
+ *    the highest priority; among tasks of equal priority, the one whose deadline is
+ *    earliest runs first. When no task is due, the processor sleeps until one is. 
+ *
+ *  Revisions:
+ *    \li 10-16-2026 Original file
+ *
+ *  License:
+ *    This file released under the Lesser GNU Public License, version 2. This program
+ *    is intended for educational use only, but it is not limited thereto. 
+ */
+//*************************************************************************************
+
+#include <stdlib.h>
+#include "base_text_serial.h"				// Base class for various serial devices
+#include "stl_timer.h"						// Timer measures real time
+#include "stl_task.h"						// The state transition logic header
+#include "stl_sched.h"						// Header for this file
+
+
+//--------------------------------------------------------------------------------------
+/** This constructor creates a scheduler with no tasks in it. 
+ *  @param a_timer A reference to the timer which measures real time
+ *  @param max_idle The longest time the processor may sleep before the tasks are 
+ *                  checked again, which limits how late a task blocked on something
+ *                  other than a time can notice its event
+ */
+
+task_scheduler::task_scheduler (task_timer& a_timer, const time_stamp& max_idle)
+	: the_timer (a_timer), longest_idle (max_idle)
+{
+	num_tasks = 0;
+}
+
+
+//--------------------------------------------------------------------------------------
+/** This method adds a task to the set of tasks being scheduled. 
+ *  @param p_task A pointer to the task
+ *  @param priority The task's priority; a task with a higher number runs first
+ *  @return True if the task was added, false if the scheduler was already full
+ */
+
+bool task_scheduler::add_task (stl_task* p_task, uint8_t priority)
+{
+	if (num_tasks >= STL_MAX_TASKS)
+	{
+		return (false);
+	}
+
+	tasks[num_tasks] = p_task;
+	priorities[num_tasks] = priority;
+	num_tasks++;
+
+	return (true);
+}
+
+
+//--------------------------------------------------------------------------------------
+/** This method finds the most urgent task which is due to run and runs it once. The 
+ *  task with the highest priority is chosen; if more than one have that priority, the
+ *  one with the earliest deadline is chosen. 
+ *  @return A pointer to the task which was run, or NULL if no task was due
+ */
+
+stl_task* task_scheduler::run_one (void)
+{
+	uint8_t best = STL_MAX_TASKS;			// Index of the most urgent task so far
+	time_stamp best_deadline;				// Deadline of the most urgent task
+	time_stamp deadline;					// Deadline of the task being looked at
+
+	for (uint8_t index = 0; index < num_tasks; index++)
+	{
+		if (!(tasks[index]->is_due ()))
+		{
+			continue;
+		}
+
+		deadline = tasks[index]->get_deadline ();
+		if (best == STL_MAX_TASKS
+			|| priorities[index] > priorities[best]
+			|| (priorities[index] == priorities[best] && deadline < best_deadline))
+		{
+			best = index;
+			best_deadline = deadline;
+		}
+	}
+
+	if (best == STL_MAX_TASKS)
+	{
+		return (NULL);
+	}
+
+	tasks[best]->schedule ();
+	return (tasks[best]);
+}
+
+
+//--------------------------------------------------------------------------------------
+/** This method is called over and over from the main loop. It runs the most urgent 
+ *  task which is due; if none is due, it puts the processor to sleep until the 
+ *  earliest time at which a task will be due, or until an interrupt such as a 
+ *  character arriving at a serial port wakes it up. 
+ */
+
+void task_scheduler::schedule (void)
+{
+	time_stamp wake_time;					// Earliest time at which a task is due
+	time_stamp task_time;					// Time at which one task is due
+
+	if (run_one () != NULL)
+	{
+		return;
+	}
+
+	wake_time = the_timer.get_time_now ();
+	wake_time += longest_idle;
+	for (uint8_t index = 0; index < num_tasks; index++)
+	{
+		if (tasks[index]->get_due_time (task_time) && task_time < wake_time)
+		{
+			wake_time = task_time;
+		}
+	}
+
+	the_timer.idle_until (wake_time);
+}
@@ -0,0 +1,79 @@
+//*************************************************************************************
+/** \file stl_sched.h
+ *    This file contains a scheduler class which runs a set of tasks derived from 
+ *    stl_task. Instead of calling each task's schedule() method in turn from the main
+ *    loop, the scheduler looks at all the tasks which are due and runs the one with
+ *    the highest priority; among tasks of equal priority, the one whose deadline is
+ *    earliest runs first. When no task is due, the processor sleeps until one is. 
+ *
+ *  Revisions:
+ *    \li 10-16-2026 Original file
+ *    \li 10-16-2026 Checked by sim/sched_check.cpp
+ *
+ *  License:
+ *    This file released under the Lesser GNU Public License, version 2. This program
+ *    is intended for educational use only, but it is not limited thereto. 
+ */
+//*************************************************************************************
+
+/// This define prevents this .h file from being included more than once in a .cc file
+#ifndef _STL_SCHED_H_
+#define _STL_SCHED_H_
+
+#include "stl_timer.h"						// Header for the task timer
+#include "stl_task.h"						// Header for the tasks being scheduled
+
+
+/// This is the largest number of tasks one scheduler can hold
+#define STL_MAX_TASKS		8
+
+
+//--------------------------------------------------------------------------------------
+/** This class runs a set of tasks by priority and deadline. Each time schedule() is
+ *  called, the most urgent task which is due runs once; the processor is put to sleep
+ *  if no task is due. Every task keeps its own count of missed deadlines, which can 
+ *  be printed with the task's "<<" operator. 
+ *
+ *  The scheduler only uses the timer's get_time_now() and idle_until() methods and 
+ *  the tasks' public methods. It's checked in the simulated build by 
+ *  sim/sched_check.cpp, which moves the time on by sleeping the simulated timer. 
+ *
+ *  \section sched_usage Usage
+ *    Create the timer and the tasks, create a scheduler, and add each task with its
+ *    priority (higher numbers are more urgent). Then call schedule() over and over
+ *    from the main loop. 
+ */
+
+class task_scheduler
+{
+	protected:
+		/// This is a reference to the timer which measures real time
+		task_timer& the_timer;
+
+		/// These are pointers to the tasks which are being scheduled
+		stl_task* tasks[STL_MAX_TASKS];
+
+		/// This is the priority of each task; higher numbers run first
+		uint8_t priorities[STL_MAX_TASKS];
+
+		/// This is the number of tasks which have been added so far
+		uint8_t num_tasks;
+
+		/// This is the longest time the processor sleeps without checking the tasks
+		time_stamp longest_idle;
+
+	public:
+		// The constructor makes an empty scheduler which uses the given timer
+		task_scheduler (task_timer&, const time_stamp&);
+
+		// This method adds a task with the given priority to the scheduler
+		bool add_task (stl_task*, uint8_t);
+
+		// This method runs the most urgent task which is due, if there is one
+		stl_task* run_one (void);
+
+		// This method runs one task or sleeps until one is due
+		void schedule (void);
+};
+
+#endif // _STL_SCHED_H_
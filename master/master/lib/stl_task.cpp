@@ -13,6 +13,9 @@
  *    \li 06-03-2008 JRR Cleaned up comments, got rid of Doxygen warnings
  *    \li 12-19-2009 JRR Integrated simple execution time profiling into file, changed
  *                       from *.cc to *.cpp, and set up for global serial debugging
+ *    \li 10-16-2026 Tasks can block until a character, a wake() call or a time
+ *    \li 10-16-2026 Deadline miss count and due time queries for task_scheduler
+ *    \li 10-16-2026 Uses hal.h so the scheduler also runs in a simulated PC build
  *
  *  License:
  *    This file released under the Lesser GNU Public License, version 2. This program
@@ -21,8 +24,7 @@
 //*************************************************************************************
 
 #include <stdlib.h>
-#include <avr/io.h>
-#include <avr/interrupt.h>
+#include "hal.h"
 #include "base_text_serial.h"				// Base class for various serial devices
 #include "global_debug.h"					// Class for serial port debugging
 #include "stl_timer.h"						// Timer measures real time
@@ -64,6 +66,11 @@ stl_task::stl_task (task_timer& a_timer, const time_stamp& time_interval)
 	// The task begins running in state 0, with no transitions unless called for
 	current_state = 0;
 
+	// Nothing is being waited for until the task blocks itself
+	p_wake_port = NULL;
+	wake_on_time = false;
+	deadline_misses = 0;
+
 	// The next run time should have been initialized to zero, so the task will run
 	// its run() method as soon as possible in most cases
 
@@ -123,13 +130,28 @@ task_op_state stl_task::schedule (time_stamp* til_next_time)
 		case (TASK_SUSPENDED):
 			return (TASK_SUSPENDED);
 
+		// A blocked task only runs when the event for which it's waiting has happened.
+		// Checking for a character doesn't need the timer, so that's done first
+		case (TASK_BLOCKED):
+			if (!event_happened ())
+			{
+				if (til_next_time != NULL && wake_on_time)
+				{
+					*til_next_time = wake_time;
+				}
+				return (TASK_BLOCKED);
+			}
+			unblock ();
+			// The event has happened, so run the task right now
+			// Fall through
+
 		// If the task needs to run, check if it needs to run now; if so, run it
 		case (TASK_WAITING):
 			// Find out what the current real time is from the system timer
 			the_time = the_timer.get_time_now ();
 
 			// If it's not time to run the task yet, exit without running it
-			if (next_run_time > the_timer.get_time_now ())
+			if (next_run_time > the_time)
 			{
 				if (til_next_time != NULL)
 				{
@@ -137,8 +159,15 @@ task_op_state stl_task::schedule (time_stamp* til_next_time)
 				}
 				return (TASK_WAITING);
 			}
+
+			// If a whole interval has gone by since the task was due, it's late
+			if (!(get_deadline () > the_time))
+			{
+				deadline_misses++;
+			}
 			// If we get here, it is time to run the task; just continue into the
 			// task_pending section below, which will cause the task to run right now
+			// Fall through
 
 		case (TASK_PENDING):
 			// Set the state to waiting for the next time interval. If the task needs
@@ -231,6 +260,162 @@ void stl_task::resume (void)
 }
 
 
+//--------------------------------------------------------------------------------------
+/** This method blocks the task until a character arrives at the given serial port. 
+ *  It's called from within run() by a task which has nothing to do until the user or
+ *  another device sends it something, so that it doesn't run at every interval just 
+ *  to find the receiver buffer empty. It can be combined with wait_until() to give a
+ *  time limit. 
+ *  @param p_port A pointer to the serial port whose receiver buffer is checked
+ */
+
+void stl_task::wait_for_char (base_text_serial* p_port)
+{
+	p_wake_port = p_port;
+	op_state = TASK_BLOCKED;
+}
+
+
+//--------------------------------------------------------------------------------------
+/** This method blocks the task until the given time has come. It's a better way to 
+ *  wait a while than counting runs of the task, as the task doesn't run at all until 
+ *  it's time. 
+ *  @param a_time The time at which the task should run again
+ */
+
+void stl_task::wait_until (const time_stamp& a_time)
+{
+	wake_time = a_time;
+	wake_on_time = true;
+	op_state = TASK_BLOCKED;
+}
+
+
+//--------------------------------------------------------------------------------------
+/** This method blocks the task until another task calls its wake() method, usually
+ *  because that task has set a flag or put some data where this task will find it. 
+ */
+
+void stl_task::wait_for_wake (void)
+{
+	op_state = TASK_BLOCKED;
+}
+
+
+//--------------------------------------------------------------------------------------
+/** This method makes a blocked task run as soon as the scheduler gets to it. It's
+ *  called by another task which has just given this one something to do. If the task
+ *  isn't blocked, nothing happens; it will notice the new work on its next run. 
+ */
+
+void stl_task::wake (void)
+{
+	if (op_state == TASK_BLOCKED)
+	{
+		unblock ();
+		op_state = TASK_PENDING;
+	}
+}
+
+
+//--------------------------------------------------------------------------------------
+/** This method checks if the event for which a blocked task is waiting has happened:
+ *  a character has arrived at the port it's watching, or its wake-up time has come. 
+ *  Checking for a character doesn't need the timer, so that's done first. 
+ *  @return True if the task should run now, false if it should stay blocked
+ */
+
+bool stl_task::event_happened (void)
+{
+	if (p_wake_port != NULL && p_wake_port->check_for_char ())
+	{
+		return (true);
+	}
+	return (wake_on_time && !(wake_time > the_timer.get_time_now ()));
+}
+
+
+//--------------------------------------------------------------------------------------
+/** This method checks whether the task would run if its schedule() method were called
+ *  right now. A scheduler uses it to choose which of several tasks to run first. 
+ *  @return True if the task is ready to run, false if it's not
+ */
+
+bool stl_task::is_due (void)
+{
+	switch (op_state)
+	{
+		case (TASK_PENDING):
+			return (true);
+		case (TASK_WAITING):
+			return (!(next_run_time > the_timer.get_time_now ()));
+		case (TASK_BLOCKED):
+			return (event_happened ());
+		default:
+			return (false);
+	}
+}
+
+
+//--------------------------------------------------------------------------------------
+/** This method finds the time at which the task will next be due to run, if that is
+ *  known. It isn't known for a task which is suspended or blocked without a time 
+ *  limit, as such a task may never run again unless something happens. 
+ *  @param a_time A time stamp into which the due time is written if it's known
+ *  @return True if the due time was found, false if it isn't known
+ */
+
+bool stl_task::get_due_time (time_stamp& a_time)
+{
+	switch (op_state)
+	{
+		case (TASK_PENDING):
+			a_time = the_timer.get_time_now ();
+			return (true);
+		case (TASK_WAITING):
+			a_time = next_run_time;
+			return (true);
+		case (TASK_BLOCKED):
+			if (wake_on_time)
+			{
+				a_time = wake_time;
+				return (true);
+			}
+			return (false);
+		default:
+			return (false);
+	}
+}
+
+
+//--------------------------------------------------------------------------------------
+/** This method computes the deadline for the task's next run. A periodic task should 
+ *  start each run before the following run is due, so the deadline is one interval
+ *  after the time at which the task is due. 
+ *  @return The time by which the task's next run should have started
+ */
+
+time_stamp stl_task::get_deadline (void)
+{
+	return (next_run_time + interval);
+}
+
+
+//--------------------------------------------------------------------------------------
+/** This method clears whatever a blocked task was waiting for and restarts its timing
+ *  from now. Without that, a task which had been blocked for a long time would find
+ *  its next run time far in the past and run many times in quick succession. 
+ */
+
+void stl_task::unblock (void)
+{
+	p_wake_port = NULL;
+	wake_on_time = false;
+	next_run_time = the_timer.get_time_now ();
+	op_state = TASK_WAITING;
+}
+
+
 //--------------------------------------------------------------------------------------
 /** This method changes the initial state in which the task begins to operate. The 
  *  default initial state is state 0. It should only be used before the task begins to
@@ -261,7 +446,7 @@ void stl_task::error_stop (char const* message)
 		<< endl);
 
 	cli ();									// Disable interrupts
-	while (1);								// Bang...you're dead (until reset)
+	while (1) HAL_WAIT ();					// Bang...you're dead (until reset)
 }
 
 
@@ -381,6 +566,7 @@ const time_stamp& stl_task::get_avg_run_time (void)
 base_text_serial& operator<< (base_text_serial& serial, stl_task& task)
 {
 	serial << PMS ("Task: ") << task.get_serial_number ();
+	serial << PMS (" misses: ") << task.get_deadline_misses ();
 
 	#ifdef STL_PROFILE
 		serial << PMS (" runs: ") << task.get_num_runs ();
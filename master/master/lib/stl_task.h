@@ -11,6 +11,8 @@
  *    \li 05-07-07 JRR Small bug fixes
  *    \li 06-01-08 JRR Changed debugging/trace to take advantage of base_text_serial
  *    \li 06-03-08 JRR Cleaned up comments, got rid of Doxygen warnings
+ *    \li 10-16-26 Blocked tasks which wait for a character, a wake() or a time
+ *    \li 10-16-26 Deadline miss count and due time queries for task_scheduler
  *
  *  License:
  *    This file released under the Lesser GNU Public License, version 2. This program
@@ -45,7 +47,7 @@ enum task_op_state
 	TASK_RUNNING,			///< The task's run() function is executing
 	TASK_PENDING,			///< The task needs to run again as soon as possible
 	TASK_WAITING,			///< The task is waiting for its next run time to occur
-	TASK_BLOCKED,			///< The task cannot run because a resource is unavailable
+	TASK_BLOCKED,			///< The task is waiting for an event before it runs again
 	TASK_SUSPENDED			///< The task is turned off until its resume() is called
 };
 
@@ -108,9 +110,18 @@ enum task_op_state
  *      suspended->waiting [ label = "resume() " ];
  *      running->pending   [ label = "run_again_ASAP() " ];
  *      pending->running   [ label = " run() " ];
+ *      running->blocked   [ label = "wait_for_...() " ];
+ *      blocked->running   [ label = " event " ];
+ *      blocked->pending   [ label = " wake() " ];
  *  }
  *  \enddot
- *    Blocked tasks (due to resource contention) are not currently implemented. 
+ *    A task which has nothing to do until something happens can block itself from
+ *    within run() by calling wait_for_char(), wait_until(), and/or wait_for_wake().
+ *    A blocked task isn't run at its usual interval; it runs as soon as a character
+ *    arrives at the given port, the given time has come, or another task calls its
+ *    wake() method, whichever happens first. Then it goes back to running at its
+ *    normal interval, counted from the time it woke up. The main loop can put the
+ *    processor to sleep while all the tasks are waiting or blocked. 
  *
  *    When a task is run cooperatively (rather than by interrupts), it is run when the
  *    method schedule() is called from within the main while loop in the main() 
@@ -136,6 +147,21 @@ class stl_task
 		/// This is the state (as seen by the user) in which this task is right now
 		char current_state;
 
+		/// A blocked task runs when a character arrives at this port, if it's not NULL
+		base_text_serial* p_wake_port;
+
+		/// This flag is set if a blocked task is to run when wake_time has come
+		bool wake_on_time;
+
+		/// This is the time at which a blocked task runs if wake_on_time is set
+		time_stamp wake_time;
+
+		/// This is the number of runs which started after their deadline had passed
+		uint16_t deadline_misses;
+
+		bool event_happened (void);			// Check if a blocked task may run
+		void unblock (void);				// Go back to running at the interval
+
 	protected:
 		/// This is a reference to the device driver which keeps track of real time
 		task_timer& the_timer;
@@ -164,6 +190,21 @@ class stl_task
 		void resume (void);					// Un-suspend a task so it can run again
 		void set_initial_state (char);		// Set a new state in which to start up
 
+		void wait_for_char (base_text_serial*);	// Block until a character arrives
+		void wait_until (const time_stamp&);	// Block until the given time
+		void wait_for_wake (void);			// Block until another task calls wake()
+		void wake (void);					// Make a blocked task run right away
+
+		bool is_due (void);					// Check if schedule() would run the task
+		bool get_due_time (time_stamp&);	// Find when the task will next be due
+		time_stamp get_deadline (void);		// Time by which the next run should start
+
+		/** This method returns the number of runs of this task which began after
+		 *  their deadline, that is, more than one interval after they were due. 
+		 *  @return The number of deadline misses counted so far
+		 */
+		uint16_t get_deadline_misses (void) { return (deadline_misses); }
+
 		/** This method returns the task's automatically assigned serial number. 
 		 *  @return The task's serial number
 		 */
@@ -18,6 +18,8 @@
  *    \li 05-31-2008 JRR Changed time calculations to use CPU_FREQ_MHz from Makefile
  *    \li 01-04-2009 JRR Now uses CPU_FREQ_Hz (rather than MHz) for better precision
  *    \li 11-24-2009 JRR Changed CPU_FREQ_Hz to F_CPU to match AVR-LibC's name
+ *    \li 10-16-2026 Added idle_until() to sleep between task runs
+ *    \li 10-16-2026 Time stamps printed with put_text(), which waits for room
  *
  *  License:
  *    This file copyright 2007 by JR Ridgely. It is released under the Lesser GNU
@@ -27,8 +29,8 @@
 
 #include <stdlib.h>							// Used for itoa()
 #include <string.h>							// Header for character string functions
-#include <avr/interrupt.h>					// For using interrupt service routines
 
+#include "hal.h"							// Interrupts and idle mode, real or simulated
 #include "base_text_serial.h"				// Base for text-type serial port objects
 #include "stl_timer.h"						// Header for this file
 
@@ -345,6 +347,10 @@ task_timer::task_timer (void)
 			TIMSK |= (1 << TOIE1);			// Enable Timer 1 overflow interrupt
 		#endif
 	#endif
+
+	#ifdef STL_PROFILE
+		clear_idle_profile ();
+	#endif
 }
 
 
@@ -402,6 +408,92 @@ bool task_timer::set_time (time_stamp& t_stamp)
 }
 
 
+//--------------------------------------------------------------------------------------
+/** This method puts the processor into idle sleep until the given time, so that it
+ *  doesn't spin around the main loop when no task has anything to do. The timers and
+ *  serial ports keep running in idle mode, and any interrupt wakes the processor up; 
+ *  a compare match on the timer is set up to do so at the given time. The compare 
+ *  register only holds the low 16 bits of the time, so the processor may also wake up
+ *  early, at a timer overflow. The caller just checks its tasks and calls this method
+ *  again. If the time has already passed, this method returns right away. 
+ *  @param a_time The time at which the processor should be awake again
+ */
+
+void task_timer::idle_until (const time_stamp& a_time)
+{
+	time_stamp wake_time = a_time;			// Local copy which can be compared
+
+	#ifdef STL_PROFILE
+		time_stamp sleep_start = get_time_now ();
+		idle_loops++;
+	#endif
+
+	#ifdef TMR_OCR_REG
+		TMR_OCR_REG = wake_time.data.half[0];
+		#ifdef ETIMSK						// For ATmega128
+			ETIFR = (1 << OCF3A);			// Clear a match left over from before
+			ETIMSK |= (1 << OCIE3A);		// Enable the compare match interrupt
+		#endif
+		#ifdef TIMSK3						// For ATmega1281
+			TIFR3 = (1 << OCF3A);
+			TIMSK3 |= (1 << OCIE3A);
+		#endif
+	#endif
+
+	// Interrupts are turned off while checking the time so that none can sneak in 
+	// between the check and the sleep; the instruction after sei() always runs before
+	// any interrupt, so the processor is asleep when the interrupt wakes it
+	set_sleep_mode (SLEEP_MODE_IDLE);
+	cli ();
+	if (wake_time > get_time_now ())
+	{
+		sleep_enable ();
+		sei ();
+		sleep_cpu ();
+		sleep_disable ();
+	}
+	sei ();
+
+	#ifdef STL_PROFILE
+		sleep_time += get_time_now () - sleep_start;
+	#endif
+}
+
+
+#ifdef STL_PROFILE
+//--------------------------------------------------------------------------------------
+/** This method clears the idle loop count and the total sleep time, and begins a new
+ *  measurement of how much of the time the processor spends asleep. 
+ */
+
+void task_timer::clear_idle_profile (void)
+{
+	idle_loops = 0L;
+	sleep_time.set_time (0L);
+	idle_start_time = get_time_now ();
+}
+
+
+//--------------------------------------------------------------------------------------
+/** This method computes the percentage of the time since the idle profile was cleared
+ *  which the processor has spent asleep in idle_until(). 
+ *  @return The sleeping time as a percentage of the elapsed time, 0 to 100
+ */
+
+uint8_t task_timer::get_sleep_percent (void)
+{
+	time_stamp elapsed = get_time_now () - idle_start_time;
+	uint32_t hundredth = elapsed.get_raw_time () / 100;
+
+	if (hundredth == 0)
+	{
+		return (0);
+	}
+	return ((uint8_t)(sleep_time.get_raw_time () / hundredth));
+}
+#endif  // STL_PROFILE
+
+
 //--------------------------------------------------------------------------------------
 /** This overloaded operator allows a time stamp to be printed on a serial device such
  *  as a regular serial port or radio module in text mode. This allows lines to be set
@@ -417,13 +509,13 @@ base_text_serial& operator<< (base_text_serial& serial, time_stamp& stamp)
 	uint32_t microseconds = stamp.get_microsec ();
 
 	serial << seconds;
-	serial.putchar ('.');
+	serial.put_text ('.');
 
 	// For the digits in the fractional part, write 'em in backwards order. We can't
 	// use itoa here because we need leading zeros
 	for (uint32_t divisor = 100000; divisor > 0; divisor /= 10)
 	{
-		serial.putchar (microseconds / divisor + '0');
+		serial.put_text (microseconds / divisor + '0');
 		microseconds %= divisor;
 	}
 
@@ -458,3 +550,13 @@ ISR (TMR_intr_vect)
 {
 	ust_overflows++;
 }
+
+
+#ifdef TMR_wake_vect
+//--------------------------------------------------------------------------------------
+/** This interrupt service routine runs on a compare match set up by idle_until(). It
+ *  has nothing to do; the interrupt only exists to wake the processor from sleep. 
+ */
+
+EMPTY_INTERRUPT (TMR_wake_vect);
+#endif
@@ -18,6 +18,7 @@
  *    \li 05-31-2008 JRR Changed time calculations to use CPU_FREQ_MHz from Makefile
  *    \li 01-04-2009 JRR Now uses CPU_FREQ_Hz (rather than MHz) for better precision
  *    \li 11-24-2009 JRR Changed CPU_FREQ_Hz to F_CPU to match AVR-LibC's name
+ *    \li 10-16-2026 Added idle_until() to sleep between task runs
  *
  *  License:
  *    This file copyright 2007 by JR Ridgely. It is released under the Lesser GNU
@@ -40,6 +41,8 @@
 #ifdef TCNT3
 	#define TMR_TCNT_REG	TCNT3			///< Register that holds the time count
 	#define TMR_intr_vect   TIMER3_OVF_vect	///< The timer overflow interrupt vector 
+	#define TMR_OCR_REG		OCR3A			///< Compare register which ends idle sleep
+	#define TMR_wake_vect	TIMER3_COMPA_vect	///< The compare match interrupt vector
 #else
 	#define TMR_TCNT_REG	TCNT1			///< Register that holds the time count
 	#define TMR_intr_vect   TIMER1_OVF_vect	///< The timer overflow interrupt vector 
@@ -165,6 +168,28 @@ class task_timer
 
 		/// This method sets the current time to the time in the given time stamp
 		bool set_time (time_stamp&);
+
+		// This method puts the processor to sleep until the given time or an interrupt
+		void idle_until (const time_stamp&);
+
+	// The following block is only compiled if execution time profiling has been 
+	// enabled for this project by setting -DSTL_PROFILE in the Makefile
+	#ifdef STL_PROFILE
+		protected:
+			uint32_t idle_loops;			///< Number of times the processor has slept
+			time_stamp sleep_time;			///< Total time spent asleep
+			time_stamp idle_start_time;		///< Time at which idle profiling began
+
+		public:
+			void clear_idle_profile (void);	// Begin a new set of idle measurements
+			uint8_t get_sleep_percent (void);	// Percent of the time spent asleep
+
+			/** This method returns the number of times idle_until() has been called
+			 *  since the idle profile was cleared. 
+			 *  @return The number of idle loops
+			 */
+			uint32_t get_idle_loops (void) { return (idle_loops); }
+	#endif  // STL_PROFILE
 };
 
 //--------------------------------------------------------------------------------------
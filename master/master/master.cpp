@@ -9,6 +9,9 @@
  *    \li 02-03-2008 JRR Various cleanup, tested on new ME 405 boards
  *    \li 01-15-2008 JRR Changed to new file/directory layout with ./lib and *.cpp
  *    \li 01-19-2011 JRR Updated calls to newer version of stl_task constructor
+ *    \li 10-16-2026 Processor sleeps in the main loop while no task is due
+ *    \li 10-16-2026 Tasks run by a priority and deadline scheduler
+ *    \li 10-16-2026 User task given the character database, to time each letter
  *
  *  License:
  *    This file released under the Lesser GNU Public License, version 2. This program
@@ -18,20 +21,20 @@
 
 											// System headers included with < >
 #include <stdlib.h>							// Standard C library
-#include <avr/io.h>							// Input-output ports, special registers
-#include <avr/interrupt.h>					// Interrupt handling functions
 
 											// User written headers included with " "
+#include "lib/hal.h"						// Registers and interrupts, real or simulated
 #include "lib/queue.h"						// Queue class used for character buffer
 #include "servo.h"							// Servo class
 #include "slave_picker.h"					// The class that sets the multiplexer pins
-#include "character.h"
 #include "character_database.h"				// The class that stores all character info
 #include "lib/rs232int.h"					// Serial port header
 #include "lib/global_debug.h"				// Header for serial debugging port
+#include "lib/mechutil.h"					// Memory helpers such as free_ram()
 //#include "motor.h"							// Class containing all motors
 #include "lib/stl_timer.h"					// Microsecond-resolution timer
 #include "lib/stl_task.h"					// Base class for all task classes
+#include "lib/stl_sched.h"					// Runs the tasks by priority and deadline
 #include "task_output.h"					// The task that outputs all commands to the motor controllers
 #include "task_user.h"						// The task that listens to the user
 
@@ -55,9 +58,9 @@ int main ()
 			set_glob_debug_port (&sport_comp);
 
 			// Create a slave picker
-			slave_picker the_slave_picker(&sport_comp);
+			slave_picker the_slave_picker(&sport_comp, &sport_slave);
 			
-			// Create a character database
+			// Create a character database. Its tables are all in program memory
 			character_database char_dbase;
 			
 			// Servos and motor databases
@@ -76,25 +79,34 @@ int main ()
 
 			// Set the interval to 20ms
 			interval_time.set_time (0, 10000);
-			task_output output_task (the_timer, interval_time, &sport_comp, &sport_slave, &the_slave_picker,&servo_top,&servo_bottom);
+			task_output output_task (the_timer, interval_time, &sport_comp, &sport_slave, &the_slave_picker, &char_dbase, &servo_top, &servo_bottom);
 
 			// Set the interval a bit slower for the user interface task
 			interval_time.set_time (0, 25000);
 
 			// Create a task to read commands from the keyboard
-			task_user user_task (the_timer, interval_time, &sport_comp, &sport_slave, &the_slave_picker, &output_task);
+			task_user user_task (the_timer, interval_time, &sport_comp, &sport_slave, &the_slave_picker, &char_dbase, &output_task);
 			
 			// Turn on interrupt processing so the timer can work
 			sei ();
 
-	// Run the main scheduling loop, in which the tasks are continuously scheduled.
-	// This program currently uses very simple "round robin" scheduling in which the
-	// tasks are simply called in order. More sophisticated scheduling strategies
-	// will be used in other more sophisticated programs
+	// When profiling, report how long setup took and how much SRAM is left over
+	#ifdef STL_PROFILE
+		sport_comp << PMS ("Setup done at ") << the_timer << PMS (" s, free RAM ") 
+				   << free_ram () << PMS (" bytes") << endl;
+	#endif
+
+	// Run the main scheduling loop. The scheduler runs whichever task is most urgent:
+	// the output task has the higher priority, so a long menu print by the user task
+	// can't hold up the motors, and tasks of equal priority run earliest deadline 
+	// first. When no task is due the processor sleeps until one is, or until a 
+	// character arriving at a serial port wakes it up
+	task_scheduler scheduler (the_timer, time_stamp (0, 100000));
+	scheduler.add_task (&output_task, 2);
+	scheduler.add_task (&user_task, 1);
 	while (true)
 	{
-		output_task.schedule ();
-		user_task.schedule ();
+		scheduler.schedule ();
 	}
 
 	return (0);
@@ -17,7 +17,7 @@
 //*************************************************************************************
 
 #include <stdlib.h>
-#include <avr/io.h>
+#include "lib/hal.h"
 #include "lib/base_text_serial.h"
 #include "slave_picker.h"
 #include "servo.h"							// Driver for servo motors
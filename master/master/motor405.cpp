@@ -18,7 +18,7 @@
  */
 //*************************************************************************************
 
-#include <avr/io.h>
+#include "lib/hal.h"
 #include "motor405.h"
 
 
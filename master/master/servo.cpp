@@ -14,7 +14,7 @@
  */
 //*************************************************************************************
 
-#include <avr/io.h>
+#include "lib/hal.h"
 #include "servo.h"
 
 
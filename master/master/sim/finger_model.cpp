@@ -0,0 +1,107 @@
+//*************************************************************************************
+/** \file finger_model.cpp
+ *    This file contains the physical model of one finger used by the slave simulator.
+ *    It's only compiled when HAL_SIM is defined.
+ *
+ *  Revisions:
+ *    \li 10-16-2026 Original file
+ *
+ *  License:
+ *    This file released under the Lesser GNU Public License, version 2. This program
+ *    is intended for educational use only, but it is not limited thereto.
+ */
+//*************************************************************************************
+
+#ifdef HAL_SIM
+
+#include <math.h>
+#include "finger_model.h"
+
+
+//-------------------------------------------------------------------------------------
+/** This constructor makes a finger which rests against its open stop, with the
+ *  encoder reading zero.
+ */
+
+finger_model::finger_model (void)
+{
+	position = FINGER_START;
+	speed = 0.0;
+	encoder_count = 0;
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method moves the finger for a short time. The time should be much shorter
+ *  than FINGER_TAU, as the motion is found by one Euler step.
+ *  @param dt The time, in seconds
+ *  @param drive The fraction of full voltage across the motor, from -1 to 1;
+ *               positive makes the encoder count up
+ *  @param brake How hard the bridge brakes the motor, from 0 when it's off or driving
+ *               to 1 when it shorts the motor all the time
+ */
+
+void finger_model::run (double dt, double drive, double brake)
+{
+	double target = 0.0;					// Speed the motor heads for
+	double rate;							// How fast it gets there, per second
+
+	if (fabs (drive) > FINGER_STICTION)
+	{
+		double overcome = (fabs (drive) - FINGER_STICTION) / (1.0 - FINGER_STICTION);
+		target = (drive > 0.0 ? overcome : -overcome) * FINGER_MAX_SPEED;
+		rate = 1.0 / FINGER_TAU;
+	}
+	else if (drive != 0.0)
+	{
+		// Driven too weakly to move, so the finger stops and stays stuck
+		rate = 1.0 / FINGER_TAU;
+	}
+	else
+	{
+		rate = brake / FINGER_TAU + (1.0 - brake) / FINGER_TAU_COAST;
+	}
+
+	double fraction = dt * rate;
+	speed += (target - speed) * (fraction < 1.0 ? fraction : 1.0);
+	position += speed * dt;
+
+	// The hard stops end the motion at once
+	if (position < 0.0)
+	{
+		position = 0.0;
+		speed = 0.0;
+	}
+	else if (position > FINGER_TRAVEL)
+	{
+		position = FINGER_TRAVEL;
+		speed = 0.0;
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method moves the encoder one count toward the finger's position if it's
+ *  behind. The slave simulator calls it until it returns false, calling the encoder
+ *  interrupt after each edge, so that the firmware sees every edge one at a time.
+ *  @return True if one of the encoder's channels changed
+ */
+
+bool finger_model::encoder_edge (void)
+{
+	int32_t should_be = (int32_t)floor (position);
+
+	if (should_be > encoder_count)
+	{
+		encoder_count++;
+		return (true);
+	}
+	if (should_be < encoder_count)
+	{
+		encoder_count--;
+		return (true);
+	}
+	return (false);
+}
+
+#endif // HAL_SIM
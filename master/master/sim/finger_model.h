@@ -0,0 +1,78 @@
+//*************************************************************************************
+/** \file finger_model.h
+ *    This file contains a simple physical model of one finger of the hand: a small DC
+ *    gearmotor driven by an L293D H-bridge, with a quadrature encoder on the motor and
+ *    hard stops at both ends of the finger's travel. The slave simulator keeps one of
+ *    these for each slave and moves it according to the slave's motor pins.
+ *
+ *    The motor is modelled by its first-order response. With a drive of u, the fraction
+ *    of full voltage from -1 to 1, the speed heads for u times the no-load speed with
+ *    the motor's mechanical time constant. Static friction swallows drives smaller than
+ *    FINGER_STICTION, so a small PWM duty cycle doesn't move the finger at all. When
+ *    both bridge inputs are equal the bridge shorts the motor, which brakes it with the
+ *    same time constant; with the bridge disabled the motor coasts to a stop against the
+ *    gearbox friction. Positions and speeds are in encoder counts.
+ *
+ *  Revisions:
+ *    \li 10-16-2026 Original file
+ *
+ *  License:
+ *    This file released under the Lesser GNU Public License, version 2. This program
+ *    is intended for educational use only, but it is not limited thereto.
+ */
+//*************************************************************************************
+
+/// This define prevents this .h file from being included more than once in a .cc file
+#ifndef _FINGER_MODEL_H_
+#define _FINGER_MODEL_H_
+
+#include <stdint.h>
+
+
+#define FINGER_MAX_SPEED	600.0			///< No-load speed, counts per second
+#define FINGER_TAU			0.030			///< Mechanical time constant, seconds
+#define FINGER_TAU_COAST	0.250			///< Time constant of coasting, seconds
+#define FINGER_STICTION		0.15			///< Drive which just overcomes friction
+#define FINGER_TRAVEL		1023.0			///< Counts from one hard stop to the other
+#define FINGER_START		0.5				///< Starting position, against the open stop
+
+
+//-------------------------------------------------------------------------------------
+/** This class models one finger: its motor, gearbox, encoder and hard stops. The
+ *  encoder is an ideal quadrature encoder whose reading (A << 1) | B goes through the
+ *  sequence 0, 2, 3, 1 as the count goes up, which is the direction the slave
+ *  firmware counts as clockwise.
+ */
+
+class finger_model
+{
+	protected:
+		double position;					///< Where the finger is, in counts
+		double speed;						///< How fast it's moving, counts per second
+		int32_t encoder_count;				///< Count the encoder's channels stand at
+
+	public:
+		// The constructor puts the finger at rest against its open stop
+		finger_model (void);
+
+		// Move the finger for a while with the given bridge drive
+		void run (double, double, double);
+
+		// Step the encoder one edge toward the finger's position, if it's behind
+		bool encoder_edge (void);
+
+		/// This method returns the encoder's reading, (A << 1) | B
+		uint8_t encoder_reading (void)
+		{
+			static const uint8_t sequence[4] = { 0, 2, 3, 1 };
+			return (sequence[encoder_count & 3]);
+		}
+
+		/// This method returns where the finger is, in counts from the open stop
+		double get_position (void) { return (position); }
+
+		/// This method returns how fast the finger is moving, in counts per second
+		double get_speed (void) { return (speed); }
+};
+
+#endif // _FINGER_MODEL_H_
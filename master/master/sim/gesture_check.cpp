@@ -0,0 +1,595 @@
+//*************************************************************************************
+/** \file gesture_check.cpp
+ *    This file contains a check that the gesture table gives the same motor commands
+ *    as the character switch it replaced in task_output. The switch is kept here as
+ *    data: for each character, the hand shape functions each step called, such as
+ *    thumb_curl(), and the interference flags the step set; and for each hand shape
+ *    function, the output_to_motor() calls it made. For each step of each character
+ *    the check sends the table's step through gesture_target() and gesture_decode()
+ *    in the order task_output sends it, and compares the motor numbers and values, in
+ *    order, and the step's interference bits with what the switch did.
+ *
+ *    The switch had no case for V, which was left where the letter before it was; the
+ *    table spells it with the steps of 2, which is the same hand shape, so V is
+ *    compared with the switch's 2. The comma, period and space were never handled by
+ *    the switch and are pauses in the table, so they aren't checked.
+ *
+ *    The check is run before main() when the environment variable HAL_SIM_GESTURES
+ *    is "check":
+ *    \code
+ *    HAL_SIM_GESTURES=check ./master_sim
+ *    \endcode
+ *    Each difference goes to the standard error stream with a summary, a line of JSON
+ *    to the standard output, and the program's exit status is 1 if there was any
+ *    difference, 0 if not. The check is only compiled when HAL_SIM is defined.
+ *
+ *  Revisions:
+ *    \li 10-16-2026 Original file
+ *
+ *  License:
+ *    This file released under the Lesser GNU Public License, version 2. This program
+ *    is intended for educational use only, but it is not limited thereto.
+ */
+//*************************************************************************************
+
+#ifdef HAL_SIM
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../lib/hal.h"
+#include "../gesture.h"						// Gesture steps and their decoding
+#include "../character_database.h"			// Gestures for every character
+
+
+/// Most output_to_motor() calls made by one hand shape function
+#define GESTURE_CHECK_SHAPE_SIZE	4
+
+/// Most hand shape functions called by one step of the switch
+#define GESTURE_CHECK_STEP_SIZE		6
+
+/// Characters the switch had a case for: the digits and every letter but V
+#define GESTURE_CHECK_LETTERS		35
+
+/// Most motor commands one step can send
+#define GESTURE_CHECK_COMMANDS		(GESTURE_CHECK_SHAPE_SIZE * GESTURE_CHECK_STEP_SIZE)
+
+
+//-------------------------------------------------------------------------------------
+/** This structure holds one output_to_motor() call. A motor number of zero ends a 
+ *  list of calls.
+ */
+
+typedef struct
+{
+	uint8_t motor;							///< Motor number, 1-13
+	uint8_t value;							///< Value sent to the motor
+} gesture_check_command;
+
+
+//-------------------------------------------------------------------------------------
+/** This structure holds what the switch did for one character.
+ */
+
+typedef struct
+{
+	char letter;							///< The character
+	uint8_t steps;							///< Steps it took, 1-4
+	uint8_t shapes[GESTURE_MAX_STEPS][GESTURE_CHECK_STEP_SIZE];	///< Functions called
+	uint8_t interference[GESTURE_MAX_STEPS];	///< GESTURE_INTERFERE_* bits set
+} gesture_check_letter;
+
+
+//-------------------------------------------------------------------------------------
+/** The hand shape functions which the switch called, in the order they were written
+ *  in task_output.cpp. The fingers were opened out of the way with open_thumb() and
+ *  the like, but that is now planned by task_output::plan_transition() from the 
+ *  interference bits, so only the bits are compared.
+ */
+
+enum gesture_check_shape_id
+{
+	SHAPE_NONE,							///< Ends a step's list of shapes
+	SHAPE_THUMB_FLAT_UP,
+	SHAPE_THUMB_FOLD_UP,
+	SHAPE_THUMB_FOLD_IN,
+	SHAPE_THUMB_FOLD_OUT,
+	SHAPE_THUMB_STRETCH,
+	SHAPE_THUMB_CURL,
+	SHAPE_INDEX_STRETCH,
+	SHAPE_INDEX_CURL,
+	SHAPE_INDEX_CLENCH,
+	SHAPE_INDEX_VERT_CLENCH,
+	SHAPE_INDEX_CROSS,
+	SHAPE_INDEX_U,
+	SHAPE_INDEX_FOLD,
+	SHAPE_MIDDLE_STRETCH,
+	SHAPE_MIDDLE_CURL,
+	SHAPE_MIDDLE_CLENCH,
+	SHAPE_MIDDLE_VERT_CLENCH,
+	SHAPE_MIDDLE_FOLD,
+	SHAPE_RING_STRETCH,
+	SHAPE_RING_CURL,
+	SHAPE_RING_CLENCH,
+	SHAPE_PINKY_STRETCH,
+	SHAPE_PINKY_CURL,
+	SHAPE_PINKY_CLENCH,
+	SHAPE_WRIST_DEFAULT,
+	SHAPE_WRIST_BENT,
+	SHAPE_WRIST_BENT_AND_TWISTED,
+	SHAPE_WRIST_TWISTED,
+	SHAPE_WRIST_Z1,
+	SHAPE_WRIST_Z2,
+	SHAPE_WRIST_Z3,
+	SHAPE_COUNT
+};
+
+
+//-------------------------------------------------------------------------------------
+/** The output_to_motor() calls each hand shape function made, in order.
+ */
+
+static const gesture_check_command shape_commands[SHAPE_COUNT][GESTURE_CHECK_SHAPE_SIZE] = 
+{
+	{ },															// SHAPE_NONE
+	{ {  5,  'a' }, {  6,  'a' }, {  7,  'a' }, {  8,  'a' } },		// thumb_flat_up
+	{ {  5,  'e' }, {  6,  'a' }, {  7,  'a' }, {  8,  'a' } },		// thumb_fold_up
+	{ {  5,  'c' }, {  6,  'c' }, {  7,  'e' }, {  8,  'a' } },		// thumb_fold_in
+	{ {  5,  'e' }, {  6,  'a' }, {  7,  'b' }, {  8,  'b' } },		// thumb_fold_out
+	{ {  5,  'a' }, {  6,  'e' }, {  7,  'a' }, {  8,  'a' } },		// thumb_stretch
+	{ {  5,  'e' }, {  6,  'b' }, {  7,  'b' }, {  8,  'b' } },		// thumb_curl
+	{ {  1,  'a' }, {  9,  'a' } },									// index_stretch
+	{ {  1,  'c' }, {  9,  'c' } },									// index_curl
+	{ {  1,  'e' }, {  9,  'e' } },									// index_clench
+	{ {  1,  'a' }, {  9,  'e' } },									// index_vert_clench
+	{ {  1,  'c' }, {  9,  'a' }, { 11,    1 } },					// index_cross
+	{ {  1,  'a' }, {  9,  'a' }, { 11,    1 } },					// index_u
+	{ {  1,  'e' }, {  9,  'a' } },									// index_fold
+	{ {  2,  'a' }, { 10,  'a' } },									// middle_stretch
+	{ {  2,  'c' }, { 10,  'c' } },									// middle_curl
+	{ {  2,  'e' }, { 10,  'e' } },									// middle_clench
+	{ {  2,  'a' }, { 10,  'e' } },									// middle_vert_clench
+	{ {  2,  'e' }, { 10,  'a' } },									// middle_fold
+	{ {  3,  'a' } },												// ring_stretch
+	{ {  3,  'c' } },												// ring_curl
+	{ {  3,  'e' } },												// ring_clench
+	{ {  4,  'a' } },												// pinky_stretch
+	{ {  4,  'c' } },												// pinky_curl
+	{ {  4,  'e' } },												// pinky_clench
+	{ { 12,    0 }, { 13,    0 } },									// wrist_default
+	{ { 12,   90 }, { 13,    0 } },									// wrist_bent
+	{ { 12,   90 }, { 13,   90 } },									// wrist_bent_and_twisted
+	{ { 12,    0 }, { 13,   90 } },									// wrist_twisted
+	{ { 12,   45 }, { 13,   45 } },									// wrist_z1
+	{ { 12,   45 }, { 13,    0 } },									// wrist_z2
+	{ { 12,   90 }, { 13,   45 } },									// wrist_z3
+};
+
+
+//-------------------------------------------------------------------------------------
+/** The hand shape functions each step of each character called, in order, and the 
+ *  interference flags the step set, from the switch in task_output::run() state 2. 
+ */
+
+static const gesture_check_letter switch_letters[GESTURE_CHECK_LETTERS] = 
+{
+	{ '0', 1,
+		{
+			{ SHAPE_THUMB_CURL, SHAPE_INDEX_CURL, SHAPE_MIDDLE_CURL,
+			  SHAPE_RING_CURL, SHAPE_PINKY_CURL, SHAPE_WRIST_DEFAULT }
+		},
+		{ 0 } },
+	{ '1', 1,
+		{
+			{ SHAPE_THUMB_FLAT_UP, SHAPE_INDEX_STRETCH, SHAPE_MIDDLE_CLENCH,
+			  SHAPE_RING_CLENCH, SHAPE_PINKY_CLENCH, SHAPE_WRIST_DEFAULT }
+		},
+		{ 0 } },
+	{ '2', 1,
+		{
+			{ SHAPE_THUMB_FLAT_UP, SHAPE_INDEX_STRETCH, SHAPE_MIDDLE_STRETCH,
+			  SHAPE_RING_CLENCH, SHAPE_PINKY_CLENCH, SHAPE_WRIST_DEFAULT }
+		},
+		{ 0 } },
+	{ '3', 1,
+		{
+			{ SHAPE_THUMB_STRETCH, SHAPE_INDEX_STRETCH, SHAPE_MIDDLE_STRETCH,
+			  SHAPE_RING_CLENCH, SHAPE_PINKY_CLENCH, SHAPE_WRIST_DEFAULT }
+		},
+		{ 0 } },
+	{ '4', 2,
+		{
+			{ SHAPE_THUMB_FOLD_OUT, SHAPE_INDEX_STRETCH, SHAPE_MIDDLE_STRETCH,
+			  SHAPE_RING_STRETCH, SHAPE_PINKY_STRETCH, SHAPE_WRIST_DEFAULT },
+			{ SHAPE_THUMB_FOLD_IN }
+		},
+		{ 0, GESTURE_INTERFERE_THUMB } },
+	{ '5', 1,
+		{
+			{ SHAPE_THUMB_STRETCH, SHAPE_INDEX_STRETCH, SHAPE_MIDDLE_STRETCH,
+			  SHAPE_RING_STRETCH, SHAPE_PINKY_STRETCH, SHAPE_WRIST_DEFAULT }
+		},
+		{ 0 } },
+	{ '6', 2,
+		{
+			{ SHAPE_THUMB_FOLD_OUT, SHAPE_INDEX_STRETCH, SHAPE_MIDDLE_STRETCH,
+			  SHAPE_RING_STRETCH, SHAPE_PINKY_CLENCH, SHAPE_WRIST_DEFAULT },
+			{ SHAPE_THUMB_FOLD_IN }
+		},
+		{ 0, GESTURE_INTERFERE_THUMB } },
+	{ '7', 2,
+		{
+			{ SHAPE_THUMB_FOLD_OUT, SHAPE_INDEX_STRETCH, SHAPE_MIDDLE_STRETCH,
+			  SHAPE_RING_CLENCH, SHAPE_PINKY_STRETCH, SHAPE_WRIST_DEFAULT },
+			{ SHAPE_THUMB_FOLD_IN }
+		},
+		{ 0, GESTURE_INTERFERE_THUMB } },
+	{ '8', 2,
+		{
+			{ SHAPE_THUMB_FOLD_OUT, SHAPE_INDEX_STRETCH, SHAPE_MIDDLE_CLENCH,
+			  SHAPE_RING_STRETCH, SHAPE_PINKY_STRETCH, SHAPE_WRIST_DEFAULT },
+			{ SHAPE_THUMB_FOLD_IN }
+		},
+		{ 0, GESTURE_INTERFERE_THUMB } },
+	{ '9', 1,
+		{
+			{ SHAPE_THUMB_FLAT_UP, SHAPE_INDEX_CLENCH, SHAPE_MIDDLE_STRETCH,
+			  SHAPE_RING_STRETCH, SHAPE_PINKY_STRETCH, SHAPE_WRIST_DEFAULT }
+		},
+		{ 0 } },
+	{ 'A', 1,
+		{
+			{ SHAPE_THUMB_FLAT_UP, SHAPE_INDEX_CLENCH, SHAPE_MIDDLE_CLENCH,
+			  SHAPE_RING_CLENCH, SHAPE_PINKY_CLENCH, SHAPE_WRIST_DEFAULT }
+		},
+		{ 0 } },
+	{ 'B', 2,
+		{
+			{ SHAPE_THUMB_FOLD_OUT, SHAPE_INDEX_STRETCH, SHAPE_MIDDLE_STRETCH,
+			  SHAPE_RING_STRETCH, SHAPE_PINKY_STRETCH, SHAPE_WRIST_DEFAULT },
+			{ SHAPE_THUMB_FOLD_IN }
+		},
+		{ 0, GESTURE_INTERFERE_THUMB } },
+	{ 'C', 1,
+		{
+			{ SHAPE_THUMB_FOLD_OUT, SHAPE_INDEX_CURL, SHAPE_MIDDLE_CURL,
+			  SHAPE_RING_CURL, SHAPE_PINKY_CLENCH, SHAPE_WRIST_DEFAULT }
+		},
+		{ 0 } },
+	{ 'D', 1,
+		{
+			{ SHAPE_THUMB_CURL, SHAPE_INDEX_STRETCH, SHAPE_MIDDLE_CURL,
+			  SHAPE_RING_CURL, SHAPE_PINKY_CLENCH, SHAPE_WRIST_DEFAULT }
+		},
+		{ 0 } },
+	{ 'E', 2,
+		{
+			{ SHAPE_THUMB_FOLD_OUT, SHAPE_INDEX_STRETCH, SHAPE_MIDDLE_STRETCH,
+			  SHAPE_RING_STRETCH, SHAPE_PINKY_STRETCH, SHAPE_WRIST_DEFAULT },
+			{ SHAPE_THUMB_FOLD_IN, SHAPE_INDEX_CURL, SHAPE_MIDDLE_CURL,
+			  SHAPE_RING_CURL, SHAPE_PINKY_CURL }
+		},
+		{ 0, GESTURE_INTERFERE_THUMB | GESTURE_INTERFERE_INDEX | GESTURE_INTERFERE_MIDDLE
+			| GESTURE_INTERFERE_RING | GESTURE_INTERFERE_PINKY } },
+	{ 'F', 1,
+		{
+			{ SHAPE_THUMB_FLAT_UP, SHAPE_INDEX_CLENCH, SHAPE_MIDDLE_STRETCH,
+			  SHAPE_RING_STRETCH, SHAPE_PINKY_STRETCH, SHAPE_WRIST_DEFAULT }
+		},
+		{ 0 } },
+	{ 'G', 1,
+		{
+			{ SHAPE_THUMB_FLAT_UP, SHAPE_INDEX_STRETCH, SHAPE_MIDDLE_CLENCH,
+			  SHAPE_RING_CLENCH, SHAPE_PINKY_CLENCH, SHAPE_WRIST_BENT }
+		},
+		{ 0 } },
+	{ 'H', 1,
+		{
+			{ SHAPE_THUMB_FLAT_UP, SHAPE_INDEX_STRETCH, SHAPE_MIDDLE_STRETCH,
+			  SHAPE_RING_CLENCH, SHAPE_PINKY_CLENCH, SHAPE_WRIST_BENT }
+		},
+		{ 0 } },
+	{ 'I', 1,
+		{
+			{ SHAPE_THUMB_FLAT_UP, SHAPE_INDEX_CLENCH, SHAPE_MIDDLE_CLENCH,
+			  SHAPE_RING_CLENCH, SHAPE_PINKY_STRETCH, SHAPE_WRIST_DEFAULT }
+		},
+		{ 0 } },
+	{ 'J', 4,
+		{
+			{ SHAPE_THUMB_FLAT_UP, SHAPE_INDEX_CLENCH, SHAPE_MIDDLE_CLENCH,
+			  SHAPE_RING_CLENCH, SHAPE_PINKY_STRETCH, SHAPE_WRIST_DEFAULT },
+			{ SHAPE_WRIST_BENT },
+			{ SHAPE_WRIST_BENT_AND_TWISTED },
+			{ SHAPE_WRIST_TWISTED }
+		},
+		{ 0, 0, 0, 0 } },
+	{ 'K', 2,
+		{
+			{ SHAPE_THUMB_FLAT_UP, SHAPE_INDEX_STRETCH, SHAPE_MIDDLE_STRETCH,
+			  SHAPE_RING_CLENCH, SHAPE_PINKY_CLENCH, SHAPE_WRIST_DEFAULT },
+			{ SHAPE_THUMB_FOLD_IN }
+		},
+		{ 0, GESTURE_INTERFERE_THUMB } },
+	{ 'L', 1,
+		{
+			{ SHAPE_THUMB_STRETCH, SHAPE_INDEX_STRETCH, SHAPE_MIDDLE_CLENCH,
+			  SHAPE_RING_CLENCH, SHAPE_PINKY_CLENCH, SHAPE_WRIST_DEFAULT }
+		},
+		{ 0 } },
+	{ 'M', 2,
+		{
+			{ SHAPE_THUMB_FOLD_IN, SHAPE_INDEX_STRETCH, SHAPE_MIDDLE_STRETCH,
+			  SHAPE_RING_STRETCH, SHAPE_PINKY_CLENCH, SHAPE_WRIST_DEFAULT },
+			{ SHAPE_INDEX_VERT_CLENCH, SHAPE_MIDDLE_VERT_CLENCH, SHAPE_RING_CURL }
+		},
+		{ 0, GESTURE_INTERFERE_THUMB | GESTURE_INTERFERE_INDEX | GESTURE_INTERFERE_MIDDLE
+			| GESTURE_INTERFERE_RING } },
+	{ 'N', 2,
+		{
+			{ SHAPE_THUMB_FOLD_IN, SHAPE_INDEX_STRETCH, SHAPE_MIDDLE_STRETCH,
+			  SHAPE_RING_CLENCH, SHAPE_PINKY_CLENCH, SHAPE_WRIST_DEFAULT },
+			{ SHAPE_INDEX_VERT_CLENCH, SHAPE_MIDDLE_VERT_CLENCH }
+		},
+		{ 0, GESTURE_INTERFERE_THUMB | GESTURE_INTERFERE_INDEX | GESTURE_INTERFERE_MIDDLE } },
+	{ 'O', 1,
+		{
+			{ SHAPE_THUMB_CURL, SHAPE_INDEX_CURL, SHAPE_MIDDLE_CURL,
+			  SHAPE_RING_CURL, SHAPE_PINKY_CURL, SHAPE_WRIST_DEFAULT }
+		},
+		{ 0 } },
+	{ 'P', 1,
+		{
+			{ SHAPE_THUMB_FOLD_UP, SHAPE_INDEX_STRETCH, SHAPE_MIDDLE_FOLD,
+			  SHAPE_RING_CLENCH, SHAPE_PINKY_CLENCH, SHAPE_WRIST_BENT }
+		},
+		{ GESTURE_INTERFERE_THUMB | GESTURE_INTERFERE_MIDDLE } },
+	{ 'Q', 1,
+		{
+			{ SHAPE_THUMB_FOLD_OUT, SHAPE_INDEX_FOLD, SHAPE_MIDDLE_CLENCH,
+			  SHAPE_RING_CLENCH, SHAPE_PINKY_CLENCH, SHAPE_WRIST_BENT }
+		},
+		{ 0 } },
+	{ 'R', 1,
+		{
+			{ SHAPE_THUMB_FLAT_UP, SHAPE_INDEX_CROSS, SHAPE_MIDDLE_CLENCH,
+			  SHAPE_RING_CLENCH, SHAPE_PINKY_CLENCH, SHAPE_WRIST_DEFAULT }
+		},
+		{ GESTURE_INTERFERE_INDEX } },
+	{ 'S', 2,
+		{
+			{ SHAPE_THUMB_FOLD_OUT, SHAPE_INDEX_CLENCH, SHAPE_MIDDLE_CLENCH,
+			  SHAPE_RING_CLENCH, SHAPE_PINKY_CLENCH, SHAPE_WRIST_DEFAULT },
+			{ SHAPE_THUMB_FOLD_IN }
+		},
+		{ 0, GESTURE_INTERFERE_THUMB } },
+	{ 'T', 2,
+		{
+			{ SHAPE_THUMB_FLAT_UP, SHAPE_INDEX_VERT_CLENCH, SHAPE_MIDDLE_CLENCH,
+			  SHAPE_RING_CLENCH, SHAPE_PINKY_CLENCH, SHAPE_WRIST_DEFAULT },
+			{ SHAPE_THUMB_FOLD_IN }
+		},
+		{ 0, GESTURE_INTERFERE_THUMB | GESTURE_INTERFERE_INDEX } },
+	{ 'U', 2,
+		{
+			{ SHAPE_THUMB_FLAT_UP, SHAPE_INDEX_STRETCH, SHAPE_MIDDLE_STRETCH,
+			  SHAPE_RING_CLENCH, SHAPE_PINKY_CLENCH, SHAPE_WRIST_DEFAULT },
+			{ SHAPE_INDEX_U }
+		},
+		{ 0, GESTURE_INTERFERE_THUMB | GESTURE_INTERFERE_INDEX } },
+	{ 'W', 2,
+		{
+			{ SHAPE_THUMB_FOLD_OUT, SHAPE_INDEX_STRETCH, SHAPE_MIDDLE_STRETCH,
+			  SHAPE_RING_STRETCH, SHAPE_PINKY_CLENCH, SHAPE_WRIST_DEFAULT },
+			{ SHAPE_THUMB_FOLD_IN }
+		},
+		{ 0, GESTURE_INTERFERE_THUMB } },
+	{ 'X', 2,
+		{
+			{ SHAPE_THUMB_FOLD_OUT, SHAPE_INDEX_STRETCH, SHAPE_MIDDLE_CLENCH,
+			  SHAPE_RING_CLENCH, SHAPE_PINKY_CLENCH, SHAPE_WRIST_DEFAULT },
+			{ SHAPE_THUMB_FOLD_IN, SHAPE_INDEX_VERT_CLENCH }
+		},
+		{ 0, GESTURE_INTERFERE_THUMB | GESTURE_INTERFERE_INDEX } },
+	{ 'Y', 1,
+		{
+			{ SHAPE_THUMB_STRETCH, SHAPE_INDEX_CLENCH, SHAPE_MIDDLE_CLENCH,
+			  SHAPE_RING_CLENCH, SHAPE_PINKY_STRETCH, SHAPE_WRIST_DEFAULT }
+		},
+		{ 0 } },
+	{ 'Z', 4,
+		{
+			{ SHAPE_THUMB_FLAT_UP, SHAPE_INDEX_CLENCH, SHAPE_MIDDLE_CLENCH,
+			  SHAPE_RING_CLENCH, SHAPE_PINKY_STRETCH, SHAPE_WRIST_Z1 },
+			{ SHAPE_WRIST_Z2 },
+			{ SHAPE_WRIST_Z3 },
+			{ SHAPE_WRIST_BENT }
+		},
+		{ 0, 0, 0, 0 } }
+};
+
+
+//-------------------------------------------------------------------------------------
+/** This function lists the motor commands the switch sent for one step.
+ *  @param p_letter The switch's entry for the character
+ *  @param step The step, from 0
+ *  @param p_commands Space for GESTURE_CHECK_COMMANDS commands
+ *  @return The number of commands
+ */
+
+static uint8_t gesture_check_switch (const gesture_check_letter* p_letter, uint8_t step,
+									 gesture_check_command* p_commands)
+{
+	uint8_t count = 0;
+
+	for (uint8_t call = 0; call < GESTURE_CHECK_STEP_SIZE; call++)
+	{
+		uint8_t shape = p_letter->shapes[step][call];
+		if (shape == SHAPE_NONE)
+		{
+			break;
+		}
+		for (uint8_t index = 0; index < GESTURE_CHECK_SHAPE_SIZE; index++)
+		{
+			if (shape_commands[shape][index].motor == 0)
+			{
+				break;
+			}
+			p_commands[count++] = shape_commands[shape][index];
+		}
+	}
+	return (count);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function lists the motor commands the gesture table gives for one step, in 
+ *  the order task_output::output_gesture_step() sends them.
+ *  @param p_step Program memory address of the step
+ *  @param p_commands Space for GESTURE_NUM_MOTORS commands
+ *  @return The number of commands
+ */
+
+static uint8_t gesture_check_table (const gesture_step* p_step, gesture_check_command* p_commands)
+{
+	uint8_t count = 0;
+
+	for (uint8_t index = 0; index < GESTURE_NUM_MOTORS; index++)
+	{
+		uint8_t motor = pgm_read_byte (&gesture_motor_order[index]);
+		uint8_t code = gesture_target (p_step, motor);
+		if (code != GESTURE_NO_CHANGE)
+		{
+			p_commands[count].motor = motor;
+			p_commands[count].value = gesture_decode (motor, code);
+			count++;
+		}
+	}
+	return (count);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function prints a list of motor commands on the standard error stream.
+ *  @param p_label What the list is
+ *  @param p_commands The commands
+ *  @param count The number of commands
+ */
+
+static void gesture_check_print (const char* p_label, const gesture_check_command* p_commands,
+								 uint8_t count)
+{
+	fprintf (stderr, "  %-6s", p_label);
+	for (uint8_t index = 0; index < count; index++)
+	{
+		if (p_commands[index].motor <= 10)
+		{
+			fprintf (stderr, " %u:%c", p_commands[index].motor, p_commands[index].value);
+		}
+		else
+		{
+			fprintf (stderr, " %u:%u", p_commands[index].motor, p_commands[index].value);
+		}
+	}
+	fprintf (stderr, "\n");
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function compares every character's steps in the gesture table with the 
+ *  switch, prints the results and ends the program.
+ */
+
+static void gesture_check_run (void)
+{
+	character_database database;
+	gesture_check_command from_switch[GESTURE_CHECK_COMMANDS];
+	gesture_check_command from_table[GESTURE_NUM_MOTORS];
+	uint8_t characters = 0;
+	uint8_t steps = 0;
+	uint8_t commands = 0;
+	uint8_t differences = 0;
+
+	for (uint8_t letter = 0; letter <= GESTURE_CHECK_LETTERS; letter++)
+	{
+		// V is spelled as 2, which comes first among the switch's entries
+		const gesture_check_letter* p_letter = &switch_letters[2];
+		char character = 'V';
+		if (letter < GESTURE_CHECK_LETTERS)
+		{
+			p_letter = &switch_letters[letter];
+			character = p_letter->letter;
+		}
+		uint8_t index = database.get_index (character);
+		characters++;
+
+		if (database.get_steps (index) != p_letter->steps)
+		{
+			fprintf (stderr, "%c: the switch took %u steps, the table has %u\n", character,
+					 p_letter->steps, database.get_steps (index));
+			differences++;
+			continue;
+		}
+		for (uint8_t step = 0; step < p_letter->steps; step++)
+		{
+			const gesture_step* p_step = database.get_step (index, step);
+			uint8_t switch_count = gesture_check_switch (p_letter, step, from_switch);
+			uint8_t table_count = gesture_check_table (p_step, from_table);
+			bool same = (switch_count == table_count);
+
+			for (uint8_t command = 0; same && command < switch_count; command++)
+			{
+				same = (from_switch[command].motor == from_table[command].motor
+						&& from_switch[command].value == from_table[command].value);
+			}
+			steps++;
+			commands += switch_count;
+			if (!same)
+			{
+				fprintf (stderr, "%c step %u: the motor commands differ\n", character, step + 1);
+				gesture_check_print ("switch", from_switch, switch_count);
+				gesture_check_print ("table", from_table, table_count);
+				differences++;
+			}
+			if (gesture_interference (p_step) != p_letter->interference[step])
+			{
+				fprintf (stderr, "%c step %u: the switch set interference 0x%02X, the table "
+						 "has 0x%02X\n", character, step + 1, p_letter->interference[step],
+						 gesture_interference (p_step));
+				differences++;
+			}
+		}
+	}
+
+	fprintf (stderr, "\nGesture check: %u characters, %u steps, %u motor commands, "
+			 "%u differences from the switch\n", characters, steps, commands, differences);
+	printf ("{\"check\": \"gestures\", \"pass\": %s, \"characters\": %u, \"steps\": %u, "
+			"\"commands\": %u, \"differences\": %u}\n", differences ? "false" : "true",
+			characters, steps, commands, differences);
+	fflush (stdout);
+	exit (differences ? 1 : 0);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function runs the check before main() does, if the environment variable
+ *  HAL_SIM_GESTURES asks for it.
+ */
+
+static void __attribute__ ((constructor)) gesture_check_start (void)
+{
+	const char* p_env = getenv ("HAL_SIM_GESTURES");
+
+	if (p_env == NULL)
+	{
+		return;
+	}
+	if (strcmp (p_env, "check"))
+	{
+		fprintf (stderr, "HAL_SIM_GESTURES must be \"check\"\n");
+		exit (1);
+	}
+	gesture_check_run ();
+}
+
+#endif // HAL_SIM
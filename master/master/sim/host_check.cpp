@@ -0,0 +1,396 @@
+//*************************************************************************************
+/** \file host_check.cpp
+ *    This file contains a check of the framed binary protocol in host_protocol.h, run
+ *    against the whole simulated hand. It takes the user's place at the terminal,
+ *    sends frames as a program on the computer would, and reads the answers from what
+ *    the terminal shows. Frames may hold the bytes which are XON and XOFF in streaming
+ *    mode, so besides checking each answer's status, length and check byte it checks
+ *    that:
+ *    \li Answers whose check byte is XON, 0x11, come whole: an unknown command, a
+ *        frame with a bad check byte and a sentence of 32 characters are answered so
+ *    \li Answers with XON and XOFF among their data come whole, and the hand goes on
+ *        answering after them: the stats give the count of good frames, which is run
+ *        up to 0x11 and then 0x13
+ *    \li A frame with XOFF among its data is read as data
+ *    \li In streaming mode, with enough text sent to fill the queue, the terminal
+ *        takes XON and XOFF as flow control and doesn't show them, and once
+ *        streaming has stopped, answers with XON in them come whole again
+ *
+ *    The check is run alongside the firmware when the environment variable
+ *    HAL_SIM_HOST is "check":
+ *    \code
+ *    HAL_SIM_HOST=check ./master_sim
+ *    \endcode
+ *    Each case goes to the standard error stream with a summary, a line of JSON to
+ *    the standard output, and the program's exit status is 1 if anything failed, 0 if
+ *    not. The check is only compiled when HAL_SIM is defined.
+ *
+ *  Revisions:
+ *    \li 10-16-2026 Original file
+ *
+ *  License:
+ *    This file released under the Lesser GNU Public License, version 2. This program
+ *    is intended for educational use only, but it is not limited thereto.
+ */
+//*************************************************************************************
+
+#ifdef HAL_SIM
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../lib/hal_sim_dev.h"				// Hooks into the simulated master
+#include "../lib/hal.h"						// hal_sim_exit()
+#include "../host_protocol.h"
+
+
+/// Microseconds between runs of the check
+#define HOST_CHECK_RUN_US			10000UL
+
+/// Quiet time before each frame, longer than HOST_FRAME_GAP_MS so that the rest of a
+/// bad frame has been thrown away
+#define HOST_CHECK_GAP_US			200000UL
+
+/// Longest the hand may take to answer a frame
+#define HOST_CHECK_ANSWER_US		2000000UL
+
+/// Time given to streaming mode to fill the queue before Escape is typed
+#define HOST_CHECK_STREAM_US		3000000UL
+
+/// Characters streamed, more than the queue holds before XOFF is sent
+#define HOST_CHECK_STREAM_CHARS		230
+
+/// Expected check byte which stands for any value
+#define HOST_CHECK_ANY				0xFFFF
+
+/// The flow control bytes of streaming mode
+#define HOST_CHECK_XON				0x11
+#define HOST_CHECK_XOFF				0x13
+
+
+//-------------------------------------------------------------------------------------
+/** This structure holds one case of the check: the frame sent, or keys typed instead,
+ *  and what the answer must be.
+ */
+
+typedef struct
+{
+	const char* p_what;						///< What the case checks
+	const char* p_keys;						///< Keys typed instead of a frame, or NULL
+	uint8_t command;						///< Command of the frame sent
+	uint8_t length;							///< Data bytes in the frame
+	const char* p_data;						///< The data bytes
+	bool bad_check;							///< The frame's check byte is made wrong
+	uint8_t repeat;							///< Times the frame is sent
+	uint8_t status;							///< Status the answer must have
+	uint8_t answer_length;					///< Data bytes the answer has after its status
+	uint16_t check;							///< Check byte of the answer, or HOST_CHECK_ANY
+	int8_t data_index;						///< Index of a data byte checked, or -1
+	uint8_t data_value;						///< What the last answer has in that byte
+} host_check_case;
+
+
+/// 32 spellable characters, whose count in the answer makes its check byte 0x11
+static const char spell_32[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ012345";
+
+/// The cases, in the order they're run. The good frame count is byte 3 of the stats
+static const host_check_case cases[] =
+{
+	{ "stats until 0x11 good frames", NULL, HOST_READ_STATS, 0, "", false, 17,
+	  HOST_OK, HOST_STATS_SIZE, HOST_CHECK_ANY, 3, HOST_CHECK_XON },
+	{ "stats until 0x13 good frames", NULL, HOST_READ_STATS, 0, "", false, 2,
+	  HOST_OK, HOST_STATS_SIZE, HOST_CHECK_ANY, 3, HOST_CHECK_XOFF },
+	{ "stats after XOFF in an answer", NULL, HOST_READ_STATS, 0, "", false, 1,
+	  HOST_OK, HOST_STATS_SIZE, HOST_CHECK_ANY, 3, 0x14 },
+	{ "unknown command 0x4a, check byte 0x11", NULL, 0x4A, 0, "", false, 1,
+	  HOST_BAD_COMMAND, 0, 0x11, -1, 0 },
+	{ "bad check byte on 0x5e, check byte 0x11", NULL, 0x5E, 0, "", true, 1,
+	  HOST_BAD_FRAME, 0, 0x11, -1, 0 },
+	{ "XOFF as the data of an encoder query", NULL, HOST_QUERY_ENCODER, 1, "\x13", false,
+	  1, HOST_BAD_DATA, 0, HOST_CHECK_ANY, -1, 0 },
+	{ "stats after XOFF in a frame", NULL, HOST_READ_STATS, 0, "", false, 1,
+	  HOST_OK, HOST_STATS_SIZE, HOST_CHECK_ANY, -1, 0 },
+	{ "streaming until the queue is full", "s", 0, 0, "", false, 0,
+	  0, 0, HOST_CHECK_ANY, -1, 0 },
+	{ "Escape to stop streaming", "\x1B", 0, 0, "", false, 0,
+	  0, 0, HOST_CHECK_ANY, -1, 0 },
+	{ "unknown command 0x4a after streaming", NULL, 0x4A, 0, "", false, 1,
+	  HOST_BAD_COMMAND, 0, 0x11, -1, 0 },
+	{ "32 characters to spell, check byte 0x11", NULL, HOST_SPELL, 32, spell_32, false,
+	  1, HOST_OK, 1, 0x11, 0, 32 }
+};
+
+/// Number of cases in the check
+#define HOST_CHECK_CASES	(sizeof (cases) / sizeof (cases[0]))
+
+
+static uint8_t case_index = 0;				///< The case being run
+static uint8_t sent = 0;					///< Frames of the case sent so far
+static bool waiting = false;				///< A frame has been sent and not answered
+static bool case_failed = false;			///< Something in the case has failed
+static uint64_t due_us = 0;					///< When the next thing is to be done
+static uint8_t failures = 0;				///< Cases which failed
+static uint8_t answer[HOST_MAX_DATA + 4];	///< The answer being read, from its command
+static uint8_t answer_count = 0;			///< Bytes of it read, or 0 between answers
+static uint16_t answers = 0;				///< Whole answers read
+static uint16_t answers_bad = 0;			///< Answers with a wrong check byte
+static uint16_t flow_shown = 0;				///< XON or XOFF shown outside a frame
+
+
+//-------------------------------------------------------------------------------------
+/** This function notes a failed part of the case being run and prints it.
+ *  @param p_what What went wrong
+ */
+
+static void host_check_fail (const char* p_what)
+{
+	fprintf (stderr, "Failed: %s: %s\n", cases[case_index].p_what, p_what);
+	case_failed = true;
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function checks a whole answer against the case being run.
+ */
+
+static void host_check_answer (void)
+{
+	const host_check_case& now = cases[case_index];
+	uint8_t length = answer[1];
+	uint8_t check = 0;
+
+	waiting = false;
+	due_us = 0;								// The next frame can go at once
+	if (length > HOST_MAX_DATA + 1)
+	{
+		host_check_fail ("answer's length is too long for a frame");
+		return;
+	}
+	for (uint8_t index = 0; index < length + 2; index++)
+	{
+		check = host_crc8 (check, answer[index]);
+	}
+	if (check != answer[length + 2])
+	{
+		answers_bad++;
+		host_check_fail ("answer's check byte is wrong");
+	}
+	if (sent == 0)
+	{
+		host_check_fail ("answer which wasn't asked for");
+		return;
+	}
+	if (answer[0] != (now.command | HOST_REPLY) || length != now.answer_length + 1
+		|| answer[2] != now.status)
+	{
+		fprintf (stderr, "  answer %02x, %u bytes, status %u\n", answer[0], length,
+				 answer[2]);
+		host_check_fail ("answer's command, length or status");
+	}
+	if (now.check != HOST_CHECK_ANY && answer[length + 2] != now.check)
+	{
+		host_check_fail ("answer's check byte isn't the one the case is for");
+	}
+	if (sent == now.repeat && now.data_index >= 0 && now.data_index < length - 1
+		&& answer[3 + now.data_index] != now.data_value)
+	{
+		host_check_fail ("answer's data");
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function is given each byte the terminal shows. It puts the bytes of answer
+ *  frames together, and counts XON and XOFF shown outside them.
+ *  @param byte The byte shown
+ */
+
+static void host_check_screen (uint8_t byte)
+{
+	if (answer_count == 0 && byte != HOST_FRAME_START)
+	{
+		if (byte == HOST_CHECK_XON || byte == HOST_CHECK_XOFF)
+		{
+			flow_shown++;
+		}
+		return;
+	}
+	if (byte == HOST_FRAME_START && answer_count == 0)
+	{
+		answer_count = 1;					// The start byte isn't kept
+		return;
+	}
+	answer[answer_count - 1] = byte;
+	answer_count++;
+	if (answer_count > 2 && (answer[1] > HOST_MAX_DATA + 1
+							 || answer_count == answer[1] + 4))
+	{
+		answers++;
+		host_check_answer ();
+		answer_count = 0;
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function sends the frame of the case being run.
+ */
+
+static void host_check_send (void)
+{
+	const host_check_case& now = cases[case_index];
+	uint8_t check = 0;
+
+	hal_sim_receive (0, HOST_FRAME_START);
+	hal_sim_receive (0, now.command);
+	check = host_crc8 (check, now.command);
+	hal_sim_receive (0, now.length);
+	check = host_crc8 (check, now.length);
+	for (uint8_t index = 0; index < now.length; index++)
+	{
+		hal_sim_receive (0, now.p_data[index]);
+		check = host_crc8 (check, now.p_data[index]);
+	}
+	hal_sim_receive (0, now.bad_check ? check ^ 0xFF : check);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function prints the results and ends the program.
+ */
+
+static void host_check_report (void)
+{
+	if (flow_shown)
+	{
+		fprintf (stderr, "Failed: %u XON or XOFF shown outside a frame\n", flow_shown);
+		failures++;
+	}
+	fprintf (stderr, "\nHost protocol check: %u cases, %u failed, %u answers, %u with a "
+			 "bad check byte\n", (unsigned)HOST_CHECK_CASES, failures, answers, answers_bad);
+	printf ("{\"check\": \"host\", \"pass\": %s, \"cases\": %u, \"failed\": %u, "
+			"\"answers\": %u, \"bad_check\": %u, \"flow_shown\": %u}\n",
+			failures ? "false" : "true", (unsigned)HOST_CHECK_CASES, failures, answers,
+			answers_bad, flow_shown);
+	fflush (stdout);
+	if (failures)
+	{
+		exit (1);
+	}
+	hal_sim_exit ();
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function ends the case being run, noting whether it passed, and moves on.
+ */
+
+static void host_check_next (uint64_t now_us)
+{
+	fprintf (stderr, "%-44s %s\n", cases[case_index].p_what,
+			 case_failed ? "FAILED" : "passed");
+	if (case_failed)
+	{
+		failures++;
+	}
+	case_failed = false;
+	sent = 0;
+	case_index++;
+	due_us = now_us + HOST_CHECK_GAP_US;
+	if (case_index >= HOST_CHECK_CASES)
+	{
+		host_check_report ();
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function is run every HOST_CHECK_RUN_US. It sends the frames or types the
+ *  keys of each case in turn and waits for the answers.
+ *  @param now_us The simulated time
+ */
+
+static void host_check_run (uint64_t now_us)
+{
+	static bool started = false;
+
+	if (!started)
+	{
+		hal_sim_take_terminal (host_check_screen);
+		due_us = now_us + HOST_CHECK_GAP_US;
+		started = true;
+	}
+	if (waiting)
+	{
+		if (now_us >= due_us)
+		{
+			waiting = false;
+			host_check_fail ("no answer");
+			host_check_next (now_us);
+		}
+		return;
+	}
+	if (now_us < due_us)
+	{
+		return;
+	}
+
+	const host_check_case& now = cases[case_index];
+	if (now.p_keys)
+	{
+		// Streaming mode is filled with more text than the queue holds; Escape ends it
+		if (sent == 0)
+		{
+			for (const char* p_key = now.p_keys; *p_key; p_key++)
+			{
+				hal_sim_receive (0, *p_key);
+			}
+			sent = 1;
+			due_us = now_us + HOST_CHECK_GAP_US;
+			if (now.p_keys[0] == 's')
+			{
+				for (uint16_t count = 0; count < HOST_CHECK_STREAM_CHARS; count++)
+				{
+					hal_sim_receive (0, 'A' + count % 26);
+				}
+				due_us = now_us + HOST_CHECK_STREAM_US;
+			}
+			return;
+		}
+		host_check_next (now_us);
+		return;
+	}
+	if (sent < now.repeat)
+	{
+		host_check_send ();
+		sent++;
+		waiting = true;
+		due_us = now_us + HOST_CHECK_ANSWER_US;
+		return;
+	}
+	host_check_next (now_us);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function hooks the check into the simulation before main() runs, if the
+ *  environment variable HAL_SIM_HOST asks for it.
+ */
+
+static void __attribute__ ((constructor)) host_check_start (void)
+{
+	const char* p_env = getenv ("HAL_SIM_HOST");
+
+	if (p_env == NULL)
+	{
+		return;
+	}
+	if (strcmp (p_env, "check"))
+	{
+		fprintf (stderr, "HAL_SIM_HOST must be \"check\"\n");
+		exit (1);
+	}
+	hal_sim_add_device (host_check_run, HOST_CHECK_RUN_US);
+}
+
+#endif // HAL_SIM
@@ -0,0 +1,498 @@
+//*************************************************************************************
+/** \file queue_check.cpp
+ *    This file contains a check of the queue template in queue.h and a measurement of
+ *    what its block methods save. The check makes queues of sizes which are powers of
+ *    two and sizes which aren't, among them 255 with unsigned char indices, the most
+ *    those indices allow, and for each one:
+ *    \li Runs a long random mix of put(), jam(), get(), put_n(), get_n(), peek(),
+ *        get_span() with skip(), delete_one(), flush() and the subscript operator,
+ *        comparing the contents after each with a model of the queue
+ *    \li Writes and peeks at runs which are split by the end of the buffer, and finds
+ *        the two spans either side of it
+ *    \li Calls delete_one() on an empty queue, and when the newest item is the last
+ *        place in the buffer
+ *    \li Jams an item into a full queue, which throws away the oldest
+ *    Then it times moving items through the queue one at a time with put() and get()
+ *    and in blocks with put_n() and get_n(), and prints the time each item takes. The
+ *    times are of the host running the simulated build, which isn't optimized, so
+ *    they only tell how the methods compare with each other.
+ *
+ *    The check is run before main() when the environment variable HAL_SIM_QUEUE is
+ *    "check":
+ *    \code
+ *    HAL_SIM_QUEUE=check ./master_sim
+ *    \endcode
+ *    Each failure and the timings go to the standard error stream with a summary, a
+ *    line of JSON to the standard output, and the program's exit status is 1 if
+ *    anything failed, 0 if not; the timings don't make it fail. The check is only
+ *    compiled when HAL_SIM is defined.
+ *
+ *  Revisions:
+ *    \li 10-16-2026 Original file
+ *
+ *  License:
+ *    This file released under the Lesser GNU Public License, version 2. This program
+ *    is intended for educational use only, but it is not limited thereto.
+ */
+//*************************************************************************************
+
+#ifdef HAL_SIM
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include "../lib/queue.h"
+
+
+/// Operations in the random mix for each size of queue
+#define QUEUE_CHECK_STEPS			20000
+
+/// Most items any queue being checked holds, and so the model too
+#define QUEUE_CHECK_MOST			1000
+
+/// Items moved through the queue for each timing
+#define QUEUE_CHECK_TIMED_ITEMS		4000000L
+
+
+static uint16_t failures = 0;				///< Checks which failed
+static uint32_t checks = 0;					///< Checks made
+static uint32_t lcg = 24680;				///< State of the check's random numbers
+static const char* p_size_name;				///< The queue being checked, for messages
+
+
+//-------------------------------------------------------------------------------------
+/** This function notes the result of one check, printing it if it failed. Only the
+ *  first few failures are printed, as one mistake in the queue can make many.
+ *  @param passed True if the check passed
+ *  @param p_what What was checked
+ */
+
+static void queue_check_expect (bool passed, const char* p_what)
+{
+	checks++;
+	if (!passed)
+	{
+		if (failures < 10)
+		{
+			fprintf (stderr, "Failed: %s, %s\n", p_size_name, p_what);
+		}
+		failures++;
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function gives a pseudo-random number, the same each time the check runs.
+ *  @param range One more than the largest number wanted
+ *  @return A number from zero to range - 1
+ */
+
+static uint16_t queue_check_random (uint16_t range)
+{
+	lcg = lcg * 1103515245UL + 12345UL;
+	return ((uint16_t)((lcg >> 16) % range));
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This class is a model of a queue: an array which holds the items oldest first, and
+ *  which is shifted down when items are taken out. It's slow but plainly right.
+ */
+
+template <class qType>
+class queue_model
+{
+	public:
+		qType items[QUEUE_CHECK_MOST];		///< The items, oldest first
+		uint16_t count;						///< Number of items
+
+		/// The constructor makes an empty model
+		queue_model (void) { count = 0; }
+
+		/// This method adds an item to the end
+		void put (qType item) { items[count++] = item; }
+
+		/// This method takes a number of the oldest items away
+		void take (uint16_t number)
+		{
+			memmove (items, items + number, (count - number) * sizeof (qType));
+			count -= number;
+		}
+};
+
+
+//-------------------------------------------------------------------------------------
+/** This function compares a queue with its model: the number of items, is_empty(),
+ *  every item through the subscript operator and through peek(), and the subscript
+ *  just past the end.
+ *  @param the_queue The queue being checked
+ *  @param model The model of what it should hold
+ *  @param p_what What was done to the queue, for messages
+ */
+
+template <class qType, class qIndexType, qIndexType qSize>
+static void queue_check_same (queue<qType, qIndexType, qSize>& the_queue,
+							  queue_model<qType>& model, const char* p_what)
+{
+	qType copy[QUEUE_CHECK_MOST];
+	bool same = true;
+
+	queue_check_expect (the_queue.num_items () == model.count, p_what);
+	queue_check_expect (the_queue.is_empty () == (model.count == 0), p_what);
+	for (uint16_t index = 0; index < model.count; index++)
+	{
+		if (the_queue[(qIndexType)index] != model.items[index])
+		{
+			same = false;
+		}
+	}
+	queue_check_expect (same, p_what);
+	if (model.count < qSize)
+	{
+		queue_check_expect (the_queue[(qIndexType)model.count] == (qType)(-1), p_what);
+	}
+	queue_check_expect (the_queue.peek (copy, qSize) == model.count, p_what);
+	queue_check_expect (!memcmp (copy, model.items, model.count * sizeof (qType)), p_what);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function runs the random mix of operations on one queue, checking it against
+ *  its model after each.
+ *  @param the_queue The queue to be checked, which starts out empty
+ */
+
+template <class qType, class qIndexType, qIndexType qSize>
+static void queue_check_mix (queue<qType, qIndexType, qSize>& the_queue)
+{
+	queue_model<qType> model;
+	qType block[QUEUE_CHECK_MOST];
+	qType next_item = 1;
+	qIndexType count;
+	qIndexType span;
+	qType* p_span;
+
+	the_queue.flush ();
+	for (uint16_t step = 0; step < QUEUE_CHECK_STEPS; step++)
+	{
+		uint16_t action = queue_check_random (100);
+		uint16_t room = qSize - model.count;
+
+		if (action < 25)					// One item with put()
+		{
+			queue_check_expect (the_queue.put (next_item) == (room == 0), "put() result");
+			if (room)
+			{
+				model.put (next_item);
+			}
+			next_item++;
+		}
+		else if (action < 30)				// One item with jam()
+		{
+			queue_check_expect (the_queue.jam (next_item) == (room == 0), "jam() result");
+			if (room == 0)
+			{
+				model.take (1);
+			}
+			model.put (next_item++);
+		}
+		else if (action < 50)				// One item with get()
+		{
+			if (model.count)
+			{
+				queue_check_expect (the_queue.get () == model.items[0], "get() item");
+				model.take (1);
+			}
+		}
+		else if (action < 65)				// A block with put_n(), perhaps too many
+		{
+			count = (qIndexType)queue_check_random (qSize < 40 ? qSize + 3 : 40);
+			for (qIndexType index = 0; index < count; index++)
+			{
+				block[index] = next_item++;
+			}
+			qIndexType put = the_queue.put_n (block, count);
+			queue_check_expect (put == (count < room ? count : room), "put_n() count");
+			for (qIndexType index = 0; index < put; index++)
+			{
+				model.put (block[index]);
+			}
+		}
+		else if (action < 80)				// A block with get_n()
+		{
+			count = (qIndexType)queue_check_random (qSize < 40 ? qSize + 3 : 40);
+			qIndexType got = the_queue.get_n (block, count);
+			queue_check_expect (got == (count < model.count ? count : model.count),
+								"get_n() count");
+			queue_check_expect (!memcmp (block, model.items, got * sizeof (qType)),
+								"get_n() items");
+			model.take (got);
+		}
+		else if (action < 90)				// The first span, used where it lies
+		{
+			p_span = the_queue.get_span (&span);
+			queue_check_expect (span <= model.count && (span > 0 || model.count == 0),
+								"get_span() count");
+			queue_check_expect (!memcmp (p_span, model.items, span * sizeof (qType)),
+								"get_span() items");
+			count = (qIndexType)queue_check_random (span + 1);
+			the_queue.skip (count);
+			model.take (count);
+		}
+		else if (action < 99)				// Take back the newest, maybe from nothing
+		{
+			the_queue.delete_one ();
+			if (model.count)
+			{
+				model.count--;
+			}
+		}
+		else
+		{
+			the_queue.flush ();
+			model.count = 0;
+		}
+		queue_check_same (the_queue, model, "random mix");
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function runs the checks of particular cases on one queue: runs split by the
+ *  end of the buffer, delete_one() when empty and across the end, and jam() when full.
+ *  @param the_queue The queue to be checked
+ */
+
+template <class qType, class qIndexType, qIndexType qSize>
+static void queue_check_cases (queue<qType, qIndexType, qSize>& the_queue)
+{
+	queue_model<qType> model;
+	qType block[QUEUE_CHECK_MOST];
+	qType copy[QUEUE_CHECK_MOST];
+	qIndexType span;
+	qType* p_span;
+
+	// Put the indices three places before the end, then put and peek at a run of
+	// seven, which is split three and four by the end of the buffer
+	the_queue.flush ();
+	for (qIndexType index = 0; index < qSize - 3; index++)
+	{
+		the_queue.put (1);
+		the_queue.get ();
+	}
+	for (qIndexType index = 0; index < 7; index++)
+	{
+		block[index] = (qType)(index + 10);
+		model.put (block[index]);
+	}
+	queue_check_expect (the_queue.put_n (block, 7) == 7, "put_n() across the end");
+	queue_check_same (the_queue, model, "put_n() across the end");
+	queue_check_expect (the_queue.peek (copy, 7) == 7 && !memcmp (copy, block,
+						7 * sizeof (qType)), "peek() across the end");
+	p_span = the_queue.get_span (&span);
+	queue_check_expect (span == 3 && p_span[0] == 10, "get_span() to the end");
+	the_queue.skip (span);
+	model.take (span);
+	p_span = the_queue.get_span (&span);
+	queue_check_expect (span == 4 && p_span[0] == 13, "get_span() from the start");
+	queue_check_same (the_queue, model, "skip() to the end");
+
+	// Taking back from an empty queue does nothing
+	the_queue.flush ();
+	model.count = 0;
+	the_queue.delete_one ();
+	queue_check_same (the_queue, model, "delete_one() when empty");
+	the_queue.put (5);
+	queue_check_expect (the_queue.get () == 5, "put() after delete_one() when empty");
+
+	// The newest of two items is in the last place of the buffer, so the put index has
+	// wrapped to zero and has to go back around the end
+	the_queue.flush ();
+	for (qIndexType index = 0; index < qSize - 1; index++)
+	{
+		the_queue.put (1);
+		the_queue.get ();
+	}
+	the_queue.put (7);
+	the_queue.put (8);
+	the_queue.get ();
+	the_queue.put (9);
+	the_queue.delete_one ();
+	model.count = 0;
+	model.put (8);
+	queue_check_same (the_queue, model, "delete_one() across the end");
+	the_queue.delete_one ();
+	model.count = 0;
+	queue_check_same (the_queue, model, "delete_one() to empty across the end");
+	the_queue.put (6);
+	model.put (6);
+	queue_check_same (the_queue, model, "put() after delete_one() across the end");
+
+	// Jamming into a full queue throws away the oldest item and keeps the newest
+	the_queue.flush ();
+	model.count = 0;
+	for (qIndexType index = 0; index < qSize; index++)
+	{
+		queue_check_expect (!the_queue.put ((qType)(index + 1)), "put() until full");
+		model.put ((qType)(index + 1));
+	}
+	queue_check_expect (the_queue.put (99), "put() when full");
+	queue_check_expect (the_queue.jam (100), "jam() when full");
+	model.take (1);
+	model.put (100);
+	queue_check_same (the_queue, model, "jam() when full");
+	queue_check_expect (the_queue.get () == 2, "the oldest is gone after jam()");
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function runs every check on one size of queue.
+ *  @param p_name The queue's type, for messages
+ */
+
+template <class qType, class qIndexType, qIndexType qSize>
+static void queue_check_size (const char* p_name)
+{
+	static queue<qType, qIndexType, qSize> the_queue;
+	uint16_t failed_before = failures;
+
+	p_size_name = p_name;
+	queue_check_mix (the_queue);
+	queue_check_cases (the_queue);
+	fprintf (stderr, "%-36s %s\n", p_name, (failures == failed_before) ? "passed"
+			 : "FAILED");
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function finds the time on the host's clock, for the timings.
+ *  @return The time in nanoseconds from some fixed moment
+ */
+
+static double queue_check_ns (void)
+{
+	struct timespec now;
+
+	clock_gettime (CLOCK_MONOTONIC, &now);
+	return (now.tv_sec * 1.0e9 + now.tv_nsec);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function times moving characters through a queue, in blocks of a given size
+ *  with put_n() and get_n(), or one at a time with put() and get() if the block size
+ *  is zero. Half a block is left in the queue between moves, so the runs keep
+ *  crossing the end of the buffer.
+ *  @param the_queue The queue to time
+ *  @param block_size Characters in each block, or zero for one at a time
+ *  @return The time each character takes, in nanoseconds
+ */
+
+template <class qIndexType, qIndexType qSize>
+static double queue_check_time (queue<char, qIndexType, qSize>& the_queue,
+								qIndexType block_size)
+{
+	char block[256];
+	volatile char sink = 0;				// Keeps the reads from being left out
+	long moved = 0;
+	double start;
+
+	memset (block, 'x', sizeof (block));
+	the_queue.flush ();
+	for (qIndexType index = 0; index < block_size / 2; index++)
+	{
+		the_queue.put ('x');
+	}
+	start = queue_check_ns ();
+	if (block_size == 0)
+	{
+		for ( ; moved < QUEUE_CHECK_TIMED_ITEMS; moved++)
+		{
+			the_queue.put ('x');
+			sink = the_queue.get ();
+		}
+	}
+	else
+	{
+		for ( ; moved < QUEUE_CHECK_TIMED_ITEMS; moved += block_size)
+		{
+			the_queue.put_n (block, block_size);
+			the_queue.get_n (block, block_size);
+			sink = block[0];
+		}
+	}
+	(void)sink;
+	return ((queue_check_ns () - start) / moved);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function runs every part of the check, prints the results and ends the
+ *  program.
+ */
+
+static void queue_check_run (void)
+{
+	static queue<char, unsigned char, 128> power_queue;
+	static queue<char, unsigned char, 100> other_queue;
+	const unsigned char block_sizes[] = { 0, 4, 16, 64 };
+	double per_item[2][4];
+
+	fprintf (stderr, "Queue check\n");
+	queue_check_size<char, unsigned char, 16> ("queue<char, unsigned char, 16>");
+	queue_check_size<char, unsigned char, 128> ("queue<char, unsigned char, 128>");
+	queue_check_size<char, unsigned char, 100> ("queue<char, unsigned char, 100>");
+	queue_check_size<char, unsigned char, 255> ("queue<char, unsigned char, 255>");
+	queue_check_size<short, unsigned short, 256> ("queue<short, unsigned short, 256>");
+	queue_check_size<long, unsigned short, 1000> ("queue<long, unsigned short, 1000>");
+
+	fprintf (stderr, "\nNanoseconds per character moved on this host\n");
+	fprintf (stderr, "%-32s %10s %10s %10s %10s\n", "Queue", "put/get", "blocks 4",
+			 "blocks 16", "blocks 64");
+	for (uint8_t index = 0; index < 4; index++)
+	{
+		per_item[0][index] = queue_check_time (power_queue, block_sizes[index]);
+		per_item[1][index] = queue_check_time (other_queue, block_sizes[index]);
+	}
+	for (uint8_t row = 0; row < 2; row++)
+	{
+		fprintf (stderr, "%-32s %10.2f %10.2f %10.2f %10.2f\n", row
+				 ? "queue<char, unsigned char, 100>" : "queue<char, unsigned char, 128>",
+				 per_item[row][0], per_item[row][1], per_item[row][2], per_item[row][3]);
+	}
+
+	fprintf (stderr, "\nQueue check: %lu checks, %u failed\n", (unsigned long)checks,
+			 failures);
+	printf ("{\"check\": \"queue\", \"pass\": %s, \"checks\": %lu, \"failed\": %u, "
+			"\"ns_per_char\": {\"put_get\": %.2f, \"blocks_16\": %.2f}}\n",
+			failures ? "false" : "true", (unsigned long)checks, failures,
+			per_item[0][0], per_item[0][2]);
+	fflush (stdout);
+	exit (failures ? 1 : 0);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function runs the check before main() does, if the environment variable
+ *  HAL_SIM_QUEUE asks for it.
+ */
+
+static void __attribute__ ((constructor)) queue_check_start (void)
+{
+	const char* p_env = getenv ("HAL_SIM_QUEUE");
+
+	if (p_env == NULL)
+	{
+		return;
+	}
+	if (strcmp (p_env, "check"))
+	{
+		fprintf (stderr, "HAL_SIM_QUEUE must be \"check\"\n");
+		exit (1);
+	}
+	queue_check_run ();
+}
+
+#endif // HAL_SIM
@@ -0,0 +1,392 @@
+//*************************************************************************************
+/** \file rs232_check.cpp
+ *    This file contains a check of the receiver ring of the rs232 class in rs232int.*.
+ *    The receive interrupt of USART 0 is run by hand, one character at a time, in
+ *    between calls to getchar(), getchars() and check_for_char(), and what comes out
+ *    is compared with a model of the queue. The check covers:
+ *    \li A long run of puts and reads in a mixed order, which takes the free-running
+ *        8-bit indices around many times and the ring's place in the buffer around
+ *        more often still
+ *    \li Filling the ring to RSINT_BUF_SIZE with the indices about to wrap, which
+ *        loses nothing, and one character more, which is lost and counted
+ *    \li Reading a full ring in one getchars(), and in pieces which end where the
+ *        buffer does and where the indices wrap
+ *    \li The count of lost characters stopping at 255
+ *    \li Characters sent through the simulated USART while getchar() waits for them,
+ *        and a burst which comes in while nothing is read, of which the characters
+ *        beyond RSINT_BUF_SIZE are lost
+ *
+ *    The check is run before main() when the environment variable HAL_SIM_RS232 is
+ *    "check":
+ *    \code
+ *    HAL_SIM_RS232=check ./master_sim
+ *    \endcode
+ *    Each failure goes to the standard error stream with a summary, a line of JSON to
+ *    the standard output, and the program's exit status is 1 if anything failed, 0 if
+ *    not. The check is only compiled when HAL_SIM is defined.
+ *
+ *  Revisions:
+ *    \li 10-16-2026 Original file
+ *
+ *  License:
+ *    This file released under the Lesser GNU Public License, version 2. This program
+ *    is intended for educational use only, but it is not limited thereto.
+ */
+//*************************************************************************************
+
+#ifdef HAL_SIM
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../lib/hal_sim_dev.h"				// Hooks into the simulated master
+#include "../lib/hal.h"
+#include "../lib/rs232int.h"
+
+
+/// Puts and reads in the long mixed run
+#define RS232_CHECK_STEPS			20000
+
+/// Characters the model of the queue can hold; more than the ring, so it sees losses
+#define RS232_CHECK_MODEL_SIZE		1024
+
+/// Characters sent through the simulated USART in each part which uses it
+#define RS232_CHECK_WIRE_CHARS		200
+
+/// The receive interrupt of USART 0, which rs232int.cpp defines
+extern "C" void USART0_RX_vect (void);
+
+// The indices of port 0's receiver ring, which the check looks at to see where they are
+extern volatile uint8_t rcv0_read_index;
+extern volatile uint8_t rcv0_write_index;
+
+
+static uint8_t model[RS232_CHECK_MODEL_SIZE];	///< Characters which should be in the ring
+static uint32_t model_head = 0;				///< Where the model's next character goes
+static uint32_t model_tail = 0;				///< Where the model's oldest character is
+static uint16_t model_lost = 0;				///< Characters which should have been lost
+static uint8_t next_char = 0;				///< Character the interrupt gets next
+static uint32_t put_count = 0;				///< Characters given to the interrupt
+static uint32_t read_count = 0;				///< Characters read back
+static uint16_t failures = 0;				///< Checks which failed
+static uint32_t checks = 0;					///< Checks made
+static uint32_t lcg = 12345;				///< State of the check's random numbers
+
+
+//-------------------------------------------------------------------------------------
+/** This function notes the result of one check, printing it if it failed. Only the
+ *  first few failures are printed, as one mistake in the ring can make many.
+ *  @param passed True if the check passed
+ *  @param p_what What was checked
+ */
+
+static void rs232_check_expect (bool passed, const char* p_what)
+{
+	checks++;
+	if (!passed)
+	{
+		if (failures < 10)
+		{
+			fprintf (stderr, "Failed: %s (after %lu characters put, %lu read)\n", p_what,
+					 (unsigned long)put_count, (unsigned long)read_count);
+		}
+		failures++;
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function gives a pseudo-random number, the same each time the check runs.
+ *  @param range One more than the largest number wanted
+ *  @return A number from zero to range - 1
+ */
+
+static uint16_t rs232_check_random (uint16_t range)
+{
+	lcg = lcg * 1103515245UL + 12345UL;
+	return ((uint16_t)((lcg >> 16) % range));
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function empties the model of the queue, for a port which has just been set
+ *  up.
+ */
+
+static void rs232_check_reset (void)
+{
+	model_head = model_tail = model_lost = 0;
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function runs the receive interrupt for the next character, as if it had come
+ *  in on the wire, and puts it in the model unless the ring should be full.
+ */
+
+static void rs232_check_put (void)
+{
+	UDR0 = next_char;
+	USART0_RX_vect ();
+	if (model_head - model_tail < RSINT_BUF_SIZE)
+	{
+		model[model_head++ % RS232_CHECK_MODEL_SIZE] = next_char;
+	}
+	else
+	{
+		model_lost++;
+	}
+	next_char++;
+	put_count++;
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function checks that the port agrees with the model about whether there's
+ *  anything to read and how many characters have been lost.
+ *  @param port The port being checked
+ */
+
+static void rs232_check_state (rs232& port)
+{
+	rs232_check_expect (port.check_for_char () == (model_head != model_tail),
+						"check_for_char() tells whether anything is waiting");
+	rs232_check_expect (port.get_lost_chars () == (model_lost > 255 ? 255 : model_lost),
+						"lost characters counted, stopping at 255");
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function reads one character with getchar() and checks it against the model.
+ *  The model must hold a character, as getchar() would wait forever if it didn't.
+ *  @param port The port being checked
+ */
+
+static void rs232_check_getchar (rs232& port)
+{
+	uint8_t ch = (uint8_t)port.getchar ();
+
+	rs232_check_expect (ch == model[model_tail++ % RS232_CHECK_MODEL_SIZE],
+						"getchar() gives the oldest character");
+	read_count++;
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function reads with getchars() and checks the characters and their number
+ *  against the model.
+ *  @param port The port being checked
+ *  @param max_chars The most characters to ask for
+ */
+
+static void rs232_check_getchars (rs232& port, uint8_t max_chars)
+{
+	char buffer[256];
+	uint32_t waiting = model_head - model_tail;
+	uint8_t expected = (waiting < max_chars) ? waiting : max_chars;
+	uint8_t count;
+	bool same = true;
+
+	memset (buffer, 0, sizeof (buffer));
+	count = port.getchars (buffer, max_chars);
+	rs232_check_expect (count == expected, "getchars() gives what's waiting, up to the most");
+	for (uint8_t index = 0; index < count && index < expected; index++)
+	{
+		if ((uint8_t)buffer[index] != model[(model_tail + index) % RS232_CHECK_MODEL_SIZE])
+		{
+			same = false;
+		}
+	}
+	rs232_check_expect (same, "getchars() gives the characters in order");
+	rs232_check_expect (buffer[count] == 0, "getchars() writes no more than it returns");
+	model_tail += count;
+	read_count += count;
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function sends characters to USART 0 through the simulated wire and lets the
+ *  simulated time run until they've all come in, without reading any.
+ *  @param count The number of characters to send
+ */
+
+static void rs232_check_wire (uint16_t count)
+{
+	uint64_t end_us;
+
+	for (uint16_t index = 0; index < count; index++)
+	{
+		hal_sim_receive (0, next_char++);
+	}
+	end_us = hal_sim_time_us () + (uint64_t)((count + 2) * hal_sim_byte_time_us (0));
+	while (hal_sim_time_us () < end_us)
+	{
+		HAL_WAIT ();
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function runs every part of the check, prints the results and ends the
+ *  program.
+ */
+
+static void rs232_check_run (void)
+{
+	uint16_t wraps = 0;
+	uint8_t last_index;
+
+	hal_sim_take_terminal ();				// Standard input isn't for the firmware
+	sei ();
+
+	// A long run of puts and reads in a random mix. Puts come in bursts which are now
+	// and then long enough to fill the ring, so some characters are lost along the way
+	{
+		rs232 port (9600, 0);
+		rs232_check_reset ();
+		last_index = rcv0_write_index;
+		for (uint16_t step = 0; step < RS232_CHECK_STEPS; step++)
+		{
+			uint16_t action = rs232_check_random (100);
+			uint16_t burst = (action < 2) ? RSINT_BUF_SIZE + 8 : rs232_check_random (4);
+			for (uint16_t index = 0; index < burst; index++)
+			{
+				rs232_check_put ();
+				if (rcv0_write_index < last_index)
+				{
+					wraps++;
+				}
+				last_index = rcv0_write_index;
+			}
+			rs232_check_state (port);
+			if (action < 40)
+			{
+				if (port.check_for_char ())
+				{
+					rs232_check_getchar (port);
+				}
+			}
+			else if (action < 80)
+			{
+				rs232_check_getchars (port, (uint8_t)rs232_check_random (12));
+			}
+			else if (action < 85)
+			{
+				rs232_check_getchars (port, 255);
+			}
+			rs232_check_state (port);
+		}
+		rs232_check_getchars (port, 255);
+		rs232_check_state (port);
+		rs232_check_expect (wraps > 10, "the mixed run took the indices around many times");
+	}
+
+	// Fill the ring with the indices just short of wrapping: it holds RSINT_BUF_SIZE
+	// characters, and the one after is lost. Then read it back in pieces, the first of
+	// which ends where the buffer and the indices both wrap
+	{
+		rs232 port (9600, 0);
+		rs232_check_reset ();
+		for (uint16_t index = 0; index < 250; index++)
+		{
+			rs232_check_put ();
+			rs232_check_getchar (port);
+		}
+		for (uint16_t index = 0; index < RSINT_BUF_SIZE; index++)
+		{
+			rs232_check_put ();
+		}
+		rs232_check_expect (port.get_lost_chars () == 0, "a full ring loses nothing");
+		rs232_check_expect ((uint8_t)(rcv0_write_index - rcv0_read_index) == RSINT_BUF_SIZE,
+							"a full ring holds RSINT_BUF_SIZE characters");
+		rs232_check_expect (rcv0_write_index < rcv0_read_index, "the indices wrapped");
+		rs232_check_put ();
+		rs232_check_expect (port.get_lost_chars () == 1, "one more character is lost");
+		rs232_check_state (port);
+		rs232_check_getchars (port, 6);		// Up to where the buffer and indices wrap
+		rs232_check_getchars (port, 1);		// Just past it
+		rs232_check_getchars (port, 255);
+		rs232_check_state (port);
+		rs232_check_getchars (port, 255);	// Nothing's left
+	}
+
+	// A full ring read in one getchars(), and the lost count stopping at 255
+	{
+		rs232 port (9600, 0);
+		rs232_check_reset ();
+		for (uint16_t index = 0; index < RSINT_BUF_SIZE + 300; index++)
+		{
+			rs232_check_put ();
+		}
+		rs232_check_state (port);
+		rs232_check_getchars (port, 255);
+		rs232_check_state (port);
+		rs232_check_put ();
+		rs232_check_getchar (port);
+		rs232_check_state (port);
+	}
+
+	// Characters come in through the simulated USART, one byte time apart, while
+	// getchar() waits for each of them
+	{
+		rs232 port (9600, 0);
+		rs232_check_reset ();
+		for (uint16_t index = 0; index < RS232_CHECK_WIRE_CHARS; index++)
+		{
+			hal_sim_receive (0, next_char);
+			model[model_head++ % RS232_CHECK_MODEL_SIZE] = next_char++;
+		}
+		for (uint16_t index = 0; index < RS232_CHECK_WIRE_CHARS; index++)
+		{
+			rs232_check_getchar (port);
+		}
+		rs232_check_state (port);
+
+		// A burst with nobody reading fills the ring, and the rest is lost
+		rs232_check_wire (RS232_CHECK_WIRE_CHARS);
+		rs232_check_expect (port.get_lost_chars () == RS232_CHECK_WIRE_CHARS - RSINT_BUF_SIZE,
+							"characters beyond a full ring are lost from the wire");
+		rs232_check_expect (port.getchars (NULL, 0) == 0, "getchars() of none gives none");
+		for (uint16_t index = 0; index < RSINT_BUF_SIZE; index++)
+		{
+			rs232_check_expect ((uint8_t)port.getchar () == (uint8_t)(next_char
+								- RS232_CHECK_WIRE_CHARS + index), "the oldest are kept");
+		}
+		rs232_check_expect (!port.check_for_char (), "nothing left after the burst");
+	}
+
+	fprintf (stderr, "\nReceiver ring check: %lu characters put, %lu read, the indices "
+			 "wrapped %u times in the mixed run\n", (unsigned long)put_count,
+			 (unsigned long)read_count, wraps);
+	fprintf (stderr, "%lu checks, %u failed\n", (unsigned long)checks, failures);
+	printf ("{\"check\": \"rs232\", \"pass\": %s, \"checks\": %lu, \"failed\": %u, "
+			"\"put\": %lu, \"read\": %lu}\n", failures ? "false" : "true",
+			(unsigned long)checks, failures, (unsigned long)put_count,
+			(unsigned long)read_count);
+	fflush (stdout);
+	exit (failures ? 1 : 0);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function runs the check before main() does, if the environment variable
+ *  HAL_SIM_RS232 asks for it.
+ */
+
+static void __attribute__ ((constructor)) rs232_check_start (void)
+{
+	const char* p_env = getenv ("HAL_SIM_RS232");
+
+	if (p_env == NULL)
+	{
+		return;
+	}
+	if (strcmp (p_env, "check"))
+	{
+		fprintf (stderr, "HAL_SIM_RS232 must be \"check\"\n");
+		exit (1);
+	}
+	rs232_check_run ();
+}
+
+#endif // HAL_SIM
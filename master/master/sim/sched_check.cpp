@@ -0,0 +1,323 @@
+//*************************************************************************************
+/** \file sched_check.cpp
+ *    This file contains a check of the task scheduler in stl_sched.cpp and of the
+ *    blocking methods of stl_task. It makes a few tasks which note each run, adds them
+ *    to a scheduler, moves the simulated time on by sleeping, and checks that:
+ *    \li A task of higher priority runs before one of lower priority, even when the
+ *        lower one's deadline is earlier
+ *    \li Among tasks of equal priority, the one with the earliest deadline runs first
+ *    \li A run which starts one interval or more after the task was due counts as a
+ *        missed deadline, and one which starts sooner doesn't
+ *    \li A task blocked with wait_for_wake() doesn't run until another task calls its
+ *        wake() method, and then runs at once
+ *    \li A task blocked with wait_until() isn't run before its time, which the 
+ *        scheduler sleeps until, and isn't counted late when it then runs
+ *
+ *    The check is run before main() when the environment variable HAL_SIM_SCHED is
+ *    "check":
+ *    \code
+ *    HAL_SIM_SCHED=check ./master_sim
+ *    \endcode
+ *    Each failure goes to the standard error stream with a summary, a line of JSON to
+ *    the standard output, and the program's exit status is 1 if anything failed, 0 if
+ *    not. The check is only compiled when HAL_SIM is defined.
+ *
+ *  Revisions:
+ *    \li 10-16-2026 Original file
+ *
+ *  License:
+ *    This file released under the Lesser GNU Public License, version 2. This program
+ *    is intended for educational use only, but it is not limited thereto.
+ */
+//*************************************************************************************
+
+#ifdef HAL_SIM
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../lib/hal_sim_dev.h"				// Hooks into the simulated master
+#include "../lib/hal.h"
+#include "../lib/base_text_serial.h"
+#include "../lib/stl_timer.h"
+#include "../lib/stl_task.h"
+#include "../lib/stl_sched.h"
+
+
+/// Most runs the check notes down between looks
+#define SCHED_CHECK_LOG_SIZE		16
+
+// What a check task does each time it runs
+#define SCHED_CHECK_RUN				0		///< Nothing; run again at the interval
+#define SCHED_CHECK_BLOCK_WAKE		1		///< Block until another task wakes it
+#define SCHED_CHECK_BLOCK_TIME		2		///< Block for SCHED_CHECK_BLOCK_US
+#define SCHED_CHECK_WAKE_OTHER		3		///< Wake the task it's been given
+
+/// Microseconds a task doing SCHED_CHECK_BLOCK_TIME blocks for
+#define SCHED_CHECK_BLOCK_US		30000L
+
+
+static char run_log[SCHED_CHECK_LOG_SIZE];	///< Names of the tasks which ran, in order
+static uint8_t run_count = 0;				///< Runs in the log
+static uint8_t failures = 0;				///< Checks which failed
+static uint8_t checks = 0;					///< Checks made
+static time_stamp last_run_time;			///< When the last task which ran started
+
+
+//-------------------------------------------------------------------------------------
+/** This task notes its name in the log each time it runs and then does one of the
+ *  SCHED_CHECK_* things.
+ */
+
+class sched_check_task : public stl_task
+{
+	protected:
+		char name;							///< Letter put in the log for each run
+		uint8_t action;						///< What the task does when it runs
+		stl_task* p_other;					///< Task woken by SCHED_CHECK_WAKE_OTHER
+
+	public:
+		/** The constructor makes a task which starts out due at the given time.
+		 *  @param a_timer The timer which measures real time
+		 *  @param interval The time between runs
+		 *  @param start The time at which the first run is due
+		 *  @param a_name The letter put in the log for each run
+		 *  @param an_action What the task does when it runs, a SCHED_CHECK_* value
+		 *  @param p_task The task woken by SCHED_CHECK_WAKE_OTHER, or NULL
+		 */
+		sched_check_task (task_timer& a_timer, const time_stamp& interval,
+						  const time_stamp& start, char a_name, uint8_t an_action,
+						  stl_task* p_task = NULL)
+			: stl_task (a_timer, interval)
+		{
+			name = a_name;
+			action = an_action;
+			p_other = p_task;
+			set_next_run_time (start);
+		}
+
+		/** This method notes the run and does the task's action. The task has only
+		 *  one state, so the state it's given isn't used.
+		 *  @return STL_NO_TRANSITION, as the task has only one state
+		 */
+		char run (char)
+		{
+			time_stamp wake_time;
+
+			last_run_time = the_timer.get_time_now ();
+			if (run_count < SCHED_CHECK_LOG_SIZE)
+			{
+				run_log[run_count++] = name;
+			}
+			switch (action)
+			{
+				case (SCHED_CHECK_BLOCK_WAKE):
+					wait_for_wake ();
+					break;
+				case (SCHED_CHECK_BLOCK_TIME):
+					wake_time = the_timer.get_time_now ();
+					wake_time += time_stamp (0, SCHED_CHECK_BLOCK_US);
+					wait_until (wake_time);
+					break;
+				case (SCHED_CHECK_WAKE_OTHER):
+					p_other->wake ();
+					break;
+				default:
+					break;
+			}
+			return (STL_NO_TRANSITION);
+		}
+};
+
+
+//-------------------------------------------------------------------------------------
+/** This function notes the result of one check, printing it if it failed.
+ *  @param passed True if the check passed
+ *  @param p_what What was checked
+ */
+
+static void sched_check_expect (bool passed, const char* p_what)
+{
+	checks++;
+	if (!passed)
+	{
+		failures++;
+		fprintf (stderr, "Failed: %s\n", p_what);
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function checks the log of runs against the expected order, then empties the
+ *  log.
+ *  @param p_expected The names of the tasks which should have run, in order
+ *  @param p_what What was checked
+ */
+
+static void sched_check_log (const char* p_expected, const char* p_what)
+{
+	bool same = (run_count == strlen (p_expected)
+				 && !strncmp (run_log, p_expected, run_count));
+
+	sched_check_expect (same, p_what);
+	if (!same)
+	{
+		fprintf (stderr, "  ran \"%.*s\", expected \"%s\"\n", run_count, run_log,
+				 p_expected);
+	}
+	run_count = 0;
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function sleeps the simulated processor until the given time has come. The
+ *  timer wakes it at every overflow as well, so it may take more than one sleep.
+ *  @param the_timer The timer which measures real time
+ *  @param a_time The time to wait for
+ */
+
+static void sched_check_sleep (task_timer& the_timer, const time_stamp& a_time)
+{
+	time_stamp wake_time = a_time;			// Local copy which can be compared
+
+	while (wake_time > the_timer.get_time_now ())
+	{
+		the_timer.idle_until (wake_time);
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function runs every part of the check, prints the results and ends the
+ *  program.
+ */
+
+static void sched_check_run (void)
+{
+	task_timer the_timer;
+	time_stamp ms_5 (0, 5000), ms_10 (0, 10000), ms_20 (0, 20000), ms_25 (0, 25000);
+	time_stamp now;
+
+	hal_sim_take_terminal ();				// Standard input isn't for the firmware
+	sei ();
+
+	// Priority comes before deadline: L is due at the same time as H and its deadline
+	// is sooner, but H has the higher priority
+	{
+		now = the_timer.get_time_now ();
+		sched_check_task low (the_timer, ms_5, now, 'L', SCHED_CHECK_RUN);
+		sched_check_task high (the_timer, ms_20, now, 'H', SCHED_CHECK_RUN);
+		task_scheduler scheduler (the_timer, time_stamp (0, 100000));
+		scheduler.add_task (&low, 1);
+		scheduler.add_task (&high, 2);
+		scheduler.run_one ();
+		scheduler.run_one ();
+		sched_check_expect (scheduler.run_one () == NULL, "nothing due once both ran");
+		sched_check_log ("HL", "higher priority runs first");
+	}
+
+	// Among equal priorities, earliest deadline first, whatever order they were added
+	{
+		now = the_timer.get_time_now ();
+		sched_check_task slow (the_timer, ms_20, now, 'A', SCHED_CHECK_RUN);
+		sched_check_task fast (the_timer, ms_5, now, 'B', SCHED_CHECK_RUN);
+		sched_check_task middle (the_timer, ms_10, now, 'C', SCHED_CHECK_RUN);
+		task_scheduler scheduler (the_timer, time_stamp (0, 100000));
+		scheduler.add_task (&slow, 1);
+		scheduler.add_task (&fast, 1);
+		scheduler.add_task (&middle, 1);
+		scheduler.run_one ();
+		scheduler.run_one ();
+		scheduler.run_one ();
+		sched_check_log ("BCA", "earliest deadline first among equal priorities");
+	}
+
+	// A task due at the start, first run 25 ms late with a 10 ms interval: the runs due
+	// at 0 and 10 ms have missed their deadlines, and the one due at 20 ms hasn't
+	{
+		now = the_timer.get_time_now ();
+		sched_check_task late (the_timer, ms_10, now, 'M', SCHED_CHECK_RUN);
+		task_scheduler scheduler (the_timer, time_stamp (0, 100000));
+		scheduler.add_task (&late, 1);
+		sched_check_sleep (the_timer, now + ms_25);
+		scheduler.run_one ();
+		sched_check_expect (late.get_deadline_misses () == 1, "run 25 ms late is a miss");
+		scheduler.run_one ();
+		sched_check_expect (late.get_deadline_misses () == 2, "run 15 ms late is a miss");
+		scheduler.run_one ();
+		sched_check_expect (late.get_deadline_misses () == 2, "run 5 ms late isn't a miss");
+		sched_check_expect (scheduler.run_one () == NULL, "caught up after three runs");
+		sched_check_log ("MMM", "late task runs until it has caught up");
+	}
+
+	// A task blocked with wait_for_wake() runs only once another task wakes it
+	{
+		now = the_timer.get_time_now ();
+		sched_check_task sleeper (the_timer, ms_10, now, 'S', SCHED_CHECK_BLOCK_WAKE);
+		sched_check_task waker (the_timer, ms_20, now + ms_5, 'W', SCHED_CHECK_WAKE_OTHER,
+								&sleeper);
+		task_scheduler scheduler (the_timer, time_stamp (0, 100000));
+		scheduler.add_task (&sleeper, 2);
+		scheduler.add_task (&waker, 1);
+		scheduler.run_one ();
+		sched_check_expect (sleeper.get_op_state () == TASK_BLOCKED, "task blocks itself");
+		sched_check_expect (!sleeper.is_due (), "blocked task isn't due");
+		sched_check_sleep (the_timer, now + ms_20);
+		sched_check_expect (!sleeper.is_due (), "blocked task isn't due at its interval");
+		scheduler.run_one ();
+		sched_check_expect (sleeper.is_due (), "woken task is due");
+		scheduler.run_one ();
+		sched_check_log ("SWS", "woken task runs next");
+	}
+
+	// A task blocked with wait_until() isn't run until its time; the scheduler sleeps,
+	// perhaps more than once, until then
+	{
+		now = the_timer.get_time_now ();
+		sched_check_task timed (the_timer, ms_10, now, 'T', SCHED_CHECK_BLOCK_TIME);
+		task_scheduler scheduler (the_timer, time_stamp (0, 100000));
+		time_stamp wake_time;
+		scheduler.add_task (&timed, 1);
+		scheduler.schedule ();
+		wake_time = last_run_time + time_stamp (0, SCHED_CHECK_BLOCK_US);
+		sched_check_expect (timed.get_op_state () == TASK_BLOCKED, "task blocks until a time");
+		sched_check_log ("T", "timed task runs when first due");
+		while (run_count == 0)
+		{
+			scheduler.schedule ();
+		}
+		sched_check_expect (!(wake_time > last_run_time), "timed task waits for its time");
+		sched_check_log ("T", "timed task runs once at its time");
+		sched_check_expect (timed.get_deadline_misses () == 0, "timed wake-up isn't a miss");
+	}
+
+	fprintf (stderr, "\nScheduler check: %u checks, %u failed\n", checks, failures);
+	printf ("{\"check\": \"scheduler\", \"pass\": %s, \"checks\": %u, \"failed\": %u}\n",
+			failures ? "false" : "true", checks, failures);
+	fflush (stdout);
+	exit (failures ? 1 : 0);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function runs the check before main() does, if the environment variable
+ *  HAL_SIM_SCHED asks for it.
+ */
+
+static void __attribute__ ((constructor)) sched_check_start (void)
+{
+	const char* p_env = getenv ("HAL_SIM_SCHED");
+
+	if (p_env == NULL)
+	{
+		return;
+	}
+	if (strcmp (p_env, "check"))
+	{
+		fprintf (stderr, "HAL_SIM_SCHED must be \"check\"\n");
+		exit (1);
+	}
+	sched_check_run ();
+}
+
+#endif // HAL_SIM
@@ -0,0 +1,418 @@
+//*************************************************************************************
+/** \file sentence_bench.cpp
+ *    This file contains a benchmark of how fast the simulated hand spells. It types
+ *    standard sentences into the user task's sentence prompt, just as a user at the
+ *    terminal would, lets the master and the simulated slaves spell them, and
+ *    measures each one:
+ *    \li Characters per minute, from pressing Enter until the user task has handed
+ *        the last character to the output task
+ *    \li The latency of each letter, from the moment the output task gets it until
+ *        the last byte of its gesture has reached the slaves and the last finger has
+ *        settled, given as the median, 90th and 99th percentiles and the maximum
+ *    \li The bytes sent on the slave bus per letter, both ways, and the time the bus
+ *        spent carrying them
+ *    \li The characters which were typed but didn't make it into the sentence
+ *
+ *    Each sentence is pasted in, a little faster than the serial line at 9600 baud
+ *    can carry it, so that it comes into the master back to back.
+ *
+ *    The benchmark runs when the environment variable HAL_SIM_BENCH is set, to "all"
+ *    for every sentence or to the name of one. It takes the terminal's place, so the
+ *    firmware's own messages aren't shown, and it ends the simulation when it's done.
+ *    A table goes to the standard error stream, and one line of JSON per sentence,
+ *    then one for all of them together, to the standard output, for example
+ *    \code
+ *    HAL_SIM_BENCH=all ./master_sim > bench.json
+ *    \endcode
+ *    The benchmark is only compiled when HAL_SIM is defined.
+ *
+ *  Revisions:
+ *    \li 10-16-2026 Original file
+ *    \li 10-16-2026 Bus time per letter
+ *    \li 10-16-2026 Sentences pasted at the line's full rate; dropped characters
+ *    \li 10-16-2026 Every field of the sentence table is given its starting value
+ *
+ *  License:
+ *    This file released under the Lesser GNU Public License, version 2. This program
+ *    is intended for educational use only, but it is not limited thereto.
+ */
+//*************************************************************************************
+
+#ifdef HAL_SIM
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../lib/hal_sim_dev.h"				// Hooks into the simulated master
+#include "../lib/hal.h"						// Codes of the firmware's events
+#include "slave_sim.h"						// Measurements of each letter
+
+
+/// Microseconds between runs of the benchmark, each of which types a burst of keys
+#define SENTENCE_BENCH_KEY_US		30000UL
+
+/// Keys pasted in each run, more than the line carries at 9600 baud in that time
+#define SENTENCE_BENCH_PASTE_KEYS	32
+
+/// Longest a sentence may take per character before the benchmark gives up on it
+#define SENTENCE_BENCH_CHAR_LIMIT_US	5000000UL
+
+/// Time allowed after the last sentence for its last letter to form
+#define SENTENCE_BENCH_SETTLE_US	3000000UL
+
+/// Most characters in a sentence, as MAX_SENTENCE_SIZE in task_user.h
+#define SENTENCE_BENCH_MAX_CHARS	255
+
+
+//-------------------------------------------------------------------------------------
+/** This structure holds one of the benchmark's sentences and what was measured when
+ *  it was spelled.
+ */
+
+typedef struct
+{
+	const char* p_name;						///< Name used to pick the sentence
+	const char* p_text;						///< The sentence, typed as it is
+	uint64_t start_us;						///< Time at which Enter was read
+	uint64_t done_us;						///< Time the last character was handed over
+	uint16_t first_letter;					///< Index of its first letter's measurements
+	uint16_t end_letter;					///< Index just past its last letter's
+	uint16_t dropped;						///< Characters typed but not in the sentence
+	bool run;								///< The sentence was chosen to be run
+	bool finished;							///< The user task got through the sentence
+} sentence_bench_corpus;
+
+
+/// The sentences: pangrams, digit strings, and one at the longest length allowed. The
+/// measurements start out zero and the sentences unchosen until the benchmark starts
+static sentence_bench_corpus corpora[] =
+{
+	{ "pangrams", "THE QUICK BROWN FOX JUMPS OVER THE LAZY DOG. PACK MY BOX WITH "
+				  "FIVE DOZEN LIQUOR JUGS. SPHINX OF BLACK QUARTZ, JUDGE MY VOW.",
+	  0, 0, 0, 0, 0, false, false },
+	{ "digits",   "0123456789 9876543210 3141592653 2718281828 1123581321",
+	  0, 0, 0, 0, 0, false, false },
+	{ "longest",  "SPELLING A LONG SENTENCE, ONE LETTER AT A TIME, SHOWS HOW FAST THE "
+				  "HAND CAN GO. SPELLING A LONG SENTENCE, ONE LETTER AT A TIME, SHOWS "
+				  "HOW FAST THE HAND CAN GO. SPELLING A LONG SENTENCE, ONE LETTER AT A "
+				  "TIME, SHOWS HOW FAST THE HAND CAN GO. SO THAT IS ALL.",
+	  0, 0, 0, 0, 0, false, false }
+};
+
+/// Number of sentences in the benchmark
+#define SENTENCE_BENCH_CORPORA	(sizeof (corpora) / sizeof (corpora[0]))
+
+
+/// The states of the benchmark
+typedef enum
+{
+	BENCH_TYPING,							///< Typing a sentence
+	BENCH_SPELLING,							///< Waiting for the hand to spell it
+	BENCH_SETTLING,							///< Waiting for the last letter to form
+} sentence_bench_state;
+
+static sentence_bench_state state = BENCH_TYPING;	///< What the benchmark is doing
+static uint8_t corpus = 0;					///< Index of the sentence being run
+static uint16_t typed = 0;					///< Characters of it typed so far
+static bool at_prompt = false;				///< The user task is at the sentence prompt
+static bool started = false;				///< The benchmark has taken the terminal
+static uint64_t deadline_us = 0;			///< Time at which the benchmark gives up
+static hal_sim_event_hook p_next_hook = NULL;	///< Event watcher set before this one
+
+
+//-------------------------------------------------------------------------------------
+/** This function finds the next sentence which was chosen to be run, starting from
+ *  the given one.
+ *  @param index The index of the first sentence to look at
+ *  @return The index of a chosen sentence, or SENTENCE_BENCH_CORPORA if none is left
+ */
+
+static uint8_t sentence_bench_next (uint8_t index)
+{
+	while (index < SENTENCE_BENCH_CORPORA && !corpora[index].run)
+	{
+		index++;
+	}
+	return (index);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function compares two latencies for qsort().
+ */
+
+static int sentence_bench_compare (const void* p_a, const void* p_b)
+{
+	uint64_t a = *(const uint64_t*)p_a;
+	uint64_t b = *(const uint64_t*)p_b;
+	return ((a > b) - (a < b));
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function finds a percentile of sorted latencies by the nearest rank method.
+ *  @param p_sorted The latencies, smallest first
+ *  @param count The number of latencies, at least one
+ *  @param percent The percentile
+ *  @return The latency in milliseconds
+ */
+
+static double sentence_bench_percentile (const uint64_t* p_sorted, uint16_t count,
+										 uint8_t percent)
+{
+	uint16_t rank = (uint16_t)((percent * (uint32_t)count + 99) / 100);
+	return (p_sorted[(rank ? rank : 1) - 1] / 1.0e3);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function works out and prints the results for a range of letters: one row of
+ *  the table on the standard error stream and one line of JSON on the standard
+ *  output.
+ *  @param p_name The name of the sentence, or "all"
+ *  @param p_letters The measurements of every letter
+ *  @param first The index of the first letter
+ *  @param end The index just past the last letter
+ *  @param spell_us The time taken to spell the letters
+ *  @param dropped The characters which were typed but lost
+ *  @param finished True if the hand got through all the sentences
+ */
+
+static void sentence_bench_print (const char* p_name, const slave_sim_letter* p_letters,
+								  uint16_t first, uint16_t end, uint64_t spell_us,
+								  uint16_t dropped, bool finished)
+{
+	static uint64_t latency[SLAVE_SIM_MAX_LETTERS];	// Each letter's latency, in us
+	uint16_t count = 0;
+	uint32_t bus_bytes = 0;
+	double bus_us = 0.0;
+	uint16_t unsettled = 0;
+
+	for (uint16_t index = first; index < end; index++)
+	{
+		const slave_sim_letter& letter = p_letters[index];
+		uint64_t formed_us = letter.last_byte_us;
+		if (letter.moved && letter.start_us + letter.settle_us > formed_us)
+		{
+			formed_us = letter.start_us + letter.settle_us;
+		}
+		latency[count++] = formed_us - letter.start_us;
+		bus_bytes += letter.bytes_down + letter.bytes_up;
+		bus_us += letter.bus_us;
+		if (letter.moved && !letter.settled)
+		{
+			unsettled++;
+		}
+	}
+	if (count == 0)
+	{
+		fprintf (stderr, "%-9s  no letters were spelled\n", p_name);
+		printf ("{\"corpus\": \"%s\", \"finished\": false, \"chars\": 0}\n", p_name);
+		return;
+	}
+	qsort (latency, count, sizeof (latency[0]), sentence_bench_compare);
+
+	double spell_s = spell_us / 1.0e6;
+	double per_min = spell_s > 0.0 ? count * 60.0 / spell_s : 0.0;
+	double p50 = sentence_bench_percentile (latency, count, 50);
+	double p90 = sentence_bench_percentile (latency, count, 90);
+	double p99 = sentence_bench_percentile (latency, count, 99);
+	double most = latency[count - 1] / 1.0e3;
+	double bytes_per = (double)bus_bytes / count;
+	double bus_ms_per = bus_us / 1.0e3 / count;
+
+	fprintf (stderr, "%-9s %5u %9.2f %8.1f %8.1f %8.1f %8.1f %8.1f %8.2f %8.2f %9u %7u%s\n",
+			 p_name, count, spell_s, per_min, p50, p90, p99, most, bytes_per, bus_ms_per,
+			 unsettled, dropped, finished ? "" : "  (gave up)");
+	printf ("{\"corpus\": \"%s\", \"finished\": %s, \"chars\": %u, \"seconds\": %.3f, "
+			"\"chars_per_min\": %.2f, \"latency_ms\": {\"p50\": %.2f, \"p90\": %.2f, "
+			"\"p99\": %.2f, \"max\": %.2f}, \"bus_bytes_per_letter\": %.2f, "
+			"\"bus_ms_per_letter\": %.2f, \"unsettled_letters\": %u, \"dropped_chars\": %u}\n",
+			p_name, finished ? "true" : "false", count, spell_s, per_min, p50, p90, p99,
+			most, bytes_per, bus_ms_per, unsettled, dropped);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function prints the results of every sentence which was run, then for all of
+ *  them together, and ends the simulation.
+ */
+
+static void sentence_bench_report (void)
+{
+	const slave_sim_letter* p_letters;
+	uint64_t total_us = 0;
+	uint16_t dropped = 0;
+	uint16_t first = 0;
+	uint16_t end = 0;
+	bool all_finished = true;
+
+	slave_sim_get_letters (&p_letters);
+
+	fprintf (stderr, "\nSentence benchmark\n");
+	fprintf (stderr, "Sentence  Chars   Seconds  Per min  p50 (ms) p90 (ms) p99 (ms) "
+			 "max (ms) Bytes/ch  Bus (ms) Unsettled Dropped\n");
+	for (uint8_t index = 0; index < SENTENCE_BENCH_CORPORA; index++)
+	{
+		sentence_bench_corpus& corpus = corpora[index];
+		if (!corpus.run)
+		{
+			continue;
+		}
+		uint64_t spell_us = (corpus.finished ? corpus.done_us : hal_sim_time_us ())
+							- corpus.start_us;
+		sentence_bench_print (corpus.p_name, p_letters, corpus.first_letter,
+							  corpus.end_letter, spell_us, corpus.dropped, corpus.finished);
+		total_us += spell_us;
+		dropped += corpus.dropped;
+		if (end == 0)
+		{
+			first = corpus.first_letter;
+		}
+		end = corpus.end_letter;
+		all_finished = all_finished && corpus.finished;
+	}
+	sentence_bench_print ("all", p_letters, first, end, total_us, dropped, all_finished);
+	fflush (stdout);
+	hal_sim_exit ();
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function is told of each HAL_EVENT() in the master firmware. It notes when
+ *  the user task starts and finishes a sentence, and which letters belong to it.
+ *  @param code The kind of event
+ *  @param value The value which goes with the event
+ */
+
+static void sentence_bench_event (uint8_t code, uint8_t value)
+{
+	const slave_sim_letter* p_letters;
+
+	if (started && state == BENCH_SPELLING)
+	{
+		sentence_bench_corpus& running = corpora[corpus];
+		if (code == HAL_EVENT_SENTENCE)
+		{
+			running.start_us = hal_sim_time_us ();
+			running.first_letter = slave_sim_get_letters (&p_letters);
+			running.dropped = strlen (running.p_text) - value;
+		}
+		else if (code == HAL_EVENT_SENTENCE_DONE)
+		{
+			running.done_us = hal_sim_time_us ();
+			running.end_letter = slave_sim_get_letters (&p_letters);
+			running.finished = true;
+
+			// The user task goes back to the sentence prompt for the next one
+			corpus = sentence_bench_next (corpus + 1);
+			typed = 0;
+			state = (corpus < SENTENCE_BENCH_CORPORA) ? BENCH_TYPING : BENCH_SETTLING;
+			deadline_us = running.done_us + SENTENCE_BENCH_SETTLE_US;
+		}
+	}
+	if (p_next_hook)
+	{
+		p_next_hook (code, value);
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function is run every SENTENCE_BENCH_KEY_US. It pastes the next few keys of
+ *  the current sentence, or checks whether the hand has taken too long over it.
+ *  @param now_us The simulated time
+ */
+
+static void sentence_bench_run (uint64_t now_us)
+{
+	const slave_sim_letter* p_letters;
+	uint8_t keys = 0;
+
+	if (!started)
+	{
+		hal_sim_take_terminal ();
+		slave_sim_no_letter_table ();
+		started = true;
+	}
+
+	switch (state)
+	{
+		case BENCH_TYPING:
+			if (!at_prompt)
+			{
+				hal_sim_receive (0, '\r');			// Enter at the menu starts a sentence
+				at_prompt = true;
+				break;
+			}
+			while (keys < SENTENCE_BENCH_PASTE_KEYS && corpora[corpus].p_text[typed])
+			{
+				hal_sim_receive (0, corpora[corpus].p_text[typed++]);
+				keys++;
+			}
+			if (keys < SENTENCE_BENCH_PASTE_KEYS)
+			{
+				hal_sim_receive (0, '\r');
+				state = BENCH_SPELLING;
+				corpora[corpus].start_us = now_us;
+				corpora[corpus].first_letter = slave_sim_get_letters (&p_letters);
+				corpora[corpus].end_letter = corpora[corpus].first_letter;
+				deadline_us = now_us + SENTENCE_BENCH_CHAR_LIMIT_US * typed;
+			}
+			break;
+
+		case BENCH_SPELLING:
+			if (now_us >= deadline_us)
+			{
+				corpora[corpus].end_letter = slave_sim_get_letters (&p_letters);
+				sentence_bench_report ();
+			}
+			break;
+
+		case BENCH_SETTLING:
+			if (now_us >= deadline_us)
+			{
+				sentence_bench_report ();
+			}
+			break;
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function hooks the benchmark into the simulation before main() runs, if the
+ *  environment variable HAL_SIM_BENCH asks for it.
+ */
+
+static void __attribute__ ((constructor)) sentence_bench_start (void)
+{
+	const char* p_env = getenv ("HAL_SIM_BENCH");
+	bool any = false;
+
+	if (p_env == NULL)
+	{
+		return;
+	}
+	for (uint8_t index = 0; index < SENTENCE_BENCH_CORPORA; index++)
+	{
+		corpora[index].run = !strcmp (p_env, "all")
+							 || !strcmp (p_env, corpora[index].p_name);
+		any = any || corpora[index].run;
+	}
+	if (!any)
+	{
+		fprintf (stderr, "HAL_SIM_BENCH must be \"all\" or one of:");
+		for (uint8_t index = 0; index < SENTENCE_BENCH_CORPORA; index++)
+		{
+			fprintf (stderr, " %s", corpora[index].p_name);
+		}
+		fprintf (stderr, "\n");
+		exit (1);
+	}
+
+	corpus = sentence_bench_next (0);
+	hal_sim_add_device (sentence_bench_run, SENTENCE_BENCH_KEY_US);
+	p_next_hook = hal_sim_set_event_hook (sentence_bench_event);
+}
+
+#endif // HAL_SIM
@@ -0,0 +1,71 @@
+//*************************************************************************************
+/** \file slave_chips.cpp
+ *    This file compiles the slave firmware from the slave project ten times, once for
+ *    each finger, so that the slave simulator can run ten independent slaves. Each
+ *    copy lives in a namespace of its own, slave_1 to slave_10, with its own
+ *    simulated ATtiny2313 named hal_chip, which the register names in the slave's
+ *    hal_sim.h refer to. The file is only compiled when HAL_SIM is defined.
+ *
+ *  Revisions:
+ *    \li 10-16-2026 Original file
+ *    \li 10-16-2026 Control loop interrupt
+ *    \li 10-16-2026 Receive interrupt
+ *
+ *  License:
+ *    This file released under the Lesser GNU Public License, version 2. This program
+ *    is intended for educational use only, but it is not limited thereto.
+ */
+//*************************************************************************************
+
+#ifdef HAL_SIM
+
+#include "../../../slave/slave/hal.h"		// The slave's simulated registers
+#include "slave_sim.h"
+
+
+namespace slave_1 { hal_sim_chip hal_chip;
+	#include "slave_firmware.h"
+}
+namespace slave_2 { hal_sim_chip hal_chip;
+	#include "slave_firmware.h"
+}
+namespace slave_3 { hal_sim_chip hal_chip;
+	#include "slave_firmware.h"
+}
+namespace slave_4 { hal_sim_chip hal_chip;
+	#include "slave_firmware.h"
+}
+namespace slave_5 { hal_sim_chip hal_chip;
+	#include "slave_firmware.h"
+}
+namespace slave_6 { hal_sim_chip hal_chip;
+	#include "slave_firmware.h"
+}
+namespace slave_7 { hal_sim_chip hal_chip;
+	#include "slave_firmware.h"
+}
+namespace slave_8 { hal_sim_chip hal_chip;
+	#include "slave_firmware.h"
+}
+namespace slave_9 { hal_sim_chip hal_chip;
+	#include "slave_firmware.h"
+}
+namespace slave_10 { hal_sim_chip hal_chip;
+	#include "slave_firmware.h"
+}
+
+
+/// This macro lists the chip and entry points of the copy of the firmware in a namespace
+#define SLAVE_SIM_ENTRY(name)	{ &name::hal_chip, name::slave_setup, name::slave_loop, \
+								  name::hal_sim_int0, name::hal_sim_int1, \
+								  name::hal_sim_timer1_compa, name::hal_sim_usart_rx }
+
+const slave_sim_firmware slave_sim_slaves[NUM_SLAVES] =
+{
+	SLAVE_SIM_ENTRY (slave_1), SLAVE_SIM_ENTRY (slave_2), SLAVE_SIM_ENTRY (slave_3),
+	SLAVE_SIM_ENTRY (slave_4), SLAVE_SIM_ENTRY (slave_5), SLAVE_SIM_ENTRY (slave_6),
+	SLAVE_SIM_ENTRY (slave_7), SLAVE_SIM_ENTRY (slave_8), SLAVE_SIM_ENTRY (slave_9),
+	SLAVE_SIM_ENTRY (slave_10)
+};
+
+#endif // HAL_SIM
@@ -0,0 +1,31 @@
+//*************************************************************************************
+/** \file slave_firmware.h
+ *    This file compiles one copy of the slave firmware. slave_chips.cpp includes it
+ *    once inside each slave's namespace, after defining that slave's hal_chip, so it
+ *    deliberately has no include guard. The slave's own headers do have guards, and
+ *    they're undone here so that each namespace gets its own motor, serial, pid and
+ *    profile classes. The firmware's hal.h and hal_sim.h have already been included outside
+ *    the namespaces and are not included again.
+ *
+ *  Revisions:
+ *    \li 10-16-2026 Original file
+ *    \li 10-16-2026 The slave's PID controller
+ *    \li 10-16-2026 The slave's motion profile
+ *
+ *  License:
+ *    This file released under the Lesser GNU Public License, version 2. This program
+ *    is intended for educational use only, but it is not limited thereto.
+ */
+//*************************************************************************************
+
+#undef _MOTOR_H_
+#undef _SERIAL_H_
+#undef _PID_H_
+#undef _PROFILE_H_
+#undef _ANGLES_H_
+
+#include "../../../slave/slave/motor.cpp"
+#include "../../../slave/slave/serial.cpp"
+#include "../../../slave/slave/pid.cpp"
+#include "../../../slave/slave/profile.cpp"
+#include "../../../slave/slave/slave.cpp"
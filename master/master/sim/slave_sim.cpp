@@ -0,0 +1,607 @@
+//*************************************************************************************
+/** \file slave_sim.cpp
+ *    This file contains the slave simulator, which runs the ten finger slaves, their
+ *    fingers and the slave bus alongside the simulated master and measures how long
+ *    each letter takes to form. See slave_sim.h for what it models and measures. It
+ *    hooks itself into the master's simulation before main() runs, and is only
+ *    compiled when HAL_SIM is defined.
+ *
+ *  Revisions:
+ *    \li 10-16-2026 Original file
+ *    \li 10-16-2026 Letters' measurements are given to the sentence benchmark
+ *    \li 10-16-2026 Each slave's timer 0 runs, for the control loop's tick
+ *    \li 10-16-2026 Time each finger took to form the letter, for the transition check
+ *    \li 10-16-2026 The slaves' ready pins drive the master's ready line
+ *    \li 10-16-2026 Receive interrupt; bus time taken by each letter
+ *
+ *  License:
+ *    This file released under the Lesser GNU Public License, version 2. This program
+ *    is intended for educational use only, but it is not limited thereto.
+ */
+//*************************************************************************************
+
+#ifdef HAL_SIM
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "../lib/hal_sim_dev.h"				// Hooks into the simulated master
+#include "../lib/hal.h"						// Codes of the firmware's events
+#include "../../../slave/slave/hal_sim_chip.h"	// The simulated slave chips
+#include "finger_model.h"
+#include "slave_sim.h"
+
+
+/// Bytes which can be on their way from the master to one slave at once
+#define SLAVE_SIM_WIRE_SIZE		16
+
+/// The slave's bits which the simulator drives and watches
+#define SLAVE_SIM_PIN_A			0x04		///< Encoder channel A on PD2, INT0
+#define SLAVE_SIM_PIN_B			0x08		///< Encoder channel B on PD3, INT1
+#define SLAVE_SIM_PIN_PWM		0x04		///< Bridge enable on PB2, OC0A
+#define SLAVE_SIM_PIN_INA		0x02		///< Bridge input A on PB1
+#define SLAVE_SIM_PIN_INB		0x01		///< Bridge input B on PB0
+#define SLAVE_SIM_PIN_READY		0x10		///< Open drain ready line on PD4
+#define SLAVE_SIM_MASTER_READY	0x01		///< The master's ready line pin, PD0
+#define SLAVE_SIM_GIMSK_INT0	0x40		///< INT0 enable in GIMSK
+#define SLAVE_SIM_GIMSK_INT1	0x80		///< INT1 enable in GIMSK
+#define SLAVE_SIM_COM0A1		0x80		///< OC0A connected to the timer, in TCCR0A
+#define SLAVE_SIM_TIFR_OCF1A	0x40		///< Timer 1 compare match A flag in TIFR
+#define SLAVE_SIM_TIMSK_OCIE1A	0x40		///< Timer 1 compare match A enable in TIMSK
+
+
+//-------------------------------------------------------------------------------------
+/** This structure holds what the simulator keeps for each slave besides its chip: the
+ *  finger it moves, the bytes coming to it on the bus, and the measurements of the
+ *  letter being formed.
+ */
+
+typedef struct
+{
+	finger_model finger;					///< The finger the slave's motor moves
+	bool started;							///< The firmware's setup code has run
+	uint64_t sleep_cycles;					///< Clock cycles the slave has spent asleep
+	uint64_t wire_due[SLAVE_SIM_WIRE_SIZE];	///< Cycle at which each byte arrives
+	uint8_t wire_byte[SLAVE_SIM_WIRE_SIZE];	///< The bytes on their way
+	double wire_byte_us[SLAVE_SIM_WIRE_SIZE];	///< Time the sender took for each byte
+	uint8_t wire_head;						///< Index where the next byte is put
+	uint8_t wire_tail;						///< Index of the next byte to arrive
+	double start;							///< Position when the letter started
+	double low;								///< Lowest position during the letter
+	double high;							///< Highest position during the letter
+	double anchor;							///< Position when the finger last moved
+	uint64_t last_move_us;					///< Time at which the finger last moved
+	double formed_anchor;					///< Position when it last moved a long way
+	uint64_t formed_us;						///< Time at which it last moved a long way
+	bool moved;								///< The finger has moved during the letter
+} slave_sim_slave;
+
+
+static slave_sim_slave slaves[NUM_SLAVES];	///< The simulator's side of each slave
+static uint8_t slave_count = NUM_SLAVES;	///< Number of slaves which are plugged in
+static slave_sim_letter letters[SLAVE_SIM_MAX_LETTERS];	///< Measurements of letters
+static uint16_t letter_count = 0;			///< Number of letters started so far
+static uint32_t bytes_down = 0;				///< Bytes the master has sent
+static uint32_t bytes_up = 0;				///< Bytes the slaves have sent
+static double busy_down_us = 0.0;			///< Time the master has spent sending
+static double busy_up_us = 0.0;				///< Time the slaves have spent sending
+static uint32_t lost_down = 0;				///< Master's bytes no slave was listening to
+static uint32_t lost_up = 0;				///< Slaves' bytes sent while not selected
+static hal_sim_event_hook p_next_hook = NULL;	///< Event watcher set before this one
+static bool letter_table = true;			///< Print each letter in the report
+
+
+//-------------------------------------------------------------------------------------
+/** This function garbles a byte which was sent at a baud rate the receiver isn't
+ *  set to, as though the receiver had sampled each bit a bit time late.
+ *  @param byte The byte which was sent
+ *  @return The byte which arrives
+ */
+
+static uint8_t slave_sim_garble (uint8_t byte)
+{
+	return ((byte >> 1) | 0x80);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function checks whether a byte sent at one baud rate can be read correctly by
+ *  a receiver set to another.
+ *  @param sent_us The time the sender takes for a byte
+ *  @param read_us The time the receiver expects a byte to take
+ *  @return True if the rates are close enough for the byte to get through
+ */
+
+static bool slave_sim_baud_match (double sent_us, double read_us)
+{
+	return (fabs (sent_us - read_us) <= SLAVE_SIM_BAUD_TOLERANCE * read_us);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function finds the multiplexer channel selected by the master's slave picker
+ *  on the low four bits of port A.
+ *  @return The channel, 0 for the broadcast channel or 1 to 10 for a slave
+ */
+
+static uint8_t slave_sim_channel (void)
+{
+	return (hal_sim_read_port ('A') & 0x0F);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function is given each byte the master sends on USART 1. It puts the byte on
+ *  the wire to each slave the multiplexer connects to the master's transmitter; the
+ *  byte arrives one byte time later.
+ *  @param byte The byte the master has started to send
+ */
+
+static void slave_sim_from_master (uint8_t byte)
+{
+	double byte_us = hal_sim_byte_time_us (1);
+	uint64_t due = (uint64_t)((hal_sim_time_us () + byte_us) * (SLAVE_SIM_CPU_HZ / 1.0e6));
+	uint8_t channel = slave_sim_channel ();
+	bool heard = false;
+
+	bytes_down++;
+	busy_down_us += byte_us;
+	if (letter_count)
+	{
+		letters[letter_count - 1].bytes_down++;
+		letters[letter_count - 1].bus_us += byte_us;
+		letters[letter_count - 1].last_byte_us = (uint64_t)(hal_sim_time_us () + byte_us);
+	}
+
+	for (uint8_t index = 0; index < slave_count; index++)
+	{
+		slave_sim_slave& slave = slaves[index];
+		if ((channel == SLAVE_BROADCAST || channel == index + 1)
+			&& (uint8_t)((slave.wire_head + 1) % SLAVE_SIM_WIRE_SIZE) != slave.wire_tail)
+		{
+			slave.wire_due[slave.wire_head] = due;
+			slave.wire_byte[slave.wire_head] = byte;
+			slave.wire_byte_us[slave.wire_head] = byte_us;
+			slave.wire_head = (slave.wire_head + 1) % SLAVE_SIM_WIRE_SIZE;
+			heard = true;
+		}
+	}
+	if (!heard)
+	{
+		lost_down++;
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function finds how the slave's motor pins drive the H-bridge. The bridge is
+ *  enabled by the PWM output on OC0A, or by PB2 itself if the timer isn't connected.
+ *  @param chip The slave's chip
+ *  @param drive Set to the fraction of full voltage across the motor, from -1 to 1
+ *  @param brake Set to how hard the bridge shorts the motor, from 0 to 1
+ */
+
+static void slave_sim_bridge (hal_sim_chip& chip, double& drive, double& brake)
+{
+	double duty;
+
+	if ((chip.TCCR0A.value & SLAVE_SIM_COM0A1) && (chip.TCCR0B.value & 0x07))
+	{
+		duty = chip.OCR0A.value / 255.0;
+	}
+	else
+	{
+		duty = (chip.PORTB.value & SLAVE_SIM_PIN_PWM) ? 1.0 : 0.0;
+	}
+
+	bool in_a = chip.PORTB.value & SLAVE_SIM_PIN_INA;
+	bool in_b = chip.PORTB.value & SLAVE_SIM_PIN_INB;
+	if (in_a != in_b)
+	{
+		drive = in_a ? duty : -duty;
+		brake = 0.0;
+	}
+	else
+	{
+		drive = 0.0;
+		brake = duty;
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function runs one slave until its clock catches up with the master's: it
+ *  passes bytes between the slave and the bus, moves the finger, calls the encoder
+ *  interrupts, and runs the firmware's main loop over and over.
+ *  @param index The slave's index, 0 for slave 1
+ *  @param until The cycle count at which to stop
+ *  @param channel The multiplexer channel the master has selected
+ */
+
+static void slave_sim_run_slave (uint8_t index, uint64_t until, uint8_t channel)
+{
+	const slave_sim_firmware& firmware = slave_sim_slaves[index];
+	hal_sim_chip& chip = *firmware.p_chip;
+	slave_sim_slave& slave = slaves[index];
+	double drive, brake;
+
+	if (!slave.started)
+	{
+		chip.cycles = until;
+		firmware.p_setup ();
+		slave.started = true;
+	}
+
+	while (chip.cycles < until)
+	{
+		// Bytes from the master which have finished arriving
+		while (slave.wire_tail != slave.wire_head
+			   && slave.wire_due[slave.wire_tail] <= chip.cycles)
+		{
+			uint8_t byte = slave.wire_byte[slave.wire_tail];
+			double read_us = chip.byte_cycles () / (SLAVE_SIM_CPU_HZ / 1.0e6);
+			if (slave_sim_baud_match (slave.wire_byte_us[slave.wire_tail], read_us))
+			{
+				chip.receive (byte, false);
+			}
+			else
+			{
+				chip.receive (slave_sim_garble (byte), true);
+			}
+			slave.wire_tail = (slave.wire_tail + 1) % SLAVE_SIM_WIRE_SIZE;
+		}
+
+		// A byte waiting in the receiver wakes the CPU if its interrupt is on
+		if ((chip.UCSRA.value & HAL_SIM_RXC) && (chip.UCSRB.value & HAL_SIM_RXCIE))
+		{
+			chip.interrupt (firmware.p_usart_rx);
+		}
+
+		// A byte which has finished going out reaches the master if it's listening
+		if (chip.xmt_count && chip.xmt_done <= chip.cycles)
+		{
+			double byte_us = chip.byte_cycles () / (SLAVE_SIM_CPU_HZ / 1.0e6);
+			uint8_t byte = chip.transmitted ();
+			bytes_up++;
+			busy_up_us += byte_us;
+			if (letter_count)
+			{
+				letters[letter_count - 1].bytes_up++;
+				letters[letter_count - 1].bus_us += byte_us;
+			}
+			if (channel != index + 1)
+			{
+				lost_up++;
+			}
+			else if (slave_sim_baud_match (byte_us, hal_sim_byte_time_us (1)))
+			{
+				hal_sim_receive (1, byte);
+			}
+			else
+			{
+				hal_sim_receive (1, slave_sim_garble (byte));
+			}
+		}
+
+		// The finger moves, and the firmware sees each encoder edge in turn
+		slave_sim_bridge (chip, drive, brake);
+		slave.finger.run ((double)SLAVE_SIM_LOOP_CYCLES / SLAVE_SIM_CPU_HZ, drive, brake);
+		while (slave.finger.encoder_edge ())
+		{
+			uint8_t reading = slave.finger.encoder_reading ();
+			uint8_t pins = ((reading & 0x02) ? SLAVE_SIM_PIN_A : 0)
+						   | ((reading & 0x01) ? SLAVE_SIM_PIN_B : 0);
+			uint8_t changed = (chip.PIND.value ^ pins) & (SLAVE_SIM_PIN_A | SLAVE_SIM_PIN_B);
+			chip.PIND.value = (chip.PIND.value & ~changed) | pins;
+			if ((changed & SLAVE_SIM_PIN_A) && (chip.GIMSK.value & SLAVE_SIM_GIMSK_INT0))
+			{
+				chip.interrupt (firmware.p_int0);
+			}
+			if ((changed & SLAVE_SIM_PIN_B) && (chip.GIMSK.value & SLAVE_SIM_GIMSK_INT1))
+			{
+				chip.interrupt (firmware.p_int1);
+			}
+		}
+
+		// The control interrupt, which takes its time before the main loop goes on
+		if ((chip.TIFR.value & SLAVE_SIM_TIFR_OCF1A)
+			&& (chip.TIMSK.value & SLAVE_SIM_TIMSK_OCIE1A) && (chip.SREG.value & HAL_SIM_SREG_I))
+		{
+			chip.TIFR.value &= ~SLAVE_SIM_TIFR_OCF1A;
+			chip.cycles += SLAVE_SIM_CONTROL_CYCLES;
+			chip.count_timer0 (SLAVE_SIM_CONTROL_CYCLES);
+			chip.count_timer1 (SLAVE_SIM_CONTROL_CYCLES);
+			chip.interrupt (firmware.p_timer1);
+		}
+
+		if (chip.sleeping)
+		{
+			slave.sleep_cycles += SLAVE_SIM_LOOP_CYCLES;
+		}
+		else
+		{
+			firmware.p_loop ();
+		}
+		chip.cycles += SLAVE_SIM_LOOP_CYCLES;
+		chip.count_timer0 (SLAVE_SIM_LOOP_CYCLES);
+		chip.count_timer1 (SLAVE_SIM_LOOP_CYCLES);
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function follows one finger during a letter. The finger is taken to have
+ *  moved whenever it gets more than SLAVE_SIM_SETTLE_BAND counts from where it last
+ *  moved, so the time of its last move is the time at which it settled.
+ *  @param slave The simulator's side of the slave
+ *  @param now_us The simulated time
+ */
+
+static void slave_sim_measure (slave_sim_slave& slave, uint64_t now_us)
+{
+	double position = slave.finger.get_position ();
+
+	if (position < slave.low)
+	{
+		slave.low = position;
+	}
+	if (position > slave.high)
+	{
+		slave.high = position;
+	}
+	if (fabs (position - slave.anchor) > SLAVE_SIM_SETTLE_BAND)
+	{
+		slave.anchor = position;
+		slave.last_move_us = now_us;
+		slave.moved = true;
+	}
+	if (fabs (position - slave.formed_anchor) > SLAVE_SIM_FORMED_BAND)
+	{
+		slave.formed_anchor = position;
+		slave.formed_us = now_us;
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function is run by the master's simulation every SLAVE_SIM_PERIOD_US. It
+ *  brings each slave up to the present time, takes the measurements, and puts the
+ *  ready line on the master's pin: high, from its pull-up, unless a slave has made
+ *  its ready pin an output to pull it low.
+ *  @param now_us The simulated time
+ */
+
+static void slave_sim_run (uint64_t now_us)
+{
+	uint64_t until = now_us * (SLAVE_SIM_CPU_HZ / 1000000UL);
+	uint8_t channel = slave_sim_channel ();
+	bool ready = true;
+
+	for (uint8_t index = 0; index < slave_count; index++)
+	{
+		slave_sim_run_slave (index, until, channel);
+		slave_sim_measure (slaves[index], now_us);
+
+		const hal_sim_chip& chip = *slave_sim_slaves[index].p_chip;
+		if ((chip.DDRD.value & SLAVE_SIM_PIN_READY) && !(chip.PORTD.value & SLAVE_SIM_PIN_READY))
+		{
+			ready = false;
+		}
+	}
+	hal_sim_drive_port ('D', SLAVE_SIM_MASTER_READY, ready ? SLAVE_SIM_MASTER_READY : 0);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function finishes the measurements of the letter being formed, if there is
+ *  one. A finger which moved within the last SLAVE_SIM_SETTLE_BAND counts' worth of
+ *  time at full speed is taken to be still moving.
+ *  @param now_us The simulated time at which the letter ends
+ */
+
+static void slave_sim_end_letter (uint64_t now_us)
+{
+	if (letter_count == 0)
+	{
+		return;
+	}
+	slave_sim_letter& letter = letters[letter_count - 1];
+	uint64_t quiet_us = (uint64_t)(1.0e6 * SLAVE_SIM_SETTLE_BAND / FINGER_MAX_SPEED) * 10;
+
+	letter.settle_us = 0;
+	letter.overshoot = 0.0;
+	letter.moved = false;
+	letter.settled = true;
+	for (uint8_t index = 0; index < slave_count; index++)
+	{
+		slave_sim_slave& slave = slaves[index];
+		letter.finger_formed_us[index] = 0;
+		if (!slave.moved)
+		{
+			continue;
+		}
+		letter.moved = true;
+		letter.finger_formed_us[index] = (uint32_t)(slave.formed_us - letter.start_us);
+		if (slave.last_move_us - letter.start_us > letter.settle_us)
+		{
+			letter.settle_us = slave.last_move_us - letter.start_us;
+		}
+		if (now_us - slave.last_move_us < quiet_us
+			|| fabs (slave.finger.get_speed ()) > FINGER_MAX_SPEED / 100.0)
+		{
+			letter.settled = false;
+		}
+
+		// Overshoot is measured past the final position, in the direction of motion
+		double final_position = slave.finger.get_position ();
+		double past = 0.0;
+		if (final_position > slave.start)
+		{
+			past = slave.high - final_position;
+		}
+		else if (final_position < slave.start)
+		{
+			past = final_position - slave.low;
+		}
+		if (past > letter.overshoot)
+		{
+			letter.overshoot = past;
+		}
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function is told of each HAL_EVENT() in the master firmware. A new letter
+ *  ends the measurements of the one before and starts its own.
+ *  @param code The kind of event
+ *  @param value The value which goes with the event
+ */
+
+static void slave_sim_event (uint8_t code, uint8_t value)
+{
+	if (code == HAL_EVENT_LETTER && letter_count < SLAVE_SIM_MAX_LETTERS)
+	{
+		uint64_t now_us = hal_sim_time_us ();
+
+		slave_sim_end_letter (now_us);
+		slave_sim_letter& letter = letters[letter_count++];
+		letter.letter = value;
+		letter.start_us = now_us;
+		letter.bytes_down = 0;
+		letter.bytes_up = 0;
+		letter.bus_us = 0.0;
+		letter.last_byte_us = now_us;
+
+		for (uint8_t index = 0; index < slave_count; index++)
+		{
+			slave_sim_slave& slave = slaves[index];
+			slave.start = slave.low = slave.high = slave.anchor
+				= slave.finger.get_position ();
+			slave.formed_anchor = slave.anchor;
+			slave.last_move_us = slave.formed_us = now_us;
+			slave.moved = false;
+		}
+	}
+	if (p_next_hook)
+	{
+		p_next_hook (code, value);
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function prints the measurements of each letter on the standard error stream.
+ */
+
+static void slave_sim_print_letters (void)
+{
+	fprintf (stderr, "Letter  Start (s)  Settle (ms)  Overshoot  Bytes out  Bytes in\n");
+	for (uint16_t index = 0; index < letter_count; index++)
+	{
+		slave_sim_letter& letter = letters[index];
+		fprintf (stderr, "  %c   %10.3f  ", (letter.letter > ' ' && letter.letter < 127)
+				 ? letter.letter : ' ', letter.start_us / 1.0e6);
+		if (letter.moved)
+		{
+			fprintf (stderr, "%10.1f%c  %9.1f", letter.settle_us / 1.0e3,
+					 letter.settled ? ' ' : '*', letter.overshoot);
+		}
+		else
+		{
+			fprintf (stderr, "%10s   %9s", "-", "-");
+		}
+		fprintf (stderr, "  %9lu  %8lu\n", (unsigned long)letter.bytes_down,
+				 (unsigned long)letter.bytes_up);
+	}
+	fprintf (stderr, "(- no finger moved; * still moving when the next letter came)\n");
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function prints the measurements on the standard error stream when the
+ *  simulation ends.
+ */
+
+static void slave_sim_report (void)
+{
+	uint64_t now_us = hal_sim_time_us ();
+	uint32_t overruns = 0;
+	uint32_t collisions = 0;
+	uint64_t sleep_cycles = 0;
+
+	slave_sim_end_letter (now_us);
+	for (uint8_t index = 0; index < slave_count; index++)
+	{
+		overruns += slave_sim_slaves[index].p_chip->overruns;
+		collisions += slave_sim_slaves[index].p_chip->collisions;
+		sleep_cycles += slaves[index].sleep_cycles;
+	}
+
+	fprintf (stderr, "\nSlave simulator, %u slaves\n", slave_count);
+	if (letter_table)
+	{
+		slave_sim_print_letters ();
+	}
+
+	double elapsed_us = now_us ? (double)now_us : 1.0;
+	fprintf (stderr, "Bus to slaves:   %lu bytes, %.1f%% busy, %lu heard by no slave\n",
+			 (unsigned long)bytes_down, 100.0 * busy_down_us / elapsed_us,
+			 (unsigned long)lost_down);
+	fprintf (stderr, "Bus from slaves: %lu bytes, %.1f%% busy, %lu sent while not "
+			 "selected\n", (unsigned long)bytes_up, 100.0 * busy_up_us / elapsed_us,
+			 (unsigned long)lost_up);
+	fprintf (stderr, "Slave receiver overruns: %lu, bytes written to a full "
+			 "transmitter: %lu\n", (unsigned long)overruns, (unsigned long)collisions);
+	fprintf (stderr, "Slaves asleep %.1f%% of the time\n", 100.0 * sleep_cycles
+			 / (elapsed_us * slave_count * (SLAVE_SIM_CPU_HZ / 1.0e6)));
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function finishes the measurements of the letter being formed, so far, and
+ *  gives the measurements of every letter. It's used by a harness which makes its own
+ *  report from them, such as the sentence benchmark.
+ *  @param pp_letters Set to point to the measurements, oldest letter first
+ *  @return The number of letters measured
+ */
+
+uint16_t slave_sim_get_letters (const slave_sim_letter** pp_letters)
+{
+	slave_sim_end_letter (hal_sim_time_us ());
+	*pp_letters = letters;
+	return (letter_count);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function leaves the table of letters out of the report printed at the end of
+ *  the simulation, for a harness which prints its own.
+ */
+
+void slave_sim_no_letter_table (void)
+{
+	letter_table = false;
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function hooks the slave simulator into the master's simulation before
+ *  main() runs.
+ */
+
+static void __attribute__ ((constructor)) slave_sim_start (void)
+{
+	const char* p_env = getenv ("SLAVE_SIM_COUNT");
+	if (p_env && atoi (p_env) >= 0 && atoi (p_env) <= NUM_SLAVES)
+	{
+		slave_count = atoi (p_env);
+	}
+
+	hal_sim_set_uart_sink (1, slave_sim_from_master);
+	hal_sim_add_device (slave_sim_run, SLAVE_SIM_PERIOD_US);
+	p_next_hook = hal_sim_set_event_hook (slave_sim_event);
+	atexit (slave_sim_report);
+}
+
+#endif // HAL_SIM
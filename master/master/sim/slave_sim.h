@@ -0,0 +1,138 @@
+//*************************************************************************************
+/** \file slave_sim.h
+ *    This file contains the interface between the slave simulator and the copies of
+ *    the slave firmware it runs. slave_chips.cpp compiles the slave's own source
+ *    files from the slave project once for each finger, each copy in a namespace of
+ *    its own with its own simulated ATtiny2313, and lists them in slave_sim_slaves.
+ *    slave_sim.cpp runs them alongside the simulated master:
+ *    \li Each slave's clock runs at SLAVE_SIM_CPU_HZ. The firmware's main loop is
+ *        called over and over, each pass being charged SLAVE_SIM_LOOP_CYCLES, until
+ *        the firmware puts the chip to sleep; then the loop waits for an interrupt
+ *    \li Timer 1's compare match interrupt runs the control loop. Each run is
+ *        charged SLAVE_SIM_CONTROL_CYCLES, an estimate of what it takes on the chip
+ *    \li A received byte calls the USART's receive interrupt, if it's turned on
+ *    \li The slave's motor pins drive a finger_model, and the model's encoder edges
+ *        call the slave's encoder interrupt
+ *    \li The slaves share the master's USART 1 through the multiplexer on port A:
+ *        what the master sends on channel n reaches slave n, on channel 0 it reaches
+ *        them all, and only the selected slave's answers reach the master. A byte
+ *        sent at a baud rate which differs from the receiver's by more than
+ *        SLAVE_SIM_BAUD_TOLERANCE arrives garbled, with a frame error
+ *    \li The slaves' ready pins, PD4, are wired together to the master's ready line
+ *        pin and pulled up, so the master reads it low while any slave pulls it low
+ *
+ *    While the simulation runs, the simulator measures how each letter is formed and
+ *    prints a report on the standard error stream when the simulation ends. A letter
+ *    lasts from the moment the output task is given it (HAL_EVENT_LETTER) until the
+ *    next letter. For each letter the report gives:
+ *    \li The settle time, from the start of the letter until the last finger came to
+ *        rest within SLAVE_SIM_SETTLE_BAND counts of where it stopped
+ *    \li The overshoot, the furthest any finger went past where it stopped
+ *    \li The time each finger took to come within SLAVE_SIM_FORMED_BAND counts of 
+ *        where it stopped, which is when it's in place as far as anyone watching the
+ *        hand can tell
+ *    \li The bytes sent each way on the slave bus during the letter, and the time
+ *        the bus spent carrying them
+ *    and at the end, how busy the bus was in each direction, how many bytes were
+ *    lost, and how much of the time the slaves slept. The environment variable SLAVE_SIM_COUNT can make fewer slaves answer, as
+ *    if the rest were unplugged.
+ *
+ *  Revisions:
+ *    \li 10-16-2026 Original file
+ *    \li 10-16-2026 Letters' measurements are given to the sentence benchmark
+ *    \li 10-16-2026 Control interrupt from timer 1; slaves sleep between interrupts
+ *    \li 10-16-2026 Time each finger took to form the letter, for the transition check
+ *    \li 10-16-2026 Ready line
+ *    \li 10-16-2026 Receive interrupt; bus time taken by each letter
+ *
+ *  License:
+ *    This file released under the Lesser GNU Public License, version 2. This program
+ *    is intended for educational use only, but it is not limited thereto.
+ */
+//*************************************************************************************
+
+/// This define prevents this .h file from being included more than once in a .cc file
+#ifndef _SLAVE_SIM_H_
+#define _SLAVE_SIM_H_
+
+#include <stdint.h>
+#include "../slave_protocol.h"				// Number of slaves on the bus
+
+
+/// The slaves' clock rate, the same as CPU_FREQ_Hz in the slave's serial.h
+#define SLAVE_SIM_CPU_HZ			20000000UL
+
+/// Clock cycles charged for each pass through the slave's main loop
+#define SLAVE_SIM_LOOP_CYCLES		200
+
+/// Clock cycles charged for each run of the control interrupt, estimated for the PID
+/// controller's software multiplies on a chip with no multiplier
+#define SLAVE_SIM_CONTROL_CYCLES	700
+
+/// Microseconds of simulated time between runs of the slave simulator
+#define SLAVE_SIM_PERIOD_US			100
+
+/// Largest fractional difference of two baud rates which still gets bytes through
+#define SLAVE_SIM_BAUD_TOLERANCE	0.04
+
+/// A finger within this many counts of where it stops is taken to have settled
+#define SLAVE_SIM_SETTLE_BAND		2.0
+
+/// A finger within this many counts of where it stops is taken to be in place, though
+/// the PID controller may still be easing it in
+#define SLAVE_SIM_FORMED_BAND		8.0
+
+/// The most letters the report has room for
+#define SLAVE_SIM_MAX_LETTERS		2048
+
+
+//-------------------------------------------------------------------------------------
+/** This structure holds the entry points of one copy of the slave firmware and the
+ *  simulated chip on which it runs.
+ */
+
+struct hal_sim_chip;
+
+typedef struct
+{
+	hal_sim_chip* p_chip;					///< The simulated ATtiny2313
+	void (*p_setup)(void);					///< Setup code run once after reset
+	void (*p_loop)(void);					///< One pass through the main loop
+	void (*p_int0)(void);					///< Encoder channel A interrupt
+	void (*p_int1)(void);					///< Encoder channel B interrupt
+	void (*p_timer1)(void);					///< Control loop interrupt, timer 1 compare A
+	void (*p_usart_rx)(void);				///< USART receive complete interrupt
+} slave_sim_firmware;
+
+/// The copies of the slave firmware, slave 1 first
+extern const slave_sim_firmware slave_sim_slaves[NUM_SLAVES];
+
+
+//-------------------------------------------------------------------------------------
+/** This structure holds the measurements of one letter.
+ */
+
+typedef struct
+{
+	uint8_t letter;							///< The character being formed
+	uint64_t start_us;						///< Time at which the output task got it
+	uint64_t settle_us;						///< Time the last finger took to settle
+	uint32_t finger_formed_us[NUM_SLAVES];	///< Time each finger took to get within 
+											///< SLAVE_SIM_FORMED_BAND, 0 if it didn't move
+	uint64_t last_byte_us;					///< Time the last byte to the slaves arrived
+	double overshoot;						///< Furthest a finger went past its stop
+	uint32_t bytes_down;					///< Bytes sent from the master to slaves
+	uint32_t bytes_up;						///< Bytes sent from the slaves to the master
+	double bus_us;							///< Time the bus spent carrying those bytes
+	bool moved;								///< Some finger moved during the letter
+	bool settled;							///< All fingers were still at the end
+} slave_sim_letter;
+
+
+// Finish the letter being measured and find the measurements of all the letters
+uint16_t slave_sim_get_letters (const slave_sim_letter**);
+
+// Leave the table of letters out of the report at the end of the simulation
+void slave_sim_no_letter_table (void);
+
+#endif // _SLAVE_SIM_H_
@@ -0,0 +1,804 @@
+//*************************************************************************************
+/** \file transition_model.cpp
+ *    This file contains the model of how long the hand takes to change from one hand
+ *    shape to another, which makes the table in transition_table.cpp, and a check of
+ *    that table against the simulated slaves. For each change the model works out:
+ *    \li Where every finger is, from the steps of the first shape; a finger which
+ *        that shape leaves alone could be anywhere, so it's taken to be as far from
+ *        its new count as it could be
+ *    \li Which interfering fingers have to go first, as task_output's planner does,
+ *        and how long the rest of the step waits for them
+ *    \li How long each finger takes to reach its new count along the slaves' motion
+ *        profile, at the profile's speed limit or the motor's top speed if that's
+ *        lower, speeding up and slowing down at the profile's acceleration
+ *    \li How long the output task and the slave bus take to get each step out
+ *    and the time for the change is that of the slowest finger, plus an allowance for
+ *    the motor and the PID controller to bring it in.
+ *
+ *    The environment variable HAL_SIM_TRANSITIONS picks what's done:
+ *    \li "table" prints a new transition_table.cpp on the standard output, then ends
+ *    \code
+ *    HAL_SIM_TRANSITIONS=table ./master_sim > transition_table.cpp
+ *    \endcode
+ *    \li "check" has the hand spell a sequence holding every one of the 36 x 36
+ *        changes once, timed by the table in the firmware as it would be in use, and
+ *        compares the time each letter took to form with the table's time for it.
+ *        A letter is formed when every finger it commands has come within
+ *        SLAVE_SIM_FORMED_BAND counts of where it stops. A summary goes to the
+ *        standard error stream and a line of JSON to the standard output, and the
+ *        program's exit status is 1 if any letter took longer than the table allows,
+ *        0 if none did
+ *    \li "latency" works out the time for every one of the 36 x 36 changes three
+ *        times, with the slave bus driven each of the ways it has been: each finger
+ *        slave picked in turn and sent one set point byte, starting to move as soon
+ *        as its own byte came in; each step in one broadcast set point frame; and each
+ *        step in one target frame, as it is now. Everything else is modelled the same
+ *        each time. A summary goes to the standard error stream and a line of JSON to
+ *        the standard output
+ *
+ *    The model and the check are only compiled when HAL_SIM is defined.
+ *
+ *  Revisions:
+ *    \li 10-16-2026 Original file
+ *    \li 10-16-2026 Settle allowance raised, as letters now start as soon as the one
+ *                    before is in position and the fingers begin from nearer rest
+ *    \li 10-16-2026 Letter to letter latency with each way of driving the slave bus
+ *    \li 10-16-2026 A group of fingers which an earlier letter left in the way and the
+ *                    first shape doesn't move as a whole is taken to be in the way still
+ *
+ *  License:
+ *    This file released under the Lesser GNU Public License, version 2. This program
+ *    is intended for educational use only, but it is not limited thereto.
+ */
+//*************************************************************************************
+
+#ifdef HAL_SIM
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "../lib/hal_sim_dev.h"				// Hooks into the simulated master
+#include "../lib/hal.h"
+#include "../lib/rs232int.h"
+#include "../lib/stl_timer.h"
+#include "../lib/stl_task.h"
+#include "../slave_picker.h"
+#include "../slave_protocol.h"				// Target frame size
+#include "../gesture.h"						// Gesture steps and finger counts
+#include "../character_database.h"			// Gestures for every character
+#include "../task_output.h"					// The planner's clearing distance and rate
+#include "../transition.h"					// The table being made or checked
+#include "../../../slave/slave/profile.h"	// The slaves' motion profile limits
+#include "finger_model.h"					// The motor's top speed
+#include "slave_sim.h"						// Measurements of each letter
+
+
+/// Milliseconds from a letter being given to the output task until its first step is
+/// sent, the output task running from state 0 through state 1 to state 2
+#define TRANSITION_MODEL_START_MS	20.0
+
+/// Milliseconds the slave bus takes to carry a target frame at 9600 baud
+#define TRANSITION_MODEL_FRAME_MS	((SLAVE_TARGET_DATA + 2) * 10 * 1000.0 / 9600.0)
+
+/// Milliseconds allowed at the end of a move for the motor to catch up with the profile
+/// and the PID controller to bring the finger within SLAVE_SIM_FORMED_BAND of its
+/// target, found with the check
+#define TRANSITION_MODEL_SETTLE_MS	150.0
+
+/// Milliseconds the slave bus took to carry one set point byte, before there were
+/// frames; each finger slave was picked and sent its own byte
+#define TRANSITION_MODEL_BYTE_MS	(10 * 1000.0 / 9600.0)
+
+/// Milliseconds the slave bus took to carry a set point frame, before target frames
+#define TRANSITION_MODEL_SET_POINT_MS	((SLAVE_FRAME_DATA + 2) * TRANSITION_MODEL_BYTE_MS)
+
+// The ways the model can drive the slave bus
+#define TRANSITION_BUS_BYTES		0		///< One set point byte to each slave in turn
+#define TRANSITION_BUS_SET_POINTS	1		///< One set point frame per step
+#define TRANSITION_BUS_TARGETS		2		///< One target frame per step, as now
+#define TRANSITION_BUS_WAYS			3		///< Number of ways
+
+/// Microseconds between keys typed by the check
+#define TRANSITION_CHECK_KEY_US		30000UL
+
+/// Characters in each sentence the check types, within MAX_SENTENCE_SIZE
+#define TRANSITION_CHECK_SENTENCE	250
+
+/// Changes in the check's sequence: every shape to every shape, itself included
+#define TRANSITION_CHECK_CHANGES	(TRANSITION_SHAPES * TRANSITION_SHAPES)
+
+/// Time allowed after the last sentence for its last letter to form
+#define TRANSITION_CHECK_SETTLE_US	3000000UL
+
+
+//-------------------------------------------------------------------------------------
+// The model can drive the slave bus as it is now or as it was before
+
+static uint8_t bus_way = TRANSITION_BUS_TARGETS;	///< How steps go to the slaves
+static double bus_ms = 0.0;					///< Time the bus has spent on commands
+
+
+//-------------------------------------------------------------------------------------
+/** This function works out when the fingers commanded by a step start to move. When
+ *  the whole step goes out in one frame, they all start together when it's in; when
+ *  each slave is sent a byte of its own, in the order the steps are sent, each starts
+ *  as soon as its byte is in.
+ *  @param slaves The slaves the step commands, GESTURE_SLAVE_BIT() for each
+ *  @param sent_ms When the bus is free to send the step
+ *  @param p_start_ms Where to put the time each commanded slave starts to move
+ *  @return When the bus is free again
+ */
+
+static double transition_send_ms (uint16_t slaves, double sent_ms, double* p_start_ms)
+{
+	if (bus_way != TRANSITION_BUS_BYTES)
+	{
+		double frame_ms = (bus_way == TRANSITION_BUS_TARGETS) ? TRANSITION_MODEL_FRAME_MS
+							: TRANSITION_MODEL_SET_POINT_MS;
+		sent_ms += frame_ms;
+		bus_ms += frame_ms;
+		for (uint8_t slave = 0; slave < GESTURE_NUM_SLAVES; slave++)
+		{
+			p_start_ms[slave] = sent_ms;
+		}
+		return (sent_ms);
+	}
+	for (uint8_t index = 0; index < GESTURE_NUM_MOTORS; index++)
+	{
+		uint8_t motor = pgm_read_byte (&gesture_motor_order[index]);
+		if (motor <= GESTURE_NUM_SLAVES && (slaves & GESTURE_SLAVE_BIT (motor)))
+		{
+			sent_ms += TRANSITION_MODEL_BYTE_MS;
+			bus_ms += TRANSITION_MODEL_BYTE_MS;
+			p_start_ms[motor - 1] = sent_ms;
+		}
+	}
+	return (sent_ms);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function finds how long a finger takes to move a distance along a motion
+ *  profile which starts and ends at rest.
+ *  @param distance The distance in encoder counts
+ *  @return The time in milliseconds
+ */
+
+static double transition_move_ms (double distance)
+{
+	// The profile's limits are per control tick of 1 ms, in fixed point
+	double speed = PROFILE_SPEED_DEFAULT * 1000.0 / (1L << (16 - PROFILE_SPEED_SHIFT));
+	double accel = PROFILE_ACCEL_DEFAULT * 1.0e6 / (1L << (16 - PROFILE_ACCEL_SHIFT));
+
+	if (speed > FINGER_MAX_SPEED)
+	{
+		speed = FINGER_MAX_SPEED;
+	}
+	distance = fabs (distance);
+	if (distance == 0.0)
+	{
+		return (0.0);
+	}
+
+	// Too short to reach the top speed, the move is all speeding up and slowing down
+	if (distance < speed * speed / accel)
+	{
+		return (2000.0 * sqrt (distance / accel));
+	}
+	return (1000.0 * (distance / speed + speed / accel));
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function finds how far a finger has to go to a count. A finger which the shape
+ *  the hand is in doesn't command is wherever an earlier letter left it, so it's 
+ *  taken to be at whichever of its counts is furthest from the new one.
+ *  @param slave The slave's index, 0-9
+ *  @param p_counts Where each finger is, or a negative number if that isn't known
+ *  @param target The count the finger is to go to
+ *  @return The distance in encoder counts
+ */
+
+static double transition_distance (uint8_t slave, const double* p_counts, double target)
+{
+	double furthest = 0.0;
+
+	if (p_counts[slave] >= 0.0)
+	{
+		return (fabs (target - p_counts[slave]));
+	}
+	for (uint8_t code = 1; code <= GESTURE_NUM_CODES; code++)
+	{
+		double distance = fabs (target - gesture_count (slave + 1, code));
+		if (distance > furthest)
+		{
+			furthest = distance;
+		}
+	}
+	return (furthest);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function works out how long the hand takes to change from one shape to
+ *  another, from the moment the output task is given the new one until the last
+ *  finger has settled.
+ *  @param from The database row of the shape the hand is in
+ *  @param to The database row of the new shape
+ *  @return The time in milliseconds
+ */
+
+static double transition_model_ms (uint8_t from, uint8_t to)
+{
+	character_database database;
+	const gesture_step* p_step;
+	double counts[GESTURE_NUM_SLAVES];		// Where each finger is, if it's known
+	double ahead[GESTURE_NUM_SLAVES];		// Where a finger going first goes
+	double finish_ms[GESTURE_NUM_SLAVES];	// When each finger gets where it's going
+	double start_ms[GESTURE_NUM_SLAVES];	// When each finger is told to go
+	uint16_t commanded;
+	uint16_t moving = 0;
+	uint16_t first = 0;						// Fingers going first
+	uint8_t interference = 0;
+	uint8_t after;
+	uint8_t code;
+	double frame_ms = 0.0;					// When the frame being looked at is sent
+	double done_ms;
+
+	// The first shape's steps put some fingers where it wants them; the others are
+	// wherever earlier letters left them
+	for (uint8_t slave = 0; slave < GESTURE_NUM_SLAVES; slave++)
+	{
+		counts[slave] = -1.0;
+		finish_ms[slave] = 0.0;
+	}
+
+	// An earlier letter may have left any group of fingers in the way. The planner only
+	// takes a group out of the way when it's sent on ahead, as the first shape's first
+	// step moves a finger it blocks, or when that step gives every finger in it a target,
+	// so any other group is taken to be in the way still
+	if (database.get_steps (from) > 0)
+	{
+		p_step = database.get_step (from, 0);
+		commanded = 0;
+		for (uint8_t slave = 0; slave < GESTURE_NUM_SLAVES; slave++)
+		{
+			if (gesture_target (p_step, slave + 1) != GESTURE_NO_CHANGE)
+			{
+				commanded |= GESTURE_SLAVE_BIT (slave + 1);
+			}
+		}
+		for (uint8_t group = 0; group < GESTURE_NUM_GROUPS; group++)
+		{
+			uint16_t group_slaves = pgm_read_word (&gesture_group_slaves[group]);
+			if ((commanded & group_slaves) != group_slaves
+				&& !(commanded & pgm_read_word (&gesture_group_conflicts[group])))
+			{
+				interference |= 1 << group;
+			}
+		}
+	}
+	for (uint8_t step = 0; step < database.get_steps (from); step++)
+	{
+		p_step = database.get_step (from, step);
+		for (uint8_t slave = 0; slave < GESTURE_NUM_SLAVES; slave++)
+		{
+			code = gesture_target (p_step, slave + 1);
+			if (code != GESTURE_NO_CHANGE)
+			{
+				counts[slave] = gesture_count (slave + 1, code);
+			}
+		}
+		interference |= gesture_interference (p_step);
+	}
+
+	// Interfering fingers which block part of the first step go first, as planned by
+	// task_output::plan_transition(), and the step waits for them to get out of the way
+	p_step = database.get_step (to, 0);
+	after = gesture_interference (p_step);
+	for (uint8_t slave = 0; slave < GESTURE_NUM_SLAVES; slave++)
+	{
+		code = gesture_target (p_step, slave + 1);
+		if (code != GESTURE_NO_CHANGE 
+			&& transition_distance (slave, counts, gesture_count (slave + 1, code)) > 0.0)
+		{
+			moving |= GESTURE_SLAVE_BIT (slave + 1);
+		}
+	}
+	for (uint8_t group = 0; group < GESTURE_NUM_GROUPS; group++)
+	{
+		if (!(interference & (1 << group))
+			|| !(moving & pgm_read_word (&gesture_group_conflicts[group])))
+		{
+			continue;
+		}
+		for (uint8_t slave = 0; slave < GESTURE_NUM_SLAVES; slave++)
+		{
+			if (!(pgm_read_word (&gesture_group_slaves[group]) & GESTURE_SLAVE_BIT (slave + 1)))
+			{
+				continue;
+			}
+			code = gesture_target (p_step, slave + 1);
+			if (code == GESTURE_NO_CHANGE || (after & (1 << group)))
+			{
+				code = 1;
+			}
+			ahead[slave] = gesture_count (slave + 1, code);
+			first |= GESTURE_SLAVE_BIT (slave + 1);
+		}
+	}
+	if (first)
+	{
+		double clear_ms = 0.0;
+		frame_ms = transition_send_ms (first, 0.0, start_ms);
+		for (uint8_t slave = 0; slave < GESTURE_NUM_SLAVES; slave++)
+		{
+			if (!(first & GESTURE_SLAVE_BIT (slave + 1)))
+			{
+				continue;
+			}
+			double distance = transition_distance (slave, counts, ahead[slave]);
+			finish_ms[slave] = start_ms[slave] + transition_move_ms (distance);
+			counts[slave] = ahead[slave];
+			if (distance > OUTPUT_CLEAR_COUNTS)
+			{
+				distance = OUTPUT_CLEAR_COUNTS;
+			}
+			distance = floor (distance / OUTPUT_COUNTS_PER_RUN) * 10.0;
+			if (distance > clear_ms)
+			{
+				clear_ms = distance;
+			}
+		}
+		frame_ms += clear_ms;
+	}
+
+	// Then each step goes out in a frame of its own; a finger heads for the target of
+	// the last step which commands it, once it's done with any move before
+	for (uint8_t step = 0; step < database.get_steps (to); step++)
+	{
+		p_step = database.get_step (to, step);
+		commanded = 0;
+		for (uint8_t slave = 0; slave < GESTURE_NUM_SLAVES; slave++)
+		{
+			if (gesture_target (p_step, slave + 1) != GESTURE_NO_CHANGE)
+			{
+				commanded |= GESTURE_SLAVE_BIT (slave + 1);
+			}
+		}
+		frame_ms = transition_send_ms (commanded, frame_ms, start_ms);
+		for (uint8_t slave = 0; slave < GESTURE_NUM_SLAVES; slave++)
+		{
+			code = gesture_target (p_step, slave + 1);
+			if (code == GESTURE_NO_CHANGE)
+			{
+				continue;
+			}
+			double distance = transition_distance (slave, counts, gesture_count (slave + 1, code));
+			counts[slave] = gesture_count (slave + 1, code);
+			if (distance == 0.0)
+			{
+				continue;
+			}
+			if (finish_ms[slave] > start_ms[slave])
+			{
+				start_ms[slave] = finish_ms[slave];
+			}
+			finish_ms[slave] = start_ms[slave] + transition_move_ms (distance);
+		}
+	}
+
+	// The letter is formed when its last frame is out and its last finger has settled
+	done_ms = frame_ms;
+	for (uint8_t slave = 0; slave < GESTURE_NUM_SLAVES; slave++)
+	{
+		if (finish_ms[slave] > 0.0 && finish_ms[slave] + TRANSITION_MODEL_SETTLE_MS > done_ms)
+		{
+			done_ms = finish_ms[slave] + TRANSITION_MODEL_SETTLE_MS;
+		}
+	}
+	return (TRANSITION_MODEL_START_MS + done_ms);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function finds a change's time in the units of the table, rounded up.
+ *  @param from The database row of the shape the hand is in
+ *  @param to The database row of the new shape
+ *  @return The time in TRANSITION_TICK_MS, at most 255
+ */
+
+static uint8_t transition_model_ticks (uint8_t from, uint8_t to)
+{
+	double ticks = ceil (transition_model_ms (from, to) / TRANSITION_TICK_MS);
+	return ((uint8_t)(ticks > 255.0 ? 255.0 : ticks));
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function prints a new transition_table.cpp on the standard output.
+ */
+
+static void transition_model_table (void)
+{
+	character_database database;
+	uint8_t longest = 0;
+
+	printf ("//*************************************************************************************\n"
+			"/** \\file transition_table.cpp\n"
+			" *    This file contains the time the hand takes to change from each hand shape to\n"
+			" *    each other one, in units of TRANSITION_TICK_MS. It was made by the transition\n"
+			" *    model in sim/transition_model.cpp and shouldn't be edited by hand; after the\n"
+			" *    gestures, the finger counts or the slaves' motion profile change, make it again\n"
+			" *    with\n"
+			" *    \\code\n"
+			" *    HAL_SIM_TRANSITIONS=table ./master_sim > transition_table.cpp\n"
+			" *    \\endcode\n"
+			" *    Rows are the shape the hand is in and columns the new shape, both in the order\n"
+			" *    of the character database: the digits, then the letters.\n"
+			" *\n"
+			" *  Revisions:\n"
+			" *    \\li 10-16-2026 Original file\n"
+			" *\n"
+			" *  License:\n"
+			" *    This file released under the Lesser GNU Public License, version 2. This program\n"
+			" *    is intended for educational use only, but it is not limited thereto.\n"
+			" */\n"
+			"//*************************************************************************************\n"
+			"\n"
+			"#include <stdint.h>\n"
+			"#include \"lib/hal.h\"\n"
+			"#include \"transition.h\"\n"
+			"\n"
+			"\n"
+			"const uint8_t transition_times[TRANSITION_SHAPES][TRANSITION_SHAPES] PROGMEM = \n"
+			"{\n"
+			"\t//  ");
+	for (uint8_t to = 0; to < TRANSITION_SHAPES; to++)
+	{
+		printf ("%c%s", database.get_letter (to), (to + 1 < TRANSITION_SHAPES) ? "    " : "\n");
+	}
+	for (uint8_t from = 0; from < TRANSITION_SHAPES; from++)
+	{
+		printf ("\t{ ");
+		for (uint8_t to = 0; to < TRANSITION_SHAPES; to++)
+		{
+			uint8_t ticks = transition_model_ticks (from, to);
+			if (ticks > longest)
+			{
+				longest = ticks;
+			}
+			printf ("%3u%s", ticks, (to + 1 < TRANSITION_SHAPES) ? ", " : " ");
+		}
+		printf ("}%s\t// %c\n", (from + 1 < TRANSITION_SHAPES) ? "," : " ",
+				database.get_letter (from));
+	}
+	printf ("};\n"
+			"\n"
+			"const uint8_t transition_longest = %u;\n", longest);
+	fflush (stdout);
+	exit (0);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function works out the time for every change with each way of driving the
+ *  slave bus, prints the results and ends the program.
+ */
+
+static void transition_model_latency (void)
+{
+	const char* p_keys[TRANSITION_BUS_WAYS] = { "bytes", "set_points", "targets" };
+	const char* p_names[TRANSITION_BUS_WAYS] = 
+		{ "Byte per slave", "Set point frame", "Target frame" };
+	double mean_ms[TRANSITION_BUS_WAYS];
+	double most_ms[TRANSITION_BUS_WAYS];
+	double bus_mean_ms[TRANSITION_BUS_WAYS];
+
+	for (uint8_t scheme = 0; scheme < TRANSITION_BUS_WAYS; scheme++)
+	{
+		double total_ms = 0.0;
+		bus_way = scheme;
+		bus_ms = 0.0;
+		most_ms[scheme] = 0.0;
+		for (uint8_t from = 0; from < TRANSITION_SHAPES; from++)
+		{
+			for (uint8_t to = 0; to < TRANSITION_SHAPES; to++)
+			{
+				double time_ms = transition_model_ms (from, to);
+				total_ms += time_ms;
+				if (time_ms > most_ms[scheme])
+				{
+					most_ms[scheme] = time_ms;
+				}
+			}
+		}
+		mean_ms[scheme] = total_ms / TRANSITION_CHECK_CHANGES;
+		bus_mean_ms[scheme] = bus_ms / TRANSITION_CHECK_CHANGES;
+	}
+	bus_way = TRANSITION_BUS_TARGETS;
+
+	fprintf (stderr, "\nLetter to letter latency over %u changes, modelled\n",
+			 TRANSITION_CHECK_CHANGES);
+	fprintf (stderr, "Bus              Mean (ms)   Most (ms)   Bus per letter (ms)\n");
+	for (uint8_t scheme = 0; scheme < TRANSITION_BUS_WAYS; scheme++)
+	{
+		fprintf (stderr, "%-15s  %9.1f   %9.1f   %19.2f\n", p_names[scheme],
+				 mean_ms[scheme], most_ms[scheme], bus_mean_ms[scheme]);
+	}
+	printf ("{\"model\": \"latency\", \"changes\": %u", TRANSITION_CHECK_CHANGES);
+	for (uint8_t scheme = 0; scheme < TRANSITION_BUS_WAYS; scheme++)
+	{
+		printf (", \"%s\": {\"mean_ms\": %.2f, \"most_ms\": %.2f, \"bus_ms\": %.2f}",
+				p_keys[scheme], mean_ms[scheme], most_ms[scheme], bus_mean_ms[scheme]);
+	}
+	printf ("}\n");
+	fflush (stdout);
+	exit (0);
+}
+
+
+//-------------------------------------------------------------------------------------
+// The check types a de Bruijn sequence of the shapes, in which every pair of shapes
+// comes next to each other exactly once
+
+static char sequence[TRANSITION_CHECK_CHANGES + 2];		///< The characters to spell
+static uint16_t sequence_length = 0;		///< Characters in the sequence
+static uint16_t typed = 0;					///< Characters of it typed so far
+static uint16_t sentence_end = 0;			///< End of the sentence being typed
+static uint16_t first_letter = 0;			///< Index of the first letter measured
+static bool at_prompt = false;				///< Enter has been pressed at the menu
+static bool spelling = false;				///< The hand is spelling a sentence
+static bool started = false;				///< The check has taken the terminal
+static uint64_t finish_us = 0;				///< Time at which to stop and report
+static hal_sim_event_hook p_next_hook = NULL;	///< Event watcher set before this one
+
+
+//-------------------------------------------------------------------------------------
+/** This function builds the de Bruijn sequence of order two on the shapes, by the
+ *  standard recursive construction from Lyndon words.
+ *  @param p_work Working space of at least three bytes
+ *  @param t The position being filled
+ *  @param p The length of the current Lyndon word
+ */
+
+static void transition_check_build (uint8_t* p_work, uint8_t t, uint8_t p)
+{
+	character_database database;
+
+	if (t > 2)
+	{
+		if (2 % p == 0)
+		{
+			for (uint8_t index = 1; index <= p; index++)
+			{
+				sequence[sequence_length++] = database.get_letter (p_work[index]);
+			}
+		}
+		return;
+	}
+	p_work[t] = p_work[t - p];
+	transition_check_build (p_work, t + 1, p);
+	for (uint8_t shape = p_work[t - p] + 1; shape < TRANSITION_SHAPES; shape++)
+	{
+		p_work[t] = shape;
+		transition_check_build (p_work, t + 1, t);
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function compares the letters the hand spelled with the table, prints the
+ *  results and ends the program.
+ */
+
+static void transition_check_report (void)
+{
+	character_database database;
+	const slave_sim_letter* p_letters;
+	uint16_t count = slave_sim_get_letters (&p_letters);
+	uint16_t checked = 0;
+	uint16_t late = 0;
+	uint16_t unsettled = 0;
+	double spare_total = 0.0;
+	double spare_least = 1.0e9;
+	double worst_late = 0.0;
+	char worst_from = ' ';
+	char worst_to = ' ';
+
+	// The first letter is left out, as the hand starts out open and unknown
+	for (uint16_t index = first_letter + 1; index < count; index++)
+	{
+		const slave_sim_letter& letter = p_letters[index];
+		uint8_t from = database.get_index (p_letters[index - 1].letter);
+		uint8_t to = database.get_index (letter.letter);
+		if (from >= TRANSITION_SHAPES || to >= TRANSITION_SHAPES)
+		{
+			continue;
+		}
+
+		// The letter is formed once the fingers it commands have settled; the others
+		// may be on their way to the next letter, sent early by output_lookahead()
+		uint32_t formed_us = 0;
+		for (uint8_t step = 0; step < database.get_steps (to); step++)
+		{
+			const gesture_step* p_step = database.get_step (to, step);
+			for (uint8_t slave = 0; slave < GESTURE_NUM_SLAVES; slave++)
+			{
+				if (gesture_target (p_step, slave + 1) != GESTURE_NO_CHANGE
+					&& letter.finger_formed_us[slave] > formed_us)
+				{
+					formed_us = letter.finger_formed_us[slave];
+				}
+			}
+		}
+		double formed_ms = formed_us / 1.0e3;
+		double table_ms = pgm_read_byte (&transition_times[from][to]) * TRANSITION_TICK_MS;
+		double spare = table_ms - formed_ms;
+
+		checked++;
+		spare_total += spare;
+		if (spare < spare_least)
+		{
+			spare_least = spare;
+		}
+			if (letter.moved && !letter.settled)
+		{
+			unsettled++;
+		}
+		if (spare < 0.0)
+		{
+			late++;
+			if (-spare > worst_late)
+			{
+				worst_late = -spare;
+				worst_from = p_letters[index - 1].letter;
+				worst_to = letter.letter;
+			}
+		}
+	}
+
+	double spare_mean = checked ? spare_total / checked : 0.0;
+	fprintf (stderr, "\nTransition check: %u of %u changes checked, %u took longer than "
+			 "the table allows\n", checked, TRANSITION_CHECK_CHANGES, late);
+	fprintf (stderr, "Table time to spare: mean %.1f ms, least %.1f ms\n", spare_mean,
+			 spare_least);
+	fprintf (stderr, "Fingers still creeping when the next letter began: %u letters\n",
+			 unsettled);
+	if (late)
+	{
+		fprintf (stderr, "Worst: %c to %c, %.1f ms late\n", worst_from, worst_to, worst_late);
+	}
+	printf ("{\"check\": \"transitions\", \"pass\": %s, \"changes\": %u, \"late\": %u, "
+			"\"spare_ms\": {\"mean\": %.2f, \"least\": %.2f}, \"unsettled_letters\": %u}\n",
+			late ? "false" : "true", checked, late, spare_mean, spare_least, unsettled);
+	fflush (stdout);
+	if (late || checked == 0)
+	{
+		exit (1);
+	}
+	hal_sim_exit ();
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function is told of each HAL_EVENT() in the master firmware. It notes when
+ *  the user task has finished spelling a sentence.
+ *  @param code The kind of event
+ *  @param value The value which goes with the event
+ */
+
+static void transition_check_event (uint8_t code, uint8_t value)
+{
+	if (started && spelling && code == HAL_EVENT_SENTENCE_DONE)
+	{
+		spelling = false;
+		at_prompt = true;					// The user task goes back to the prompt
+		if (typed >= sequence_length)
+		{
+			finish_us = hal_sim_time_us () + TRANSITION_CHECK_SETTLE_US;
+		}
+	}
+	if (p_next_hook)
+	{
+		p_next_hook (code, value);
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function is run every TRANSITION_CHECK_KEY_US. It types the sequence one key
+ *  at a time, in sentences short enough for the user task.
+ *  @param now_us The simulated time
+ */
+
+static void transition_check_run (uint64_t now_us)
+{
+	const slave_sim_letter* p_letters;
+
+	if (!started)
+	{
+		hal_sim_take_terminal ();
+		slave_sim_no_letter_table ();
+		first_letter = slave_sim_get_letters (&p_letters);
+		started = true;
+	}
+	if (finish_us)
+	{
+		if (now_us >= finish_us)
+		{
+			transition_check_report ();
+		}
+		return;
+	}
+	if (spelling)
+	{
+		return;
+	}
+	if (!at_prompt)
+	{
+		hal_sim_receive (0, '\r');			// Enter at the menu starts a sentence
+		at_prompt = true;
+		sentence_end = typed + TRANSITION_CHECK_SENTENCE;
+		if (sentence_end > sequence_length)
+		{
+			sentence_end = sequence_length;
+		}
+	}
+	else if (typed < sentence_end)
+	{
+		hal_sim_receive (0, sequence[typed++]);
+	}
+	else
+	{
+		hal_sim_receive (0, '\r');
+		spelling = true;
+		sentence_end = typed + TRANSITION_CHECK_SENTENCE;
+		if (sentence_end > sequence_length)
+		{
+			sentence_end = sequence_length;
+		}
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function hooks the model into the simulation before main() runs, if the
+ *  environment variable HAL_SIM_TRANSITIONS asks for it.
+ */
+
+static void __attribute__ ((constructor)) transition_model_start (void)
+{
+	const char* p_env = getenv ("HAL_SIM_TRANSITIONS");
+	uint8_t work[3] = { 0, 0, 0 };
+
+	if (p_env == NULL)
+	{
+		return;
+	}
+	if (!strcmp (p_env, "table"))
+	{
+		transition_model_table ();
+	}
+	if (!strcmp (p_env, "latency"))
+	{
+		transition_model_latency ();
+	}
+	if (strcmp (p_env, "check"))
+	{
+		fprintf (stderr, "HAL_SIM_TRANSITIONS must be \"table\", \"check\" or \"latency\"\n");
+		exit (1);
+	}
+
+	// The sequence wraps around, so its first character is repeated at the end
+	transition_check_build (work, 1, 1);
+	sequence[sequence_length] = sequence[0];
+	sequence_length++;
+	sequence[sequence_length] = '\0';
+
+	hal_sim_add_device (transition_check_run, TRANSITION_CHECK_KEY_US);
+	p_next_hook = hal_sim_set_event_hook (transition_check_event);
+}
+
+#endif // HAL_SIM
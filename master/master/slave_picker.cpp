@@ -9,6 +9,8 @@
  *    \li 05-15-2008 JRR Modified to work with two motor drivers rather than one
  *    \li 03-08-2009 JRR Added code to test A/D converter
  *    \li 01-19-2011 JRR Updated calls to newer version of stl_task constructor
+ *    \li 10-16-2026 Waits for buffered slave characters before switching the mux
+ *    \li 10-16-2026 Channel no longer echoed to the computer, as the slaves are polled
  *
  *  License:
  *    This file released under the Lesser GNU Public License, version 2. This program
@@ -17,7 +19,7 @@
 //*************************************************************************************
 
 #include <stdlib.h>
-#include <avr/io.h>
+#include "lib/hal.h"
 #include "slave_picker.h"
 #include "lib/global_debug.h"
 
@@ -25,12 +27,15 @@
 /** This constructor creates a slave_picker object. It outputs the correct pins to
  *  choose multiplexer outputs to make sure the master is communicating with the right
  *  slave chips.
+ *  @param p_ser_comp Pointer to the serial port which talks to the computer
+ *  @param p_ser_slave Pointer to the serial port which talks to the slaves
  */
 
-slave_picker::slave_picker (base_text_serial* p_ser_comp)
+slave_picker::slave_picker (base_text_serial* p_ser_comp, base_text_serial* p_ser_slave)
 {
 	// Assign pointers
 	p_serial_comp = p_ser_comp;
+	p_serial_slave = p_ser_slave;
 	
 	// Clear array
 	for(unsigned char i = 0; i < 4; i++)
@@ -51,7 +56,8 @@ slave_picker::slave_picker (base_text_serial* p_ser_comp)
 
 void slave_picker::choose (unsigned char pinnumber)
 {
-	*p_serial_comp << numeric << " Mot " << pinnumber;
+	// Characters still in the transmit buffer belong to the slave now selected
+	p_serial_slave->transmit_now();
 	
 	// Split number into individual bits
 	for(unsigned char i = 0; i < 4; i++)
@@ -9,6 +9,7 @@
  *	  \li 05-15-2008 JRR Modified to work with two motor drivers rather than one
  *	  \li 03-08-2009 JRR Added code to test A/D converter
  *    \li 01-19-2011 JRR Updated calls to newer version of stl_task constructor
+ *	  \li 10-16-2026 Waits for buffered slave characters before switching the mux
  *
  *  License:
  *	This file released under the Lesser GNU Public License, version 2. This program
@@ -33,10 +34,11 @@ class slave_picker
 	protected:
 		unsigned char		pinarray[4];	// Create pin array
 		base_text_serial* 	p_serial_comp;			///< Pointer to serial device for computer
+		base_text_serial* 	p_serial_slave;			///< Pointer to serial device for slaves
 
 	public:
 		// The constructor creates a new task object
-		slave_picker (base_text_serial*);
+		slave_picker (base_text_serial*, base_text_serial*);
 
 		// The run method is where the task actually performs its function
 		void choose (unsigned char);
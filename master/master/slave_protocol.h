@@ -0,0 +1,148 @@
+//*************************************************************************************
+/** \file slave_protocol.h
+ *	  This file contains the codes used on the serial bus between the master and the
+ *	  ten finger slaves. Single-character commands go to whichever slave the slave
+ *	  picker has selected. Set point frames go to every slave at once on the broadcast
+ *	  channel, and each slave picks out its own field using the motor number it was
+ *	  given when it was initialized. The same values are defined in the slave code.
+ *	  Target frames, also broadcast, give each slave any encoder count to move to
+ *	  rather than one of its five set points. The P command sets how a slave moves to
+ *	  its set points, and the Q command asks a slave whether it has got there. The
+ *	  ready line, which all the slaves share, tells the master when they all have.
+ *	  The B and U commands let the master move the bus to a faster baud rate.
+ *
+ *  Revisions:
+ *	  \li 10-16-2026 Original file, broadcast set point frame
+ *	  \li 10-16-2026 Motion profile command
+ *	  \li 10-16-2026 Target frame with a 10 bit encoder count for each slave
+ *	  \li 10-16-2026 In-position query
+ *	  \li 10-16-2026 Ready line, and target frame moves which leave it alone
+ *	  \li 10-16-2026 Baud rate switch and test
+ *
+ *  License:
+ *	This file released under the Lesser GNU Public License, version 2. This program
+ *	is intended for educational use only, but it is not limited thereto.
+ */
+//*************************************************************************************
+
+#ifndef _SLAVE_PROTOCOL_H_
+#define _SLAVE_PROTOCOL_H_
+
+#define NUM_SLAVES				10		///< Finger slaves on the bus, numbered 1-10
+
+/// The multiplexer channel whose transmit line is wired to all ten slaves
+#define SLAVE_BROADCAST			0
+
+//-------------------------------------------------------------------------------------
+/*  A set point frame is SLAVE_FRAME_START, then SLAVE_FRAME_DATA bytes of set points,
+ *  then one check byte. Each data byte holds the three-bit set point codes of two
+ *  slaves (odd-numbered slave in bits 0-2, even-numbered slave in bits 3-5); a code
+ *  of 0 leaves that slave alone and 1-5 mean set points 'a'-'e'. Bit 7 is always set
+ *  in data and check bytes, so a slave which missed the start byte never mistakes
+ *  them for single-character commands. The check byte is SLAVE_FRAME_MARK ored with
+ *  the exclusive-or of the data bytes. Slaves don't answer set point frames.
+ */
+
+#define SLAVE_FRAME_START		'F'		///< First byte of a set point frame
+#define SLAVE_FRAME_DATA		5		///< Data bytes in a frame, two slaves each
+#define SLAVE_FRAME_MARK		0x80	///< Bit set in every data and check byte
+
+/// This macro packs the set point codes of an odd and an even slave into a data byte
+#define SLAVE_FRAME_PACK(odd, even)	(SLAVE_FRAME_MARK | ((even) << 3) | (odd))
+
+//-------------------------------------------------------------------------------------
+/*  A target frame is SLAVE_TARGET_START, then two bytes for each slave in order from
+ *  slave 1, then a check byte made as for a set point frame. The first byte of each
+ *  pair holds bits 7-9 of the slave's target encoder count in its bits 0-2 and the
+ *  second holds bits 0-6 of the count; both have SLAVE_FRAME_MARK set. A first byte
+ *  with SLAVE_TARGET_KEEP set leaves that slave where it is, and one with
+ *  SLAVE_TARGET_QUIET set moves the slave without holding the ready line low. Slaves
+ *  don't answer target frames.
+ */
+
+#define SLAVE_TARGET_START		'W'		///< First byte of a target frame
+#define SLAVE_TARGET_DATA		20		///< Data bytes in a target frame, two per slave
+#define SLAVE_TARGET_KEEP		0x40	///< First byte bit which leaves a slave alone
+#define SLAVE_TARGET_QUIET		0x20	///< First byte bit for a move the master won't wait for
+#define SLAVE_TARGET_MAX		1023	///< Largest encoder count a frame can carry
+#define SLAVE_TARGET_NONE		0xFFFF	///< Count the master uses for "leave alone"
+
+/// This macro makes the first byte of a slave's pair from its target count
+#define SLAVE_TARGET_HIGH(count)	(SLAVE_FRAME_MARK | (((count) >> 7) & 0x07))
+
+/// This macro makes the second byte of a slave's pair from its target count
+#define SLAVE_TARGET_LOW(count)		(SLAVE_FRAME_MARK | ((count) & 0x7F))
+
+//-------------------------------------------------------------------------------------
+/*  A motion profile command is SLAVE_PROFILE, then a speed limit byte and an
+ *  acceleration byte, and the slave answers SLAVE_PROFILE_ACK. The slave moves to
+ *  each new set point at no more than the speed limit, in 1/256 count per control
+ *  tick, speeding up and slowing down by the acceleration, in 1/16384 count per tick
+ *  per tick. A speed limit of zero makes the slave jump straight to each set point.
+ *  The slave's control tick is 1 ms. The data bytes are sent as they are, and they
+ *  needn't have SLAVE_FRAME_MARK set.
+ */
+
+#define SLAVE_PROFILE			'P'		///< Command to set the motion profile
+#define SLAVE_PROFILE_ACK		'p'		///< The slave's answer to a profile command
+
+//-------------------------------------------------------------------------------------
+/*  An in-position query is the single byte SLAVE_QUERY, sent to one slave. The slave
+ *  answers SLAVE_QUERY_SETTLED if its motor is in position: the motion profile has
+ *  stopped on the target, the encoder count is within a few counts of it, and the
+ *  motor has stopped turning. Otherwise, or while the motor is disabled, it answers
+ *  SLAVE_QUERY_MOVING. The slave's control interrupt makes the judgement every tick,
+ *  so the answer comes back straight away, about two byte times after the query.
+ */
+
+#define SLAVE_QUERY				'Q'		///< Command asking whether the slave is in position
+#define SLAVE_QUERY_SETTLED		'q'		///< Answer from a slave which is in position
+#define SLAVE_QUERY_MOVING		'Q'		///< Answer from a slave which isn't
+
+//-------------------------------------------------------------------------------------
+/*  The ready line is an open drain line shared by all the slaves, each on its PD4,
+ *  and pulled up at the master's SLAVE_READY_PIN. A slave pulls it low as soon as it
+ *  takes a new set point or target, other than one marked SLAVE_TARGET_QUIET, and
+ *  lets it go once its motor is in position as for the Q command, or is disabled. So
+ *  the line goes high when the last finger of a hand shape gets there, and the master
+ *  can watch one pin rather than ask each slave in turn. A slave takes up to
+ *  SLAVE_READY_DELAY_US after the end of a frame to pull the line low.
+ */
+
+#define SLAVE_READY_DDR			DDRD	///< Direction register of the ready line pin
+#define SLAVE_READY_PORT		PORTD	///< Port register of the ready line pin, for the pull-up
+#define SLAVE_READY_PINR		PIND	///< Input register of the ready line pin
+#define SLAVE_READY_PIN			PIND0	///< The master's ready line pin
+#define SLAVE_READY_DELAY_US	2000	///< Time for the slaves to take a frame and pull the line low
+
+//-------------------------------------------------------------------------------------
+/*  The bus runs at SLAVE_BAUD_BASE after reset, and the master can move it to one of
+ *  the faster rates in SLAVE_BAUD_RATES, each known by its index in the list, its
+ *  code. SLAVE_BAUD, then the code with SLAVE_FRAME_MARK set, makes every slave which
+ *  hears it switch to that rate as soon as it has the code; it's broadcast, and not
+ *  answered. SLAVE_BAUD_TEST, then SLAVE_BAUD_TEST_BYTES bytes made by
+ *  SLAVE_BAUD_PATTERN, sent to one slave, checks that the slave hears the master at
+ *  the rate in use and can keep up with bytes sent back to back, even while its
+ *  control interrupt runs; it answers SLAVE_BAUD_TEST_ACK if every byte came through,
+ *  and nothing if not. A slave which gets a byte with a frame error while it's above
+ *  the base rate goes back to the base rate. SLAVE_BAUD_RESET sent at the base rate is
+ *  low for longer than a whole byte at any faster rate, so it puts every slave which
+ *  hears it back on the base rate, and slaves already there ignore it.
+ */
+
+#define SLAVE_BAUD				'B'		///< Command to switch baud rate
+#define SLAVE_BAUD_TEST			'U'		///< Command to test the baud rate
+#define SLAVE_BAUD_TEST_ACK		'u'		///< A slave's answer to a test which came through
+#define SLAVE_BAUD_TEST_BYTES	64		///< Pattern bytes in a test
+#define SLAVE_BAUD_RESET		0x00	///< Byte sent at the base rate to put slaves back on it
+#define SLAVE_BAUD_BASE			9600UL	///< Baud rate after reset, code 0
+#define SLAVE_BAUD_CODES		5		///< Number of rates, base rate included
+
+/// The baud rates, by code. Both the master and the slaves run at 20 MHz, which makes
+/// each of these to within 0.2% in double speed mode
+#define SLAVE_BAUD_RATES		{ SLAVE_BAUD_BASE, 38400UL, 125000UL, 250000UL, 500000UL }
+
+/// This macro makes byte n of a baud rate test, mixing runs of ones and zeros
+#define SLAVE_BAUD_PATTERN(n)	(SLAVE_FRAME_MARK | ((0x55 + 0x3B * (n)) & 0x7F))
+
+#endif // _SLAVE_PROTOCOL_H_
@@ -9,6 +9,26 @@
  *    \li 05-15-2008 JRR Modified to work with two motor drivers rather than one
  *    \li 03-08-2009 JRR Added code to test A/D converter
  *    \li 01-19-2011 JRR Updated calls to newer version of stl_task constructor
+ *    \li 10-16-2026 Gesture steps go to the slaves in one broadcast set point frame
+ *    \li 10-16-2026 Task blocks while idle and is woken by the user task's requests
+ *    \li 10-16-2026 New characters are marked for measurement in the simulation;
+ *                    initializing the motors no longer repeats forever
+ *    \li 10-16-2026 Fingers sent encoder counts in target frames rather than set
+ *                    point codes, and opened together in one frame
+ *    \li 10-16-2026 Fingers the character leaves alone start toward the next one as
+ *                    soon as its last step has gone out
+ *    \li 10-16-2026 Interfering fingers moved out of the way first only when the new
+ *                    character moves a finger they block, rather than always opened
+ *    \li 10-16-2026 Fingers the character moves are asked in turn whether they're in
+ *                    position, without blocking, so that the user task can tell when
+ *                    the hand has formed it; query_motor() removed, as it blocked
+ *    \li 10-16-2026 The slaves' shared ready line tells when the fingers are in
+ *                    position, so they're no longer asked in turn
+ *    \li 10-16-2026 Initializing the motors first moves the slave bus to the fastest
+ *                    baud rate every slave passes a test at, trying the one saved in
+ *                    EEPROM first and falling back to a slower one on errors
+ *    \li 10-16-2026 A finger can be sent to any encoder count on its own, for the 
+ *                    computer's binary protocol
  *
  *  License:
  *    This file released under the Lesser GNU Public License, version 2. This program
@@ -18,13 +38,16 @@
 
 
 #include <stdlib.h>
-#include <avr/io.h>
+#include "lib/hal.h"
 #include "lib/rs232int.h"
 #include "lib/stl_timer.h"
 #include "lib/stl_task.h"
 #include "servo.h"
 #include "slave_picker.h"			// The class that sets the multiplexer pins
+#include "slave_protocol.h"			// Codes sent on the slave bus
 //#include "motor.h"
+#include "gesture.h"				// Layout of gesture steps
+#include "character_database.h"	// Gestures for every character
 #include "task_output.h"
 #include "lib/global_debug.h"
 
@@ -32,6 +55,12 @@
 #define MOTOR_SWITCH_PORT	PORTD
 #define MOTOR_SWITCH_PIN	PIND6
 
+/// The slave bus's baud rates, by the codes in the B command
+static const unsigned long slave_baud_rates[SLAVE_BAUD_CODES] = SLAVE_BAUD_RATES;
+
+/// Code of the baud rate found last time, so that it can be tried first
+uint8_t EEMEM output_saved_baud = 0;
+
 
 //-------------------------------------------------------------------------------------
 /** This constructor creates a user interface task object. It checks if the user has
@@ -43,9 +72,10 @@
  *  @param p_timer   A pointer to the main real-time clock object in use
  *  @param p_a_to_d  A pointer to the A/D converter which measures voltages
  *  @param p_ser	 A pointer to a serial device for sending and receiving messages
+ *  @param p_char_dbase A pointer to the database holding the gesture for each character
  */
 
-task_output::task_output (task_timer& a_timer, time_stamp& t_stamp, base_text_serial* p_ser_comp, base_text_serial* p_ser_slave, slave_picker* p_slave_picker, servo* p_servotop, servo* p_servobottom) 
+task_output::task_output (task_timer& a_timer, time_stamp& t_stamp, base_text_serial* p_ser_comp, base_text_serial* p_ser_slave, slave_picker* p_slave_picker, character_database* p_char_dbase, servo* p_servotop, servo* p_servobottom) 
 	: stl_task (a_timer, t_stamp)
 {
 	
@@ -53,6 +83,7 @@ task_output::task_output (task_timer& a_timer, time_stamp& t_stamp, base_text_se
 	p_serial_comp = p_ser_comp;
 	p_serial_slave = p_ser_slave;
 	p_slave_chooser = p_slave_picker;
+	p_character_database = p_char_dbase;
 	//p_motors = p_the_motors;
 	p_servo_top = p_servotop;
 	p_servo_bottom = p_servobottom;
@@ -68,15 +99,26 @@ task_output::task_output (task_timer& a_timer, time_stamp& t_stamp, base_text_se
 	}
 	
 	// Initialize variables
-	flag_interference_thumb = false;
-	flag_interference_index = false;
-	flag_interference_middle = false;
-	flag_interference_ring = false;
-	flag_interference_pinky = false;
+	interference = 0;
+	flag_output_change = false;
+	flag_target_change = false;
+	flag_motors_enabled = false;
+	flag_ready_to_output = false;
+	flag_awaiting_ready = false;
+	flag_hand_settled = false;
+	flag_find_baud = false;
+	slaves_present = 0;
+	for (i = 0; i < NUM_SLAVES; i++)
+	{
+		slave_counts[i] = SLAVE_TARGET_NONE;
+		requested_targets[i] = SLAVE_TARGET_NONE;
+	}
 	flag_stop_motors = false;
 	flag_start_motors = false;
 	flag_init_motors = false;
 	character_step = 1;
+	character_index = CHARACTER_NONE;
+	next_index = CHARACTER_NONE;
 	motor_to_init = 1;
 	motor_to_start = 1;
 	motor_to_stop = 1;
@@ -84,6 +126,10 @@ task_output::task_output (task_timer& a_timer, time_stamp& t_stamp, base_text_se
 	MOTOR_SWITCH_DDR |= (1 << MOTOR_SWITCH_PIN);
 	MOTOR_SWITCH_PORT &= ~(1 << MOTOR_SWITCH_PIN);
 	
+	// The slaves' ready line is an input with the pull-up on
+	SLAVE_READY_DDR &= ~(1 << SLAVE_READY_PIN);
+	SLAVE_READY_PORT |= (1 << SLAVE_READY_PIN);
+	
 	//*p_serial_comp << endl << "Output task initialized." << endl;
 }
 
@@ -97,13 +143,19 @@ task_output::task_output (task_timer& a_timer, time_stamp& t_stamp, base_text_se
 
 char task_output::run (char state)
 {
+	unsigned char clear_runs;			// Task runs to wait for fingers to get clear
+	
 	//*p_serial_comp << endl << "Out State " << state << endl;
 	
 	switch(state)
 	{
 		// Wait for output change
 		case(0):
-			if (flag_stop_motors)
+			if (flag_find_baud)
+			{
+				return(11);
+			}
+			else if (flag_stop_motors)
 			{
 				return(3);
 			}
@@ -120,40 +172,35 @@ char task_output::run (char state)
 				flag_output_change = false;
 				return(1);	// Go to state 1 (Check for interferences)
 			}
+			else if (flag_target_change)
+			{
+				// Send the fingers which were asked for, then watch the ready line
+				flag_target_change = false;
+				output_slave_targets(requested_targets, false);
+				for (i = 0; i < NUM_SLAVES; i++)
+				{
+					requested_targets[i] = SLAVE_TARGET_NONE;
+				}
+				return(9);
+			}
 			else
 			{
 				flag_ready_to_output = true;
+				wait_for_wake();	// Sleep until the user task sets a flag
 				return(STL_NO_TRANSITION);				
 			}
 			return(STL_NO_TRANSITION);
 			break;
-		// Check for interferences		
+		// Move fingers which are in the way, then wait for them to get clear
 		case(1):
 			flag_ready_to_output = false;
-			if(flag_interference_thumb)
-			{
-				open_thumb();
-				flag_interference_thumb = false;
-			}
-			if(flag_interference_index)
-			{
-				open_index();
-				flag_interference_index = false;
-			}
-			if(flag_interference_middle)
+			flag_awaiting_ready = false;
+			clear_runs = plan_transition();
+			if (clear_runs)
 			{
-				open_middle();
-				flag_interference_middle = false;
-			}
-			if(flag_interference_ring)
-			{
-				open_ring();
-				flag_interference_ring = false;
-			}
-			if(flag_interference_pinky)
-			{
-				open_pinky();
-				flag_interference_pinky = false;
+				clear_time = the_timer.get_time_now();
+				clear_time += time_stamp(interval.get_raw_time() * clear_runs);
+				wait_until(clear_time);
 			}
 			return(2);
 			break;	
@@ -162,529 +209,30 @@ char task_output::run (char state)
 			if (!flag_motors_enabled)
 			{
 				flag_motors_enabled = true;
-			}	
-			// Parse character
-			switch(character_to_output)
+			}
+			// Characters with no gesture (pauses and anything unexpected) send nothing
+			if (p_character_database->get_steps(character_index) == 0)
 			{
-				case('0'):
-				case('O'):
-				case('o'):
-					thumb_curl();
-					index_curl();
-					middle_curl();
-					ring_curl();
-					pinky_curl();
-					wrist_default();
-					return(0);
-					break;
-				case('1'):
-					thumb_flat_up();
-					index_stretch();
-					middle_clench();
-					ring_clench();
-					pinky_clench();
-					wrist_default();
-					return(0);
-					break;
-				case('2'):
-					thumb_flat_up();
-					index_stretch();
-					middle_stretch();
-					ring_clench();
-					pinky_clench();
-					wrist_default();
-					return(0);
-					break;
-				case('3'):
-					thumb_stretch();
-					index_stretch();
-					middle_stretch();
-					ring_clench();
-					pinky_clench();
-					wrist_default();
-					return(0);
-					break;
-				case('4'):
-				case('b'):
-				case('B'):
-					switch(character_step)
-					{
-						case(1):
-							thumb_fold_out();
-							index_stretch();
-							middle_stretch();
-							ring_stretch();
-							pinky_stretch();
-							wrist_default();
-							character_step++;
-							return(STL_NO_TRANSITION);
-						case(2):
-							thumb_fold_in();
-							flag_interference_thumb = true;
-							character_step = 1;
-							return(0);
-						default:
-							*p_serial_comp << endl << "Error character " << character_to_output << " step " << character_step << endl;
-					}
-					break;
-				case('5'):
-					thumb_stretch();
-					index_stretch();
-					middle_stretch();
-					ring_stretch();
-					pinky_stretch();
-					wrist_default();
-					return(0);
-					break;
-				case('6'):
-				case('W'):
-				case('w'):
-					switch(character_step)
-					{
-						case(1):
-							thumb_fold_out();
-							index_stretch();
-							middle_stretch();
-							ring_stretch();
-							pinky_clench();
-							wrist_default();
-							character_step++;
-							return(STL_NO_TRANSITION);
-						case(2):
-							thumb_fold_in();
-							flag_interference_thumb = true;
-							character_step = 1;
-							return(0);
-						default:
-							*p_serial_comp << endl << "Error character " << character_to_output << " step " << character_step << endl;
-					}
-					break;
-				case('7'):
-					switch(character_step)
-					{
-						case(1):
-							thumb_fold_out();
-							index_stretch();
-							middle_stretch();
-							ring_clench();
-							pinky_stretch();
-							wrist_default();
-							character_step++;
-							return(STL_NO_TRANSITION);
-						case(2):
-							thumb_fold_in();
-							flag_interference_thumb = true;
-							character_step = 1;
-							return(0);
-						default:
-							*p_serial_comp << endl << "Error character " << character_to_output << " step " << character_step << endl;
-					}
-					break;
-				case('8'):
-					switch(character_step)
-					{
-						case(1):
-							thumb_fold_out();
-							index_stretch();
-							middle_clench();
-							ring_stretch();
-							pinky_stretch();
-							wrist_default();
-							character_step++;
-							return(STL_NO_TRANSITION);
-						case(2):
-							thumb_fold_in();
-							flag_interference_thumb = true;
-							character_step = 1;
-							return(0);
-						default:
-							*p_serial_comp << endl << "Error character " << character_to_output << " step " << character_step << endl;
-					}
-					break;
-				case('9'):
-					thumb_flat_up();
-					index_clench();
-					middle_stretch();
-					ring_stretch();
-					pinky_stretch();
-					wrist_default();
-					return(0);
-					break;
-				case('A'):
-				case('a'):
-					thumb_flat_up();
-					index_clench();
-					middle_clench();
-					ring_clench();
-					pinky_clench();
-					wrist_default();
-					return(0);
-					break;
-				case('C'):
-				case('c'):
-					thumb_fold_out();
-					index_curl();
-					middle_curl();
-					ring_curl();
-					pinky_clench();
-					wrist_default();
-					return(0);
-					break;
-				case('D'):
-				case('d'):
-					thumb_curl();
-					index_stretch();
-					middle_curl();
-					ring_curl();
-					pinky_clench();
-					wrist_default();
-					return(0);
-					break;
-				case('E'):
-				case('e'):
-					switch(character_step)
-					{
-						case(1):
-							thumb_fold_out();
-							index_stretch();
-							middle_stretch();
-							ring_stretch();
-							pinky_stretch();
-							wrist_default();
-							character_step++;
-							return(STL_NO_TRANSITION);
-						case(2):
-							thumb_fold_in();
-							index_curl();
-							middle_curl();
-							ring_curl();
-							pinky_curl();
-							flag_interference_thumb = true;
-							flag_interference_index = true;
-							flag_interference_middle = true;
-							flag_interference_ring = true;
-							flag_interference_pinky = true;
-							character_step = 1;
-							return(0);
-						default:
-							*p_serial_comp << endl << "Error character " << character_to_output << " step " << character_step << endl;
-					}
-					break;
-				case('F'):
-				case('f'):
-					thumb_flat_up();
-					index_clench();
-					middle_stretch();
-					ring_stretch();
-					pinky_stretch();
-					wrist_default();
-					return(0);
-					break;
-				case('G'):
-				case('g'):
-					thumb_flat_up();
-					index_stretch();
-					middle_clench();
-					ring_clench();
-					pinky_clench();
-					wrist_bent();
-					return(0);
-					break;
-				case('H'):
-				case('h'):
-					thumb_flat_up();
-					index_stretch();
-					middle_stretch();
-					ring_clench();
-					pinky_clench();
-					wrist_bent();
-					return(0);
-					break;
-				case('I'):
-				case('i'):
-					thumb_flat_up();
-					index_clench();
-					middle_clench();
-					ring_clench();
-					pinky_stretch();
-					wrist_default();
-					return(0);
-					break;
-				case('J'):
-				case('j'):
-					switch(character_step)
-					{
-						case(1):
-							thumb_flat_up();
-							index_clench();
-							middle_clench();
-							ring_clench();
-							pinky_stretch();
-							wrist_default();
-							character_step++;
-							return(STL_NO_TRANSITION);
-						case(2):
-							wrist_bent();
-							character_step++;
-							return(STL_NO_TRANSITION);
-						case(3):
-							wrist_bent_and_twisted();
-							character_step++;
-							return(STL_NO_TRANSITION);
-						case(4):
-							wrist_twisted();
-							character_step = 1;
-							return(0);
-					}
-					break;
-				case('K'):
-				case('k'):
-					switch(character_step)
-					{
-						case(1):
-							thumb_flat_up();
-							index_stretch();
-							middle_stretch();
-							ring_clench();
-							pinky_clench();
-							wrist_default();
-							character_step++;
-							return(STL_NO_TRANSITION);
-						case(2):
-						thumb_fold_in();
-							flag_interference_thumb = true;
-							character_step = 1;
-							return(0);
-						default:
-							*p_serial_comp << endl << "Error character " << character_to_output << " step " << character_step << endl;
-					}
-					break;
-				case('L'):
-				case('l'):
-					thumb_stretch();
-					index_stretch();
-					middle_clench();
-					ring_clench();
-					pinky_clench();
-					wrist_default();
-					return(0);
-					break;
-				case('M'):
-				case('m'):
-					switch(character_step)
-					{
-						case(1):
-							thumb_fold_in();
-							index_stretch();
-							middle_stretch();
-							ring_stretch();
-							pinky_clench();
-							wrist_default();
-							character_step++;
-							return(STL_NO_TRANSITION);
-						case(2):
-							index_vert_clench();
-							middle_vert_clench();
-							ring_curl();
-							flag_interference_thumb = true;
-							flag_interference_index = true;
-							flag_interference_middle = true;
-							flag_interference_ring = true;
-							character_step = 1;
-							return(0);
-						default:
-							*p_serial_comp << endl << "Error character " << character_to_output << " step " << character_step << endl;
-					}
-					break;
-				case('N'):
-				case('n'):
-					switch(character_step)
-					{
-						case(1):
-							thumb_fold_in();
-							index_stretch();
-							middle_stretch();
-							ring_clench();
-							pinky_clench();
-							wrist_default();
-							character_step++;
-							return(STL_NO_TRANSITION);
-						case(2):
-							index_vert_clench();
-							middle_vert_clench();
-							flag_interference_thumb = true;
-							flag_interference_index = true;
-							flag_interference_middle = true;
-							character_step = 1;
-							return(0);
-						default:
-							*p_serial_comp << endl << "Error character " << character_to_output << " step " << character_step << endl;
-					}
-					break;
-				case('P'):
-				case('p'):
-					thumb_fold_up();
-					index_stretch();
-					middle_fold();
-					ring_clench();
-					pinky_clench();
-					wrist_bent();
-					flag_interference_thumb = true;
-					flag_interference_middle = true;
-					return(0);
-					break;
-				case('Q'):
-				case('q'):
-					thumb_fold_out();
-					index_fold();
-					middle_clench();
-					ring_clench();
-					pinky_clench();
-					wrist_bent();
-					return(0);
-					break;
-				case('R'):
-				case('r'):
-					thumb_flat_up();
-					index_cross();
-					middle_clench();
-					ring_clench();
-					pinky_clench();
-					wrist_default();
-					flag_interference_index = true;
-					return(0);
-					break;
-				case('S'):
-				case('s'):
-					switch(character_step)
-					{
-						case(1):
-							thumb_fold_out();
-							index_clench();
-							middle_clench();
-							ring_clench();
-							pinky_clench();
-							wrist_default();
-							character_step++;
-							return(STL_NO_TRANSITION);
-						case(2):
-							thumb_fold_in();
-							flag_interference_thumb = true;
-							character_step = 1;
-							return(0);
-						default:
-							*p_serial_comp << endl << "Error character " << character_to_output << " step " << character_step << endl;
-					}
-					break;
-				case('T'):
-				case('t'):
-					switch(character_step)
-					{
-						case(1):
-							thumb_flat_up();
-							index_vert_clench();
-							middle_clench();
-							ring_clench();
-							pinky_clench();
-							wrist_default();
-							character_step++;
-							return(STL_NO_TRANSITION);
-						case(2):
-							thumb_fold_in();
-							flag_interference_thumb = true;
-							flag_interference_index = true;
-							character_step = 1;
-							return(0);
-						default:
-							*p_serial_comp << endl << "Error character " << character_to_output << " step " << character_step << endl;
-					}
-					break;
-				case('U'):
-				case('u'):
-					switch(character_step)
-					{
-						case(1):
-							thumb_flat_up();
-							index_stretch();
-							middle_stretch();
-							ring_clench();
-							pinky_clench();
-							wrist_default();
-							character_step++;
-							return(STL_NO_TRANSITION);
-						case(2):
-							index_u();
-							flag_interference_thumb = true;
-							flag_interference_index = true;
-							character_step = 1;
-							return(0);
-						default:
-							*p_serial_comp << endl << "Error character " << character_to_output << " step " << character_step << endl;
-					}
-					break;
-				case('X'):
-				case('x'):
-					switch(character_step)
-					{
-						case(1):
-							thumb_fold_out();
-							index_stretch();
-							middle_clench();
-							ring_clench();
-							pinky_clench();
-							wrist_default();
-							character_step++;
-							return(STL_NO_TRANSITION);
-						case(2):
-							thumb_fold_in();
-							index_vert_clench();
-							flag_interference_thumb = true;
-							flag_interference_index = true;
-							character_step = 1;
-							return(0);
-						default:
-							*p_serial_comp << endl << "Error character " << character_to_output << " step " << character_step << endl;
-					}
-				case('Y'):
-				case('y'):
-					thumb_stretch();
-					index_clench();
-					middle_clench();
-					ring_clench();
-					pinky_stretch();
-					wrist_default();
-					break;
-				case('Z'):
-				case('z'):
-					switch(character_step)
-					{
-						case(1):
-							thumb_flat_up();
-							index_clench();
-							middle_clench();
-							ring_clench();
-							pinky_stretch();
-							wrist_z1();
-							character_step++;
-							return(STL_NO_TRANSITION);
-						case(2):
-							wrist_z2();
-							character_step++;
-							return(STL_NO_TRANSITION);
-						case(3):
-							wrist_z3();
-							character_step++;
-							return(STL_NO_TRANSITION);
-						case(4):
-							wrist_bent();
-							character_step = 1;
-							return(0);
-						default:
-							*p_serial_comp << endl << "Error character " << character_to_output << " step " << character_step << endl;
-					}
+				character_step = 1;
+				flag_hand_settled = true;
+				return(0);
 			}
-				
-			return(0);	// Go to state 2 (output) when done
+			
+			// Send one step of the gesture each run until the last step has gone out
+			output_gesture_step();
+			if (character_step < p_character_database->get_steps(character_index))
+			{
+				character_step++;
+				return(STL_NO_TRANSITION);
+			}
+			output_lookahead();
+			character_step = 1;
+			if (flag_awaiting_ready)
+			{
+				return(9);	// Find out when the fingers get there in state 9
+			}
+			flag_hand_settled = true;
+			return(0);
 			break;
 		// Send Stop Command to a Motor
 		case(3):
@@ -719,6 +267,7 @@ char task_output::run (char state)
 			}
 			else
 			{
+				wait_for_char(p_serial_slave);
 				return(STL_NO_TRANSITION);
 			}
 		// Send Start Command to a Motor
@@ -754,10 +303,12 @@ char task_output::run (char state)
 			}
 			else
 			{
+				wait_for_char(p_serial_slave);
 				return(STL_NO_TRANSITION);
 			}
 		// Send initialization command to one motor
 		case(7):
+			flag_init_motors = false;
 			p_slave_chooser->choose(motor_to_init);
 			if(p_serial_slave->ready_to_send())
 			{
@@ -794,9 +345,142 @@ char task_output::run (char state)
 				}
 			}
 			else
+			{
+				wait_for_char(p_serial_slave);
+				return(STL_NO_TRANSITION);
+			}
+			break;
+		// Wait for the slaves to take the last frame and pull the ready line low
+		case(9):
+			// A new character or command means the fingers are going somewhere else
+			if (flag_output_change || flag_target_change || flag_stop_motors || flag_start_motors
+				|| flag_init_motors)
+			{
+				return(0);
+			}
+			flag_ready_to_output = true;
+			if (!slave_bus_idle())
+			{
+				return(STL_NO_TRANSITION);
+			}
+			ready_time = the_timer.get_time_now();
+			ready_time += time_stamp(0, SLAVE_READY_DELAY_US);
+			wait_until(ready_time);
+			return(10);
+			break;
+		// Wait for the last finger to get there and let the ready line go high
+		case(10):
+			if (flag_output_change || flag_target_change || flag_stop_motors || flag_start_motors
+				|| flag_init_motors)
+			{
+				return(0);
+			}
+			if (SLAVE_READY_PINR & (1 << SLAVE_READY_PIN))
+			{
+				flag_hand_settled = true;
+				return(0);
+			}
+			return(STL_NO_TRANSITION);	// Look again next run
+			break;
+		// Start the search for the fastest baud rate every slave can keep up with, by
+		// finding which slaves answer a test at the base rate
+		case(11):
+			flag_find_baud = false;
+			flag_ready_to_output = false;
+			baud_phase = OUTPUT_BAUD_FIND;
+			baud_trying = 0;
+			baud_good = 0;
+			slaves_present = 0;
+			return(12);
+			break;
+		// Put every slave back on the base rate, and give the reset byte time to pass
+		case(12):
+			if (!slave_bus_idle())
 			{
 				return(STL_NO_TRANSITION);
 			}
+			p_serial_slave->set_baud(SLAVE_BAUD_BASE);
+			p_slave_chooser->choose(SLAVE_BROADCAST);
+			p_serial_slave->putchar(SLAVE_BAUD_RESET);
+			probe_time = the_timer.get_time_now();
+			probe_time += time_stamp(0, OUTPUT_BAUD_SWITCH_US);
+			wait_until(probe_time);
+			return(13);
+			break;
+		// Move the slaves to the rate to be tested
+		case(13):
+			if (!slave_bus_idle())
+			{
+				return(STL_NO_TRANSITION);
+			}
+			if (baud_trying != 0)
+			{
+				p_serial_slave->putchar(SLAVE_BAUD);
+				p_serial_slave->putchar(SLAVE_FRAME_MARK | baud_trying);
+			}
+			return(14);
+			break;
+		// Once the code has gone out, move the master to the rate too
+		case(14):
+			if (!slave_bus_idle())
+			{
+				return(STL_NO_TRANSITION);
+			}
+			p_serial_slave->set_baud(slave_baud_rates[baud_trying]);
+			probe_slave = 0;
+			probe_time = the_timer.get_time_now();
+			probe_time += time_stamp(0, OUTPUT_BAUD_SWITCH_US);
+			wait_until(probe_time);
+			return(15);
+			break;
+		// Test the next slave, or go on once every slave has passed
+		case(15):
+			do
+			{
+				probe_slave++;
+			}
+			while (probe_slave <= NUM_SLAVES && baud_phase != OUTPUT_BAUD_FIND
+				   && !(slaves_present & GESTURE_SLAVE_BIT(probe_slave)));
+			if (probe_slave > NUM_SLAVES)
+			{
+				return(baud_passed());
+			}
+			
+			while (p_serial_slave->check_for_char())
+			{
+				p_serial_slave->getchar();		// Throw away anything left over
+			}
+			p_slave_chooser->choose(probe_slave);
+			p_serial_slave->putchar(SLAVE_BAUD_TEST);
+			for (i = 0; i < SLAVE_BAUD_TEST_BYTES; i++)
+			{
+				p_serial_slave->putchar(SLAVE_BAUD_PATTERN(i));
+			}
+			
+			// The test takes ten bits a byte, and the answer one more byte
+			probe_time = the_timer.get_time_now();
+			probe_time += time_stamp(0, (SLAVE_BAUD_TEST_BYTES + 2) * 10000000UL
+										/ slave_baud_rates[baud_trying] + OUTPUT_BAUD_ANSWER_US);
+			return(16);
+			break;
+		// Wait for the slave's answer to the test
+		case(16):
+			if (p_serial_slave->check_for_char())
+			{
+				if (p_serial_slave->getchar() == SLAVE_BAUD_TEST_ACK)
+				{
+					slaves_present |= GESTURE_SLAVE_BIT(probe_slave);
+					return(15);
+				}
+				return(baud_failed());
+			}
+			if (the_timer.get_time_now() > probe_time)
+			{
+				return(baud_failed());
+			}
+			wait_for_char(p_serial_slave);
+			wait_until(probe_time);
+			return(STL_NO_TRANSITION);
 			break;
 		default:
 			return(0);
@@ -807,11 +491,45 @@ char task_output::run (char state)
 	return (STL_NO_TRANSITION);
 }
 
-void task_output::set_new_character(unsigned char outchar)
+//-------------------------------------------------------------------------------------
+/** This method gives the task a new character to output, along with the one which
+ *  will follow it, so that the task can get fingers which the new character doesn't
+ *  use moving toward the following one while the new one is held. 
+ *  @param outchar The character to output now
+ *  @param nextchar The character which will be output next, or zero if none is known
+ */
+
+void task_output::set_new_character(unsigned char outchar, unsigned char nextchar)
 {
 	character_to_output = outchar;
+	character_index = p_character_database->get_index(character_to_output);
+	next_index = p_character_database->get_index(nextchar);
+	character_step = 1;
+	flag_hand_settled = false;
+	HAL_EVENT (HAL_EVENT_LETTER, character_to_output);
 	*p_serial_comp << endl << "New output character: " << ascii << character_to_output << numeric << endl;
 	flag_output_change = true;
+	wake();
+}
+
+//-------------------------------------------------------------------------------------
+/** This method asks for one finger to be moved to an encoder count, outside of any 
+ *  character. The target goes out in a target frame the next time the task runs, and
+ *  the hand is taken as settled once the ready line says the finger is there. 
+ *  @param slave The number of the finger's slave, 1 to NUM_SLAVES
+ *  @param count The encoder count to move to, up to SLAVE_TARGET_MAX
+ */
+
+void task_output::set_slave_target(unsigned char slave, uint16_t count)
+{
+	if (slave < 1 || slave > NUM_SLAVES || count > SLAVE_TARGET_MAX)
+	{
+		return;
+	}
+	requested_targets[slave - 1] = count;
+	flag_hand_settled = false;
+	flag_target_change = true;
+	wake();
 }
 
 void task_output::stop_motor(void)
@@ -819,6 +537,7 @@ void task_output::stop_motor(void)
 	motor_to_stop = 1;
 	flag_stop_motors = true;
 	flag_motors_enabled = false;
+	wake();
 }
 
 void task_output::start_motor(void)
@@ -826,6 +545,8 @@ void task_output::start_motor(void)
 	motor_to_start = 1;
 	flag_start_motors = true;
 	flag_motors_enabled = true;
+	flag_ready_to_output = false;	// Not ready until the slaves have been told
+	wake();
 }
 
 bool task_output::motors_enabled(void)
@@ -833,37 +554,182 @@ bool task_output::motors_enabled(void)
 	return(flag_motors_enabled);
 }
 
-bool task_output::query_motor(unsigned char motornum)
+void task_output::init_motor(void)
+{
+	motor_to_init = 1;
+	flag_init_motors = true;
+	flag_find_baud = true;		// A slave may have been reset to the base rate
+	flag_ready_to_output = false;
+	wake();
+}
+
+//-------------------------------------------------------------------------------------
+/** This method checks whether everything sent to the slaves has gone out. If not, the
+ *  task is set to run again in a millisecond to check again, so a state which needs a
+ *  quiet bus can just return STL_NO_TRANSITION. 
+ *  @return True if the bus is quiet, false if something is still being sent
+ */
+
+bool task_output::slave_bus_idle (void)
+{
+	if (p_serial_slave->done_sending())
+	{
+		return (true);
+	}
+	ready_time = the_timer.get_time_now();
+	ready_time += time_stamp(0, 1000);
+	wait_until(ready_time);
+	return (false);
+}
+
+//-------------------------------------------------------------------------------------
+/** This method picks the next step of the baud rate search once every slave being 
+ *  tested has passed at the rate being tried. Having found which slaves answer at the
+ *  base rate, the search tries the rate saved in EEPROM, and if there's none, tries 
+ *  each faster rate in turn until one fails or there are no more. 
+ *  @return The state in which to go on with the search, or 0 if it's over
+ */
+
+char task_output::baud_passed (void)
 {
-	p_slave_chooser->choose(motornum);
-	if(p_serial_slave->ready_to_send())
+	unsigned char saved;
+	
+	baud_good = baud_trying;
+	switch (baud_phase)
 	{
-		*p_serial_slave << "Q";
-		input_character = p_serial_comp->getchar();		// Wait for response
-		if (input_character == 'Q')
+		case (OUTPUT_BAUD_FIND):
+			if (slaves_present == 0)
+			{
+				return (baud_found());	// With no slaves, there's nothing to speed up
+			}
+			saved = eeprom_read_byte(&output_saved_baud);
+			if (saved > 0 && saved < SLAVE_BAUD_CODES)
+			{
+				baud_phase = OUTPUT_BAUD_SAVED;
+				baud_trying = saved;
+				return (12);
+			}
+			baud_phase = OUTPUT_BAUD_CLIMB;
+			baud_trying = 1;
+			return (12);
+		case (OUTPUT_BAUD_CLIMB):
+			if (baud_trying + 1 < SLAVE_BAUD_CODES)
+			{
+				baud_trying++;
+				return (12);
+			}
+			return (baud_found());
+		default:
+			return (baud_found());
+	}
+}
+
+//-------------------------------------------------------------------------------------
+/** This method picks the next step of the baud rate search when the slave being tested
+ *  answers wrongly or not at all. At the base rate, that just means the slave isn't 
+ *  there, and the rest are tested. At a faster rate, a failure of the saved rate 
+ *  starts the climb from the slowest faster rate, and any other failure sends the 
+ *  bus back to the fastest rate which worked, or to the base rate if that one fails.
+ *  @return The state in which to go on with the search
+ */
+
+char task_output::baud_failed (void)
+{
+	if (baud_trying == 0)
+	{
+		return (15);
+	}
+	if (baud_phase == OUTPUT_BAUD_SAVED)
+	{
+		baud_phase = OUTPUT_BAUD_CLIMB;
+		baud_trying = 1;
+	}
+	else
+	{
+		baud_phase = OUTPUT_BAUD_FALL_BACK;
+		if (baud_trying == baud_good)
 		{
-			return(false);
+			baud_good = 0;
 		}
-		else if (input_character == 'q')
+		baud_trying = baud_good;
+	}
+	return (12);
+}
+
+//-------------------------------------------------------------------------------------
+/** This method ends the baud rate search. The rate in use is saved in EEPROM, which is
+ *  only written if it has changed, to be tried first next time. 
+ *  @return The state in which the task waits for work, 0
+ */
+
+char task_output::baud_found (void)
+{
+	eeprom_update_byte(&output_saved_baud, baud_trying);
+	*p_serial_comp << endl << "Slave bus at " << slave_baud_rates[baud_trying] << " baud";
+	return (0);
+}
+
+//-------------------------------------------------------------------------------------
+/** This method sends encoder counts to all the finger slaves in one broadcast target
+ *  frame, so that a whole hand shape costs one multiplexer switch instead of a switch
+ *  per finger. Each slave picks its own count out of the frame, and all the fingers
+ *  start moving together when the frame ends. The frame layout is described in 
+ *  slave_protocol.h. The counts are kept so that the next move can be planned. 
+ *  @param p_counts Counts for slaves 1-10, each up to SLAVE_TARGET_MAX, or 
+ *                  SLAVE_TARGET_NONE to leave a slave where it is
+ *  @param quiet True for moves which the current character doesn't wait for, so the
+ *               slaves leave the ready line alone
+ */
+
+void task_output::output_slave_targets (const uint16_t* p_counts, bool quiet)
+{
+	unsigned char data_byte;
+	unsigned char check = 0;
+	bool any_change = false;
+	
+	for (i = 0; i < NUM_SLAVES; i++)
+	{
+		if (p_counts[i] != SLAVE_TARGET_NONE)
 		{
-			return(true);
+			any_change = true;
 		}
-		else
-		*p_serial_comp << endl << "Motor query error " << motornum << endl;
-		return(false);
 	}
-	else
+	if (!any_change)
 	{
-		*p_serial_comp << endl << "Serial port not ready to send to motor " << motornum << endl;
-		return(false);
+		return;
 	}
 	
-}
-
-void task_output::init_motor(void)
-{
-	motor_to_init = 1;
-	flag_init_motors = true;
+	p_slave_chooser->choose(SLAVE_BROADCAST);
+	p_serial_slave->putchar(SLAVE_TARGET_START);
+	for (i = 0; i < NUM_SLAVES; i++)
+	{
+		if (p_counts[i] == SLAVE_TARGET_NONE)
+		{
+			data_byte = SLAVE_FRAME_MARK | SLAVE_TARGET_KEEP;
+			check ^= data_byte;
+			p_serial_slave->putchar(data_byte);
+			data_byte = SLAVE_FRAME_MARK;
+		}
+		else
+		{
+			slave_counts[i] = p_counts[i];
+			data_byte = SLAVE_TARGET_HIGH(p_counts[i]);
+			if (quiet)
+			{
+				data_byte |= SLAVE_TARGET_QUIET;
+			}
+			check ^= data_byte;
+			p_serial_slave->putchar(data_byte);
+			data_byte = SLAVE_TARGET_LOW(p_counts[i]);
+		}
+		check ^= data_byte;
+		p_serial_slave->putchar(data_byte);
+	}
+	p_serial_slave->putchar(check | SLAVE_FRAME_MARK);
+	if (!quiet)
+	{
+		flag_awaiting_ready = true;
+	}
 }
 
 void task_output::output_to_motor (unsigned char motornumber, unsigned char output_value)
@@ -873,7 +739,7 @@ void task_output::output_to_motor (unsigned char motornumber, unsigned char outp
 	if (motornumber <= 10 && motornumber >= 0)
 	{
 		p_slave_chooser->choose(motornumber);
-		*p_serial_slave << output_value;
+		*p_serial_slave << ascii << output_value << numeric;
 		*p_serial_comp << ascii << output_value << numeric;
 	}
 	else if (motornumber == 11)
@@ -906,260 +772,224 @@ bool task_output::ready_to_output(void)
 	return (flag_ready_to_output);
 }
 
-void task_output::open_thumb(void)
-{
-	*p_serial_comp << endl << "thumb" << endl;
-	output_to_motor(5,'a');
-}
-
-void task_output::open_index(void)
-{
-	*p_serial_comp << endl << "index" << endl;
-	output_to_motor(1,'a');
-	output_to_motor(11,0);
-}
-
-void task_output::open_middle(void)
-{
-	*p_serial_comp << endl << "middle" << endl;
-	output_to_motor(2,'a');
-}
-
-void task_output::open_ring(void)
-{
-	*p_serial_comp << endl << "ring" << endl;
-	output_to_motor(3,'a');
-}
-
-void task_output::open_pinky(void)
-{
-	*p_serial_comp << endl << "pinky" << endl;
-	output_to_motor(4,'a');
-}
-
-void task_output::thumb_flat_up(void)
-{
-	*p_serial_comp << endl << "thumb" << endl;
-	output_to_motor(5,'a');
-	output_to_motor(6,'a');
-	output_to_motor(7,'a');
-	output_to_motor(8,'a');
-}
-
-void task_output::thumb_fold_up(void)
-{
-	*p_serial_comp << endl << "thumb" << endl;
-	output_to_motor(5,'e');
-	output_to_motor(6,'a');
-	output_to_motor(7,'a');
-	output_to_motor(8,'a');
-}
-
-void task_output::thumb_fold_in(void)
-{
-	*p_serial_comp << endl << "thumb" << endl;
-	output_to_motor(5,'c');
-	output_to_motor(6,'c');
-	output_to_motor(7,'e');
-	output_to_motor(8,'a');
-}
-
-void task_output::thumb_fold_out(void)
-{
-	*p_serial_comp << endl << "thumb" << endl;
-	output_to_motor(5,'e');
-	output_to_motor(6,'a');
-	output_to_motor(7,'b');
-	output_to_motor(8,'b');
-}
-
-void task_output::thumb_stretch(void)
-{
-	*p_serial_comp << endl << "thumb" << endl;
-	output_to_motor(5,'a');
-	output_to_motor(6,'e');
-	output_to_motor(7,'a');
-	output_to_motor(8,'a');
-}
-
-void task_output::thumb_curl(void)
-{
-	*p_serial_comp << endl << "thumb" << endl;
-	output_to_motor(5,'e');
-	output_to_motor(6,'b');
-	output_to_motor(7,'b');
-	output_to_motor(8,'b');
-}
-
-void task_output::index_stretch(void)
-{
-	*p_serial_comp << endl << "index" << endl;
-	output_to_motor(1,'a');
-	output_to_motor(9,'a');
-}
-
-void task_output::index_curl(void)
-{
-	*p_serial_comp << endl << "index" << endl;
-	output_to_motor(1,'c');
-	output_to_motor(9,'c');
-}
-
-void task_output::index_clench(void)
-{
-	*p_serial_comp << endl << "index" << endl;
-	output_to_motor(1,'e');
-	output_to_motor(9,'e');
-}
-
-void task_output::index_vert_clench(void)
-{
-	*p_serial_comp << endl << "index" << endl;
-	output_to_motor(1,'a');
-	output_to_motor(9,'e');
-}
-
-void task_output::index_cross(void)
-{
-	*p_serial_comp << endl << "index" << endl;
-	output_to_motor(1,'c');
-	output_to_motor(9,'a');
-	output_to_motor(11,1);
-}
-
-void task_output::index_u(void)
-{
-	*p_serial_comp << endl << "index" << endl;
-	output_to_motor(1,'a');
-	output_to_motor(9,'a');
-	output_to_motor(11,1);
-}
-
-void task_output::index_fold(void)
-{
-	*p_serial_comp << endl << "index" << endl;
-	output_to_motor(1,'e');
-	output_to_motor(9,'a');
-}
-
-void task_output::middle_stretch(void)
-{
-	*p_serial_comp << endl << "middle" << endl;
-	output_to_motor(2,'a');
-	output_to_motor(10,'a');
-}
-
-void task_output::middle_curl(void)
-{
-	*p_serial_comp << endl << "middle" << endl;
-	output_to_motor(2,'c');
-	output_to_motor(10,'c');
-}
-
-void task_output::middle_clench(void)
-{
-	*p_serial_comp << endl << "middle" << endl;
-	output_to_motor(2,'e');
-	output_to_motor(10,'e');
-}
-
-void task_output::middle_vert_clench(void)
-{
-	*p_serial_comp << endl << "middle" << endl;
-	output_to_motor(2,'a');
-	output_to_motor(10,'e');
-}
-
-void task_output::middle_fold(void)
-{
-	*p_serial_comp << endl << "middle" << endl;
-	output_to_motor(2,'e');
-	output_to_motor(10,'a');
-}
-
-void task_output::ring_stretch(void)
-{
-	*p_serial_comp << endl << "ring" << endl;
-	output_to_motor(3,'a');
-}
-
-void task_output::ring_curl(void)
-{
-	*p_serial_comp << endl << "ring" << endl;
-	output_to_motor(3,'c');
-}
-
-void task_output::ring_clench(void)
-{
-	*p_serial_comp << endl << "ring" << endl;
-	output_to_motor(3,'e');
-}
-
-void task_output::pinky_stretch(void)
-{
-	*p_serial_comp << endl << "pinky" << endl;
-	output_to_motor(4,'a');
-}
-
-void task_output::pinky_curl(void)
-{
-	*p_serial_comp << endl << "pinky" << endl;
-	output_to_motor(4,'c');
-}
-
-void task_output::pinky_clench(void)
-{
-	*p_serial_comp << endl << "pinky" << endl;
-	output_to_motor(4,'e');
-}
+//-------------------------------------------------------------------------------------
+/** This method tells whether every finger the current character moves has answered
+ *  that it's in position, so that the character can be seen. 
+ *  @return True once the hand has formed the character, false while it's moving
+ */
 
-void task_output::wrist_default(void)
+bool task_output::hand_settled(void)
 {
-	*p_serial_comp << endl << "wrist" << endl;
-	output_to_motor(12,0);
-	output_to_motor(13,0);
+	return (flag_hand_settled);
 }
 
-void task_output::wrist_bent(void)
-{
-	*p_serial_comp << endl << "wrist" << endl;
-	output_to_motor(12,90);
-	output_to_motor(13,0);
-}
+//-------------------------------------------------------------------------------------
+/** This method sends the current step of the current character's gesture to the 
+ *  motors. Targets are read from the character database in program memory and sent in
+ *  thumb, index, middle, ring, pinky, wrist order; motors the step doesn't command
+ *  are left alone. Fingers which the step leaves in an interfering position are 
+ *  noted so that plan_transition() can move them out of the way if they would block
+ *  the next character. 
+ */
 
-void task_output::wrist_bent_and_twisted(void)
+void task_output::output_gesture_step (void)
 {
-	*p_serial_comp << endl << "wrist" << endl;
-	output_to_motor(12,90);
-	output_to_motor(13,90);
+	const gesture_step* p_step = p_character_database->get_step(character_index, character_step - 1);
+	unsigned char motornumber;
+	unsigned char code;
+	
+	// The finger slaves all get their counts in one broadcast frame
+	for (i = 0; i < NUM_SLAVES; i++)
+	{
+		code = gesture_target(p_step, i + 1);
+		if (code == GESTURE_NO_CHANGE)
+			slave_targets[i] = SLAVE_TARGET_NONE;
+		else
+			slave_targets[i] = gesture_count(i + 1, code);
+	}
+	output_slave_targets(slave_targets, false);
+	
+	// The spread switch and the wrist servos are driven from here
+	for (i = 0; i < GESTURE_NUM_MOTORS; i++)
+	{
+		motornumber = pgm_read_byte(&gesture_motor_order[i]);
+		code = gesture_target(p_step, motornumber);
+		if (motornumber > NUM_SLAVES && code != GESTURE_NO_CHANGE)
+		{
+			output_to_motor(motornumber, gesture_decode(motornumber, code));
+		}
+	}
+	
+	interference |= gesture_interference(p_step);
 }
 
-void task_output::wrist_twisted(void)
-{
-	*p_serial_comp << endl << "wrist" << endl;
-	output_to_motor(12,0);
-	output_to_motor(13,90);
-}
+//-------------------------------------------------------------------------------------
+/** This method starts the next character early, once the last step of the current one
+ *  has gone out. Finger slaves which no step of the current character commands play
+ *  no part in holding it, so any of them which the next character's first step moves
+ *  are sent there now, while the current character is held, rather than when the next
+ *  character begins. Fingers which are in an interfering position, and the fingers
+ *  they block, aren't started early, as they could catch on each other. The moves
+ *  are quiet, as the current character doesn't wait for them. 
+ */
 
-void task_output::wrist_z1(void)
+void task_output::output_lookahead (void)
 {
-	*p_serial_comp << endl << "wrist" << endl;
-	output_to_motor(12,45);
-	output_to_motor(13,45);
+	const gesture_step* p_step;
+	unsigned char code;
+	unsigned char step;
+	unsigned char group;
+	uint16_t blocked = 0;
+	
+	if (p_character_database->get_steps(next_index) == 0)
+	{
+		return;
+	}
+	
+	// Start from the next character's first step
+	p_step = p_character_database->get_step(next_index, 0);
+	for (i = 0; i < NUM_SLAVES; i++)
+	{
+		code = gesture_target(p_step, i + 1);
+		if (code == GESTURE_NO_CHANGE)
+			slave_targets[i] = SLAVE_TARGET_NONE;
+		else
+			slave_targets[i] = gesture_count(i + 1, code);
+	}
+	
+	// and leave out every finger the current character holds
+	for (step = 0; step < p_character_database->get_steps(character_index); step++)
+	{
+		p_step = p_character_database->get_step(character_index, step);
+		for (i = 0; i < NUM_SLAVES; i++)
+		{
+			if (gesture_target(p_step, i + 1) != GESTURE_NO_CHANGE)
+			{
+				slave_targets[i] = SLAVE_TARGET_NONE;
+			}
+		}
+	}
+	
+	// and every finger which is in the way or blocked
+	for (group = 0; group < GESTURE_NUM_GROUPS; group++)
+	{
+		if (interference & (1 << group))
+		{
+			blocked |= pgm_read_word(&gesture_group_slaves[group]);
+			blocked |= pgm_read_word(&gesture_group_conflicts[group]);
+		}
+	}
+	for (i = 0; i < NUM_SLAVES; i++)
+	{
+		if (blocked & GESTURE_SLAVE_BIT(i + 1))
+		{
+			slave_targets[i] = SLAVE_TARGET_NONE;
+		}
+	}
+	output_slave_targets(slave_targets, true);	// Sends nothing if no finger is free
 }
 
-void task_output::wrist_z2(void)
-{
-	*p_serial_comp << endl << "wrist" << endl;
-	output_to_motor(12,45);
-	output_to_motor(13,0);
-}
+//-------------------------------------------------------------------------------------
+/** This method plans the move from the hand shape being held to the first step of a
+ *  new character. A finger left in an interfering position only matters if the step
+ *  moves one of the fingers it blocks. In that case it's sent on ahead, straight to 
+ *  its new target if the step gives it one where it won't interfere and open if not,
+ *  and the rest of the step waits until it has gone OUTPUT_CLEAR_COUNTS, or all the
+ *  way if that's nearer, and so is out of the way. An interfering finger which blocks
+ *  nothing in the step is left alone, or moves with the rest of the step, rather than
+ *  being opened every time. A group of interfering fingers only stops interfering once
+ *  the step gives every finger in it a target.
+ *  @return The number of task runs the rest of the step should wait, zero if none
+ */
 
-void task_output::wrist_z3(void)
-{
-	*p_serial_comp << endl << "wrist" << endl;
-	output_to_motor(12,90);
-	output_to_motor(13,45);
+unsigned char task_output::plan_transition (void)
+{
+	const gesture_step* p_step;
+	uint16_t moving = 0;				// Slaves which the step moves
+	uint16_t placed = 0;				// Slaves which the step moves or finds there
+	uint16_t group_slaves;
+	unsigned char group;
+	unsigned char code;
+	unsigned char after;				// Interference bits the step itself sets
+	unsigned short int distance;
+	unsigned short int longest = 0;		// Longest distance a finger goes on ahead
+	
+	if (interference == 0 || p_character_database->get_steps(character_index) == 0)
+	{
+		return (0);
+	}
+	p_step = p_character_database->get_step(character_index, 0);
+	after = gesture_interference(p_step);
+	
+	for (i = 0; i < NUM_SLAVES; i++)
+	{
+		slave_targets[i] = SLAVE_TARGET_NONE;
+		code = gesture_target(p_step, i + 1);
+		if (code == GESTURE_NO_CHANGE)
+		{
+			continue;
+		}
+		placed |= GESTURE_SLAVE_BIT(i + 1);
+		if (gesture_count(i + 1, code) != slave_counts[i])
+		{
+			moving |= GESTURE_SLAVE_BIT(i + 1);
+		}
+	}
+	
+	for (group = 0; group < GESTURE_NUM_GROUPS; group++)
+	{
+		if (!(interference & (1 << group)))
+		{
+			continue;
+		}
+		group_slaves = pgm_read_word(&gesture_group_slaves[group]);
+		
+		// The finger blocks part of the step, so it goes first
+		if (moving & pgm_read_word(&gesture_group_conflicts[group]))
+		{
+			for (i = 0; i < NUM_SLAVES; i++)
+			{
+				if (!(group_slaves & GESTURE_SLAVE_BIT(i + 1)))
+				{
+					continue;
+				}
+				code = gesture_target(p_step, i + 1);
+				if (code == GESTURE_NO_CHANGE || (after & (1 << group)))
+				{
+					code = 1;	// Open
+				}
+				slave_targets[i] = gesture_count(i + 1, code);
+				
+				if (slave_counts[i] == SLAVE_TARGET_NONE)
+					distance = SLAVE_TARGET_MAX;
+				else if (slave_targets[i] > slave_counts[i])
+					distance = slave_targets[i] - slave_counts[i];
+				else
+					distance = slave_counts[i] - slave_targets[i];
+				if (distance > OUTPUT_CLEAR_COUNTS)
+				{
+					distance = OUTPUT_CLEAR_COUNTS;
+				}
+				if (distance > longest)
+				{
+					longest = distance;
+				}
+			}
+			if ((1 << group) == GESTURE_INTERFERE_INDEX)
+			{
+				output_to_motor(11, 0);		// Spread switch off
+			}
+			interference &= ~(1 << group);
+		}
+		// Every finger of the group moves with the rest of the step, or is already where
+		// the step puts it, so they won't be in the way any more unless the step puts
+		// them there again; if the step leaves any of them alone, they still are
+		else if ((placed & group_slaves) == group_slaves)
+		{
+			interference &= ~(1 << group);
+		}
+	}
+	
+	output_slave_targets(slave_targets, false);	// Sends nothing if no finger goes first
+	return ((unsigned char) (longest / OUTPUT_COUNTS_PER_RUN));
 }
-
-
@@ -9,6 +9,16 @@
  *	  \li 05-15-2008 JRR Modified to work with two motor drivers rather than one
  *	  \li 03-08-2009 JRR Added code to test A/D converter
  *    \li 01-19-2011 JRR Updated calls to newer version of stl_task constructor
+ *    \li 10-16-2026 Fingers sent encoder counts in target frames
+ *    \li 10-16-2026 The next character is given with each one, so that free fingers
+ *                    can start toward it early
+ *    \li 10-16-2026 Interference flags replaced by a plan of which fingers must move
+ *                    out of the way first
+ *    \li 10-16-2026 Blocking query_motor() replaced by polling the fingers a character
+ *                    moves until they're all in position
+ *    \li 10-16-2026 Slaves' ready line watched instead of polling them
+ *    \li 10-16-2026 Search for the fastest baud rate the slaves can keep up with
+ *    \li 10-16-2026 One finger can be sent to an encoder count on request
  *
  *  License:
  *	This file released under the Lesser GNU Public License, version 2. This program
@@ -18,6 +28,7 @@
 
 //#include "motor.h"
 #include "servo.h"
+#include "character_database.h"
 
 #ifndef	_TASK_OUTPUT_H_
 #define	_TASK_OUTPUT_H_
@@ -28,6 +39,26 @@
 #define KEY_ENTER			0x0D
 #define KEY_BACKSPACE		0x08
 
+/// Encoder counts a finger is taken to move in one run of this task, about 600 counts
+/// per second at its 10 ms interval; used to judge how long a finger takes to get clear
+#define OUTPUT_COUNTS_PER_RUN	6
+
+/// Encoder counts an interfering finger must move, or its whole move if shorter, before
+/// the fingers it was blocking can move
+#define OUTPUT_CLEAR_COUNTS		192
+
+/// Steps of the search for the fastest baud rate every slave can keep up with
+#define OUTPUT_BAUD_FIND		0		///< Finding which slaves answer at the base rate
+#define OUTPUT_BAUD_SAVED		1		///< Trying the rate saved in EEPROM
+#define OUTPUT_BAUD_CLIMB		2		///< Trying each faster rate in turn
+#define OUTPUT_BAUD_FALL_BACK	3		///< Going back to the fastest rate which worked
+
+/// Microseconds given to the slaves to put a reset byte behind them, and to switch rate
+#define OUTPUT_BAUD_SWITCH_US	2000
+
+/// Microseconds a slave has to answer once a baud rate test has reached it
+#define OUTPUT_BAUD_ANSWER_US	5000
+
 //-------------------------------------------------------------------------------------
 /** This class contains a task which moves a motorized lever back and forth. 
  *  WARNING:  This task uses an older version of parent class stl_task, and its 
@@ -42,6 +73,7 @@ class task_output : public stl_task
 		base_text_serial* 	p_serial_comp;			///< Pointer to serial device for computer
 		base_text_serial* 	p_serial_slave;			///< Pointer to serial device for slave
 		slave_picker* 		p_slave_chooser;		///< Pointer to slave picker for mux pins
+		character_database*	p_character_database;	///< Pointer to the character database
 		//motor*				p_motors;			///< Pointer to all the motors
 		servo*				p_servo_top;			///< Pointer to the top servo
 		servo*				p_servo_bottom;			///< Pointer to the bottom servo
@@ -49,85 +81,65 @@ class task_output : public stl_task
 		
 		unsigned char		finger_configuration[8];
 		unsigned char		output[14];
+		uint16_t			slave_targets[GESTURE_NUM_SLAVES];	///< Counts for the next target frame
 		bool				flag_output_change;
+		bool				flag_target_change;		///< A finger has been asked to move on its own
 		unsigned char		input_character;
 		unsigned char		character_to_output;
 		unsigned char		motor_to_stop;
 		unsigned char		motor_to_start;
 		unsigned char		motor_to_init;
-		bool				flag_interference_thumb;
-		bool				flag_interference_index;
-		bool				flag_interference_middle;
-		bool				flag_interference_ring;
-		bool				flag_interference_pinky;
+		unsigned char		interference;			///< GESTURE_INTERFERE_* bits of fingers in the way
+		uint16_t			slave_counts[GESTURE_NUM_SLAVES];	///< Count last sent to each slave
+		uint16_t			requested_targets[GESTURE_NUM_SLAVES];	///< Counts asked for by set_slave_target()
+		time_stamp			clear_time;				///< Time at which blocking fingers are clear
+		time_stamp			ready_time;				///< Time at which the ready line can be trusted
+		bool				flag_awaiting_ready;	///< Fingers were sent moves which hold the ready line
+		unsigned char		baud_phase;				///< OUTPUT_BAUD_* step of the baud rate search
+		unsigned char		baud_trying;			///< Code of the baud rate being tested
+		unsigned char		baud_good;				///< Fastest code every slave has passed so far
+		unsigned char		probe_slave;			///< Slave being given a baud rate test
+		uint16_t			slaves_present;			///< GESTURE_SLAVE_BIT()s of slaves which answered
+		time_stamp			probe_time;				///< Time by which the tested slave must answer
+		bool				flag_find_baud;			///< The baud rate search is to be run
+		bool				flag_hand_settled;		///< All the character's fingers are in position
 		bool				flag_motors_enabled;
 		bool				flag_ready_to_output;
 		bool				flag_stop_motors;
 		bool				flag_start_motors;
 		bool				flag_init_motors;
 		unsigned char		character_step;
+		unsigned char		character_index;		///< Database row of character to output
+		unsigned char		next_index;				///< Database row of the character after it
 		unsigned char		i;
 
 	public:
 		// The constructor creates a new task object
-		task_output (task_timer&, time_stamp&, base_text_serial*, base_text_serial*, slave_picker*, servo*, servo*);
+		task_output (task_timer&, time_stamp&, base_text_serial*, base_text_serial*, slave_picker*, character_database*, servo*, servo*);
 
 		// The run method is where the task actually performs its function
 		char run (char);
 
-		void set_new_character(unsigned char);
+		void set_new_character(unsigned char, unsigned char);
+		void set_slave_target(unsigned char, uint16_t);
 		
 		void stop_motor (void);
 		void start_motor (void);
 		bool motors_enabled(void);
-		bool query_motor (unsigned char);
 		void init_motor (void);
 		//void set_motor (unsigned char);
 		void output_to_motor(unsigned char, unsigned char);
 		bool ready_to_output(void);
+		bool hand_settled(void);
 		
-		void open_thumb(void);
-		void open_index(void);
-		void open_middle(void);
-		void open_ring(void);
-		void open_pinky(void);
-		
-		void thumb_flat_up(void);
-		void thumb_fold_up(void);
-		void thumb_fold_in(void);
-		void thumb_fold_out(void);
-		void thumb_stretch(void);
-		void thumb_curl(void);
-		
-		void index_stretch(void);
-		void index_curl(void);
-		void index_clench(void);
-		void index_vert_clench(void);
-		void index_cross(void);
-		void index_u(void);
-		void index_fold(void);
-		
-		void middle_stretch(void);
-		void middle_curl(void);
-		void middle_clench(void);
-		void middle_vert_clench(void);
-		void middle_fold(void);
-		
-		void ring_stretch(void);
-		void ring_curl(void);
-		void ring_clench(void);
-		
-		void pinky_stretch(void);
-		void pinky_curl(void);
-		void pinky_clench(void);
-		
-		void wrist_default(void);
-		void wrist_bent(void);
-		void wrist_bent_and_twisted(void);
-		void wrist_twisted(void);
-		void wrist_z1(void);
-		void wrist_z2(void);
-		void wrist_z3(void);
+		void output_gesture_step(void);
+		void output_lookahead(void);
+		unsigned char plan_transition(void);
+		void output_slave_targets(const uint16_t*, bool);
+		bool slave_bus_idle(void);
+		char baud_passed(void);
+		char baud_failed(void);
+		char baud_found(void);
 };
 
 #endif
@@ -9,6 +9,26 @@
  *    \li 05-15-2008 JRR Modified to work with two motor drivers rather than one
  *    \li 03-08-2009 JRR Added code to test A/D converter
  *    \li 01-19-2011 JRR Updated calls to newer version of stl_task constructor
+ *    \li 10-16-2026 Blocks while waiting for keys and during letter delays
+ *    \li 10-16-2026 Start and end of each sentence marked for the simulated benchmark
+ *    \li 10-16-2026 Each character is made ready while the one before it is held, 
+ *                    and the output task is told which character comes next
+ *    \li 10-16-2026 Each letter is held for the time the hand takes to form it, from
+ *                    the table of transitions, rather than for a fixed delay
+ *    \li 10-16-2026 Each letter is held from when the output task finds the fingers in
+ *                    position, with the table's time as the longest wait
+ *    \li 10-16-2026 Pause flags cleared at start rather than left to chance
+ *    \li 10-16-2026 The sentence prompt takes every character waiting each run, up to
+ *                    USER_INPUT_BUDGET, so pasted text isn't lost
+ *    \li 10-16-2026 Streaming mode spells text as it comes from the computer, which
+ *                    is paced with XON and XOFF
+ *    \li 10-16-2026 Streamed text is taken from the port in one block each run
+ *    \li 10-16-2026 Streamed text is queued in one block, and a backspace at an empty
+ *                    prompt no longer upsets the queue
+ *    \li 10-16-2026 Framed binary commands from a program on the computer, told from
+ *                    menu keys by their start byte
+ *    \li 10-16-2026 Answer frames go out whole, or are held until there's room
+ *    \li 10-16-2026 Start and end of streaming mode marked for the simulated terminal
  *
  *  License:
  *    This file released under the Lesser GNU Public License, version 2. This program
@@ -18,15 +38,16 @@
 
 
 #include <stdlib.h>
-#include <avr/io.h>
+#include "lib/hal.h"
 #include "lib/rs232int.h"
 #include "lib/stl_timer.h"
 #include "lib/stl_task.h"
 #include "slave_picker.h"			// The class that sets the multiplexer pins
+#include "slave_protocol.h"			// Codes sent on the slave bus
 #include "lib/queue.h"
-#include "character.h"				// The class that stores character info
-#include "character_database.h"		
+#include "character_database.h"		// Gestures for every character
 #include "task_output.h"
+#include "transition.h"			// How long the hand takes to form each letter
 #include "task_user.h"
 #include "lib/global_debug.h"
 
@@ -41,11 +62,13 @@
  *  @param p_timer   A pointer to the main real-time clock object in use
  *  @param p_a_to_d  A pointer to the A/D converter which measures voltages
  *  @param p_ser	 A pointer to a serial device for sending and receiving messages
+ *  @param p_char_dbase A pointer to the character database, which finds each letter's
+ *                      hand shape
  */
 
 task_user::task_user (task_timer& a_timer, time_stamp& t_stamp, base_text_serial* p_ser_comp, 
 					  base_text_serial* p_ser_slave, slave_picker* p_slave_picker, 
-					  task_output* p_output_task ) 
+					  character_database* p_char_dbase, task_output* p_output_task ) 
 	: stl_task (a_timer, t_stamp)
 {
 	flag_message_printed = false;	// Clear message_printed flag
@@ -54,10 +77,25 @@ task_user::task_user (task_timer& a_timer, time_stamp& t_stamp, base_text_serial
 	p_serial_comp = p_ser_comp;
 	p_serial_slave = p_ser_slave;
 	p_slave_chooser = p_slave_picker;
-	//p_character_database = p_char_dbase;
+	p_character_database = p_char_dbase;
 	p_task_output = p_output_task;
 	
 	character_buffer.flush();	// Flush character buffer
+	last_shape = CHARACTER_NONE;	// The hand's shape isn't known until it forms one
+	dwell_ms = 0;
+	flag_period = false;			// No pause is pending until one is read
+	flag_comma = false;
+	flag_space = false;
+	flag_outputting_letter = false;
+	flag_streaming = false;
+	flag_xoff_sent = false;
+	flag_host = false;
+	flag_host_spell = false;
+	host_frames_good = 0;
+	host_frames_bad = 0;
+	letters_spelled = 0;
+	host_answer_size = 0;
+	host_answers_held = 0;
 	
 	backspace = 0x08;			// Backspace character for printing
 	
@@ -75,27 +113,48 @@ task_user::task_user (task_timer& a_timer, time_stamp& t_stamp, base_text_serial
 
 char task_user::run (char state)
 {
+	uint8_t input_budget;				// Characters the sentence prompt may still take
+	
 	//*p_serial_comp << endl << "Use State " << state << endl;
+	
+	// An answer which didn't fit in the transmit buffer goes before anything else is 
+	// done, so that answers keep their order and no more frames are taken meanwhile
+	if (host_answer_size != 0 && !host_send_answer())
+	{
+		return(STL_NO_TRANSITION);	// Still no room, so try again next run
+	}
+	
 	switch(state)
 	{
 		// Home screen
 		case(0):
-			if(!flag_message_printed)
+			if(!flag_message_printed && !flag_host)
 			{
 				*p_serial_comp << endl << endl << "Robotic Fingerspelling Hand" << endl << endl;
 				*p_serial_comp <<	endl << "ESC Stop Motors" << 
 									endl << "C   Calibrate" << 
 									endl << "ENT Enter Sentence" << 
 									endl << "E   Encoder Query" << 
-									endl << "M   Manual Mode" << endl ;
+									endl << "M   Manual Mode" << 
+									endl << "S   Stream Text" << endl ;
 				flag_message_printed = true;
 			}
 			if(p_serial_comp->check_for_char())
 			{
 				flag_message_printed = false;
 				input_character = p_serial_comp->getchar();
+				if (input_character != HOST_FRAME_START)
+				{
+					flag_host = false;	// Someone's at the keyboard, so the menu comes back
+				}
 				switch(input_character)
 				{
+					case(HOST_FRAME_START):	// Start of a frame from a program, not a key
+						host_count = 0;
+						host_time = the_timer.get_time_now();
+						host_time += time_stamp(0, HOST_FRAME_GAP_MS * 1000UL);
+						return(20);	// Go to state 20 (receive frame)
+						break;
 					case(0x1B):		// Escape
 						return(1);	// Go to state 1 (stop motors)
 						break;
@@ -114,11 +173,28 @@ char task_user::run (char state)
 					case('m'):
 						return(13);	// Go to state 13 (Manual mode)
 						break;
+					case('S'):
+					case('s'):
+						return(17);	// Go to state 17 (Streaming mode)
+						break;
+				#ifdef STL_PROFILE
+					case('P'):
+					case('p'):
+						*p_serial_comp << endl << *p_task_output << endl << *this << endl
+							<< PMS ("Idle loops: ") << numeric << the_timer.get_idle_loops ()
+							<< PMS (" asleep: ") << the_timer.get_sleep_percent () << PMS ("%")
+							<< endl;
+						break;
+				#endif
 					default:
 						*p_serial_comp << endl << "Invalid command" << endl;
 						break;
 				}
 			}
+			else
+			{
+				wait_for_char(p_serial_comp);	// Sleep until a key is pressed
+			}
 			//*p_serial_comp << endl << "User task state 0" << endl;
 			return(STL_NO_TRANSITION);
 			break;
@@ -199,8 +275,8 @@ char task_user::run (char state)
 				}
 			}
 				
-			// Collect characters
-			if(p_serial_comp->check_for_char())		// Check if character received
+			// Collect every character received, up to the budget for one run
+			for (input_budget = USER_INPUT_BUDGET; input_budget > 0 && p_serial_comp->check_for_char(); input_budget--)
 			{
 				input_character = p_serial_comp->getchar();		// collect character if so.
 					
@@ -210,7 +286,7 @@ char task_user::run (char state)
 				// If so it can be stored directly
 				if( ( (input_character >= '0')&&(input_character <= '9') )||( (input_character >= 'A')&&(input_character <= 'Z' ) )||(input_character == ' ')||(input_character == ',')||(input_character == '.') )	
 				{
-					if (character_buffer.num_items() <= MAX_SENTENCE_SIZE )	// If it is and there's room in the character buffer
+					if (character_buffer.num_items() < MAX_SENTENCE_SIZE )	// If it is and there's room in the character buffer
 					{
 						*p_serial_comp << ascii << input_character << numeric;	// Echo character to the screen
 						character_buffer.put(input_character);					// store it directly into the character buffer
@@ -223,7 +299,7 @@ char task_user::run (char state)
 				// If not a number or capital letter, is it a lowercase letter (between hex 61 and 7A)?
 				else if ( (input_character >= 'a')&&(input_character <= 'z') )
 				{
-					if (character_buffer.num_items() <= MAX_SENTENCE_SIZE )	// If it is and there's room in the character buffer
+					if (character_buffer.num_items() < MAX_SENTENCE_SIZE )	// If it is and there's room in the character buffer
 					{
 							
 						input_character = input_character - ('a' - 'A');		// convert it to a capital letter first.
@@ -252,6 +328,7 @@ char task_user::run (char state)
 				else if (input_character == 0x0D)
 				{
 					*p_serial_comp << endl << "Parsing sentence." << endl;
+					HAL_EVENT (HAL_EVENT_SENTENCE, character_buffer.num_items());
 					flag_message_printed = false;
 					return(5);	// Go to state 5
 				}
@@ -262,94 +339,64 @@ char task_user::run (char state)
 					flag_message_printed = false;
 					return(0);	// Go to state 5
 				}
-				// If any other characters are pressed
-				else
-				{
-					// Don't echo or store anything
-					return(STL_NO_TRANSITION);
-				}
-					
+				// If any other characters are pressed, don't echo or store anything
+			}
+			
+			// With all of them taken, sleep until the next key is pressed; otherwise take
+			// the rest next run
+			if (input_budget > 0)
+			{
+				wait_for_char(p_serial_comp);
 			}
 				
 			return(STL_NO_TRANSITION);	// Don't leave the state until Enter is pressed.
 			break;
-		// Prepare one character for output
+		// Get the first character ready for output
 		case(5):
-			if(character_buffer.num_items())	// If character buffer is not empty
-			{
-				character_to_output = character_buffer.get();						// Retrieve the character
-					
-				// If it's not a pause character, collect information.
-				if ((character_to_output != '.')||(character_to_output != ',')||(character_to_output != ' '))
-				{
-					flag_outputting_letter = true;
-				}
-				// If it's a pause character, set the proper flag.
-				else
-				{
-					flag_outputting_letter = false;
-					switch(character_to_output)
-					{
-						case('.'):
-							flag_period = true;
-							break;
-						case(','):
-							flag_comma = true;
-							break;
-						case(' '):
-							flag_space = true;
-							break;
-						default:
-							break;
-					}
-				}
-				return(6);	// Now go to state 6 to figure out timing
-			}
-			else
+			dwell_ms = 0;		// Nothing is held yet, so the first character waits as before
+			if (prepare_character())
 			{
-				return(9);	// Printing is done. Go to state 9 to print the end message.
+				return(8);	// Output it in state 8 once its delay is over
 			}
+			return(9);	// Printing is done. Go to state 9 to print the end message.
 			break;
-		// Timing calculations
+		// Wait for the output task to find the letter formed
 		case(6):
-			if(flag_comma || flag_space || flag_period )
+			if (flag_streaming && !stream_input())
 			{
-				if(flag_comma)
-				{
-					output_delay = 60;
-				}
-				else if(flag_space)
-				{
-					output_delay = 40;
-				}
-				else
-				{
-					output_delay = 80;
-				}
+				return(19);
 			}
-			else
+			if (!(p_task_output -> hand_settled()) && !(the_timer.get_time_now() > settle_end_time))
 			{
-				output_delay = 20;
+				return(STL_NO_TRANSITION);	// Ask again next run
 			}
-			current_delay = 0;
-			current_step = 0;
-			return(7);	// Go to state 7 to start outputting
-			break;
-		// Delay
-		case(7):
-			if(current_delay == output_delay)	// Wait until delay counter increments up to desired value
-			{
-				current_delay = 0;			// Clear delay count
-				return(8);					// Now go to state 8 to output data
-			}
-			else
+			
+			// Hold it to be seen while the next character is made ready
+			dwell_ms = TRANSITION_HOLD_MS;
+			if (prepare_character())
 			{
-				current_delay++;
-				return(STL_NO_TRANSITION);	// Keep delaying until ready
+				return(8);
 			}
+			return(9);	// Printing is done. Go to state 9 to print the end message.
 			break;
 		// Output values
 		case(8):
+			// The task doesn't run in this state until the delay is over, except that in
+			// streaming mode it's woken early to take characters from the computer
+			if (flag_streaming)
+			{
+				if (!stream_input())
+				{
+					return(19);
+				}
+				if (delay_end_time > the_timer.get_time_now())
+				{
+					wait_until(delay_end_time);
+					wait_for_char(p_serial_comp);
+					return(STL_NO_TRANSITION);
+				}
+			}
+			
 			// Enable motors if they're disabled
 			if (!(p_task_output -> motors_enabled()))
 			{
@@ -357,11 +404,40 @@ char task_user::run (char state)
 				p_task_output -> start_motor();
 			}
 			
-			// Output the character
+			// Output the character, telling the output task which one comes next
 			if (p_task_output -> ready_to_output())
 			{	
-				p_task_output -> set_new_character(character_to_output);
-				return(5);	// Output next letter
+				letters_spelled++;
+				if (character_buffer.is_empty())
+				{
+					p_task_output -> set_new_character(character_to_output, 0);
+				}
+				else
+				{
+					p_task_output -> set_new_character(character_to_output, character_buffer[0]);
+				}
+				
+				// A letter is held once the hand has formed it, which state 6 waits for, 
+				// but no longer than the table says the change takes; pauses leave the hand
+				// as it is and keep their own delays
+				output_configuration = p_character_database -> get_index(character_to_output);
+				if (output_configuration < TRANSITION_SHAPES)
+				{
+					dwell_ms = transition_dwell_ms(last_shape, output_configuration);
+					last_shape = output_configuration;
+					settle_end_time = the_timer.get_time_now();
+					dwell_ms -= TRANSITION_HOLD_MS;
+					settle_end_time += time_stamp(dwell_ms / 1000, (dwell_ms % 1000) * 1000UL);
+					return(6);
+				}
+				dwell_ms = 0;
+				
+				// Get the next one ready while this one is held, staying here to output it
+				if (prepare_character())
+				{
+					return(STL_NO_TRANSITION);
+				}
+				return(9);	// Printing is done. Go to state 9 to print the end message.
 			}
 			else
 			{
@@ -370,9 +446,21 @@ char task_user::run (char state)
 			break;
 		// Done
 		case(9):
-			if (p_task_output -> ready_to_output() && flag_outputting_letter == true)
+			if (flag_streaming)
+			{
+				return(18);		// There's no end to a stream, just a wait for more
+			}
+			if (p_task_output -> ready_to_output() && flag_outputting_letter == true && flag_host_spell)
+			{
+				host_reply(HOST_SPELL, HOST_DONE, NULL, 0);
+				flag_host_spell = false;
+				flag_outputting_letter = false;
+				return(0);	// Return to the home screen for the next frame
+			}
+			else if (p_task_output -> ready_to_output() && flag_outputting_letter == true)
 			{
 				*p_serial_comp << endl << "Message done. Returning to message prompt." << endl;
+				HAL_EVENT (HAL_EVENT_SENTENCE_DONE, 0);
 				flag_outputting_letter = false;
 				return(4);	// Return to message prompt
 			}
@@ -556,9 +644,500 @@ char task_user::run (char state)
 				return (STL_NO_TRANSITION);
 			}
 			break;
+		// Start streaming mode
+		case(17):
+			*p_serial_comp << endl << "Streaming text. Escape to stop." << endl;
+			character_buffer.flush();
+			flag_streaming = true;
+			flag_xoff_sent = false;
+			HAL_EVENT (HAL_EVENT_STREAMING, 1);	// XON and XOFF are flow control from here
+			p_serial_comp->putchar(USER_XON);	// In case the computer was left stopped
+			return(18);
+			break;
+		// Wait for text to come from the computer in streaming mode
+		case(18):
+			if (!stream_input())
+			{
+				return(19);
+			}
+			if (prepare_character())
+			{
+				return(8);	// Output it in state 8 once its delay is over
+			}
+			wait_for_char(p_serial_comp);	// Sleep until more text comes
+			return(STL_NO_TRANSITION);
+			break;
+		// Leave streaming mode, letting the computer send again
+		case(19):
+			flag_streaming = false;
+			character_buffer.flush();
+			if (flag_xoff_sent)
+			{
+				p_serial_comp->putchar(USER_XON);
+				flag_xoff_sent = false;
+			}
+			HAL_EVENT (HAL_EVENT_STREAMING, 0);	// Until here, once what's been sent has gone
+			*p_serial_comp << endl << "Streaming stopped" << endl;
+			return(0);
+			break;
+		// Take the bytes of a frame from the computer, then carry out its command
+		case(20):
+			if (host_receive())
+			{
+				return(host_command());
+			}
+			if (!(host_time > the_timer.get_time_now()))
+			{
+				return(0);	// The rest of the frame didn't come, so what came is thrown away
+			}
+			wait_until(host_time);
+			wait_for_char(p_serial_comp);	// Sleep until more comes or it's too late
+			return(STL_NO_TRANSITION);
+			break;
+		// Throw away the rest of a bad frame, until the computer stops sending, so that 
+		// none of it is taken for menu keys
+		case(21):
+			if (p_serial_comp->getchars((char*)host_frame, sizeof (host_frame)) > 0)
+			{
+				host_time = the_timer.get_time_now();
+				host_time += time_stamp(0, HOST_FRAME_GAP_MS * 1000UL);
+			}
+			else if (!(host_time > the_timer.get_time_now()))
+			{
+				return(0);
+			}
+			wait_until(host_time);
+			wait_for_char(p_serial_comp);
+			return(STL_NO_TRANSITION);
+			break;
+		// Start the motors if they're stopped, then give the output task a finger's target
+		case(22):
+			if (!(p_task_output -> motors_enabled()))
+			{
+				p_task_output -> init_motor();
+				p_task_output -> start_motor();
+			}
+			if (!(p_task_output -> ready_to_output()))
+			{
+				return(STL_NO_TRANSITION);	// Wait
+			}
+			p_task_output -> set_slave_target(host_slave, host_target);
+			last_shape = CHARACTER_NONE;	// The hand is no longer in a letter's shape
+			host_reply(HOST_SET_MOTOR, HOST_OK, NULL, 0);
+			return(0);
+			break;
+		// Once the output task has finished with the slave bus, ask a finger for its 
+		// encoder count
+		case(23):
+			if (!(p_task_output -> ready_to_output()) || !(p_serial_slave -> done_sending()))
+			{
+				return(STL_NO_TRANSITION);	// Wait
+			}
+			while (p_serial_slave -> check_for_char())
+			{
+				p_serial_slave -> getchar();	// Clear slave character buffer
+			}
+			p_slave_chooser -> choose(host_slave);
+			p_serial_slave -> putchar('E');
+			host_time = the_timer.get_time_now();
+			host_time += time_stamp(0, HOST_ANSWER_MS * 1000UL);
+			return(24);
+			break;
+		// Wait for the encoder count and send it to the computer
+		case(24):
+			if (p_serial_slave -> check_for_char())
+			{
+				// Convert from 8 bit truncated count to 10 bit count
+				host_target = (uint16_t)((unsigned char)(p_serial_slave -> getchar())) * 4;
+				host_frame[0] = host_target >> 8;
+				host_frame[1] = host_target & 0xFF;
+				host_reply(HOST_QUERY_ENCODER, HOST_OK, host_frame, 2);
+				return(0);
+			}
+			if (!(host_time > the_timer.get_time_now()))
+			{
+				host_reply(HOST_QUERY_ENCODER, HOST_NO_ANSWER, NULL, 0);
+				return(0);
+			}
+			wait_until(host_time);
+			wait_for_char(p_serial_slave);	// Sleep until the slave answers or it's too late
+			return(STL_NO_TRANSITION);
+			break;
 		default:
 			break;
 	}
 	// If we get here, no transition is called for
 	return (STL_NO_TRANSITION);
 };
+
+//-------------------------------------------------------------------------------------
+/** This method takes the next character out of the sentence and works out how long
+ *  to wait before it's output, then blocks the task until then. The wait starts when
+ *  this method is called, which is as soon as the character before has gone to the
+ *  output task, or for a letter, as soon as the hand has formed it, so no task runs
+ *  are spent between characters. 
+ *  @return True if a character was made ready, false if the sentence is finished
+ */
+
+bool task_user::prepare_character (void)
+{
+	if (character_buffer.is_empty())
+	{
+		return (false);
+	}
+	character_to_output = character_buffer.get();						// Retrieve the character
+		
+	// If it's not a pause character, collect information.
+	if ((character_to_output != '.')||(character_to_output != ',')||(character_to_output != ' '))
+	{
+		flag_outputting_letter = true;
+	}
+	// If it's a pause character, set the proper flag.
+	else
+	{
+		flag_outputting_letter = false;
+		switch(character_to_output)
+		{
+			case('.'):
+				flag_period = true;
+				break;
+			case(','):
+				flag_comma = true;
+				break;
+			case(' '):
+				flag_space = true;
+				break;
+			default:
+				break;
+		}
+	}
+	
+	// Timing calculations
+	if(flag_comma || flag_space || flag_period )
+	{
+		if(flag_comma)
+		{
+			output_delay = 60;
+		}
+		else if(flag_space)
+		{
+			output_delay = 40;
+		}
+		else
+		{
+			output_delay = 80;
+		}
+	}
+	else
+	{
+		output_delay = 20;
+	}
+	current_step = 0;
+	
+	// Sleep until the letter before this one has been held, or for 
+	// output_delay task intervals after a pause
+	delay_end_time = the_timer.get_time_now();
+	if (dwell_ms)
+	{
+		delay_end_time += time_stamp(dwell_ms / 1000, (dwell_ms % 1000) * 1000UL);
+	}
+	else
+	{
+		delay_end_time += time_stamp(interval.get_raw_time() * output_delay);
+	}
+	wait_until(delay_end_time);
+	if (flag_streaming)
+	{
+		wait_for_char(p_serial_comp);	// Keep taking text while waiting
+	}
+	return (true);
+}
+
+//-------------------------------------------------------------------------------------
+/** This method takes the characters which have come from the computer in streaming
+ *  mode and puts them in the queue of characters to be spelled. They're taken as at
+ *  the sentence prompt, except that they aren't echoed and a line end becomes a 
+ *  space. The computer is sent XOFF when the queue is nearly full and XON when it has
+ *  gone down, so that it can send a document of any length and the hand always has 
+ *  something to spell. 
+ *  @return False if Escape was received, to end streaming, and true otherwise
+ */
+
+bool task_user::stream_input (void)
+{
+	char block[USER_INPUT_BUDGET];			// Characters taken from the port at once
+	uint8_t block_size;						// How many there were
+	uint8_t text_size;						// How many came before any Escape
+	
+	block_size = p_serial_comp->getchars(block, USER_INPUT_BUDGET);
+	for (text_size = 0; text_size < block_size && block[text_size] != 0x1B; text_size++);
+	queue_text(block, text_size);
+	if (text_size < block_size)
+	{
+		return (false);						// Escape ends streaming
+	}
+	
+	// Only note a flow control character as sent if there was room to send it
+	if (!flag_xoff_sent && character_buffer.num_items() >= USER_XOFF_LEVEL)
+	{
+		flag_xoff_sent = p_serial_comp->putchar(USER_XOFF);
+	}
+	else if (flag_xoff_sent && character_buffer.num_items() <= USER_XON_LEVEL)
+	{
+		flag_xoff_sent = !(p_serial_comp->putchar(USER_XON));
+	}
+	return (true);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method puts the characters of some text which can be spelled into the queue of
+ *  characters to be spelled. Lowercase letters become capitals, question marks and 
+ *  exclamation points become periods, and a line end becomes a space, but only one 
+ *  for a line end of two characters. Anything else other than letters, digits, 
+ *  spaces, commas and periods is left out. The characters to be spelled are moved 
+ *  down the text, then queued together; any which don't fit in the queue are lost. 
+ *  @param p_text A pointer to the text, which is changed
+ *  @param length The number of characters in the text
+ *  @return The number of characters queued
+ */
+
+uint8_t task_user::queue_text (char* p_text, uint8_t length)
+{
+	uint8_t kept = 0;						// How many are to be spelled
+	
+	for (uint8_t index = 0; index < length; index++)
+	{
+		input_character = p_text[index];
+		if ((input_character >= 'a') && (input_character <= 'z'))
+		{
+			input_character -= ('a' - 'A');
+		}
+		else if ((input_character == '?') || (input_character == '!'))
+		{
+			input_character = '.';
+		}
+		else if ((input_character == 0x0D) || (input_character == 0x0A))
+		{
+			// One space for a line end, even one of two characters
+			if ((kept > 0) ? (p_text[kept - 1] == ' ') : (!character_buffer.is_empty()
+				&& character_buffer[character_buffer.num_items() - 1] == ' '))
+			{
+				continue;
+			}
+			input_character = ' ';
+		}
+		if (((input_character >= '0') && (input_character <= '9'))
+			|| ((input_character >= 'A') && (input_character <= 'Z'))
+			|| (input_character == ' ') || (input_character == ',') || (input_character == '.'))
+		{
+			p_text[kept++] = input_character;
+		}
+	}
+	return (character_buffer.put_n(p_text, kept));
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method takes whatever has come in of the frame being received from the 
+ *  computer. The command and length bytes come first, and then the length says how 
+ *  many more bytes to wait for. Each time bytes come, the time by which the next one
+ *  must come is moved on. A length too long for the frame buffer ends the frame at 
+ *  once, so that host_command() can throw it away. 
+ *  @return True once the whole frame is in, false if more is to come
+ */
+
+bool task_user::host_receive (void)
+{
+	uint8_t wanted;							// Bytes of the frame still to come
+	uint8_t got;							// Bytes which came this time
+	uint8_t had = host_count;				// Bytes which had come before
+	
+	do
+	{
+		if (host_count < 2)
+		{
+			wanted = 2 - host_count;
+		}
+		else if (host_frame[1] > HOST_MAX_DATA)
+		{
+			return (true);
+		}
+		else
+		{
+			wanted = host_frame[1] + 3 - host_count;
+		}
+		if (wanted == 0)
+		{
+			return (true);
+		}
+		got = p_serial_comp->getchars((char*)(host_frame + host_count), wanted);
+		host_count += got;
+	}
+	while (got > 0);
+	
+	if (host_count != had)
+	{
+		host_time = the_timer.get_time_now();
+		host_time += time_stamp(0, HOST_FRAME_GAP_MS * 1000UL);
+	}
+	return (false);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method checks a frame which has come from the computer and carries out its 
+ *  command. Commands which can be done at once are answered here; the others are 
+ *  carried on in the states this method returns. A frame whose check byte is wrong is
+ *  answered HOST_BAD_FRAME and the rest of what the computer sends is thrown away 
+ *  until it stops. 
+ *  @return The state in which the task is to go on
+ */
+
+char task_user::host_command (void)
+{
+	unsigned char command = host_frame[0];	// What the frame asks for
+	unsigned char length = host_frame[1];	// How many data bytes it has
+	unsigned char* p_data = host_frame + 2;	// Where they are
+	unsigned char check = 0;				// Check byte worked out from the frame
+	
+	if (length <= HOST_MAX_DATA)
+	{
+		for (uint8_t count = 0; count < length + 2; count++)
+		{
+			check = host_crc8(check, host_frame[count]);
+		}
+	}
+	if (length > HOST_MAX_DATA || check != p_data[length])
+	{
+		host_frames_bad++;
+		host_reply(command, HOST_BAD_FRAME, NULL, 0);
+		host_time = the_timer.get_time_now();
+		host_time += time_stamp(0, HOST_FRAME_GAP_MS * 1000UL);
+		return (21);
+	}
+	host_frames_good++;
+	flag_host = true;
+	
+	switch (command)
+	{
+		// Spell the text, answering once now and again when it's done
+		case (HOST_SPELL):
+			character_buffer.flush();
+			host_count = queue_text((char*)p_data, length);
+			if (host_count == 0)
+			{
+				host_reply(command, HOST_BAD_DATA, NULL, 0);
+				return (0);
+			}
+			host_reply(command, HOST_OK, &host_count, 1);
+			flag_host_spell = true;
+			return (5);		// Spell it as a sentence typed at the prompt would be
+			break;
+		// Move one finger, once the motors are ready
+		case (HOST_SET_MOTOR):
+			host_slave = p_data[0];
+			host_target = ((uint16_t)p_data[1] << 8) | p_data[2];
+			if (length != 3 || host_slave < 1 || host_slave > NUM_SLAVES
+				|| host_target > SLAVE_TARGET_MAX)
+			{
+				host_reply(command, HOST_BAD_DATA, NULL, 0);
+				return (0);
+			}
+			return (22);
+			break;
+		// Read one finger's encoder, once the slave bus is free
+		case (HOST_QUERY_ENCODER):
+			host_slave = p_data[0];
+			if (length != 1 || host_slave < 1 || host_slave > NUM_SLAVES)
+			{
+				host_reply(command, HOST_BAD_DATA, NULL, 0);
+				return (0);
+			}
+			return (23);
+			break;
+		// Send the counters, in the order given in host_protocol.h
+		case (HOST_READ_STATS):
+			host_frame[0] = letters_spelled >> 8;
+			host_frame[1] = letters_spelled & 0xFF;
+			host_frame[2] = host_frames_good >> 8;
+			host_frame[3] = host_frames_good & 0xFF;
+			host_frame[4] = host_frames_bad >> 8;
+			host_frame[5] = host_frames_bad & 0xFF;
+			host_frame[6] = p_serial_comp->get_lost_chars();
+			host_frame[7] = character_buffer.num_items();
+			host_frame[8] = get_deadline_misses() >> 8;
+			host_frame[9] = get_deadline_misses() & 0xFF;
+			host_frame[10] = p_task_output->motors_enabled() ? 1 : 0;
+			host_frame[11] = p_serial_comp->get_dropped_chars();
+			host_frame[12] = host_answers_held;
+			host_reply(command, HOST_OK, host_frame, HOST_STATS_SIZE);
+			return (0);
+			break;
+		default:
+			host_reply(command, HOST_BAD_COMMAND, NULL, 0);
+			return (0);
+			break;
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method makes an answer frame for the computer and sends it. The status is the
+ *  first data byte. If the transmit buffer hasn't room for the whole frame, it's held
+ *  and run() sends it on a later run, rather than part of it going out now. run() 
+ *  does nothing else while an answer is held, so there's never more than one. 
+ *  @param command The command being answered, without HOST_REPLY
+ *  @param status The HOST_OK or other status of the command
+ *  @param p_data A pointer to any data to follow the status
+ *  @param length The number of data bytes after the status, no more than 
+ *	  HOST_STATS_SIZE
+ */
+
+void task_user::host_reply (unsigned char command, unsigned char status, 
+							const unsigned char* p_data, unsigned char length)
+{
+	unsigned char check;					// Check byte, worked out as bytes go
+	
+	command |= HOST_REPLY;
+	host_answer[0] = HOST_FRAME_START;
+	host_answer[1] = command;
+	check = host_crc8(0, command);
+	host_answer[2] = length + 1;
+	check = host_crc8(check, length + 1);
+	host_answer[3] = status;
+	check = host_crc8(check, status);
+	for (uint8_t count = 0; count < length; count++)
+	{
+		host_answer[count + 4] = p_data[count];
+		check = host_crc8(check, p_data[count]);
+	}
+	host_answer[length + 4] = check;
+	host_answer_size = length + 1 + HOST_FRAME_EXTRA;
+	
+	if (!host_send_answer() && host_answers_held != 0xFF)
+	{
+		host_answers_held++;
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method sends the answer frame in host_answer if the transmit buffer has room
+ *  for all of it, and otherwise leaves it there to be tried again. 
+ *  @return True if the answer went out, false if it's still held
+ */
+
+bool task_user::host_send_answer (void)
+{
+	if (p_serial_comp->room_to_send() < host_answer_size)
+	{
+		return (false);
+	}
+	for (uint8_t count = 0; count < host_answer_size; count++)
+	{
+		p_serial_comp->putchar(host_answer[count]);
+	}
+	host_answer_size = 0;
+	return (true);
+}
@@ -9,6 +9,13 @@
  *	  \li 05-15-2008 JRR Modified to work with two motor drivers rather than one
  *	  \li 03-08-2009 JRR Added code to test A/D converter
  *    \li 01-19-2011 JRR Updated calls to newer version of stl_task constructor
+ *    \li 10-16-2026 Characters made ready while the one before is held
+ *    \li 10-16-2026 Letters held for their time in the table of transitions
+ *    \li 10-16-2026 Letters held from when the hand reports them formed
+ *    \li 10-16-2026 Sentence prompt takes every character waiting, up to a limit
+ *    \li 10-16-2026 Streaming mode, with XON/XOFF flow control
+ *    \li 10-16-2026 Binary frames from a program on the computer, alongside the menu
+ *    \li 10-16-2026 Answer frames held until the transmit buffer has room for them
  *
  *  License:
  *	This file released under the Lesser GNU Public License, version 2. This program
@@ -18,12 +25,28 @@
 
 
 #include "lib/stl_timer.h"
+#include "host_protocol.h"			// Frames from a program on the computer
 
 #ifndef	_TASK_USER_H_
 #define	_TASK_USER_H_
 
 #define MAX_SENTENCE_SIZE	255
 
+/** Most characters the sentence prompt takes from the serial port in one run. At 9600
+ *  baud about 24 come in during one 25 ms run interval, so this keeps up with text
+ *  pasted into the terminal, which would otherwise overrun the receive buffer. */
+#define USER_INPUT_BUDGET	32
+
+#define USER_XON			0x11	///< Tells the computer it may send again
+#define USER_XOFF			0x13	///< Tells the computer to stop sending
+
+/** In streaming mode the computer is sent XOFF once this many characters are waiting
+ *  to be spelled, leaving room for what it sends before it stops. */
+#define USER_XOFF_LEVEL		(MAX_SENTENCE_SIZE - 64)
+
+/// In streaming mode the computer is sent XON once the waiting characters are down to this
+#define USER_XON_LEVEL		64
+
 //-------------------------------------------------------------------------------------
 /** This class contains a task which moves a motorized lever back and forth. 
  *  WARNING:  This task uses an older version of parent class stl_task, and its 
@@ -49,8 +72,11 @@ class task_user : public stl_task
 		unsigned char		character_to_test;		///< Placeholder for character to test
 		unsigned char		steps;					///< Number of steps in a character
 		unsigned char		current_step;			///< Current gesture output step
-		unsigned char		output_delay;			///< Number of times to skip displaying a character
-		unsigned char		current_delay;			///< Remaining number of delay counts
+		unsigned char		output_delay;			///< Number of task intervals to wait before a character
+		time_stamp			delay_end_time;			///< Time at which the output delay is over
+		unsigned char		last_shape;				///< Database row of the hand's shape
+		uint16_t			dwell_ms;				///< Time to form or hold the letter just output
+		time_stamp			settle_end_time;		///< Latest time for the hand to form the letter
 		unsigned char		output_configuration;	///< Finger configuration to output to output task
 		unsigned char		encoder_reading;		///< Encoder reading retrieved from motor
 		
@@ -59,6 +85,22 @@ class task_user : public stl_task
 		bool				flag_space;				///< Flag to indicate a space character
 		bool				flag_delay_countdown;	///< Flag to indicate the output delay countdown has begun
 		bool				flag_outputting_letter;	///< Flag to indicate whether outputting a letter or pause
+		bool				flag_streaming;			///< Text is spelled as it comes, without sentences
+		bool				flag_xoff_sent;			///< The computer has been told to stop sending
+		bool				flag_host;				///< The computer is sending frames, so the menu isn't printed
+		bool				flag_host_spell;		///< The sentence being spelled came in a frame
+		
+		unsigned char		host_frame[HOST_MAX_DATA + 3];	///< Command, length, data and check byte of a frame
+		unsigned char		host_count;				///< Bytes of the frame received so far
+		time_stamp			host_time;				///< Time by which the next byte or answer must come
+		unsigned char		host_slave;				///< Slave a frame's command is for
+		uint16_t			host_target;			///< Encoder count a frame asks a finger to move to
+		uint16_t			host_frames_good;		///< Frames received with a good check byte
+		uint16_t			host_frames_bad;		///< Frames thrown away for a bad check byte
+		uint16_t			letters_spelled;		///< Characters given to the output task since reset
+		unsigned char		host_answer[HOST_STATS_SIZE + 1 + HOST_FRAME_EXTRA];	///< The answer frame being sent, the longest being stats
+		uint8_t				host_answer_size;		///< Bytes of an answer held for room to send it, or zero
+		uint8_t				host_answers_held;		///< Answers which had to wait for room, stopping at 255
 		
 		queue<char, unsigned char, MAX_SENTENCE_SIZE> character_buffer;	///< Character buffer
 		
@@ -67,10 +109,31 @@ class task_user : public stl_task
 
 	public:
 		// The constructor creates a new task object
-		task_user (task_timer&, time_stamp&, base_text_serial*, base_text_serial*, slave_picker*, task_output*);
+		task_user (task_timer&, time_stamp&, base_text_serial*, base_text_serial*, slave_picker*, character_database*, task_output*);
 
 		// The run method is where the task actually performs its function
 		char run (char);
+		
+		// Take the next character from the sentence and wait until it's due
+		bool prepare_character (void);
+		
+		// Take characters streamed from the computer, keeping it from sending too many
+		bool stream_input (void);
+		
+		// Put the characters of some text which can be spelled into the character buffer
+		uint8_t queue_text (char*, uint8_t);
+		
+		// Take the bytes of a frame from the computer as they come
+		bool host_receive (void);
+		
+		// Carry out the command in a frame from the computer
+		char host_command (void);
+		
+		// Send an answer frame to the computer, or hold it until there's room
+		void host_reply (unsigned char, unsigned char, const unsigned char*, unsigned char);
+		
+		// Send the answer frame being held, if there's room for all of it now
+		bool host_send_answer (void);
 
 };
 
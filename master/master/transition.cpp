@@ -0,0 +1,44 @@
+//*************************************************************************************
+/** \file transition.cpp
+ *    This file contains the function which looks up how long the hand should take to
+ *    form each hand shape. The table itself is in transition_table.cpp, which is
+ *    made by the simulator and shouldn't be edited by hand.
+ *
+ *  Revisions:
+ *    \li 10-16-2026 Original file
+ *
+ *  License:
+ *    This file released under the Lesser GNU Public License, version 2. This program
+ *    is intended for educational use only, but it is not limited thereto.
+ */
+//*************************************************************************************
+
+#include <stdint.h>
+#include "lib/hal.h"
+#include "transition.h"
+
+
+//-------------------------------------------------------------------------------------
+/** This function finds how long a shape should be held, from the moment it's given to
+ *  the output task until the next shape may be: the time the hand takes to change
+ *  into it, and then TRANSITION_HOLD_MS so that it can be seen.
+ *  @param from The database row of the shape the hand is in, or anything past the
+ *              last shape if that isn't known
+ *  @param to The database row of the new shape, which must be a hand shape
+ *  @return The time to hold the new shape, in milliseconds
+ */
+
+uint16_t transition_dwell_ms (uint8_t from, uint8_t to)
+{
+	uint8_t ticks;
+
+	if (from < TRANSITION_SHAPES)
+	{
+		ticks = pgm_read_byte (&transition_times[from][to]);
+	}
+	else
+	{
+		ticks = transition_longest;
+	}
+	return ((uint16_t) ticks * TRANSITION_TICK_MS + TRANSITION_HOLD_MS);
+}
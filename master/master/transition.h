@@ -0,0 +1,42 @@
+//*************************************************************************************
+/** \file transition.h
+ *	  This file contains the table of how long the hand takes to change from one hand
+ *	  shape to another, for each of the 36 shapes in the character database (the
+ *	  digits and the letters). The user task holds each letter for TRANSITION_HOLD_MS
+ *	  once the output task finds its fingers in position, or once the time the table
+ *	  gives for the change into it has passed, if that comes first.
+ *	  The table is made on a PC by the simulator's transition model, from the gestures,
+ *	  the slaves' motion profile and the finger model, and it's checked against the
+ *	  simulated slaves in the same way; see sim/transition_model.cpp.
+ *
+ *  Revisions:
+ *	  \li 10-16-2026 Original file
+ *	  \li 10-16-2026 The table's time is the longest a letter waits to be formed
+ *
+ *  License:
+ *	This file released under the Lesser GNU Public License, version 2. This program
+ *	is intended for educational use only, but it is not limited thereto.
+ */
+//*************************************************************************************
+
+#ifndef _TRANSITION_H_
+#define _TRANSITION_H_
+
+#include <stdint.h>
+#include "lib/hal.h"
+
+#define TRANSITION_SHAPES		36			///< Hand shapes, database rows 0-35
+#define TRANSITION_TICK_MS		20			///< Milliseconds in each unit of the table
+#define TRANSITION_HOLD_MS		200			///< Time a letter is held once it's formed
+
+
+/// Time to change from one shape (row) to another (column), in TRANSITION_TICK_MS
+extern const uint8_t transition_times[TRANSITION_SHAPES][TRANSITION_SHAPES] PROGMEM;
+
+/// The longest time in the table, for a change from a shape which isn't known
+extern const uint8_t transition_longest;
+
+// This function finds how long to hold a shape which the hand is changing into
+uint16_t transition_dwell_ms (uint8_t, uint8_t);
+
+#endif // _TRANSITION_H_
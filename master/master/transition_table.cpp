@@ -0,0 +1,69 @@
+//*************************************************************************************
+/** \file transition_table.cpp
+ *    This file contains the time the hand takes to change from each hand shape to
+ *    each other one, in units of TRANSITION_TICK_MS. It was made by the transition
+ *    model in sim/transition_model.cpp and shouldn't be edited by hand; after the
+ *    gestures, the finger counts or the slaves' motion profile change, make it again
+ *    with
+ *    \code
+ *    HAL_SIM_TRANSITIONS=table ./master_sim > transition_table.cpp
+ *    \endcode
+ *    Rows are the shape the hand is in and columns the new shape, both in the order
+ *    of the character database: the digits, then the letters.
+ *
+ *  Revisions:
+ *    \li 10-16-2026 Original file
+ *
+ *  License:
+ *    This file released under the Lesser GNU Public License, version 2. This program
+ *    is intended for educational use only, but it is not limited thereto.
+ */
+//*************************************************************************************
+
+#include <stdint.h>
+#include "lib/hal.h"
+#include "transition.h"
+
+
+const uint8_t transition_times[TRANSITION_SHAPES][TRANSITION_SHAPES] PROGMEM = 
+{
+	//  0    1    2    3    4    5    6    7    8    9    A    B    C    D    E    F    G    H    I    J    K    L    M    N    O    P    Q    R    S    T    U    V    W    X    Y    Z
+	{   3,  77,  77,  77,  69,  77,  69,  69,  69,  77,  77,  69,  45,  45,  80,  77,  77,  77,  77,  77, 112,  77, 112, 112,   3,  45,  45,  77,  69, 112,  77,  77,  69, 112,  77,  77 },	// 0
+	{  77,   3,  77,  77, 112,  77, 112, 112, 112,  77,  77, 112,  77,  77, 112,  77,   3,  77,  77,  77,  78,  77, 144, 144,  77,  77,  77,  45, 112,  78,  77,  77, 112, 112,  77,  77 },	// 1
+	{  77,  77,   3,  77, 112,  77, 112, 112, 112,  77,  77, 112,  77,  77, 112,  77,  77,   3,  77,  77,  78,  77, 112,  78,  77,  77,  77,  77, 112,  78,   4,   3, 112, 112,  77,  77 },	// 2
+	{  77,  77,  77,   3, 112,  77, 112, 112, 112,  77,  77, 112,  77,  77, 112,  77,  77,  77,  77,  77, 112,  77, 112,  78,  77,  77,  77,  77, 112, 112,  77,  77, 112, 112,  77,  77 },	// 3
+	{  62,  94,  94,  94, 101,  77, 101, 101, 101,  94,  94, 101,  94,  94, 101,  94,  94,  94,  94,  94, 144,  94,  79,  79,  62, 112,  94,  94, 101, 144,  94,  94, 101, 101,  94,  94 },	// 4
+	{  77,  77,  77,  77, 112,   3, 112, 112, 112,  77,  77, 112,  77,  77, 112,  77,  77,  77,  77,  77, 112,  77,  78,  78,  77,  77,  77,  77, 112, 112,  77,  77, 112, 112,  77,  77 },	// 5
+	{  62,  94,  94,  94, 101,  94, 101, 101, 101,  94,  94, 101,  62,  62, 129,  94,  94,  94,  94,  94, 144,  94,  78,  79,  62, 112,  94,  94, 101, 144,  94,  94, 101, 101,  94,  94 },	// 6
+	{  62,  94,  94,  94, 101,  94, 101, 101, 101,  94,  94, 101,  94,  94, 129,  94,  94,  94,  94,  94, 144,  94, 113,  79,  62, 112,  94,  94, 101, 144,  94,  94, 101, 101,  94,  94 },	// 7
+	{  62,  94,  94,  94, 101,  94, 101, 101, 101,  94,  94, 101,  94,  94, 129,  94,  94,  94,  94,  94, 144,  94, 145, 145,  62, 112,  94,  94, 101, 144,  94,  94, 101, 101,  94,  94 },	// 8
+	{  77,  77,  77,  77, 112,  77, 112, 112, 112,   3,  77, 112,  77,  77, 112,   3,  77,  77,  77,  77,  78,  77, 144, 144,  77,  77,  77,  77, 112,  78,  77,  77, 112, 144,  77,  77 },	// 9
+	{  77,  77,  77,  77, 112,  77, 112, 112, 112,  77,   3, 112,  77,  77, 112,  77,  77,  77,  77,  77,  78,  77, 144, 144,  77,  77,  77,  77, 112,  78,  77,  77, 112, 144,  77,  77 },	// A
+	{  62,  94,  94,  94, 101,  77, 101, 101, 101,  94,  94, 101,  94,  94, 101,  94,  94,  94,  94,  94, 144,  94,  79,  79,  62, 112,  94,  94, 101, 144,  94,  94, 101, 101,  94,  94 },	// B
+	{  45,  77,  77,  77,  77,  77,  57,  77,  77,  77,  77,  77,   3,  45, 112,  77,  77,  77,  77,  77, 112,  77, 112, 112,  45,  45,  45,  77,  57, 112,  77,  77,  57, 112,  77,  77 },	// C
+	{  45,  77,  77,  77,  77,  77,  69,  77,  77,  77,  77,  77,  45,   3, 112,  77,  77,  77,  77,  77, 112,  77, 112, 112,  45,  45,  77,  77,  77, 112,  77,  77,  69,  78,  77,  77 },	// D
+	{  57,  77,  77,  77, 101,  77, 101, 101, 101,  77,  77, 101,  56,  56, 101,  77,  77,  77,  77,  77, 144,  77, 112, 112,  57, 112,  56,  80, 101, 144,  77,  77, 101, 112,  77,  77 },	// E
+	{  77,  77,  77,  77, 112,  77, 112, 112, 112,   3,  77, 112,  77,  77, 112,   3,  77,  77,  77,  77,  78,  77, 144, 144,  77,  77,  77,  77, 112,  78,  77,  77, 112, 144,  77,  77 },	// F
+	{  77,   3,  77,  77, 112,  77, 112, 112, 112,  77,  77, 112,  77,  77, 112,  77,   3,  77,  77,  77,  78,  77, 144, 144,  77,  77,  77,  45, 112,  78,  77,  77, 112, 112,  77,  77 },	// G
+	{  77,  77,   3,  77, 112,  77, 112, 112, 112,  77,  77, 112,  77,  77, 112,  77,  77,   3,  77,  77,  78,  77, 112,  78,  77,  77,  77,  77, 112,  78,   4,   3, 112, 112,  77,  77 },	// H
+	{  77,  77,  77,  77, 112,  77, 112, 112, 112,  77,  77, 112,  77,  77, 112,  77,  77,  77,   3,   6,  78,  77, 144, 144,  77,  77,  77,  77, 112,  78,  77,  77, 112, 144,  77,   6 },	// I
+	{  77,  77,  77,  77, 112,  77, 112, 112, 112,  77,  77, 112,  77,  77, 112,  77,  77,  77,   3,   6,  78,  77, 144, 144,  77,  77,  77,  77, 112,  78,  77,  77, 112, 144,  77,   6 },	// J
+	{  62,  94,  77,  77, 101,  94, 101, 101, 101,  94,  94, 101,  62,  62, 129,  94,  94,  77,  94,  94, 144,  94, 113,  78,  62, 112,  94,  94, 101, 144,  77,  77, 101, 101,  94,  94 },	// K
+	{  77,  77,  77,  77, 112,  77, 112, 112, 112,  77,  77, 112,  77,  77, 112,  77,  77,  77,  77,  77, 112,   3, 144, 144,  77,  77,  77,  77, 112, 112,  77,  77, 112, 112,  77,  77 },	// L
+	{  62,  77,  77,  77, 101,  94, 101, 101, 101,  94,  77, 101,  56,  77, 129,  94,  77,  77,  94,  94, 144,  77, 144, 144,  62, 112,  77,  77, 101, 144,  77,  77, 101, 144,  94,  94 },	// M
+	{  62,  77,  77,  77, 101,  94, 101, 101, 101,  94,  77, 101,  62,  77, 129,  94,  77,  77,  94,  94, 144,  77, 144, 144,  62, 112,  77,  77, 101, 144,  77,  77, 101, 144,  94,  94 },	// N
+	{   3,  77,  77,  77,  69,  77,  69,  69,  69,  77,  77,  69,  45,  45,  80,  77,  77,  77,  77,  77, 112,  77, 112, 112,   3,  45,  45,  77,  69, 112,  77,  77,  69, 112,  77,  77 },	// O
+	{  62,  77,  77,  77,  94,  94,  94,  94,  94,  94,  94,  94,  62,  62, 129,  94,  77,  77,  94,  94, 112,  77, 129,  95,  62,   3,  94,  77,  94, 112,  77,  77,  94,  95,  94,  94 },	// P
+	{  45,  77,  77,  77,  77,  77,  77,  77,  77,  77,  77,  77,  45,  77, 112,  77,  77,  77,  77,  77, 112,  77, 144, 144,  45,  77,   3,  77,  77, 112,  77,  77,  77,  78,  77,  77 },	// Q
+	{  94,  45,  94,  94, 129,  94, 129, 129, 129,  94,  77, 129,  94,  94, 129,  94,  45,  94,  77,  77,  95,  94, 161, 161,  94,  94,  94,   3, 129,  78,  94,  94, 129, 129,  94,  77 },	// R
+	{  62,  94,  94,  94, 101,  94, 101, 101, 101,  94,  77, 101,  62,  94, 129,  94,  94,  94,  94,  94, 144,  94, 145, 145,  62, 112,  94,  94, 101, 144,  94,  94, 101, 161,  94,  94 },	// S
+	{  62,  77,  94,  94, 101,  94, 101, 101, 101,  94,  77, 101,  62,  77, 129,  94,  77,  94,  94,  94, 144,  77, 161, 161,  62, 112,  77,  77, 101, 145,  94,  94, 101, 144,  94,  94 },	// T
+	{  77,  78,   3,  78, 112,  94, 112, 112, 112,  78,  94, 112,  77,  77, 129,  78,  78,   3,  94,  94,  78,  94, 129,  79,  77,  78,  94,  78, 112,  95,   4,   3, 112, 112,  94,  94 },	// U
+	{  77,  77,   3,  77, 112,  77, 112, 112, 112,  77,  77, 112,  77,  77, 112,  77,  77,   3,  77,  77,  78,  77, 112,  78,  77,  77,  77,  77, 112,  78,   4,   3, 112, 112,  77,  77 },	// V
+	{  62,  94,  94,  94, 101,  94, 101, 101, 101,  94,  94, 101,  62,  62, 129,  94,  94,  94,  94,  94, 144,  94,  78,  79,  62, 112,  94,  94, 101, 144,  94,  94, 101, 101,  94,  94 },	// W
+	{  62,  77,  94,  94, 101,  94, 101, 101, 101,  94,  77, 101,  62,  77, 129,  94,  77,  94,  94,  94, 144,  77, 161, 161,  62, 112,  77,  77, 101, 145,  94,  94, 101, 144,  94,  94 },	// X
+	{  77,  77,  77,  77, 112,  77, 112, 112, 112,  77,  77, 112,  77,  77, 112,  77,  77,  77,  77,  77, 112,  77, 144, 144,  77,  77,  77,  77, 112, 112,  77,  77, 112, 144,   3,  77 },	// Y
+	{  77,  77,  77,  77, 112,  77, 112, 112, 112,  77,  77, 112,  77,  77, 112,  77,  77,  77,   3,   6,  78,  77, 144, 144,  77,  77,  77,  77, 112,  78,  77,  77, 112, 144,  77,   6 } 	// Z
+};
+
+const uint8_t transition_longest = 161;
@@ -0,0 +1,38 @@
+//============================================================================================================
+/** \file hal.h
+ *	This file is the hardware abstraction layer for the slave firmware. The slave's source files get the
+ *	ATtiny2313's registers and interrupts by including this header. When compiled for the AVR it pulls in
+ *	the AVR-LibC headers. When HAL_SIM is defined it pulls in hal_sim.h instead, whose registers belong to
+ *	a simulated chip, so that the master's simulator can run ten copies of this firmware on a PC.
+ *
+ *  Revised:
+ *    \li 10-16-2026 Original file
+ *    \li 10-16-2026 Sleep modes
+ *    \li 10-16-2026 Program memory constants
+ *
+ *  License:
+ *	This file released under the Lesser GNU Public License, version 2. This program
+ *	is intended for educational use only, but it is not limited thereto.
+ */
+//============================================================================================================
+/// This define prevents this .h file from being included more than once in a .cc file
+#ifndef _HAL_H_
+#define _HAL_H_
+
+#if defined (__AVR)
+	#include <avr/io.h>			// AVR device-specific input/output definitions
+	#include <avr/interrupt.h>	// AVR interrupt code
+	#include <avr/sleep.h>		// AVR sleep modes
+	#include <avr/pgmspace.h>	// Constants kept in program memory
+
+	/// The type of an 8-bit register, used for pointers to registers
+	typedef volatile unsigned char hal_reg8;
+
+#elif defined (HAL_SIM)
+	#include "hal_sim.h"		// Registers of a simulated ATtiny2313
+
+#else
+	#error Compile for the AVR, or define HAL_SIM to run the program on a PC
+#endif
+
+#endif
@@ -0,0 +1,161 @@
+//============================================================================================================
+/** \file hal_sim.h
+ *	This file gives the slave firmware the ATtiny2313's register names, bit names and interrupt macros when
+ *	it's compiled for a PC with HAL_SIM defined. Each register name stands for a register of hal_chip, a
+ *	hal_sim_chip (see hal_sim_chip.h) which whoever compiles the firmware must define where the firmware
+ *	can see it. The master's slave simulator compiles the firmware ten times, each time inside its own
+ *	namespace with its own hal_chip, so that the ten slaves don't share their variables.
+ *
+ *	Interrupt service routines become ordinary functions named hal_sim_int0() and hal_sim_int1(), which
+ *	the simulator calls when an encoder channel changes, hal_sim_timer1_compa(), which it calls when
+ *	timer 1 matches OCR1A, and hal_sim_usart_rx(), which it calls when a byte has been received while the
+ *	receive interrupt is on. Sleeping marks the chip as asleep; the simulator stops running the main loop
+ *	until the next interrupt.
+ *
+ *  Revised:
+ *    \li 10-16-2026 Original file
+ *    \li 10-16-2026 Timer 0 overflow flag
+ *    \li 10-16-2026 Timer 1, its compare match interrupt, and idle sleep
+ *    \li 10-16-2026 Program memory reads and the general purpose I/O registers
+ *    \li 10-16-2026 PD4, for the ready line
+ *    \li 10-16-2026 USART receive interrupt, and sleeping in separate steps
+ *
+ *  License:
+ *	This file released under the Lesser GNU Public License, version 2. This program
+ *	is intended for educational use only, but it is not limited thereto.
+ */
+//============================================================================================================
+/// This define prevents this .h file from being included more than once in a .cc file
+#ifndef _HAL_SIM_H_
+#define _HAL_SIM_H_
+
+#include "hal_sim_chip.h"	// The simulated chip
+
+//============================================================================================================
+/* Registers */
+
+/// The type of an 8-bit register, used for pointers to registers
+typedef hal_sim_reg hal_reg8;
+
+#define SREG		(hal_chip.SREG)
+#define MCUCR		(hal_chip.MCUCR)
+#define GIMSK		(hal_chip.GIMSK)
+#define PCMSK		(hal_chip.PCMSK)
+#define PORTB		(hal_chip.PORTB)
+#define DDRB		(hal_chip.DDRB)
+#define PINB		(hal_chip.PINB)
+#define PORTD		(hal_chip.PORTD)
+#define DDRD		(hal_chip.DDRD)
+#define PIND		(hal_chip.PIND)
+#define TCCR0A		(hal_chip.TCCR0A)
+#define TCCR0B		(hal_chip.TCCR0B)
+#define OCR0A		(hal_chip.OCR0A)
+#define TIFR		(hal_chip.TIFR)
+#define TIMSK		(hal_chip.TIMSK)
+#define TCCR1A		(hal_chip.TCCR1A)
+#define TCCR1B		(hal_chip.TCCR1B)
+#define OCR1A		(hal_chip.OCR1A)
+#define TCNT1		(hal_chip.TCNT1)
+#define GPIOR0		(hal_chip.GPIOR0)
+#define GPIOR1		(hal_chip.GPIOR1)
+#define GPIOR2		(hal_chip.GPIOR2)
+#define UDR			(hal_chip.UDR)
+#define UCSRA		(hal_chip.UCSRA)
+#define UCSRB		(hal_chip.UCSRB)
+#define UCSRC		(hal_chip.UCSRC)
+#define UBRRH		(hal_chip.UBRRH)
+#define UBRRL		(hal_chip.UBRRL)
+
+//============================================================================================================
+/* Bit Numbers */
+
+// Port pins
+#define PINB0		0
+#define PINB1		1
+#define PINB2		2
+#define PIND2		2
+#define PIND3		3
+#define PIND4		4
+
+// External interrupts
+#define ISC00		0
+#define ISC01		1
+#define ISC10		2
+#define ISC11		3
+#define PCIE		5
+#define INT0		6
+#define INT1		7
+#define PCINT2		2
+
+// Timer 0
+#define CS00		0
+#define CS01		1
+#define CS02		2
+#define WGM00		0
+#define WGM01		1
+#define COM0A0		6
+#define COM0A1		7
+#define TOV0		1
+
+// Timer 1
+#define CS10		0
+#define CS11		1
+#define CS12		2
+#define WGM12		3
+#define OCIE1A		6
+#define OCF1A		6
+
+// USART
+#define MPCM		0
+#define U2X			1
+#define UPE			2
+#define DOR			3
+#define FE			4
+#define UDRE		5
+#define TXC			6
+#define RXC			7
+#define UCSZ2		2
+#define TXEN		3
+#define RXEN		4
+#define UDRIE		5
+#define TXCIE		6
+#define RXCIE		7
+#define UCPOL		0
+#define UCSZ0		1
+#define UCSZ1		2
+#define USBS		3
+
+//============================================================================================================
+/* Interrupts */
+
+#define INT0_vect			hal_sim_int0
+#define INT1_vect			hal_sim_int1
+#define TIMER1_COMPA_vect	hal_sim_timer1_compa
+#define USART_RX_vect		hal_sim_usart_rx
+
+/// An interrupt service routine is an ordinary function which the simulator calls
+#define ISR(vector, ...)	void vector (void) __VA_ARGS__
+
+/// An alias is a routine which calls the one it's an alias of
+#define ISR_ALIASOF(target)	{ target (); }
+
+#define sei()				(SREG |= HAL_SIM_SREG_I)
+#define cli()				(SREG &= (uint8_t)~HAL_SIM_SREG_I)
+
+//============================================================================================================
+/* Sleep */
+
+#define SLEEP_MODE_IDLE			0
+#define set_sleep_mode(mode)	((void)(mode))
+#define sleep_mode()			(hal_chip.sleeping = true)
+#define sleep_enable()
+#define sleep_disable()
+#define sleep_cpu()				(hal_chip.sleeping = true)
+
+//============================================================================================================
+/* Program Memory */
+
+#define PROGMEM
+#define pgm_read_byte(address)	(*(const unsigned char*)(address))
+
+#endif
@@ -0,0 +1,299 @@
+//============================================================================================================
+/** \file hal_sim_chip.h
+ *	This file contains a model of the parts of an ATtiny2313 which the slave firmware uses, for running the
+ *	firmware on a PC. Each simulated slave has its own hal_sim_chip, and hal_sim.h points the register names
+ *	at it. The chip only holds the registers, the USART's buffers and the timers' counts; whatever drives
+ *	it (the slave simulator in the master project) moves the pins, times the bytes on the wire, counts the
+ *	cycles and calls the interrupt service routines. This header has no register macros, so that the driver can
+ *	include it alongside its own.
+ *
+ *  Revised:
+ *    \li 10-16-2026 Original file
+ *    \li 10-16-2026 Timer 0 counts and sets its overflow flag
+ *    \li 10-16-2026 Timer 1 in CTC mode, and sleeping until an interrupt
+ *    \li 10-16-2026 General purpose I/O registers
+ *    \li 10-16-2026 Receive complete interrupt enable
+ *
+ *  License:
+ *	This file released under the Lesser GNU Public License, version 2. This program
+ *	is intended for educational use only, but it is not limited thereto.
+ */
+//============================================================================================================
+/// This define prevents this .h file from being included more than once in a .cc file
+#ifndef _HAL_SIM_CHIP_H_
+#define _HAL_SIM_CHIP_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+//============================================================================================================
+/* Definitions */
+
+#define HAL_SIM_RCV_LEVELS	2		///< Bytes the receiver holds before it overruns
+#define HAL_SIM_XMT_LEVELS	2		///< Bytes the transmitter holds: data register and shift register
+
+// Bits of UCSRA and UCSRB which the model sets and reads
+#define HAL_SIM_RXC		0x80		///< Receive complete
+#define HAL_SIM_TXC		0x40		///< Transmit complete
+#define HAL_SIM_UDRE	0x20		///< Data register empty
+#define HAL_SIM_FE		0x10		///< Frame error
+#define HAL_SIM_DOR		0x08		///< Data overrun
+#define HAL_SIM_U2X		0x02		///< Double speed
+#define HAL_SIM_RXCIE	0x80		///< Receive complete interrupt enable, in UCSRB
+#define HAL_SIM_SREG_I	0x80		///< Global interrupt enable in SREG
+#define HAL_SIM_TOV0	0x02		///< Timer 0 overflow flag in TIFR
+#define HAL_SIM_CS0		0x07		///< Timer 0 clock select bits in TCCR0B
+#define HAL_SIM_OCF1A	0x40		///< Timer 1 compare match A flag in TIFR
+#define HAL_SIM_OCIE1A	0x40		///< Timer 1 compare match A interrupt enable in TIMSK
+#define HAL_SIM_CS1		0x07		///< Timer 1 clock select bits in TCCR1B
+#define HAL_SIM_WGM12	0x08		///< Timer 1 clear on compare match A, in TCCR1B
+
+struct hal_sim_chip;
+
+//============================================================================================================
+/* Class Definitions */
+
+//-------------------------------------------------------------------------------------
+/** This class is one 8-bit register. Most registers just hold what's written to them; the USART data
+ *  register belongs to a chip, which is told when the firmware reads or writes it, and in a flag register
+ *  such as TIFR, writing a one to a bit clears it.
+ */
+
+class hal_sim_reg
+{
+	public:
+		uint8_t value;			///< What the register holds
+		hal_sim_chip* p_chip;	///< The chip which watches reads and writes, only set for UDR
+		bool flags;				///< Writing ones clears bits, as in TIFR
+
+		/// The constructor makes a register which reads zero, as most do after reset
+		hal_sim_reg (void) : value (0), p_chip (NULL), flags (false) { }
+
+		// Reading and writing the register
+		operator uint8_t (void);
+		hal_sim_reg& operator= (uint8_t);
+
+		/// Setting bits with a read-modify-write
+		hal_sim_reg& operator|= (uint8_t bits) { value |= bits; return (*this); }
+
+		/// Clearing bits with a read-modify-write; the mask is an int, as ~(1 << bit) is
+		hal_sim_reg& operator&= (int bits) { value &= bits; return (*this); }
+
+		/// Toggling bits with a read-modify-write
+		hal_sim_reg& operator^= (uint8_t bits) { value ^= bits; return (*this); }
+
+	private:
+		// Copying a register would leave the copy's p_chip pointing at the wrong thing
+		hal_sim_reg& operator= (const hal_sim_reg&);
+};
+
+
+//-------------------------------------------------------------------------------------
+/** This structure is one simulated ATtiny2313: the registers the slave firmware uses, its cycle count, and
+ *  its USART. A byte written to UDR goes into the transmitter; the driver takes it out with transmitted()
+ *  once it has had time to go out on the wire. Bytes from the wire are put in with receive(), and reading
+ *  UDR takes them out in order, as in the real two-level receive buffer.
+ */
+
+struct hal_sim_chip
+{
+	// The registers, with the names from the ATtiny2313 data sheet
+	hal_sim_reg SREG, MCUCR, GIMSK, PCMSK;
+	hal_sim_reg PORTB, DDRB, PINB, PORTD, DDRD, PIND;
+	hal_sim_reg TCCR0A, TCCR0B, OCR0A, TIFR, TIMSK;
+	hal_sim_reg TCCR1A, TCCR1B;
+	hal_sim_reg GPIOR0, GPIOR1, GPIOR2;
+	uint16_t OCR1A, TCNT1;					///< Timer 1's 16-bit registers, read and written whole
+	hal_sim_reg UDR, UCSRA, UCSRB, UCSRC, UBRRH, UBRRL;
+
+	uint64_t cycles;						///< Clock cycles the chip has run
+	uint32_t timer0_cycles;					///< Clock cycles since timer 0 last overflowed
+	uint32_t timer1_cycles;					///< Clock cycles since timer 1 last counted
+	bool sleeping;							///< The CPU is asleep until an interrupt
+	uint8_t rcv_buf[HAL_SIM_RCV_LEVELS];	///< Bytes received and not yet read
+	uint8_t rcv_count;						///< Number of bytes in the receive buffer
+	uint8_t xmt_buf[HAL_SIM_XMT_LEVELS];	///< Bytes written and not yet sent, oldest first
+	uint8_t xmt_count;						///< Number of bytes in the transmitter
+	uint64_t xmt_done;						///< Cycle at which the oldest byte has gone out
+	uint32_t overruns;						///< Bytes lost because the receiver was full
+	uint32_t collisions;					///< Bytes lost because UDR was written while full
+
+	/// The constructor sets the registers which aren't zero after reset
+	hal_sim_chip (void) : OCR1A (0), TCNT1 (0), cycles (0), timer0_cycles (0), timer1_cycles (0),
+		sleeping (false), rcv_count (0), xmt_count (0), xmt_done (0), overruns (0), collisions (0)
+	{
+		UDR.p_chip = this;
+		TIFR.flags = true;
+		UCSRA.value = HAL_SIM_UDRE;
+	}
+
+	/// This method runs timer 0 for some clock cycles, in its 8-bit modes, and returns true if it overflowed
+	bool count_timer0 (uint32_t run_cycles)
+	{
+		static const uint16_t prescaler[8] = { 0, 1, 8, 64, 256, 1024, 0, 0 };
+		uint32_t period = 256UL * prescaler[TCCR0B.value & HAL_SIM_CS0];
+
+		if (period == 0)
+		{
+			return (false);
+		}
+		timer0_cycles += run_cycles;
+		if (timer0_cycles < period)
+		{
+			return (false);
+		}
+		timer0_cycles %= period;
+		TIFR.value |= HAL_SIM_TOV0;
+		return (true);
+	}
+
+	/// This method runs timer 1 for some clock cycles, fewer than make up one of its periods. It counts up to
+	/// OCR1A and back to zero in CTC mode or through all 16 bits otherwise, and sets the compare match flag
+	/// when the count passes OCR1A
+	void count_timer1 (uint32_t run_cycles)
+	{
+		static const uint16_t prescaler[8] = { 0, 1, 8, 64, 256, 1024, 0, 0 };
+		uint16_t divide = prescaler[TCCR1B.value & HAL_SIM_CS1];
+
+		if (divide == 0)
+		{
+			return;
+		}
+		timer1_cycles += run_cycles;
+		uint32_t count = TCNT1 + timer1_cycles / divide;
+		uint32_t top = (TCCR1B.value & HAL_SIM_WGM12) ? OCR1A : 0xFFFF;
+		timer1_cycles %= divide;
+		if (TCNT1 <= OCR1A && count > OCR1A)
+		{
+			TIFR.value |= HAL_SIM_OCF1A;
+		}
+		TCNT1 = count % (top + 1);
+	}
+
+	/// This method finds how many cycles the USART takes for a byte at the baud rate set in its registers
+	uint32_t byte_cycles (void)
+	{
+		uint32_t per_bit = (UCSRA.value & HAL_SIM_U2X) ? 8 : 16;
+		return (10 * per_bit * (((uint32_t)(UBRRH.value & 0x0F) << 8) + UBRRL.value + 1));
+	}
+
+	/// This method puts a byte from the wire into the receiver; a frame error marks a garbled byte
+	void receive (uint8_t byte, bool frame_error)
+	{
+		if (rcv_count >= HAL_SIM_RCV_LEVELS)
+		{
+			overruns++;
+			UCSRA.value |= HAL_SIM_DOR;
+			return;
+		}
+		rcv_buf[rcv_count++] = byte;
+		UCSRA.value = (UCSRA.value & ~HAL_SIM_FE) | (frame_error ? HAL_SIM_FE : 0) | HAL_SIM_RXC;
+	}
+
+	/// This method is what reading UDR does: it takes the oldest received byte
+	uint8_t read_data (void)
+	{
+		if (rcv_count == 0)
+		{
+			return (UDR.value);
+		}
+		UDR.value = rcv_buf[0];
+		for (uint8_t index = 1; index < rcv_count; index++)
+		{
+			rcv_buf[index - 1] = rcv_buf[index];
+		}
+		if (--rcv_count == 0)
+		{
+			UCSRA.value &= ~(HAL_SIM_RXC | HAL_SIM_FE | HAL_SIM_DOR);
+		}
+		return (UDR.value);
+	}
+
+	/// This method is what writing UDR does: it puts a byte in the transmitter if there's room
+	void write_data (uint8_t byte)
+	{
+		if (xmt_count >= HAL_SIM_XMT_LEVELS)
+		{
+			collisions++;
+			return;
+		}
+		if (xmt_count == 0)
+		{
+			xmt_done = cycles + byte_cycles ();
+		}
+		xmt_buf[xmt_count++] = byte;
+		UCSRA.value &= ~HAL_SIM_TXC;
+		if (xmt_count >= HAL_SIM_XMT_LEVELS)
+		{
+			UCSRA.value &= ~HAL_SIM_UDRE;
+		}
+	}
+
+	/// This method takes out the byte which has finished going out on the wire; call it when xmt_done is due
+	uint8_t transmitted (void)
+	{
+		uint8_t byte = xmt_buf[0];
+		xmt_buf[0] = xmt_buf[1];
+		xmt_count--;
+		UCSRA.value |= HAL_SIM_UDRE;
+		if (xmt_count)
+		{
+			xmt_done += byte_cycles ();
+		}
+		else
+		{
+			UCSRA.value |= HAL_SIM_TXC;
+		}
+		return (byte);
+	}
+
+	/// This method runs an interrupt service routine if interrupts are on, with them off while it runs; an
+	/// interrupt wakes the CPU
+	bool interrupt (void (*p_isr)(void))
+	{
+		if (p_isr == NULL || !(SREG.value & HAL_SIM_SREG_I))
+		{
+			return (false);
+		}
+		sleeping = false;
+		SREG.value &= ~HAL_SIM_SREG_I;
+		p_isr ();
+		SREG.value |= HAL_SIM_SREG_I;
+		return (true);
+	}
+};
+
+
+//-------------------------------------------------------------------------------------
+/** Reading a register gives what it holds, except that reading UDR takes a byte out of the receiver.
+ */
+
+inline hal_sim_reg::operator uint8_t (void)
+{
+	return (p_chip ? p_chip->read_data () : value);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** Writing a register stores the value, except that writing UDR sends a byte and writing a flag register
+ *  clears the bits written as ones.
+ */
+
+inline hal_sim_reg& hal_sim_reg::operator= (uint8_t new_value)
+{
+	if (p_chip)
+	{
+		p_chip->write_data (new_value);
+	}
+	else if (flags)
+	{
+		value &= ~new_value;
+	}
+	else
+	{
+		value = new_value;
+	}
+	return (*this);
+}
+
+#endif
@@ -5,6 +5,7 @@
  *
  *  Revised:
  *    \li 04-09-2011 JV	Original file
+ *    \li 10-16-2026 Registers come from hal.h so the driver can be simulated
  *
  *  License:
  *	This file released under the Lesser GNU Public License, version 2. This program
@@ -12,7 +13,7 @@
  */
 //============================================================================================================
 
-#include <avr/io.h>
+#include "hal.h"
 #include "motor.h"
 
 //--------------------------------------------------------------------------------------
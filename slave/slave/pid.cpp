@@ -0,0 +1,117 @@
+//============================================================================================================
+/** \file pid.cpp
+ *	This file contains a fixed-point PID position controller for an ATtiny2313. Everything is done in
+ *	integers with shifts in place of division, which the chip would otherwise have to do in software.
+ *
+ *  Revised:
+ *    \li 10-16-2026 Original file
+ *    \li 10-16-2026 Terms summed before one rounded shift, so negative terms aren't a step larger
+ *    \li 10-16-2026 Integral kept at full resolution, so small errors of either sign add to it
+ *
+ *  License:
+ *	This file released under the Lesser GNU Public License, version 2. This program
+ *	is intended for educational use only, but it is not limited thereto.
+ */
+//============================================================================================================
+
+#include "pid.h"
+
+//--------------------------------------------------------------------------------------
+/** This function clips a value to within PID_ERROR_LIMIT of zero.
+ */
+
+static short int pid_clip (short int value)
+{
+	if (value > PID_ERROR_LIMIT)
+		return (PID_ERROR_LIMIT);
+	if (value < -PID_ERROR_LIMIT)
+		return (-PID_ERROR_LIMIT);
+	return (value);
+}
+
+//--------------------------------------------------------------------------------------
+/** This function divides by 2^PID_SUM_SHIFT, rounding to the nearest whole number and halves away from zero.
+ *  A plain right shift rounds toward minus infinity, which would make every negative result up to one step
+ *  larger than the positive one for the same error.
+ */
+
+static long pid_descale (long value)
+{
+	if (value < 0)
+		return (-((-value + (1 << (PID_SUM_SHIFT - 1))) >> PID_SUM_SHIFT));
+	return ((value + (1 << (PID_SUM_SHIFT - 1))) >> PID_SUM_SHIFT);
+}
+
+//--------------------------------------------------------------------------------------
+/** This constructor makes a controller with no gains and nothing integrated.
+ */
+
+pid::pid (void)
+{
+	kp = 0;
+	ki = 0;
+	kd = 0;
+	integral = 0;
+	last_count = 0;
+}
+
+void pid::set_gains (unsigned char new_kp, unsigned char new_ki, unsigned char new_kd)
+{
+	kp = new_kp;
+	ki = new_ki;
+	kd = new_kd;
+}
+
+void pid::reset (unsigned short int count)
+{
+	integral = 0;
+	last_count = count;
+}
+
+//--------------------------------------------------------------------------------------
+/** This method runs the controller for one tick. The proportional term acts on the error, the derivative
+ *  term on how far the motor moved since the last tick, and the integral only grows while the output isn't
+ *  saturated in the direction the error would push it.
+ *  @param desired The encoder count the motor should be at
+ *  @param count The encoder count the motor is at
+ *  @return The PWM output from -255 to 255, positive to make the count go up
+ */
+
+short int pid::run (unsigned short int desired, unsigned short int count)
+{
+	short int error = pid_clip ((short int) (desired - count));
+	short int speed = pid_clip ((short int) (count - last_count));
+	long sum;
+	long new_integral;
+
+	last_count = count;
+
+	// Within the deadband the motor is left off, and the integral is emptied so it can't push the motor
+	// back out against static friction
+	if (error <= PID_DEADBAND && error >= -PID_DEADBAND)
+	{
+		integral = 0;
+		return (0);
+	}
+
+	// Each product is at most 255 * 127, so it fits in a short int; the sum of three such terms needs a long.
+	// The terms are added at the integral's resolution and rounded once, so rounding errors don't pile up
+	sum = pid_descale ((((long) (kp * error) - (long) (kd * speed)) << PID_I_SHIFT) + integral);
+
+	// Trim to the PWM range, integrating only if that doesn't wind the integral up further
+	if (sum > PID_OUTPUT_LIMIT)
+		sum = PID_OUTPUT_LIMIT;
+	else if (sum < -PID_OUTPUT_LIMIT)
+		sum = -PID_OUTPUT_LIMIT;
+	if (!(sum == PID_OUTPUT_LIMIT && error > 0) && !(sum == -PID_OUTPUT_LIMIT && error < 0))
+	{
+		new_integral = integral + (short int) (ki * error);
+		if (new_integral > PID_INTEGRAL_LIMIT)
+			new_integral = PID_INTEGRAL_LIMIT;
+		else if (new_integral < -PID_INTEGRAL_LIMIT)
+			new_integral = -PID_INTEGRAL_LIMIT;
+		integral = (short int) new_integral;
+	}
+
+	return ((short int) sum);
+}
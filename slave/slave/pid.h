@@ -0,0 +1,73 @@
+//============================================================================================================
+/** \file pid.h
+ *	This file contains a header for a fixed-point PID position controller for an ATtiny2313. The ATtiny2313
+ *	has no hardware multiplier or divider, so the controller makes only 16-bit products and scales with
+ *	shifts: gains are unsigned chars in eighths of a PWM step (Q3), and errors are clipped so that no
+ *	product can overflow. The derivative acts on the measured position rather than on the error, so a new
+ *	set point doesn't kick the motor, and the integral stops growing while the output is saturated.
+ *
+ *  Revised:
+ *    \li 10-16-2026 Original file
+ *    \li 10-16-2026 Gains retuned for the 1 kHz control interrupt
+ *    \li 10-16-2026 Integral kept in Q7, so ki * error isn't rounded away each tick; ki retuned
+ *
+ *  License:
+ *	This file released under the Lesser GNU Public License, version 2. This program
+ *	is intended for educational use only, but it is not limited thereto.
+ */
+//============================================================================================================
+/// This define prevents this .h file from being included more than once in a .cc file
+#ifndef _PID_H_
+#define _PID_H_
+
+//============================================================================================================
+/* Definitions */
+
+#define PID_SHIFT			3		///< Gains are in units of 2^-PID_SHIFT PWM steps
+#define PID_I_SHIFT			4		///< Each tick adds ki * error / 2^PID_I_SHIFT to the integral
+#define PID_SUM_SHIFT		(PID_SHIFT + PID_I_SHIFT)	///< The integral is in units of 2^-PID_SUM_SHIFT steps
+#define PID_ERROR_LIMIT		127		///< Errors and speeds are clipped to this so products fit in 16 bits
+#define PID_INTEGRAL_LIMIT	(255 << PID_SUM_SHIFT)	///< Largest integral, enough for full output
+#define PID_OUTPUT_LIMIT	255		///< Largest PWM output
+#define PID_DEADBAND		1		///< Errors this small, in counts, leave the motor off
+
+// Default gains, tuned in the simulator for a 1 kHz tick
+#define PID_KP_DEFAULT		64		///< Proportional gain: 8 PWM steps per count
+#define PID_KI_DEFAULT		8		///< Integral gain: 1/16 PWM step per count per tick
+#define PID_KD_DEFAULT		160		///< Derivative gain: 20 PWM steps per count per tick
+
+//============================================================================================================
+/* Class Definition */
+
+//-------------------------------------------------------------------------------------
+/** This class is a PID controller for one motor. It's meant to be run at a steady rate, once per tick,
+ *  with the desired and measured encoder counts, and it gives back a PWM value from -255 to 255 whose sign
+ *  is the direction in which the count should move.
+ */
+
+class pid
+{
+	protected:
+		unsigned char kp;				///< Proportional gain, Q3
+		unsigned char ki;				///< Integral gain, Q3
+		unsigned char kd;				///< Derivative gain, Q3
+		short int integral;				///< Sum of the integral term, Q7 PWM steps
+		unsigned short int last_count;	///< Measured count at the previous tick
+
+	public:
+		/// The constructor makes a controller with no gains, which leaves the motor off
+		pid (void);
+
+		/// This method sets the three gains
+		void set_gains (unsigned char, unsigned char, unsigned char);
+
+		/// This method clears the integral and takes the present count as the last one measured
+		void reset (unsigned short int);
+
+		/// This method runs the controller for one tick and returns the signed PWM output
+		short int run (unsigned short int, unsigned short int);
+};
+
+//============================================================================================================
+
+#endif
@@ -0,0 +1,141 @@
+//============================================================================================================
+/** \file profile.cpp
+ *	This file contains a trapezoidal motion profile for an ATtiny2313 motor controller. The speed only ever
+ *	changes by one step of acceleration, so it's always a whole number of steps, and the distance needed to
+ *	stop from it is the sum of the speeds on the way down: when the speed goes up a step the old speed is
+ *	added to that distance, and when it goes down a step the new speed is taken off.
+ *
+ *  Revised:
+ *    \li 10-16-2026 Original file
+ *    \li 10-16-2026 at_target() for the in-position query
+ *    \li 10-16-2026 set_limits() no longer stops the motion; the new limits are taken up at rest
+ *
+ *  License:
+ *	This file released under the Lesser GNU Public License, version 2. This program
+ *	is intended for educational use only, but it is not limited thereto.
+ */
+//============================================================================================================
+
+#include "profile.h"
+
+//--------------------------------------------------------------------------------------
+/** This constructor makes a profile with the default limits, at rest at a count of zero.
+ */
+
+profile::profile (void)
+{
+	position = 0;
+	braking = 0;
+	target = 0;
+	speed = 0;
+	reverse = false;
+	set_limits (PROFILE_SPEED_DEFAULT, PROFILE_ACCEL_DEFAULT);
+}
+
+//--------------------------------------------------------------------------------------
+/** This method sets new limits. The speed is always a whole number of steps of acceleration and the
+ *  distance needed to stop is worked out from those steps, so neither can change in the middle of a move;
+ *  if the profile is moving, it finishes the move with the old limits and takes up the new ones when it
+ *  next stops.
+ *  @param new_speed The speed limit, in units of 2^(PROFILE_SPEED_SHIFT - 16) counts per tick
+ *  @param new_accel The acceleration, in units of 2^(PROFILE_ACCEL_SHIFT - 16) counts per tick^2
+ */
+
+void profile::set_limits (unsigned char new_speed, unsigned char new_accel)
+{
+	next_speed = new_speed;
+	next_accel = new_accel;
+	if (speed == 0)
+		use_limits ();
+}
+
+void profile::use_limits (void)
+{
+	max_speed = (unsigned short int) next_speed << PROFILE_SPEED_SHIFT;
+	accel = (unsigned short int) next_accel << PROFILE_ACCEL_SHIFT;
+	if (accel > max_speed)
+		accel = max_speed;		// Reach the speed limit in one step rather than never
+}
+
+void profile::set_target (unsigned short int new_target)
+{
+	target = new_target;
+}
+
+void profile::reset (unsigned short int count)
+{
+	position = (long) count << 16;
+	speed = 0;
+	braking = 0;
+}
+
+//--------------------------------------------------------------------------------------
+/** This method moves the profile on by one tick. It slows down if going on at its present speed would
+ *  leave too little room to stop on the set point, or if it's heading away from the set point; otherwise
+ *  it speeds up, until it reaches the speed limit.
+ *  @return The encoder count the motor should be at, rounded to the nearest count
+ */
+
+unsigned short int profile::run (void)
+{
+	long distance = ((long) target << 16) - position;
+
+	// Limits given during a move are taken up once it has stopped
+	if (speed == 0)
+		use_limits ();
+
+	// With no limits, go straight to the set point
+	if (max_speed == 0 || accel == 0)
+	{
+		position = (long) target << 16;
+		return (target);
+	}
+
+	// Measure the distance in the direction of motion, turning around only when stopped
+	if (reverse)
+		distance = -distance;
+	if (speed == 0 && distance < 0)
+	{
+		reverse = !reverse;
+		distance = -distance;
+	}
+
+	// Within a step of the set point and slow enough to stop there
+	if (speed <= accel && distance <= (long) accel && distance >= -(long) accel)
+	{
+		position = (long) target << 16;
+		speed = 0;
+		braking = 0;
+		return (target);
+	}
+
+	if (distance < (long) speed + braking)
+	{
+		speed -= accel;
+		braking -= speed;
+	}
+	else if (speed <= max_speed - accel)	// The speed limit is never less than one step
+	{
+		braking += speed;
+		speed += accel;
+	}
+
+	if (reverse)
+		position -= speed;
+	else
+		position += speed;
+
+	return ((unsigned short int) ((position + 0x8000L) >> 16));
+}
+
+
+//--------------------------------------------------------------------------------------
+/** This method tells whether the profile has come to rest on its set point, so that the desired count
+ *  has stopped changing. 
+ *  @return True if the profile is stopped at the set point, false if it's still on its way
+ */
+
+bool profile::at_target (void)
+{
+	return (speed == 0 && position == ((long) target << 16));
+}
@@ -0,0 +1,82 @@
+//============================================================================================================
+/** \file profile.h
+ *	This file contains a header for a trapezoidal motion profile for an ATtiny2313 motor controller. Rather
+ *	than jumping straight to a new set point, which saturates the motor and makes it overshoot, the profile
+ *	moves the controller's desired count toward the set point one control tick at a time: speeding up at a
+ *	steady acceleration, cruising at the top speed, and slowing down at the same rate so as to stop on the
+ *	set point. Positions and speeds are fixed-point numbers with 16 fractional bits, and the distance needed
+ *	to stop is kept up to date by adding and subtracting as the speed changes, so the profile needs no
+ *	multiplication or division.
+ *
+ *  Revised:
+ *    \li 10-16-2026 Original file
+ *    \li 10-16-2026 Tells when it has stopped on its set point, for the in-position query
+ *    \li 10-16-2026 New limits wait until the motion has stopped, so a move isn't jerked to a halt
+ *
+ *  License:
+ *	This file released under the Lesser GNU Public License, version 2. This program
+ *	is intended for educational use only, but it is not limited thereto.
+ */
+//============================================================================================================
+/// This define prevents this .h file from being included more than once in a .cc file
+#ifndef _PROFILE_H_
+#define _PROFILE_H_
+
+//============================================================================================================
+/* Definitions */
+
+#define PROFILE_SPEED_SHIFT		8		///< Speed limit units are 2^(PROFILE_SPEED_SHIFT - 16) counts per tick
+#define PROFILE_ACCEL_SHIFT		2		///< Acceleration units are 2^(PROFILE_ACCEL_SHIFT - 16) counts per tick^2
+
+// Default limits for a 1 kHz tick
+#define PROFILE_SPEED_DEFAULT	160		///< Speed limit: 5/8 count per tick, about the motor's top speed
+#define PROFILE_ACCEL_DEFAULT	160		///< Acceleration: about 9800 counts per second per second
+
+//============================================================================================================
+/* Class Definition */
+
+//-------------------------------------------------------------------------------------
+/** This class is a trapezoidal motion profile for one motor. It's run once per control tick and gives the
+ *  encoder count the motor should be at during that tick. A speed limit of zero turns the profile off, so
+ *  that the desired count jumps straight to each new set point as it did before.
+ */
+
+class profile
+{
+	protected:
+		long position;					///< Where the motor should be, counts << 16
+		long braking;					///< Distance it would take to stop, counts << 16
+		unsigned short int target;		///< Set point being moved toward, in counts
+		unsigned short int speed;		///< Speed toward the set point, counts per tick << 16
+		unsigned short int max_speed;	///< Speed limit, counts per tick << 16
+		unsigned short int accel;		///< Change of speed in each tick, counts per tick << 16
+		unsigned char next_speed;		///< Speed limit to take up once stopped, as given to set_limits()
+		unsigned char next_accel;		///< Acceleration to take up once stopped, as given to set_limits()
+		bool reverse;					///< Moving toward lower counts
+
+		/// This method takes up the limits last given to set_limits()
+		void use_limits (void);
+
+	public:
+		/// The constructor makes a profile with the default limits, standing at zero
+		profile (void);
+
+		/// This method sets the speed limit and acceleration, in the units of PROFILE_SPEED_SHIFT and
+		/// PROFILE_ACCEL_SHIFT; a move under way finishes with the old ones
+		void set_limits (unsigned char, unsigned char);
+
+		/// This method sets a new set point to move toward
+		void set_target (unsigned short int);
+
+		/// This method puts the profile at rest at a count, for when the motor has been moved while off
+		void reset (unsigned short int);
+
+		/// This method moves the profile on by one tick and returns the count the motor should be at
+		unsigned short int run (void);
+		/// This method tells whether the profile has stopped on its set point
+		bool at_target (void);
+};
+
+//============================================================================================================
+
+#endif
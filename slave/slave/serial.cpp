@@ -19,6 +19,9 @@
  *    \li 01-30-2009 JRR Added class with port setup in constructor
  *    \li 04-09-2009 JRR Changed to a simpler baud rate calculation formula
  *    \li 04-08-2011 JV	New file based on Dr. Ridgely's base232.h file
+ *    \li 10-16-2026 Registers come from hal.h so the port can be simulated
+ *    \li 10-16-2026 U2X set as a bit mask rather than its bit number, which set MPCM instead;
+ *        set_baud() changes the rate, and a frame error puts it back to the base rate
  *
  *  License:
  *	This file released under the Lesser GNU Public License, version 2. This program
@@ -26,7 +29,7 @@
  */
 //============================================================================================================
 
-#include <avr/io.h>
+#include "hal.h"
 #include "serial.h"
 
 /** This constructor sets up a USART serial port for the ATtiny2313.
@@ -44,17 +47,50 @@ serial::serial (void)
 	// Setup USART Control and Status Register C (UCSRC)
 	UCSRC = (1 << UCSZ1) | (1 << UCSZ0);	// Set UCSZ bits to 8 bit character size
 	
-	// Calculate baud rate divisor
-	UBRRH = (unsigned char)(BAUD_DIV >> 8);
-	UBRRL = (unsigned char) BAUD_DIV;
-	
 	// Setup USART Control and Status Register A (UCSRA)
-	UCSRA |= U2X;	// Double Speed
+	UCSRA |= (1 << U2X);	// Double Speed
+	
+	// Calculate baud rate divisor
+	set_baud(0);
 	
 	// Create Masks
 	mask_UDRE = (1 << UDRE);
 	mask_RXC = (1 << RXC);
 	mask_TXC = (1 << TXC);
+	mask_FE = (1 << FE);
+}
+
+/** This method changes the baud rate. Anything still being sent or received goes wrong, so the master
+ *  only asks for a new rate when the bus is quiet.
+ *  @param code The rate's code: 0 for BAUD_RATE, or 1-4 for BAUD_RATE_1 to BAUD_RATE_4. Any other code
+ *              gives BAUD_RATE
+ */
+void serial::set_baud (unsigned char code)
+{
+	unsigned short int divisor;
+	
+	switch (code)
+	{
+		case (1):
+			divisor = BAUD_DIV(BAUD_RATE_1);
+			break;
+		case (2):
+			divisor = BAUD_DIV(BAUD_RATE_2);
+			break;
+		case (3):
+			divisor = BAUD_DIV(BAUD_RATE_3);
+			break;
+		case (4):
+			divisor = BAUD_DIV(BAUD_RATE_4);
+			break;
+		default:
+			code = 0;
+			divisor = BAUD_DIV(BAUD_RATE);
+			break;
+	}
+	baud_code = code;
+	UBRRH = (unsigned char)(divisor >> 8);
+	UBRRL = (unsigned char) divisor;
 }
 
 /** This method will send data out the serial port. 
@@ -105,15 +141,28 @@ bool serial::check_for_char (void)
 /** This method gets one character from the serial port, if one is there.  If not, it
  *  waits until there is a character available.  This can sometimes take a long time
  *  (even forever), so use this function carefully.  One should almost always use
- *  check_for_char() to ensure that there's data available first. 
+ *  check_for_char() to ensure that there's data available first. A character with a
+ *  frame error above the base rate means the master has gone back to the base rate, 
+ *  so the port goes back to it too.
  *  @return The character which was found in the serial port receive buffer
  */
 char serial::getchar (void)
 {
+	unsigned char status;
+	char data_in;
+	
 	//  Wait until there's something in the receiver buffer
 	while ((*p_USR & mask_RXC) == 0);
 
+	//  The status belongs to the character in the buffer, so it's read first
+	status = *p_USR;
+	data_in = *p_UDR;
+	if ((status & mask_FE) && baud_code != 0)
+	{
+		set_baud(0);
+	}
+
 	//  Return the character retreived from the buffer
-	return (*p_UDR);
+	return (data_in);
 }
 
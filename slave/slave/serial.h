@@ -5,6 +5,9 @@
  *
  *  Revised:
  *    \li 04-09-2011 JV	Original file.
+ *    \li 10-16-2026 Register pointers use the hal_reg8 type from hal.h
+ *    \li 10-16-2026 Double speed mode really set; baud rate changed with set_baud(), going back to
+ *        the base rate on a frame error
  *
  *  License:
  *	This file released under the Lesser GNU Public License, version 2. This program
@@ -15,12 +18,20 @@
 #ifndef _SERIAL_H_
 #define _SERIAL_H_
 
+#include "hal.h"		// Register type, real or simulated
+
 //============================================================================================================
 /* Definitions */
 
 #define CPU_FREQ_Hz	20000000
-#define BAUD_RATE	9600
-#define BAUD_DIV	(((CPU_FREQ_Hz) / (16UL * (BAUD_RATE))))
+#define BAUD_RATE	9600		// Base rate, code 0, used after reset
+#define BAUD_RATE_1	38400		// Faster rates the master can ask for with codes 1-4
+#define BAUD_RATE_2	125000
+#define BAUD_RATE_3	250000
+#define BAUD_RATE_4	500000
+
+/// Baud rate divisor for double speed mode, rounded to the nearest rate the clock can make
+#define BAUD_DIV(rate)	((((CPU_FREQ_Hz) + 4UL * (rate)) / (8UL * (rate))) - 1)
 
 //============================================================================================================
 
@@ -32,13 +43,13 @@ class serial
 {
 	protected:
 		/// This is a pointer to the data register used by the UART
-		volatile unsigned char* p_UDR;
+		hal_reg8* p_UDR;
 
 		/// This is a pointer to the status register used by the UART
-		volatile unsigned char* p_USR;
+		hal_reg8* p_USR;
 
 		/// This is a pointer to the control register used by the UART
-		volatile unsigned char* p_UCR;
+		hal_reg8* p_UCR;
 
 		/// This bitmask identifies the bit for data register empty, UDRE
 		unsigned char mask_UDRE;
@@ -48,10 +59,22 @@ class serial
 
 		/// This bitmask identifies the bit for transmission complete, TXC
 		unsigned char mask_TXC;
+
+		/// This bitmask identifies the bit for frame error, FE
+		unsigned char mask_FE;
+
+		/// Code of the baud rate in use, 0 for BAUD_RATE
+		unsigned char baud_code;
 	public:
 		/// The constructor sets up the port with the given baud rate and port number.
 		serial (void);
 
+		/// This method changes the baud rate to the one with the given code
+		void set_baud (unsigned char);
+
+		/// This method returns the code of the baud rate in use
+		unsigned char get_baud (void) { return (baud_code); }
+
 		/// This method sends a byte out
 		void send(unsigned char);
 
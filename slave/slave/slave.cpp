@@ -1,6 +1,6 @@
 //============================================================================================================
 /** \file controller.cc
- *	This file contains a program for an ATtiny2313 chip to control a single motor using proportional control.
+ *	This file contains a program for an ATtiny2313 chip to control a single motor using PID control.
  *	It includes interrupt service routines for monitoring the two quadrature encoder channels and PWM output
  *	to a motor driver chip. It also includes serial communication code to communicate with another
  *	microcontroller or a computer.
@@ -9,6 +9,19 @@
  *	\li  04-02-2011	JV	Original file for four channel quadrature decoder
  *	\li	04-05-2011	JV	File changed to include complete motor control
  *	\li	04-12-2011	JV	Motor control classes tested
+ *	\li	10-16-2026	Broadcast set point frames; data task now reads each character once
+ *	\li	10-16-2026	Main split into setup and loop functions so the firmware can be simulated
+ *	\li	10-16-2026	Fixed-point PID run on the timer 0 overflow tick replaces proportional control
+ *	\li	10-16-2026	Control loop moved into a timer 1 interrupt at CONTROL_RATE_Hz; the CPU idles between
+ *					interrupts, and the T command reports how long the control interrupt takes
+ *	\li	10-16-2026	Encoder decoded with a lookup table instead of nested switches
+ *	\li	10-16-2026	Set points reached along a trapezoidal motion profile, set with the P command; gains
+ *					kept in program memory to make room for it
+ *	\li	10-16-2026	Target frames carry a full 10 bit encoder count for each motor
+ *	\li	10-16-2026	Q command answers whether the motor is in position, judged by the control interrupt
+ *	\li	10-16-2026	Ready line held low from each new set point until the motor is in position
+ *	\li	10-16-2026	B and U commands let the master raise the baud rate and test it; a received byte wakes
+ *					the CPU, so that bytes coming faster than the control interrupt aren't lost
  *
  *  License:
  *	This file released under the Lesser GNU Public License, version 2. This program
@@ -19,13 +32,14 @@
 
 // Standard Libraries
 
-#include <avr/io.h>			// AVR device-specific input/output definitions
-#include <avr/interrupt.h>	// AVR interrupt code
+#include "hal.h"			// AVR input/output and interrupts, real or simulated
 	
 // Header Files
 
 #include "motor.h"			// Motor Object
 #include "serial.h"			// Serial Object
+#include "pid.h"			// PID Controller Object
+#include "profile.h"		// Motion Profile Object
 #include "angles.h"			// Angle Configuration
 
 //============================================================================================================
@@ -37,9 +51,45 @@
 #define PIN_INT0		PIND2
 #define PIN_INT1		PIND3
 
-#define CLOCKWISE		count++
-#define COUNTERCLOCKWISE	count--
-#define ENCODER_ERROR	errors++
+#define ENCODER_SHIFT	PIND2	// Encoder channels A and B are the two pins starting here
+#define ENCODER_STATE	GPIOR0	// (Last reading << 2) | current reading, each (B << 1) | A
+#define ENCODER_DELTA	GPIOR1	// Signed steps counted since the control interrupt last read them
+
+// Control loop timing. Timer 1 counts CPU_FREQ_Hz / 8 and interrupts once per control period; the
+// interrupt must finish within CONTROL_TICKS timer counts, CPU_FREQ_Hz / CONTROL_RATE_Hz cycles
+#define CONTROL_RATE_Hz	1000	// Control updates per second
+#define CONTROL_TICKS	(CPU_FREQ_Hz / (8UL * CONTROL_RATE_Hz))	// Timer 1 counts per control period
+
+// Set point frames broadcast by the master (see slave_protocol.h in the master code)
+#define FRAME_START		'F'		// First byte of a set point frame
+#define FRAME_DATA		5		// Data bytes in a frame, two motors each
+#define FRAME_MARK		0x80	// Bit set in every data and check byte
+
+// Target frames broadcast by the master, holding an encoder count for each motor
+#define TARGET_START	'W'		// First byte of a target frame
+#define TARGET_DATA		20		// Data bytes in a frame, high then low byte for each motor
+#define TARGET_KEEP		0x40	// Bit in a high byte which leaves that motor's target alone
+#define TARGET_QUIET	0x20	// Bit in a high byte which leaves the ready line alone for that move
+
+// Ready line, shared by all the slaves and read by the master. It's open drain: a slave pulls it low by
+// making the pin an output, as the pin's port bit is always 0, and lets it go by making it an input
+#define READY_DDR		DDRD
+#define READY_PORT		PORTD
+#define PIN_READY		PIND4
+
+// Baud rate commands from the master. B and a rate code switch the serial port to that rate; U and
+// BAUD_TEST_BYTES bytes of a known pattern test it, and the slave answers u if every byte came through
+#define BAUD_COMMAND	'B'		// Switch baud rate; the code follows, with FRAME_MARK set
+#define BAUD_TEST		'U'		// Test the baud rate
+#define BAUD_TEST_ACK	'u'		// Answer to a test which came through
+#define BAUD_TEST_BYTES	64		// Pattern bytes in a test
+#define BAUD_PATTERN(n)	(FRAME_MARK | ((0x55 + 0x3B * (n)) & 0x7F))	// Pattern byte n of a test
+
+// In-position test for the Q command. The motor is in position once the motion profile has stopped on the
+// set point, the count is within SETTLE_ERROR of it, and no encoder step has come for SETTLE_TICKS control
+// ticks, so the motor is turning slower than CONTROL_RATE_Hz / SETTLE_TICKS counts per second
+#define SETTLE_ERROR	8		// Counts either side of the set point
+#define SETTLE_TICKS	20		// Control ticks without an encoder step
 
 
 //============================================================================================================
@@ -51,37 +101,46 @@
 	char 			character_in;		// Incoming character read by serial port
 	char				throwaway;		// Throwaway character from when other chips are talked to
 	unsigned char		count_input;		// Incoming count set point from master chip
+	unsigned char		frame_byte;		// Latest byte of a set point frame
+	unsigned char		frame_index;		// Number of frame data bytes received so far
+	unsigned char		frame_check;		// Running check of the frame data bytes
+	unsigned char		frame_field;		// Frame data byte holding this motor's set point
+	unsigned char		frame_low;			// Target frame byte holding the low bits of this motor's count
 
 	// Encoder Reading
-	unsigned short int	count = 1;			// Encoder count
+	unsigned short int	count = 1;			// Encoder count, brought up to date each control tick
 	unsigned char		count_8bit = 1;		// Top 8 bits of the 10 bit encoder count
-	unsigned char		current_reading = 0;	// Current encoder quadrature reading
-	unsigned char		previous_reading = 0;	// Last encoder quadrature reading
 	unsigned char		errors = 0;			// Number of encoder errors
 	
 	// Configuration
-	unsigned char		kp_array[10];
-	unsigned char		ki_array[10];
-	unsigned char		kd_array[10];
+	const unsigned char	kp_array[10] PROGMEM = { PID_KP_DEFAULT, PID_KP_DEFAULT, PID_KP_DEFAULT, PID_KP_DEFAULT,
+												 PID_KP_DEFAULT, PID_KP_DEFAULT, PID_KP_DEFAULT, PID_KP_DEFAULT,
+												 PID_KP_DEFAULT, PID_KP_DEFAULT };
+	const unsigned char	ki_array[10] PROGMEM = { PID_KI_DEFAULT, PID_KI_DEFAULT, PID_KI_DEFAULT, PID_KI_DEFAULT,
+												 PID_KI_DEFAULT, PID_KI_DEFAULT, PID_KI_DEFAULT, PID_KI_DEFAULT,
+												 PID_KI_DEFAULT, PID_KI_DEFAULT };
+	const unsigned char	kd_array[10] PROGMEM = { PID_KD_DEFAULT, PID_KD_DEFAULT, PID_KD_DEFAULT, PID_KD_DEFAULT,
+												 PID_KD_DEFAULT, PID_KD_DEFAULT, PID_KD_DEFAULT, PID_KD_DEFAULT,
+												 PID_KD_DEFAULT, PID_KD_DEFAULT };
 	unsigned char		set_point_angles[10];
+	unsigned char		profile_speed;		// Speed limit of a P command, kept until its acceleration comes
 
 	// Control Loop
 	unsigned short int	desired_count;		// Desired encoder count
-	short int			control_error;		// Difference between encoder_count and desired_count
-	unsigned char		kp;				// Proportional gain
-	unsigned char		ki;				// Integral gain
-	unsigned char		kd;				// Derivative gain
-	long int			motor_output;		// PWM value to output to the motor
+	short int			motor_output;		// PWM value to output to the motor, signed for direction
+	unsigned char		control_ticks;		// Longest control interrupt, in timer 1 counts of 8 cycles
+	unsigned char		still_ticks;		// Control ticks since the last encoder step, up to SETTLE_TICKS
 	unsigned char		set_point = 1;		// Set point (1-5) for motor position
 	unsigned char		motor_number;		// '1'-'0' identification of which motor number
 
 	// State Transition Logic
-	unsigned char 		state_motor = 0;	// Next state to jump into in motor task
 	unsigned char		state_data = 0;	// Next state to jump into for data task
 	
 	// Flags
 	bool				flag_enable = false;	// Motor output enable
 	bool				flag_calibrate = false;	// Encoder calibration flag
+	bool				flag_in_position = false;	// Motor has reached its set point and stopped
+	bool				flag_holding_ready = false;	// Ready line held low until the motor is in position
 
 	// Miscellaneous
 	unsigned long		i = 0;			// Dummy counter
@@ -90,6 +149,8 @@
 	// Objects
 	motor mtr;
 	serial sport;
+	pid loop;
+	profile motion;
 	
 	
 
@@ -97,69 +158,56 @@
 //============================================================================================================
 /* State-Transition Logic Tasks */
 
-// Motor Task
+// Motor Task: run once per control period by the timer 1 interrupt, so with interrupts off
 
-	unsigned char motor_task(unsigned char state_motor, motor* the_motor)
+	void motor_task(void)
 	{
-		mtr = *the_motor;
+		if (!(flag_enable))	// If motor stop command issued
+		{
+			mtr.stop();		// Activate brake
+			loop.reset(count);	// Start the controller afresh when the motor is next enabled
+			motion.reset(count);	// and move from wherever the motor has been left
+			flag_in_position = false;	// It isn't holding any set point
+			READY_DDR &= ~(1 << PIN_READY);	// and won't get there, so it mustn't hold up the master
+			flag_holding_ready = false;
+			return;
+		}
+		
+		// Move the desired count one tick along the motion profile toward the set point
+		desired_count = motion.run();
+		
+		// Run the controller for one tick; its output is already trimmed to -255 to 255
+		motor_output = loop.run(desired_count, count);
 		
-		switch(state_motor)
+		// See whether the motor has arrived and stopped, for the Q command
+		flag_in_position = motion.at_target() && still_ticks >= SETTLE_TICKS
+						   && (short int) (desired_count - count) <= SETTLE_ERROR
+						   && (short int) (desired_count - count) >= -SETTLE_ERROR;
+		
+		// Let the ready line go once the motor is in position; the master sees it rise when the last
+		// slave it's waiting for lets go
+		if (flag_in_position && flag_holding_ready)
 		{
-			case(0):		// Check Flags
-				if (!(flag_enable))	// If motor stop command issued
-				{
-					state_motor = 1;	// go to state 1
-					break;
-				}
-				if (flag_enable)	// If motor go command issued (or no overriding commands issued)
-				{
-					state_motor = 2;	// go to state 2
-					break;
-				}
-				break;
-			case(1):		// Stop Motor
-				mtr.stop();		// Activate brake
-				state_motor = 0;	// go to state 0
-				break;
-			case(2):		// Calculate Motor Output
-
-				// Calculate control loop error
-				control_error = count - desired_count;
-					
-				// Calculate value and trim to 0-255 range
-				if (control_error > 1)
-					motor_output = (long) (kp * control_error * 255) / 768;
-				else if (control_error < -1)
-					motor_output = (long) (0xFF * control_error * 255) / 768;
-				else
-					motor_output = 0;
-				if (motor_output > 255)
-					motor_output = 255;
-				
-				state_motor = 3;	// go to state 3
-				break;
-			case(3):		// Output to Motor
-				// Set direction
-				if (control_error > 0)
-				{
-					mtr.d1();
-					mtr.output( (unsigned char) motor_output);
-				}
-				else if (control_error < 0)
-				{
-					mtr.d0();
-					mtr.output( (unsigned char) motor_output);
-				}
-				else
-					mtr.stop();
-					
-				state_motor = 0;	// Always return to state 1
-				break;
-			default:
-				state_motor = 0;
-				break;
+			READY_DDR &= ~(1 << PIN_READY);
+			flag_holding_ready = false;
+		}
+		
+		// Set direction
+		if (motor_output < 0)
+		{
+			mtr.d1();
+			mtr.output( (unsigned char) -motor_output);
+		}
+		else if (motor_output > 0)
+		{
+			mtr.d0();
+			mtr.output( (unsigned char) motor_output);
+		}
+		else
+		{
+			mtr.stop();
+			mtr.output(255);	// Brake hard inside the deadband
 		}
-		return(state_motor);
 	}
 	
 // Data Task
@@ -174,6 +222,7 @@
 			case(0):		// Check for Character
 				if(sport.check_for_char())	
 				{	
+					character_in = sport.getchar();
 					state_data = 1;	// If character received go to state 1
 				}
 				else					
@@ -218,12 +267,12 @@
 					// S,G disable and enable the motor
 					case('S'):	// Stop Motor
 						flag_enable = false;	// Disable motor
-						state_data = 1;		// Go to state 1
+						state_data = 0;		// Go to state 0
 						sport.send('s');		// Confirm command reception
 						break;
 					case('G'):	// Go (enable motor)
 						flag_enable = true;		// Enable motor
-						state_data = 1;			// Go to state 1
+						state_data = 0;			// Go to state 0
 						sport.send('g');		// Confirm command reception
 						break;
 					// C clears the encoder count to calibrate the motor position
@@ -232,7 +281,7 @@
 						state_data = 5;						// Go to state 5
 						sport.send('c');					// Confirm command reception
 						break;
-					// Q queries to identify whether the motor is done moving to the correct position
+					// Q asks whether the motor is done moving to its set point
 					case('Q'):	// Position Query from master chip
 						state_data = 2;
 						break;
@@ -255,13 +304,48 @@
 					case('E'):	// Encoder Query
 						state_data = 4;
 						break;
+					// T reports the longest control interrupt since the last T, in units of 8 cycles
+					case('T'):	// Timing Query
+						sport.send(control_ticks);
+						control_ticks = 0;
+						state_data = 0;
+						break;
+					// P sets the motion profile's speed limit and acceleration, given in the next two bytes
+					case('P'):	// Profile
+						state_data = 8;
+						break;
+					// F starts a set point frame broadcast to all motors
+					case(FRAME_START):
+						frame_index = 0;
+						frame_check = 0;
+						frame_field = 0;
+						state_data = 7;
+						break;
+					// W starts a target frame broadcast to all motors
+					case(TARGET_START):
+						frame_index = 0;
+						frame_check = 0;
+						frame_field = TARGET_KEEP;
+						state_data = 10;
+						break;
+					// B switches the baud rate to the code in the next byte
+					case(BAUD_COMMAND):
+						state_data = 11;
+						break;
+					// U starts a baud rate test, a pattern of bytes to check
+					case(BAUD_TEST):
+						frame_index = 0;
+						frame_check = 0;
+						state_data = 12;
+						break;
 					default:
-						state_data = 1;	// Return to state 1 if character is unclear
+						state_data = 0;	// Return to state 0 if character is unclear
 						break;
 				}
 				break;
 			case(2):		// Position Query
-				state_data = 1;
+				sport.send(flag_in_position ? 'q' : 'Q');	// 'q' when in position, 'Q' while still moving
+				state_data = 0;
 				break;
 			case(3):		// Motor Identification and data loading
 				// Load angle data
@@ -271,92 +355,268 @@
 				}
 				
 				// Load gain data
-				kp = kp_array[motor_number-1];
+				loop.set_gains(pgm_read_byte(&kp_array[motor_number-1]), pgm_read_byte(&ki_array[motor_number-1]),
+							   pgm_read_byte(&kd_array[motor_number-1]));
 				
 				// Send confirmation back to master
 				sport.send('!');
 				
-				state_data = 1;
+				state_data = 0;
 				break;
 			case(4):		// Respond to Encoder Query
+				cli();		// The control interrupt changes both bytes of the count
 				count_8bit = (unsigned char) (count << 2);
+				sei();
 				sport.send(count_8bit);
+				state_data = 0;
 				break;
 			case(5):		// Calibrate
 				if (!flag_calibrate)	// If the calibration flag has been turned off
 				{
+					cli();
 					count = 1;	// Clear count
+					ENCODER_DELTA = 0;
+					sei();
 				}
-				state_data = 1;	// Always return to state 1
+				state_data = 0;	// Always return to state 0
 				break;
 			case(6):		// New set point
-				desired_count = set_point_angles[set_point-1];
-				state_data = 1;
+				cli();		// The control interrupt runs the motion profile toward the set point
+				motion.set_target(set_point_angles[set_point-1]);
+				flag_in_position = false;	// Not until the control interrupt has checked again
+				READY_DDR |= (1 << PIN_READY);	// Pull the ready line low until then
+				flag_holding_ready = true;
+				sei();
+				state_data = 0;
+				break;
+			case(7):		// Receive set point frame
+				if(!sport.check_for_char())
+				{
+					break;		// Stay in state 7 until the next byte arrives
+				}
+				frame_byte = sport.getchar();
+				
+				// A byte without the frame mark is a command, so the frame was cut short
+				if(!(frame_byte & FRAME_MARK))
+				{
+					character_in = frame_byte;
+					state_data = 1;
+				}
+				// Data bytes: keep the one holding this motor's set point
+				else if(frame_index < FRAME_DATA)
+				{
+					frame_check ^= frame_byte;
+					if(motor_number != 0 && frame_index == ((motor_number - 1) >> 1))
+					{
+						frame_field = frame_byte;
+					}
+					frame_index++;
+				}
+				// Check byte: use the set point only if the frame arrived intact
+				else
+				{
+					state_data = 0;
+					if(frame_byte == (frame_check | FRAME_MARK))
+					{
+						if((motor_number - 1) & 1)
+							frame_field >>= 3;
+						frame_field &= 0x07;
+						if(frame_field >= 1 && frame_field <= 5)
+						{
+							set_point = frame_field;
+							state_data = 6;
+						}
+					}
+				}
+				break;
+			case(8):		// Receive profile speed limit
+				if(sport.check_for_char())
+				{
+					profile_speed = sport.getchar();
+					state_data = 9;
+				}
+				break;
+			case(9):		// Receive profile acceleration
+				if(sport.check_for_char())
+				{
+					character_in = sport.getchar();
+					cli();		// The control interrupt runs the motion profile
+					motion.set_limits(profile_speed, (unsigned char) character_in);
+					sei();
+					sport.send('p');	// Confirm command reception
+					state_data = 0;
+				}
+				break;
+			case(10):		// Receive target frame
+				if(!sport.check_for_char())
+				{
+					break;		// Stay in state 10 until the next byte arrives
+				}
+				frame_byte = sport.getchar();
+				
+				// A byte without the frame mark is a command, so the frame was cut short
+				if(!(frame_byte & FRAME_MARK))
+				{
+					character_in = frame_byte;
+					state_data = 1;
+				}
+				// Data bytes: keep the two holding this motor's count
+				else if(frame_index < TARGET_DATA)
+				{
+					frame_check ^= frame_byte;
+					if(motor_number != 0 && (frame_index >> 1) == motor_number - 1)
+					{
+						if(frame_index & 1)
+							frame_low = frame_byte;
+						else
+							frame_field = frame_byte;
+					}
+					frame_index++;
+				}
+				// Check byte: move to the count only if the frame arrived intact
+				else
+				{
+					state_data = 0;
+					if(frame_byte == (frame_check | FRAME_MARK) && !(frame_field & TARGET_KEEP))
+					{
+						cli();		// The control interrupt runs the motion profile toward the target
+						motion.set_target(((unsigned short int) (frame_field & 0x07) << 7) | (frame_low & 0x7F));
+						flag_in_position = false;
+						if(!(frame_field & TARGET_QUIET))
+						{
+							READY_DDR |= (1 << PIN_READY);	// Pull the ready line low until in position
+							flag_holding_ready = true;
+						}
+						sei();
+					}
+				}
+				break;
+			case(11):		// Receive baud rate code
+				if(!sport.check_for_char())
+				{
+					break;		// Stay in state 11 until the code arrives
+				}
+				frame_byte = sport.getchar();
+				if(!(frame_byte & FRAME_MARK))
+				{
+					character_in = frame_byte;
+					state_data = 1;
+				}
+				else
+				{
+					sport.set_baud(frame_byte & ~FRAME_MARK);
+					state_data = 0;
+				}
+				break;
+			case(12):		// Receive baud rate test
+				if(!sport.check_for_char())
+				{
+					break;		// Stay in state 12 until the next byte arrives
+				}
+				frame_byte = sport.getchar();
+				
+				// A byte without the frame mark is a command, so the test was cut short
+				if(!(frame_byte & FRAME_MARK))
+				{
+					character_in = frame_byte;
+					state_data = 1;
+					break;
+				}
+				if(frame_byte != BAUD_PATTERN(frame_index))
+				{
+					frame_check = 1;
+				}
+				// Answer only if every byte was right; the master takes silence as a failed test
+				if(++frame_index >= BAUD_TEST_BYTES)
+				{
+					if(!frame_check)
+					{
+						sport.send(BAUD_TEST_ACK);
+					}
+					state_data = 0;
+				}
 				break;
 			default:
-				state_data = 1;
+				state_data = 0;
 				break;
 		}
 		return(state_data);
 	}
 
 //============================================================================================================
-/* Main Function */
+/* Setup and Loop */
 
-// Initialize variables
+// Setup: prepares the encoder and control interrupts and tells the master the slave is running
 
-int main(void)
-{
-
-	
-// Setup
-
-	// Create objects
-	motor mtr;	// Create motor
-	serial sport;	// Create serial port
-
-
-	// Setup Encoder Data Directions
-	INTERRUPT_DDR &= ~(1 << PIN_INT0);	// Input
-	INTERRUPT_DDR &= ~(1 << PIN_INT1);	// Input
-	
-	// Enable interrupts on INTO, INT1, and PCINT2
-	
-		// Enable interrupt on both rising and falling edges for both pins
-		MCUCR |= (1 << ISC10);	// ISC11 = 0, ISC10 = 1
-		MCUCR |= (1 << ISC00);	// ISC01 = 0, ISC00 = 1
+	void slave_setup(void)
+	{
+		// Setup Encoder Data Directions
+		INTERRUPT_DDR &= ~(1 << PIN_INT0);	// Input
+		INTERRUPT_DDR &= ~(1 << PIN_INT1);	// Input
 		
-		// Enable interrupts on INTO, INT1, and PCIE
-		GIMSK |= (1 << INT0);
-		GIMSK |= (1 << INT1);
-		GIMSK |= (1 << PCIE);
+		// Let the ready line go; its port bit stays 0, so making the pin an output pulls the line low
+		READY_PORT &= ~(1 << PIN_READY);
+		READY_DDR &= ~(1 << PIN_READY);
 		
-		// Enable interrupts on PCINT2
-		PCMSK |= (1 << PCINT2);	// Write 1 to PCINT2 bit of PCMSK register
-	
-	// Turn on interrupts
-	sei();
-	
-	// Motor Data
-/*	for (i = 1; i<10; i++)
-	{
-		kp_array[i] = 4;
+		// Enable interrupts on INTO, INT1, and PCINT2
+		
+			// Enable interrupt on both rising and falling edges for both pins
+			MCUCR |= (1 << ISC10);	// ISC11 = 0, ISC10 = 1
+			MCUCR |= (1 << ISC00);	// ISC01 = 0, ISC00 = 1
+		
+			// Enable interrupts on INTO, INT1, and PCIE
+			GIMSK |= (1 << INT0);
+			GIMSK |= (1 << INT1);
+			GIMSK |= (1 << PCIE);
+		
+			// Enable interrupts on PCINT2
+			PCMSK |= (1 << PCINT2);	// Write 1 to PCINT2 bit of PCMSK register
+		
+		// Interrupt at CONTROL_RATE_Hz from timer 1, clearing it on compare match A with the clock / 8
+		OCR1A = CONTROL_TICKS - 1;
+		TCCR1A = 0;
+		TCCR1B = (1 << WGM12) | (1 << CS11);
+		TIMSK |= (1 << OCIE1A);
+		
+		// Idle between interrupts; the timers and USART keep running
+		set_sleep_mode(SLEEP_MODE_IDLE);
+		
+		// Turn on interrupts
+		sei();
+		
+		sport.send('A');
 	}
-*/
-	bool data_sent = false;
 
-// Loop
+// Loop: one pass through the data task, the motor task being run by the control interrupt. With nothing
+// to do the CPU sleeps until the next interrupt: the control interrupt, at most one control period away, or
+// the next byte, whose receive interrupt is turned on just before sleeping. Interrupts stay off from the
+// check until the sleep instruction, so a byte which comes in between still wakes the CPU
 
-	while(true)	// loop forever between these two tasks
-	{		
-		if (!data_sent)
+	void slave_loop(void)
+	{
+		state_data = data_task(state_data, &sport, &mtr);
+		cli();
+		if (state_data == 0 && !sport.check_for_char())
 		{
-			sport.send('A');
-			data_sent = true;
+			UCSRB |= (1 << RXCIE);
+			sleep_enable();
+			sei();
+			sleep_cpu();
+			sleep_disable();
 		}
+		sei();
+	}
 
-		state_motor = motor_task(state_motor, &mtr);
-		state_data = data_task(state_data, &sport, &mtr);
+//============================================================================================================
+/* Main Function */
+
+int main(void)
+{
+	slave_setup();
+	
+	while(true)	// loop forever in the data task
+	{		
+		slave_loop();
 	}	
 	return(0);
 }
@@ -365,81 +625,70 @@ int main(void)
 /* Interrupt Service Routines */
 
 
-// Interrupt for Encoder Channel A
+// Encoder steps, indexed by ENCODER_STATE: +1 clockwise, -1 counterclockwise, and 0 for an encoder error,
+// where the reading didn't change or both channels changed at once. Reading by reading, clockwise is
+// (B << 1) | A going 00, 01, 11, 10
+const signed char encoder_steps[16] PROGMEM =
+{
+//	  Now:	 00	 01	 10	 11
+			 0,	+1,	-1,	 0,		// Was 00
+			-1,	 0,	 0,	+1,		// Was 01
+			+1,	 0,	 0,	-1,		// Was 10
+			 0,	-1,	+1,	 0		// Was 11
+};
+
+// Interrupt for Encoder Channel A. The encoder's state and its steps are kept in general purpose I/O
+// registers, which take one cycle to reach, and the steps in a single byte, so nothing here needs the
+// 16-bit count; the control interrupt adds the steps to the count
 ISR(INT0_vect)
 {
+	unsigned char state;
+	signed char step;
 	
-	// Store last reading to old variable
-	previous_reading = current_reading;
+	// Shift the new reading in behind the last one and look up the step between them
+	state = ((ENCODER_STATE << 2) | ((PIND >> ENCODER_SHIFT) & 0x03)) & 0x0F;
+	ENCODER_STATE = state;
+	step = (signed char) pgm_read_byte(&encoder_steps[state]);
 	
-	// Take in new reading
-	current_reading = ((PIND & 0b00000100) >> 1) | ((PIND & 0b00001000) >> 3);	// (A << 1) | B
-
-	// Evaluate Reading
-	switch(current_reading)
-	{
-		case(0):				// Current value == 00
-			switch(previous_reading)
-			{
-				case(1):		// 01 to 00
-					CLOCKWISE ;
-					break;
-				case(2):		// 10 to 00
-					COUNTERCLOCKWISE ;
-					break;
-				default:		// 11 to 00
-					ENCODER_ERROR ;
-					break;
-			}
-			break;
-		case(1):				// Current value == 01
-			switch(previous_reading)
-			{
-				case(3):		// 11 to 01
-					CLOCKWISE ;
-					break;
-				case(0):		// 00 to 01
-					COUNTERCLOCKWISE ;
-					break;
-				default:		// 10 to 01
-					ENCODER_ERROR ;
-					break;
-			}
-			break;
-		case(2):				// Current value == 10
-			switch(previous_reading)
-			{
-				case(0):		// 00 to 10
-					CLOCKWISE ;
-					break;
-				case(3):		// 11 to 10
-					COUNTERCLOCKWISE ;
-					break;
-				default:		// 01 to 10
-					ENCODER_ERROR ;
-					break;
-			}
-			break;
-		case(3):				// Current value == 11
-			switch(previous_reading)
-			{
-				case(2):		// 10 to 11
-					CLOCKWISE ;
-					break;
-				case(1):		// 01 to 11
-					COUNTERCLOCKWISE ;
-					break;
-				default:		// 00 to 11
-					ENCODER_ERROR ;
-					break;
-			}
-			break;
-		default:
-			break;
-	}
+	if (step)
+		ENCODER_DELTA = ENCODER_DELTA + step;
+	else
+		errors++;
 }
 
 // Interrupt for Encoder Channel B
 ISR(INT1_vect, ISR_ALIASOF(INT0_vect));	// Duplicate code from encoder channel A
 
+// Interrupt for the Control Loop
+ISR(TIMER1_COMPA_vect)
+{
+	unsigned short int ticks;
+	
+	// Take in the encoder steps counted since the last tick, timing how long the motor has been still
+	if (ENCODER_DELTA)
+	{
+		count += (signed char) ENCODER_DELTA;
+		ENCODER_DELTA = 0;
+		still_ticks = 0;
+	}
+	else if (still_ticks < SETTLE_TICKS)
+	{
+		still_ticks++;
+	}
+	
+	motor_task();
+	
+	// Timer 1 restarted from zero at the compare match, so it has counted how long this interrupt took
+	ticks = TCNT1;
+	if (ticks > control_ticks)
+	{
+		control_ticks = (ticks > 255) ? 255 : (unsigned char) ticks;
+	}
+}
 
+// Receive interrupt, only turned on while the CPU sleeps. It just wakes the CPU, turning itself off again so
+// that it doesn't run over and over; the data task reads the byte
+ISR(USART_RX_vect)
+{
+	UCSRB &= ~(1 << RXCIE);
+}